@@ -0,0 +1,169 @@
+/** bench-casting.cpp
+ * Measures `gch::dyn_cast` against `dynamic_cast`. This must be built with RTTI.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "bench_common.hpp"
+#include "gch/nonnull_ptr_casting.hpp"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+  enum class kind
+  {
+    leaf,
+    unary,
+    binary,
+    last_binary,
+    ternary
+  };
+
+  struct node
+  {
+    explicit
+    node (kind k) noexcept
+      : node_kind (k)
+    { }
+
+    virtual ~node (void) = default;
+
+    kind node_kind;
+  };
+
+  struct leaf final : node
+  {
+    leaf (void) noexcept
+      : node (kind::leaf)
+    { }
+
+    static
+    bool
+    classof (const node *n) noexcept
+    {
+      return n->node_kind == kind::leaf;
+    }
+
+    unsigned value = 1;
+  };
+
+  struct unary final : node
+  {
+    unary (void) noexcept
+      : node (kind::unary)
+    { }
+
+    static
+    bool
+    classof (const node *n) noexcept
+    {
+      return n->node_kind == kind::unary;
+    }
+
+    unsigned value = 2;
+  };
+
+  // Non-final, so dynamic_cast has to walk the hierarchy.
+  struct binary : node
+  {
+    explicit
+    binary (kind k = kind::binary) noexcept
+      : node (k)
+    { }
+
+    static
+    bool
+    classof (const node *n) noexcept
+    {
+      return n->node_kind >= kind::binary && n->node_kind <= kind::last_binary;
+    }
+
+    unsigned value = 3;
+  };
+
+  struct ternary final : binary
+  {
+    ternary (void) noexcept
+      : binary (kind::ternary)
+    { }
+
+    static
+    bool
+    classof (const node *n) noexcept
+    {
+      return n->node_kind == kind::ternary;
+    }
+  };
+
+  template <typename F>
+  BENCH_NOINLINE
+  unsigned
+  count (const std::vector<gch::nonnull_ptr<const node>>& nodes, F f)
+  {
+    unsigned total = 0;
+    for (gch::nonnull_ptr<const node> n : nodes)
+      total += f (n);
+    return total;
+  }
+
+  struct with_dyn_cast
+  {
+    unsigned
+    operator() (gch::nonnull_ptr<const node> n) const noexcept
+    {
+      if (const binary *b = gch::dyn_cast<binary> (n))
+        return b->value;
+      return 0;
+    }
+  };
+
+  struct with_dynamic_cast
+  {
+    unsigned
+    operator() (gch::nonnull_ptr<const node> n) const noexcept
+    {
+      if (const binary *b = dynamic_cast<const binary *> (n.get ()))
+        return b->value;
+      return 0;
+    }
+  };
+
+}
+
+int
+main (int argc, char **argv)
+{
+  const std::size_t n = bench::iterations (argc, argv, 1 << 20);
+
+  std::vector<std::unique_ptr<node>> storage;
+  std::vector<gch::nonnull_ptr<const node>> nodes;
+  std::mt19937 gen { 42 };
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    switch (gen () % 4)
+    {
+      case 0:  storage.emplace_back (new leaf);    break;
+      case 1:  storage.emplace_back (new unary);   break;
+      case 2:  storage.emplace_back (new binary);  break;
+      default: storage.emplace_back (new ternary); break;
+    }
+    nodes.emplace_back (*storage.back ());
+  }
+
+  bench::report (bench::run ("gch::dyn_cast (classof)", n, [&] (std::size_t) {
+    bench::do_not_optimize (count (nodes, with_dyn_cast { }));
+  }));
+
+  bench::report (bench::run ("dynamic_cast (RTTI)", n, [&] (std::size_t) {
+    bench::do_not_optimize (count (nodes, with_dynamic_cast { }));
+  }));
+
+  return 0;
+}
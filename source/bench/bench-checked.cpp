@@ -0,0 +1,109 @@
+/** bench-checked.cpp
+ * Measures binding and dereferencing nonnull_ptr with and without
+ * GCH_NONNULL_PTR_CHECKED. This is built once normally and once in the
+ * checked mode, which is measured at several sampling periods with a
+ * populated poison registry.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "bench_common.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+  struct object
+  {
+    std::uint64_t value;
+    std::uint64_t padding;
+  };
+
+  std::uint64_t
+  next_random (std::uint64_t& state) noexcept
+  {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  }
+
+  void
+  run_kernels (const char *mode, std::vector<object>& objects)
+  {
+    const std::size_t n = objects.size ();
+    char name[64];
+
+    std::vector<gch::nonnull_ptr<object>> handles;
+    handles.reserve (n);
+    std::snprintf (name, sizeof (name), "bind: %s", mode);
+    bench::report (bench::run (name, n, [&] (std::size_t) {
+      handles.clear ();
+      for (object& o : objects)
+        handles.emplace_back (o);
+      bench::do_not_optimize (handles.data ());
+    }));
+
+    // In order, this is bound by the loop itself, which shows the most overhead.
+    std::snprintf (name, sizeof (name), "deref in order: %s", mode);
+    bench::report (bench::run (name, n, [&] (std::size_t) {
+      std::uint64_t sum = 0;
+      for (const gch::nonnull_ptr<object>& h : handles)
+        sum += h->value;
+      bench::do_not_optimize (sum);
+    }));
+
+    std::vector<gch::nonnull_ptr<object>> shuffled (handles);
+    std::uint64_t state = 0x2545F4914F6CDD1DULL;
+    for (std::size_t i = n; i > 1; --i)
+      std::swap (shuffled[i - 1], shuffled[next_random (state) % i]);
+
+    std::snprintf (name, sizeof (name), "deref shuffled: %s", mode);
+    bench::report (bench::run (name, n, [&] (std::size_t) {
+      std::uint64_t sum = 0;
+      for (const gch::nonnull_ptr<object>& h : shuffled)
+        sum += (*h).value;
+      bench::do_not_optimize (sum);
+    }));
+  }
+
+}
+
+int
+main (int argc, char **argv)
+{
+  std::vector<object> objects (bench::iterations (argc, argv, 1 << 20));
+  for (std::size_t i = 0; i < objects.size (); ++i)
+    objects[i].value = i;
+
+#ifdef GCH_NONNULL_PTR_CHECKED
+  // Poisoned memory which the kernels never touch, so that each sampled check searches a
+  // populated registry and finds nothing.
+  constexpr std::size_t freed_count = 1024;
+  std::unique_ptr<object[]> freed (new object[freed_count]);
+  for (std::size_t i = 0; i < freed_count; ++i)
+    gch::checked::poison (&freed[i], sizeof (object));
+
+  char mode[32];
+  for (std::uint32_t period : { 1000U, 100U, 1U })
+  {
+    gch::checked::set_sample_period (period);
+    std::snprintf (mode, sizeof (mode), "checked 1/%u", static_cast<unsigned> (period));
+    run_kernels (mode, objects);
+  }
+
+  gch::checked::unpoison (&freed[0], freed_count * sizeof (object));
+#else
+  run_kernels ("unchecked", objects);
+#endif
+
+  return 0;
+}
@@ -0,0 +1,238 @@
+/** bench-compile.cpp
+ * Measures how long the compiler takes on translation units which include
+ * each of the nonnull_ptr headers, against an empty one and one which
+ * includes only <functional>. When the module is configured, it also
+ * measures a unit which imports gch.nonnull_ptr instead.
+ *
+ * A generated unit which instantiates the constructors and comparisons for
+ * many types measures the overload sets themselves. It is only checked with
+ * -fsyntax-only, so that the time is the frontend's. From C++20 it is also
+ * checked with GCH_DISABLE_CONCEPTS, which selects the enable_if overloads
+ * in place of the requires-clauses.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "bench_common.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#ifndef NONNULL_PTR_BENCH_TIME_FLAGS
+#  define NONNULL_PTR_BENCH_TIME_FLAGS ""
+#endif
+
+#if defined (NONNULL_PTR_BENCH_CXX_COMPILER) && defined (NONNULL_PTR_BENCH_INCLUDE_DIR) \
+ && defined (NONNULL_PTR_BENCH_WORK_DIR)
+
+namespace
+{
+
+  // The translation units, by name. Each one also instantiates the operations that its
+  // header provides, so that the cost of overload resolution is included.
+  struct unit
+  {
+    const char *name;
+    const char *source;
+  };
+
+  const unit units[] = {
+    { "empty", "" },
+    { "functional", "#include <functional>\n" },
+    { "nonnull_ptr_fwd",
+      "#include \"gch/nonnull_ptr_fwd.hpp\"\n"
+      "bool f (const gch::nonnull_ptr<int>&);\n" },
+    { "nonnull_ptr_core",
+      "#include \"gch/nonnull_ptr_core.hpp\"\n"
+      "bool f (gch::nonnull_ptr<int> p, gch::nonnull_cptr<int> q) { return p == q; }\n" },
+    { "nonnull_ptr_functional",
+      "#include \"gch/nonnull_ptr_functional.hpp\"\n"
+      "bool f (gch::nonnull_ptr<int> p, gch::nonnull_cptr<int> q) { return p < q; }\n" },
+    { "nonnull_ptr",
+      "#include \"gch/nonnull_ptr.hpp\"\n"
+      "bool f (gch::nonnull_ptr<int> p, gch::nonnull_cptr<int> q) { return p < q; }\n" },
+  };
+
+  // The number of distinct types in the generated unit.
+  constexpr int instantiation_types = 100;
+
+  // Each type gets a function which converts, emplaces, projects and compares, so that
+  // every overload set of nonnull_ptr is resolved once per type.
+  std::string
+  instantiation_source (void)
+  {
+    std::string source = "#include \"gch/nonnull_ptr.hpp\"\n"
+                         "struct base { int v; };\n";
+    char buffer[640];
+    for (int i = 0; i < instantiation_types; ++i)
+    {
+      std::snprintf (buffer, sizeof (buffer),
+        "struct s%d : base { int w; };\n"
+        "bool f%d (s%d& a, s%d& b, base *raw)\n"
+        "{\n"
+        "  gch::nonnull_ptr<s%d> p (a);\n"
+        "  gch::nonnull_ptr<const s%d> c (p);\n"
+        "  gch::nonnull_ptr<base> q (p);\n"
+        "  p.emplace (b);\n"
+        "  q.emplace (p);\n"
+        "  gch::nonnull_ptr<int> m = p.project (&s%d::w);\n"
+        "  return p == c && q == raw && raw != q && c < p && q <= raw && raw > q && *m == 0;\n"
+        "}\n",
+        i, i, i, i, i, i, i);
+      source += buffer;
+    }
+    return source;
+  }
+
+  const char *
+  standard_flag (void) noexcept
+  {
+#if __cplusplus > 201703L
+    return "-std=c++20";
+#elif __cplusplus > 201402L
+    return "-std=c++17";
+#elif __cplusplus > 201103L
+    return "-std=c++14";
+#else
+    return "-std=c++11";
+#endif
+  }
+
+  // Writes the unit and returns the path of the unit without its extension.
+  std::string
+  prepare (const unit& u)
+  {
+    const std::string base = std::string (NONNULL_PTR_BENCH_WORK_DIR) + "/compile-" + u.name
+                           + "." + (standard_flag () + 5);
+    std::ofstream (base + ".cpp") << u.source;
+    return base;
+  }
+
+  std::string
+  compile_command (const std::string& base, const char *extra_flags, const char *log)
+  {
+    return std::string ("\"") + NONNULL_PTR_BENCH_CXX_COMPILER + "\" " + standard_flag ()
+         + " -O0 " + extra_flags + " -I\"" NONNULL_PTR_BENCH_INCLUDE_DIR "\""
+         + " -c \"" + base + ".cpp\" -o \"" + base + ".o\" > \"" + base + log + "\" 2>&1";
+  }
+
+  int
+  measure (const unit& u, const char *extra_flags, const char *prefix, std::size_t repetitions)
+  {
+    // The first compile asks for the compiler's own breakdown of its time (from
+    // -ftime-trace or -ftime-report), which is left in the .json or .log file next to the
+    // unit. The timed compiles leave it out, since collecting it has a cost of its own.
+    const std::string base = prepare (u);
+    const std::string detailed = prefix + compile_command (
+      base, (std::string (NONNULL_PTR_BENCH_TIME_FLAGS) + " " + extra_flags).c_str (), ".log");
+    if (std::system (detailed.c_str ()) != 0)
+    {
+      std::printf ("Could not compile the unit `%s`: %s\n", u.name, detailed.c_str ());
+      return 1;
+    }
+
+    const std::string command = prefix + compile_command (base, extra_flags, ".timed.log");
+
+    // Each repetition is one compile, so this reports nanoseconds per compile.
+    char name[64];
+    std::snprintf (name, sizeof (name), "compile %s: %s", standard_flag () + 5, u.name);
+    bench::report (bench::run (name, 1, [&] (std::size_t) {
+      bench::do_not_optimize (std::system (command.c_str ()));
+    }, repetitions));
+
+    return 0;
+  }
+
+#if __cplusplus > 201703L && defined (NONNULL_PTR_BENCH_MODULE_INTERFACE)
+
+  // The module is compiled once, as a build system would, and then the unit which imports
+  // it is timed against the unit which includes nonnull_ptr.hpp. The commands run in the
+  // work directory, since GCC looks for compiled modules in gcm.cache under the current
+  // directory.
+  const unit module_unit = {
+    "nonnull_ptr_module",
+    "import gch.nonnull_ptr;\n"
+    "bool f (gch::nonnull_ptr<int> p, gch::nonnull_cptr<int> q) { return p < q; }\n"
+  };
+
+  int
+  measure_module (std::size_t repetitions)
+  {
+    const std::string prefix = "cd \"" NONNULL_PTR_BENCH_WORK_DIR "\" && ";
+    const std::string interface = prefix + "\"" NONNULL_PTR_BENCH_CXX_COMPILER "\" "
+      + standard_flag () + " -O0 " NONNULL_PTR_BENCH_MODULE_PRECOMPILE_FLAGS
+      + " -I\"" NONNULL_PTR_BENCH_INCLUDE_DIR "\" \"" NONNULL_PTR_BENCH_MODULE_INTERFACE "\""
+      + " -o \"" NONNULL_PTR_BENCH_MODULE_OUTPUT "\" > compile-module.log 2>&1";
+
+    if (std::system (interface.c_str ()) != 0)
+    {
+      std::printf ("Could not compile the module interface: %s\n", interface.c_str ());
+      return 1;
+    }
+
+    char name[64];
+    std::snprintf (name, sizeof (name), "compile %s: module interface", standard_flag () + 5);
+    bench::report (bench::run (name, 1, [&] (std::size_t) {
+      bench::do_not_optimize (std::system (interface.c_str ()));
+    }, repetitions));
+
+    return measure (module_unit, NONNULL_PTR_BENCH_MODULE_IMPORT_FLAGS, prefix.c_str (),
+                    repetitions);
+  }
+
+#endif
+
+}
+
+int
+main (int argc, char **argv)
+{
+  if (std::system (nullptr) == 0)
+  {
+    std::printf ("No command processor is available.\n");
+    return 0;
+  }
+
+  const std::size_t repetitions = bench::iterations (argc, argv, 5);
+
+  for (const unit& u : units)
+  {
+    if (measure (u, "", "", repetitions) != 0)
+      return 1;
+  }
+
+  const std::string source = instantiation_source ();
+  if (measure ({ "instantiations", source.c_str () }, "-fsyntax-only", "", repetitions) != 0)
+    return 1;
+
+#if __cplusplus > 201703L
+  if (measure ({ "instantiations_enable_if", source.c_str () },
+               "-fsyntax-only -DGCH_DISABLE_CONCEPTS", "", repetitions) != 0)
+  {
+    return 1;
+  }
+#endif
+
+#if __cplusplus > 201703L && defined (NONNULL_PTR_BENCH_MODULE_INTERFACE)
+  if (measure_module (repetitions) != 0)
+    return 1;
+#endif
+
+  return 0;
+}
+
+#else
+
+int
+main (void)
+{
+  std::printf ("The compiler to measure was not configured.\n");
+  return 0;
+}
+
+#endif
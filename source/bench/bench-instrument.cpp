@@ -0,0 +1,116 @@
+/** bench-instrument.cpp
+ * Measures dereferencing, rebinding and comparing nonnull_ptr with and
+ * without GCH_NONNULL_PTR_INSTRUMENT. This is built once normally, once
+ * with the per-type counters, and once with the call sites as well. The
+ * instrumented builds also measure a value type which is excluded from
+ * instrumentation.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifdef GCH_NONNULL_PTR_INSTRUMENT
+#  define GCH_NONNULL_PTR_INSTRUMENT_ALL_TYPES 0
+#endif
+
+#include "bench_common.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+
+  template <int Tag>
+  struct object
+  {
+    std::uint64_t value;
+  };
+
+  using counted  = object<0>;
+  using excluded = object<1>;
+
+}
+
+#ifdef GCH_NONNULL_PTR_INSTRUMENT
+
+namespace gch
+{
+
+  namespace instrument
+  {
+
+    template <>
+    struct is_instrumented<counted>
+      : std::true_type
+    { };
+
+  }
+
+}
+
+#endif
+
+namespace
+{
+
+  template <typename T>
+  void
+  run_kernels (const char *mode, std::size_t n)
+  {
+    std::vector<T> objects (n);
+    for (std::size_t i = 0; i < n; ++i)
+      objects[i].value = i;
+
+    std::vector<gch::nonnull_ptr<T>> handles;
+    handles.reserve (n);
+    for (T& o : objects)
+      handles.emplace_back (o);
+
+    char name[64];
+    std::snprintf (name, sizeof (name), "dereference: %s", mode);
+    bench::report (bench::run (name, n, [&] (std::size_t) {
+      std::uint64_t sum = 0;
+      for (const gch::nonnull_ptr<T>& h : handles)
+        sum += h->value;
+      bench::do_not_optimize (sum);
+    }));
+
+    std::snprintf (name, sizeof (name), "rebind: %s", mode);
+    bench::report (bench::run (name, n, [&] (std::size_t) {
+      for (std::size_t i = 0; i < n; ++i)
+        handles[i].emplace (objects[n - 1 - i]);
+      bench::do_not_optimize (handles.data ());
+    }));
+
+    std::snprintf (name, sizeof (name), "compare: %s", mode);
+    bench::report (bench::run (name, n, [&] (std::size_t) {
+      std::size_t ordered = 0;
+      for (std::size_t i = 1; i < n; ++i)
+        ordered += handles[i - 1] < handles[i];
+      bench::do_not_optimize (ordered);
+    }));
+  }
+
+}
+
+int
+main (int argc, char **argv)
+{
+  const std::size_t n = bench::iterations (argc, argv, 1 << 16);
+
+#if defined (GCH_NONNULL_PTR_INSTRUMENT_CALL_SITES)
+  run_kernels<counted> ("call sites", n);
+  run_kernels<excluded> ("call sites, excluded type", n);
+#elif defined (GCH_NONNULL_PTR_INSTRUMENT)
+  run_kernels<counted> ("counters", n);
+  run_kernels<excluded> ("counters, excluded type", n);
+#else
+  run_kernels<counted> ("off", n);
+#endif
+
+  return 0;
+}
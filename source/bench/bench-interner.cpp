@@ -0,0 +1,110 @@
+/** bench-interner.cpp
+ * Measures the cost of interning against repeated deep comparisons and
+ * hashing of the values themselves.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "bench_common.hpp"
+#include "gch/interner.hpp"
+
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+
+  // Long values with a shared prefix make deep comparison expensive.
+  std::vector<std::string>
+  make_values (std::size_t distinct, std::size_t total)
+  {
+    const std::string prefix (96, 'p');
+    std::vector<std::string> values;
+    values.reserve (total);
+
+    std::mt19937 gen { 42 };
+    for (std::size_t i = 0; i < total; ++i)
+      values.push_back (prefix + std::to_string (gen () % distinct));
+    return values;
+  }
+
+  template <typename T>
+  BENCH_NOINLINE
+  std::size_t
+  count_equal_neighbors (const std::vector<T>& values)
+  {
+    std::size_t count = 0;
+    for (std::size_t i = 1; i < values.size (); ++i)
+      count += (values[i - 1] == values[i]) ? 1 : 0;
+    return count;
+  }
+
+  template <typename T>
+  BENCH_NOINLINE
+  std::size_t
+  count_distinct (const std::vector<T>& values)
+  {
+    std::unordered_set<T> set;
+    for (const T& v : values)
+      set.insert (v);
+    return set.size ();
+  }
+
+}
+
+int
+main (int argc, char **argv)
+{
+  const std::size_t n = bench::iterations (argc, argv, 1 << 18);
+  const std::vector<std::string> values = make_values (64, n);
+
+  bench::report (bench::run ("intern (first pass, new table)", n, [&] (std::size_t) {
+    gch::interner<std::string> table;
+    for (const std::string& v : values)
+      bench::do_not_optimize (table.intern (v));
+  }));
+
+  gch::interner<std::string> table;
+  std::vector<gch::nonnull_ptr<const std::string>> interned;
+  interned.reserve (n);
+  for (const std::string& v : values)
+    interned.push_back (table.intern (v));
+
+  bench::report (bench::run ("intern (existing values)", n, [&] (std::size_t) {
+    for (const std::string& v : values)
+      bench::do_not_optimize (table.intern (v));
+  }));
+
+  gch::concurrent_interner<std::string> shared;
+  bench::report (bench::run ("concurrent_interner::intern (uncontended)", n, [&] (std::size_t) {
+    for (const std::string& v : values)
+      bench::do_not_optimize (shared.intern (v));
+  }));
+
+  bench::report (bench::run ("equality: std::string (deep)", n, [&] (std::size_t) {
+    bench::do_not_optimize (count_equal_neighbors (values));
+  }));
+
+  bench::report (bench::run ("equality: interned nonnull_ptr", n, [&] (std::size_t) {
+    bench::do_not_optimize (count_equal_neighbors (interned));
+  }));
+
+  bench::report (bench::run ("unordered_set insert: std::string", n, [&] (std::size_t) {
+    bench::do_not_optimize (count_distinct (values));
+  }));
+
+  bench::report (bench::run ("unordered_set insert: interned nonnull_ptr", n, [&] (std::size_t) {
+    bench::do_not_optimize (count_distinct (interned));
+  }));
+
+  const gch::interner<std::string>::memory_usage usage = table.usage ();
+  std::printf ("table: %zu values, %zu arena bytes reserved, %zu used, ~%zu index bytes\n",
+               usage.count, usage.arena_reserved, usage.arena_used, usage.index);
+
+  return 0;
+}
@@ -0,0 +1,260 @@
+/** bench-intrusive_list.cpp
+ * Measures an LRU cache under churn built on intrusive_list against the same
+ * cache built on std::list and on a null-terminated intrusive list.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "bench_common.hpp"
+#include "gch/intrusive_list.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <vector>
+
+namespace
+{
+
+  // Each cache maps keys to entries through a direct index, so the list operations are
+  // most of the work: a hit moves the entry to the front, and a miss evicts the back.
+
+  class sentinel_lru
+  {
+    struct entry
+    {
+      std::size_t    key;
+      gch::list_hook hook;
+    };
+
+  public:
+    sentinel_lru (std::size_t capacity, std::size_t keys)
+      : m_entries (capacity),
+        m_index (keys, nullptr)
+    {
+      for (std::size_t i = 0; i < capacity; ++i)
+      {
+        m_entries[i].key = i;
+        m_index[i] = &m_entries[i];
+        m_lru.push_back (m_entries[i]);
+      }
+    }
+
+    BENCH_NOINLINE
+    std::size_t
+    access (std::size_t key)
+    {
+      if (entry *e = m_index[key])
+      {
+        m_lru.move_to_front (*e);
+        return 1;
+      }
+
+      // The least recently used entry is reused in place.
+      entry& victim = m_lru.back ();
+      m_index[victim.key] = nullptr;
+      victim.key = key;
+      m_index[key] = &victim;
+      m_lru.move_to_front (victim);
+      return 0;
+    }
+
+  private:
+    std::vector<entry>                       m_entries;
+    std::vector<entry *>                     m_index;
+    gch::intrusive_list<entry, &entry::hook> m_lru;
+  };
+
+  class null_terminated_lru
+  {
+    struct entry
+    {
+      std::size_t key;
+      entry      *next;
+      entry      *prev;
+    };
+
+  public:
+    null_terminated_lru (std::size_t capacity, std::size_t keys)
+      : m_entries (capacity),
+        m_index (keys, nullptr)
+    {
+      for (std::size_t i = 0; i < capacity; ++i)
+      {
+        m_entries[i].key = i;
+        m_index[i] = &m_entries[i];
+        push_back (m_entries[i]);
+      }
+    }
+
+    BENCH_NOINLINE
+    std::size_t
+    access (std::size_t key)
+    {
+      if (entry *e = m_index[key])
+      {
+        unlink (*e);
+        push_front (*e);
+        return 1;
+      }
+
+      entry& victim = *m_tail;
+      unlink (victim);
+      m_index[victim.key] = nullptr;
+      victim.key = key;
+      m_index[key] = &victim;
+      push_front (victim);
+      return 0;
+    }
+
+  private:
+    void
+    unlink (entry& e) noexcept
+    {
+      if (e.prev)
+        e.prev->next = e.next;
+      else
+        m_head = e.next;
+
+      if (e.next)
+        e.next->prev = e.prev;
+      else
+        m_tail = e.prev;
+    }
+
+    void
+    push_front (entry& e) noexcept
+    {
+      e.prev = nullptr;
+      e.next = m_head;
+      if (m_head)
+        m_head->prev = &e;
+      else
+        m_tail = &e;
+      m_head = &e;
+    }
+
+    void
+    push_back (entry& e) noexcept
+    {
+      e.next = nullptr;
+      e.prev = m_tail;
+      if (m_tail)
+        m_tail->next = &e;
+      else
+        m_head = &e;
+      m_tail = &e;
+    }
+
+    std::vector<entry>   m_entries;
+    std::vector<entry *> m_index;
+    entry               *m_head = nullptr;
+    entry               *m_tail = nullptr;
+  };
+
+  class std_list_lru
+  {
+    using list_type = std::list<std::size_t>;
+
+  public:
+    std_list_lru (std::size_t capacity, std::size_t keys)
+      : m_index (keys),
+        m_resident (keys, false)
+    {
+      for (std::size_t i = 0; i < capacity; ++i)
+      {
+        m_index[i] = m_lru.insert (m_lru.end (), i);
+        m_resident[i] = true;
+      }
+    }
+
+    BENCH_NOINLINE
+    std::size_t
+    access (std::size_t key)
+    {
+      if (m_resident[key])
+      {
+        m_lru.splice (m_lru.begin (), m_lru, m_index[key]);
+        return 1;
+      }
+
+      // Eviction frees a node and insertion allocates one, as a typical std::list cache
+      // does.
+      m_resident[m_lru.back ()] = false;
+      m_lru.pop_back ();
+      m_index[key] = m_lru.insert (m_lru.begin (), key);
+      m_resident[key] = true;
+      return 0;
+    }
+
+  private:
+    list_type                        m_lru;
+    std::vector<list_type::iterator> m_index;
+    std::vector<bool>                m_resident;
+  };
+
+  // A skewed key sequence: half of the accesses go to a hot set which fits in the cache,
+  // and the rest are uniform over every key, which causes the churn.
+  std::vector<std::size_t>
+  make_keys (std::size_t n, std::size_t keys, std::size_t hot)
+  {
+    std::vector<std::size_t> result (n);
+    std::uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (std::size_t& k : result)
+    {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      const std::size_t r = static_cast<std::size_t> (state >> 1);
+      k = (state & 1) ? r % hot : r % keys;
+    }
+    return result;
+  }
+
+  template <typename Cache>
+  void
+  run_cache (const char *name, std::size_t capacity, std::size_t keys,
+             const std::vector<std::size_t>& sequence)
+  {
+    Cache cache (capacity, keys);
+    std::size_t hits = 0;
+    bench::report (bench::run (name, sequence.size (), [&] (std::size_t) {
+      for (std::size_t k : sequence)
+        hits += cache.access (k);
+      bench::do_not_optimize (hits);
+    }));
+  }
+
+  void
+  run_size (std::size_t capacity, std::size_t n)
+  {
+    const std::size_t keys = capacity * 4;
+    const std::vector<std::size_t> sequence = make_keys (n, keys, capacity / 2);
+
+    char name[64];
+
+    std::snprintf (name, sizeof (name), "lru/%zu: intrusive_list", capacity);
+    run_cache<sentinel_lru> (name, capacity, keys, sequence);
+
+    std::snprintf (name, sizeof (name), "lru/%zu: null-terminated list", capacity);
+    run_cache<null_terminated_lru> (name, capacity, keys, sequence);
+
+    std::snprintf (name, sizeof (name), "lru/%zu: std::list", capacity);
+    run_cache<std_list_lru> (name, capacity, keys, sequence);
+  }
+
+}
+
+int
+main (int argc, char **argv)
+{
+  const std::size_t n = bench::iterations (argc, argv, 1 << 20);
+
+  run_size (1 << 10, n);
+  run_size (1 << 16, n);
+
+  return 0;
+}
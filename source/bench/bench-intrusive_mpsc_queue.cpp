@@ -0,0 +1,147 @@
+/** bench-intrusive_mpsc_queue.cpp
+ * Measures the throughput and latency of intrusive_mpsc_queue against a
+ * mutex-protected std::deque as the number of producers grows.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "bench_common.hpp"
+#include "gch/intrusive_mpsc_queue.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+  using clock_type = std::chrono::steady_clock;
+
+  struct message
+  {
+    clock_type::time_point pushed;
+    gch::mpsc_queue_hook   hook;
+  };
+
+  class intrusive_channel
+  {
+  public:
+    void
+    push (message& m) noexcept
+    {
+      m_queue.push (m);
+    }
+
+    message *
+    try_pop (void) noexcept
+    {
+      return m_queue.try_pop ();
+    }
+
+  private:
+    gch::intrusive_mpsc_queue<message, &message::hook> m_queue;
+  };
+
+  class locked_deque_channel
+  {
+  public:
+    void
+    push (message& m)
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      m_queue.push_back (&m);
+    }
+
+    message *
+    try_pop (void)
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      if (m_queue.empty ())
+        return nullptr;
+      message *m = m_queue.front ();
+      m_queue.pop_front ();
+      return m;
+    }
+
+  private:
+    std::mutex            m_mutex;
+    std::deque<message *> m_queue;
+  };
+
+  // Each producer pushes its own messages while one consumer pops all of them. The
+  // latency of a message is the time from just before its push to its pop. Producers push
+  // as fast as they can, so this includes queueing delay, and with fewer cores than
+  // threads it is dominated by scheduling.
+  template <typename Channel>
+  void
+  run_channel (const char *channel_name, std::size_t producers, std::size_t per_producer)
+  {
+    const std::size_t total = producers * per_producer;
+    std::vector<message> messages (total);
+    std::vector<double>  latencies (total);
+
+    char name[64];
+    std::snprintf (name, sizeof (name), "%zu producers: %s", producers, channel_name);
+
+    bench::report (bench::run (name, total, [&] (std::size_t) {
+      Channel channel;
+
+      std::vector<std::thread> threads;
+      for (std::size_t p = 0; p < producers; ++p)
+      {
+        message *first = messages.data () + p * per_producer;
+        threads.emplace_back ([&channel, first, per_producer] () noexcept {
+          for (message *m = first; m != first + per_producer; ++m)
+          {
+            m->pushed = clock_type::now ();
+            channel.push (*m);
+          }
+        });
+      }
+
+      std::size_t received = 0;
+      while (received < total)
+      {
+        if (message *m = channel.try_pop ())
+        {
+          latencies[received++] =
+            std::chrono::duration<double, std::nano> (clock_type::now () - m->pushed).count ();
+        }
+        else
+          std::this_thread::yield ();
+      }
+
+      for (std::thread& t : threads)
+        t.join ();
+    }, 3));
+
+    std::sort (latencies.begin (), latencies.end ());
+    std::snprintf (name, sizeof (name), "%zu producers: %s latency", producers, channel_name);
+    std::printf ("%-48s p50 %10.0f ns  p99 %10.0f ns\n", name,
+                 latencies[total / 2], latencies[total - total / 100 - 1]);
+  }
+
+}
+
+int
+main (int argc, char **argv)
+{
+  const std::size_t per_producer = bench::iterations (argc, argv, 1 << 18);
+  const std::size_t max_producers =
+    (std::max) (std::size_t (4), static_cast<std::size_t> (std::thread::hardware_concurrency ()));
+
+  for (std::size_t producers = 1; producers <= max_producers; producers *= 2)
+  {
+    run_channel<intrusive_channel> ("intrusive_mpsc_queue", producers, per_producer);
+    run_channel<locked_deque_channel> ("std::mutex + std::deque", producers, per_producer);
+  }
+
+  return 0;
+}
@@ -0,0 +1,202 @@
+/** bench-intrusive_rbtree.cpp
+ * Measures insertion, erasure and lookup in intrusive_rbtree against
+ * std::map and std::set at sizes from 10^3 up to the given size.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "bench_common.hpp"
+#include "gch/intrusive_rbtree.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+  struct level
+  {
+    std::uint64_t    key;
+    std::uint64_t    quantity;
+    gch::rbtree_hook hook;
+  };
+
+  struct by_key
+  {
+    bool
+    operator() (const level& lhs, const level& rhs) const noexcept
+    {
+      return lhs.key < rhs.key;
+    }
+
+    bool
+    operator() (const level& lhs, std::uint64_t rhs) const noexcept
+    {
+      return lhs.key < rhs;
+    }
+
+    bool
+    operator() (std::uint64_t lhs, const level& rhs) const noexcept
+    {
+      return lhs < rhs.key;
+    }
+  };
+
+  using level_tree = gch::intrusive_rbtree<level, &level::hook, by_key>;
+
+  std::uint64_t
+  next_random (std::uint64_t& state) noexcept
+  {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  }
+
+  // Distinct keys in a scrambled order, and a second scrambled order of the same keys for
+  // lookups and erasures.
+  struct workload
+  {
+    explicit
+    workload (std::size_t n)
+      : keys (n),
+        order (n)
+    {
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        keys[i]  = (static_cast<std::uint64_t> (i) + 1) * 0x9E3779B97F4A7C15ULL;
+        order[i] = i;
+      }
+
+      std::uint64_t state = 0x2545F4914F6CDD1DULL;
+      for (std::size_t i = n; i > 1; --i)
+        std::swap (order[i - 1], order[next_random (state) % i]);
+    }
+
+    std::vector<std::uint64_t> keys;
+    std::vector<std::size_t>   order;
+  };
+
+  void
+  run_tree (const workload& w, std::size_t n)
+  {
+    char name[64];
+
+    std::vector<level> levels (n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      levels[i].key = w.keys[i];
+      levels[i].quantity = i;
+    }
+
+    level_tree tree;
+
+    // Erasure takes the element, as a cancel through an order-id index would.
+    std::snprintf (name, sizeof (name), "insert+erase/%zu: intrusive_rbtree", n);
+    bench::report (bench::run (name, 2 * n, [&] (std::size_t) {
+      for (level& l : levels)
+        tree.insert (l);
+      for (std::size_t i : w.order)
+        tree.erase (levels[i]);
+      bench::do_not_optimize (tree);
+    }));
+
+    for (level& l : levels)
+      tree.insert (l);
+
+    std::snprintf (name, sizeof (name), "find/%zu: intrusive_rbtree", n);
+    bench::report (bench::run (name, n, [&] (std::size_t) {
+      std::uint64_t sum = 0;
+      for (std::size_t i : w.order)
+        sum += tree.find (w.keys[i])->quantity;
+      bench::do_not_optimize (sum);
+    }));
+
+    tree.clear ();
+  }
+
+  void
+  run_map (const workload& w, std::size_t n)
+  {
+    char name[64];
+
+    using map_type = std::map<std::uint64_t, std::uint64_t>;
+    map_type map;
+    std::vector<map_type::iterator> its (n);
+
+    std::snprintf (name, sizeof (name), "insert+erase/%zu: std::map", n);
+    bench::report (bench::run (name, 2 * n, [&] (std::size_t) {
+      for (std::size_t i = 0; i < n; ++i)
+        its[i] = map.emplace (w.keys[i], i).first;
+      for (std::size_t i : w.order)
+        map.erase (its[i]);
+      bench::do_not_optimize (map);
+    }));
+
+    for (std::size_t i = 0; i < n; ++i)
+      map.emplace (w.keys[i], i);
+
+    std::snprintf (name, sizeof (name), "find/%zu: std::map", n);
+    bench::report (bench::run (name, n, [&] (std::size_t) {
+      std::uint64_t sum = 0;
+      for (std::size_t i : w.order)
+        sum += map.find (w.keys[i])->second;
+      bench::do_not_optimize (sum);
+    }));
+  }
+
+  void
+  run_set (const workload& w, std::size_t n)
+  {
+    char name[64];
+
+    using set_type = std::set<std::uint64_t>;
+    set_type set;
+    std::vector<set_type::iterator> its (n);
+
+    std::snprintf (name, sizeof (name), "insert+erase/%zu: std::set", n);
+    bench::report (bench::run (name, 2 * n, [&] (std::size_t) {
+      for (std::size_t i = 0; i < n; ++i)
+        its[i] = set.insert (w.keys[i]).first;
+      for (std::size_t i : w.order)
+        set.erase (its[i]);
+      bench::do_not_optimize (set);
+    }));
+
+    for (std::size_t i = 0; i < n; ++i)
+      set.insert (w.keys[i]);
+
+    std::snprintf (name, sizeof (name), "find/%zu: std::set", n);
+    bench::report (bench::run (name, n, [&] (std::size_t) {
+      std::uint64_t sum = 0;
+      for (std::size_t i : w.order)
+        sum += *set.find (w.keys[i]);
+      bench::do_not_optimize (sum);
+    }));
+  }
+
+}
+
+int
+main (int argc, char **argv)
+{
+  // Pass 10000000 to include 10^7 elements.
+  const std::size_t max_size = bench::iterations (argc, argv, 1000000);
+
+  for (std::size_t n = 1000; n <= max_size; n *= 10)
+  {
+    const workload w (n);
+    run_tree (w, n);
+    run_map (w, n);
+    run_set (w, n);
+  }
+
+  return 0;
+}
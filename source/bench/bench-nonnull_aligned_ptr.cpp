@@ -0,0 +1,144 @@
+/** bench-nonnull_aligned_ptr.cpp
+ * Measures loops over buffers passed as nonnull_ptr against the same loops
+ * passed as nonnull_aligned_ptr.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "bench_common.hpp"
+#include "gch/nonnull_aligned_ptr.hpp"
+
+#include <cstdlib>
+#include <memory>
+
+namespace
+{
+
+  constexpr std::size_t buffer_alignment = 64;
+
+  struct aligned_free
+  {
+    void
+    operator() (void *p) const noexcept
+    {
+      std::free (p);
+    }
+  };
+
+  // std::aligned_alloc is not available before C++17, so over-allocate and align by hand.
+  struct aligned_buffer
+  {
+    explicit
+    aligned_buffer (std::size_t n)
+      : storage (static_cast<unsigned char *> (std::malloc (n * sizeof (float)
+                                                            + buffer_alignment)))
+    {
+      void *p = storage.get ();
+      std::size_t space = n * sizeof (float) + buffer_alignment;
+      data = static_cast<float *> (std::align (buffer_alignment, n * sizeof (float), p, space));
+      for (std::size_t i = 0; i < n; ++i)
+        data[i] = static_cast<float> (i % 7);
+    }
+
+    std::unique_ptr<unsigned char, aligned_free> storage;
+    float *data;
+  };
+
+  BENCH_NOINLINE
+  float
+  dot (gch::nonnull_ptr<const float> a, gch::nonnull_ptr<const float> b, std::size_t n)
+  {
+    const float *x = a.get ();
+    const float *y = b.get ();
+    float total = 0;
+    for (std::size_t i = 0; i < n; ++i)
+      total += x[i] * y[i];
+    return total;
+  }
+
+  BENCH_NOINLINE
+  float
+  dot (gch::nonnull_aligned_ptr<const float, buffer_alignment> a,
+       gch::nonnull_aligned_ptr<const float, buffer_alignment> b,
+       std::size_t n)
+  {
+    const float *x = a.get ();
+    const float *y = b.get ();
+    float total = 0;
+    for (std::size_t i = 0; i < n; ++i)
+      total += x[i] * y[i];
+    return total;
+  }
+
+  BENCH_NOINLINE
+  void
+  axpy (float alpha, gch::nonnull_ptr<const float> a, gch::nonnull_ptr<float> b, std::size_t n)
+  {
+    const float *x = a.get ();
+    float *y = b.get ();
+    for (std::size_t i = 0; i < n; ++i)
+      y[i] += alpha * x[i];
+  }
+
+  BENCH_NOINLINE
+  void
+  axpy (float alpha,
+        gch::nonnull_aligned_ptr<const float, buffer_alignment> a,
+        gch::nonnull_aligned_ptr<float, buffer_alignment> b,
+        std::size_t n)
+  {
+    const float *x = a.get ();
+    float *y = b.get ();
+    for (std::size_t i = 0; i < n; ++i)
+      y[i] += alpha * x[i];
+  }
+
+}
+
+int
+main (int argc, char **argv)
+{
+  const std::size_t n = bench::iterations (argc, argv, 1 << 14);
+  const std::size_t passes = 64;
+
+  aligned_buffer xs (n);
+  aligned_buffer ys (n);
+
+  gch::nonnull_ptr<const float> x { *xs.data };
+  gch::nonnull_ptr<float> y { *ys.data };
+  gch::nonnull_aligned_ptr<const float, buffer_alignment> ax (*xs.data);
+  gch::nonnull_aligned_ptr<float, buffer_alignment> ay (*ys.data);
+
+  bench::report (bench::run ("dot: nonnull_ptr", n * passes, [&] (std::size_t) {
+    for (std::size_t p = 0; p < passes; ++p)
+    {
+      bench::launder_value (x);
+      bench::do_not_optimize (dot (x, y, n));
+    }
+  }));
+
+  bench::report (bench::run ("dot: nonnull_aligned_ptr", n * passes, [&] (std::size_t) {
+    for (std::size_t p = 0; p < passes; ++p)
+    {
+      bench::launder_value (ax);
+      bench::do_not_optimize (dot (ax, ay, n));
+    }
+  }));
+
+  bench::report (bench::run ("axpy: nonnull_ptr", n * passes, [&] (std::size_t) {
+    for (std::size_t p = 0; p < passes; ++p)
+      axpy (0.5f, x, y, n);
+    bench::do_not_optimize (*y);
+  }));
+
+  bench::report (bench::run ("axpy: nonnull_aligned_ptr", n * passes, [&] (std::size_t) {
+    for (std::size_t p = 0; p < passes; ++p)
+      axpy (0.5f, ax, ay, n);
+    bench::do_not_optimize (*ay);
+  }));
+
+  return 0;
+}
@@ -0,0 +1,167 @@
+/** bench-nonnull_dyn_ptr.cpp
+ * Measures dispatch through `gch::nonnull_dyn_ptr` against virtual calls
+ * through `gch::nonnull_ptr<Base>`.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "bench_common.hpp"
+#include "gch/nonnull_dyn_ptr.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+  // Virtual hierarchy.
+
+  struct virtual_base
+  {
+    virtual ~virtual_base (void) = default;
+
+    virtual
+    unsigned
+    weight (void) const noexcept = 0;
+  };
+
+  template <unsigned K>
+  struct virtual_node final
+    : virtual_base
+  {
+    unsigned
+    weight (void) const noexcept override
+    {
+      return value * K;
+    }
+
+    unsigned value = K;
+  };
+
+  // Unrelated types, described by an interface.
+
+  struct weighted
+  {
+    unsigned (*weight) (const void *);
+
+    template <typename T>
+    static
+    unsigned
+    weight_impl (const void *self)
+    {
+      return static_cast<const T *> (self)->weight ();
+    }
+
+    template <typename T>
+    static constexpr
+    weighted
+    table_for (void) noexcept
+    {
+      return { &weight_impl<T> };
+    }
+  };
+
+  template <unsigned K>
+  struct plain_node
+  {
+    unsigned
+    weight (void) const noexcept
+    {
+      return value * K;
+    }
+
+    unsigned value = K;
+  };
+
+  template <typename Ptr>
+  void
+  permute (std::vector<Ptr>& ptrs, const std::vector<std::size_t>& order)
+  {
+    const std::vector<Ptr> copy (ptrs);
+    for (std::size_t i = 0; i < order.size (); ++i)
+      ptrs[i] = copy[order[i]];
+  }
+
+  template <typename Ptr, typename F>
+  BENCH_NOINLINE
+  unsigned
+  sum (const std::vector<Ptr>& ptrs, F f)
+  {
+    unsigned total = 0;
+    for (const Ptr& p : ptrs)
+      total += f (p);
+    return total;
+  }
+
+}
+
+int
+main (int argc, char **argv)
+{
+  const std::size_t n = bench::iterations (argc, argv, 1 << 20);
+
+  std::vector<virtual_node<1>> v1 (n / 4);
+  std::vector<virtual_node<2>> v2 (n / 4);
+  std::vector<virtual_node<3>> v3 (n / 4);
+  std::vector<virtual_node<4>> v4 (n / 4);
+
+  std::vector<plain_node<1>> p1 (n / 4);
+  std::vector<plain_node<2>> p2 (n / 4);
+  std::vector<plain_node<3>> p3 (n / 4);
+  std::vector<plain_node<4>> p4 (n / 4);
+
+  using virtual_ptr = gch::nonnull_ptr<const virtual_base>;
+  using inline_ptr  = gch::nonnull_dyn_ptr<const weighted>;
+  using table_ptr   = gch::nonnull_dyn_ptr<const weighted, false>;
+
+  std::vector<virtual_ptr> vptrs;
+  std::vector<inline_ptr>  iptrs;
+  std::vector<table_ptr>   tptrs;
+  for (std::size_t i = 0; i < n / 4; ++i)
+  {
+    vptrs.emplace_back (v1[i]);
+    vptrs.emplace_back (v2[i]);
+    vptrs.emplace_back (v3[i]);
+    vptrs.emplace_back (v4[i]);
+
+    iptrs.emplace_back (p1[i]);
+    iptrs.emplace_back (p2[i]);
+    iptrs.emplace_back (p3[i]);
+    iptrs.emplace_back (p4[i]);
+
+    tptrs.emplace_back (p1[i]);
+    tptrs.emplace_back (p2[i]);
+    tptrs.emplace_back (p3[i]);
+    tptrs.emplace_back (p4[i]);
+  }
+
+  // Use the same random order for each so branch prediction is equally hard.
+  std::vector<std::size_t> order (vptrs.size ());
+  for (std::size_t i = 0; i < order.size (); ++i)
+    order[i] = i;
+  std::shuffle (order.begin (), order.end (), std::mt19937 { 42 });
+
+  permute (vptrs, order);
+  permute (iptrs, order);
+  permute (tptrs, order);
+
+  const std::size_t ops = vptrs.size ();
+
+  bench::report (bench::run ("virtual call via nonnull_ptr<Base>", ops, [&] (std::size_t) {
+    bench::do_not_optimize (sum (vptrs, [] (virtual_ptr p) { return p->weight (); }));
+  }));
+
+  bench::report (bench::run ("nonnull_dyn_ptr (table by pointer)", ops, [&] (std::size_t) {
+    bench::do_not_optimize (sum (tptrs, [] (table_ptr p) { return p.call (&weighted::weight); }));
+  }));
+
+  bench::report (bench::run ("nonnull_dyn_ptr (inline table)", ops, [&] (std::size_t) {
+    bench::do_not_optimize (sum (iptrs, [] (inline_ptr p) { return p.call (&weighted::weight); }));
+  }));
+
+  return 0;
+}
@@ -0,0 +1,119 @@
+/** bench-nonnull_function_ref.cpp
+ * Measures the call overhead of `gch::nonnull_function_ref` against
+ * `std::function` and raw function pointers.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "bench_common.hpp"
+#include "gch/nonnull_function_ref.hpp"
+
+#include <functional>
+
+namespace
+{
+
+  BENCH_NOINLINE
+  unsigned
+  step (unsigned x)
+  {
+    return x * 2654435761U + 1U;
+  }
+
+  struct stateful_step
+  {
+    unsigned
+    operator() (unsigned x)
+    {
+      return x * multiplier + ++calls;
+    }
+
+    unsigned multiplier;
+    unsigned calls;
+  };
+
+  // Each loop is kept out of line so that the callable is opaque inside of it,
+  // which is what happens when a callback crosses a translation unit boundary.
+
+  BENCH_NOINLINE
+  unsigned
+  loop_direct (std::size_t n)
+  {
+    unsigned x = 1;
+    for (std::size_t i = 0; i < n; ++i)
+      x = step (x);
+    return x;
+  }
+
+  BENCH_NOINLINE
+  unsigned
+  loop_function_pointer (unsigned (*f) (unsigned), std::size_t n)
+  {
+    unsigned x = 1;
+    for (std::size_t i = 0; i < n; ++i)
+      x = f (x);
+    return x;
+  }
+
+  BENCH_NOINLINE
+  unsigned
+  loop_std_function (const std::function<unsigned (unsigned)>& f, std::size_t n)
+  {
+    unsigned x = 1;
+    for (std::size_t i = 0; i < n; ++i)
+      x = f (x);
+    return x;
+  }
+
+  BENCH_NOINLINE
+  unsigned
+  loop_nonnull_function_ref (gch::nonnull_function_ref<unsigned (unsigned)> f, std::size_t n)
+  {
+    unsigned x = 1;
+    for (std::size_t i = 0; i < n; ++i)
+      x = f (x);
+    return x;
+  }
+
+}
+
+int
+main (int argc, char **argv)
+{
+  const std::size_t n = bench::iterations (argc, argv, 50000000);
+
+  bench::report (bench::run ("direct call", n, [] (std::size_t k) {
+    bench::do_not_optimize (loop_direct (k));
+  }));
+
+  bench::report (bench::run ("function pointer", n, [] (std::size_t k) {
+    unsigned (*f) (unsigned) = &step;
+    bench::launder_value (f);
+    bench::do_not_optimize (loop_function_pointer (f, k));
+  }));
+
+  bench::report (bench::run ("std::function (function)", n, [] (std::size_t k) {
+    std::function<unsigned (unsigned)> f (&step);
+    bench::do_not_optimize (loop_std_function (f, k));
+  }));
+
+  bench::report (bench::run ("nonnull_function_ref (function)", n, [] (std::size_t k) {
+    bench::do_not_optimize (loop_nonnull_function_ref (step, k));
+  }));
+
+  bench::report (bench::run ("std::function (stateful object)", n, [] (std::size_t k) {
+    stateful_step s { 2654435761U, 0 };
+    std::function<unsigned (unsigned)> f (std::ref (s));
+    bench::do_not_optimize (loop_std_function (f, k));
+  }));
+
+  bench::report (bench::run ("nonnull_function_ref (stateful object)", n, [] (std::size_t k) {
+    stateful_step s { 2654435761U, 0 };
+    bench::do_not_optimize (loop_nonnull_function_ref (s, k));
+  }));
+
+  return 0;
+}
@@ -0,0 +1,145 @@
+/** bench-nonnull_iterator.cpp
+ * Measures standard algorithms over nonnull_iterator against the same
+ * algorithms over raw pointers, which the standard library lowers to
+ * memmove, memset and memcmp.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "bench_common.hpp"
+#include "gch/nonnull_iterator.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#ifdef GCH_LIB_CONCEPTS
+#  include <ranges>
+#endif
+
+namespace
+{
+
+  template <typename It, typename Out>
+  BENCH_NOINLINE
+  void
+  do_copy (It first, It last, Out out)
+  {
+    std::copy (first, last, out);
+  }
+
+  template <typename It, typename T>
+  BENCH_NOINLINE
+  void
+  do_fill (It first, It last, T value)
+  {
+    std::fill (first, last, value);
+  }
+
+  template <typename It>
+  BENCH_NOINLINE
+  bool
+  do_equal (It first, It last, It other)
+  {
+    return std::equal (first, last, other);
+  }
+
+#ifdef GCH_LIB_CONCEPTS
+
+  template <typename It, typename Out>
+  BENCH_NOINLINE
+  void
+  do_ranges_copy (It first, It last, Out out)
+  {
+    std::ranges::copy (first, last, out);
+  }
+
+#endif
+
+}
+
+int
+main (int argc, char **argv)
+{
+  const std::size_t n = bench::iterations (argc, argv, 1 << 16);
+
+  std::vector<int> src (n, 1);
+  std::vector<int> dst (n, 0);
+  std::vector<unsigned char> bytes (n, 0);
+
+  using iter  = gch::nonnull_iterator<int>;
+  using citer = gch::nonnull_iterator<const int>;
+  using biter = gch::nonnull_iterator<unsigned char>;
+
+  const citer first (src.front ());
+  const citer last = first + static_cast<std::ptrdiff_t> (n);
+  const iter out (dst.front ());
+  const biter bfirst (bytes.front ());
+  const biter blast = bfirst + static_cast<std::ptrdiff_t> (n);
+
+  bench::report (bench::run ("std::copy: int *", n, [&] (std::size_t) {
+    do_copy (src.data (), src.data () + n, dst.data ());
+    bench::do_not_optimize (dst.back ());
+  }));
+
+  bench::report (bench::run ("std::copy: nonnull_iterator", n, [&] (std::size_t) {
+    do_copy (first, last, out);
+    bench::do_not_optimize (dst.back ());
+  }));
+
+  bench::report (bench::run ("std::copy: nonnull_iterator::get", n, [&] (std::size_t) {
+    do_copy (first.get (), last.get (), out.get ());
+    bench::do_not_optimize (dst.back ());
+  }));
+
+#ifdef GCH_LIB_CONCEPTS
+  bench::report (bench::run ("std::ranges::copy: int *", n, [&] (std::size_t) {
+    do_ranges_copy (src.data (), src.data () + n, dst.data ());
+    bench::do_not_optimize (dst.back ());
+  }));
+
+  bench::report (bench::run ("std::ranges::copy: nonnull_iterator", n, [&] (std::size_t) {
+    do_ranges_copy (first, last, out);
+    bench::do_not_optimize (dst.back ());
+  }));
+#endif
+
+  bench::report (bench::run ("std::fill (bytes): unsigned char *", n, [&] (std::size_t) {
+    do_fill (bytes.data (), bytes.data () + n, static_cast<unsigned char> (7));
+    bench::do_not_optimize (bytes.back ());
+  }));
+
+  bench::report (bench::run ("std::fill (bytes): nonnull_iterator", n, [&] (std::size_t) {
+    do_fill (bfirst, blast, static_cast<unsigned char> (7));
+    bench::do_not_optimize (bytes.back ());
+  }));
+
+  bench::report (bench::run ("std::fill (int): int *", n, [&] (std::size_t) {
+    do_fill (dst.data (), dst.data () + n, 7);
+    bench::do_not_optimize (dst.back ());
+  }));
+
+  bench::report (bench::run ("std::fill (int): nonnull_iterator", n, [&] (std::size_t) {
+    do_fill (out, out + static_cast<std::ptrdiff_t> (n), 7);
+    bench::do_not_optimize (dst.back ());
+  }));
+
+  std::copy (src.begin (), src.end (), dst.begin ());
+  const citer cout (dst.front ());
+
+  bench::report (bench::run ("std::equal: const int *", n, [&] (std::size_t) {
+    bench::do_not_optimize (do_equal<const int *> (src.data (), src.data () + n, dst.data ()));
+  }));
+
+  bench::report (bench::run ("std::equal: nonnull_iterator", n, [&] (std::size_t) {
+    bench::do_not_optimize (do_equal (first, last, cout));
+  }));
+
+  bench::report (bench::run ("std::equal: nonnull_iterator::get", n, [&] (std::size_t) {
+    bench::do_not_optimize (do_equal (first.get (), last.get (), cout.get ()));
+  }));
+
+  return 0;
+}
@@ -0,0 +1,493 @@
+/** bench-nonnull_ptr.cpp
+ * Measures the everyday operations on nonnull_ptr against a raw pointer,
+ * std::reference_wrapper and a not_null wrapper which checks at run time.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "bench_common.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+  // A not_null in the style of the Guidelines Support Library, which checks for null on
+  // construction and again on every access.
+  template <typename P>
+  class not_null
+  {
+  public:
+    explicit
+    not_null (P p)
+      : m_ptr (p)
+    {
+      if (m_ptr == nullptr)
+        std::terminate ();
+    }
+
+    P
+    get (void) const
+    {
+      if (m_ptr == nullptr)
+        std::terminate ();
+      return m_ptr;
+    }
+
+    operator P (void) const
+    {
+      return get ();
+    }
+
+  private:
+    P m_ptr;
+  };
+
+  template <typename P>
+  bool
+  operator== (const not_null<P>& lhs, const not_null<P>& rhs)
+  {
+    return lhs.get () == rhs.get ();
+  }
+
+  template <typename P>
+  bool
+  operator< (const not_null<P>& lhs, const not_null<P>& rhs)
+  {
+    return std::less<P> { } (lhs.get (), rhs.get ());
+  }
+
+  // Each kind of handle converts to a pointer the way its users would write it.
+
+  struct raw_kind
+  {
+    template <typename T>
+    using handle = T *;
+
+    template <typename T>
+    static
+    T *
+    make (T& r) noexcept
+    {
+      return &r;
+    }
+
+    template <typename T>
+    static
+    T *
+    address (T *p) noexcept
+    {
+      return p;
+    }
+
+    template <typename T>
+    using hash = std::hash<T *>;
+
+    template <typename T>
+    using equal = std::equal_to<T *>;
+
+    template <typename T>
+    using less = std::less<T *>;
+
+    static constexpr const char *name = "T *";
+  };
+
+  constexpr const char *raw_kind::name;
+
+  struct nonnull_kind
+  {
+    template <typename T>
+    using handle = gch::nonnull_ptr<T>;
+
+    template <typename T>
+    static
+    gch::nonnull_ptr<T>
+    make (T& r) noexcept
+    {
+      return gch::nonnull_ptr<T> (r);
+    }
+
+    template <typename T>
+    static
+    T *
+    address (gch::nonnull_ptr<T> p) noexcept
+    {
+      return p;
+    }
+
+    template <typename T>
+    using hash = std::hash<gch::nonnull_ptr<T>>;
+
+    template <typename T>
+    using equal = std::equal_to<gch::nonnull_ptr<T>>;
+
+    template <typename T>
+    using less = std::less<gch::nonnull_ptr<T>>;
+
+    static constexpr const char *name = "gch::nonnull_ptr";
+  };
+
+  constexpr const char *nonnull_kind::name;
+
+  template <typename Kind, typename T>
+  struct address_hash
+  {
+    std::size_t
+    operator() (const typename Kind::template handle<T>& h) const noexcept
+    {
+      return std::hash<T *> { } (Kind::address (h));
+    }
+  };
+
+  template <typename Kind, typename T>
+  struct address_equal
+  {
+    bool
+    operator() (const typename Kind::template handle<T>& lhs,
+                const typename Kind::template handle<T>& rhs) const noexcept
+    {
+      return Kind::address (lhs) == Kind::address (rhs);
+    }
+  };
+
+  template <typename Kind, typename T>
+  struct address_less
+  {
+    bool
+    operator() (const typename Kind::template handle<T>& lhs,
+                const typename Kind::template handle<T>& rhs) const noexcept
+    {
+      return std::less<T *> { } (Kind::address (lhs), Kind::address (rhs));
+    }
+  };
+
+  // std::reference_wrapper has no hash, and its comparisons compare the referents, so it
+  // needs address-based function objects.
+  struct reference_wrapper_kind
+  {
+    template <typename T>
+    using handle = std::reference_wrapper<T>;
+
+    template <typename T>
+    static
+    std::reference_wrapper<T>
+    make (T& r) noexcept
+    {
+      return std::ref (r);
+    }
+
+    template <typename T>
+    static
+    T *
+    address (std::reference_wrapper<T> r) noexcept
+    {
+      T& ref = r;
+      return std::addressof (ref);
+    }
+
+    template <typename T>
+    using hash = address_hash<reference_wrapper_kind, T>;
+
+    template <typename T>
+    using equal = address_equal<reference_wrapper_kind, T>;
+
+    template <typename T>
+    using less = address_less<reference_wrapper_kind, T>;
+
+    static constexpr const char *name = "std::reference_wrapper";
+  };
+
+  constexpr const char *reference_wrapper_kind::name;
+
+  struct not_null_kind
+  {
+    template <typename T>
+    using handle = not_null<T *>;
+
+    template <typename T>
+    static
+    not_null<T *>
+    make (T& r)
+    {
+      return not_null<T *> (&r);
+    }
+
+    template <typename T>
+    static
+    T *
+    address (not_null<T *> p)
+    {
+      return p;
+    }
+
+    template <typename T>
+    using hash = address_hash<not_null_kind, T>;
+
+    template <typename T>
+    using equal = std::equal_to<not_null<T *>>;
+
+    template <typename T>
+    using less = std::less<not_null<T *>>;
+
+    static constexpr const char *name = "not_null";
+  };
+
+  constexpr const char *not_null_kind::name;
+
+  struct object
+  {
+    std::uint64_t value;
+    std::uint64_t padding;
+  };
+
+  std::uint64_t
+  next_random (std::uint64_t& state) noexcept
+  {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  }
+
+  // Objects, and an order in which to visit them which defeats the prefetcher.
+  struct workload
+  {
+    explicit
+    workload (std::size_t n)
+      : objects (n),
+        order (n)
+    {
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        objects[i].value = i;
+        order[i] = i;
+      }
+
+      std::uint64_t state = 0x2545F4914F6CDD1DULL;
+      for (std::size_t i = n; i > 1; --i)
+        std::swap (order[i - 1], order[next_random (state) % i]);
+    }
+
+    std::vector<object>      objects;
+    std::vector<std::size_t> order;
+  };
+
+  template <typename Kind>
+  std::vector<typename Kind::template handle<object>>
+  make_shuffled_handles (workload& w)
+  {
+    std::vector<typename Kind::template handle<object>> handles;
+    handles.reserve (w.objects.size ());
+    for (std::size_t i : w.order)
+      handles.push_back (Kind::make (w.objects[i]));
+    return handles;
+  }
+
+  template <typename Kind>
+  struct construct
+  {
+    static
+    void
+    run (workload& w, char *name, std::size_t name_size)
+    {
+      std::snprintf (name, name_size, "construct: %s", Kind::name);
+
+      std::vector<typename Kind::template handle<object>> handles;
+      handles.reserve (w.objects.size ());
+      bench::report (bench::run (name, w.objects.size (), [&] (std::size_t) {
+        handles.clear ();
+        for (object& o : w.objects)
+          handles.push_back (Kind::make (o));
+        bench::do_not_optimize (handles.data ());
+      }));
+    }
+  };
+
+  template <typename Kind>
+  struct grow
+  {
+    static
+    void
+    run (workload& w, char *name, std::size_t name_size)
+    {
+      std::snprintf (name, name_size, "grow: %s", Kind::name);
+      bench::report (bench::run (name, w.objects.size (), [&] (std::size_t) {
+        std::vector<typename Kind::template handle<object>> handles;
+        for (object& o : w.objects)
+          handles.push_back (Kind::make (o));
+        bench::do_not_optimize (handles.data ());
+      }));
+    }
+  };
+
+  template <typename Kind>
+  struct convert
+  {
+    static
+    void
+    run (workload& w, char *name, std::size_t name_size)
+    {
+      std::snprintf (name, name_size, "convert+deref: %s", Kind::name);
+
+      const auto handles = make_shuffled_handles<Kind> (w);
+      bench::report (bench::run (name, handles.size (), [&] (std::size_t) {
+        std::uint64_t sum = 0;
+        for (const auto& h : handles)
+          sum += Kind::address (h)->value;
+        bench::do_not_optimize (sum);
+      }));
+    }
+  };
+
+  template <typename Kind>
+  struct compare
+  {
+    static
+    void
+    run (workload& w, char *name, std::size_t name_size)
+    {
+      std::snprintf (name, name_size, "compare: %s", Kind::name);
+
+      const auto handles = make_shuffled_handles<Kind> (w);
+      const typename Kind::template equal<object> equal { };
+      const typename Kind::template less<object> less { };
+      bench::report (bench::run (name, handles.size () - 1, [&] (std::size_t) {
+        std::size_t count = 0;
+        for (std::size_t i = 1; i < handles.size (); ++i)
+          count += std::size_t (equal (handles[i - 1], handles[i]))
+                +  std::size_t (less (handles[i - 1], handles[i]));
+        bench::do_not_optimize (count);
+      }));
+    }
+  };
+
+  template <typename Kind>
+  struct hash
+  {
+    static
+    void
+    run (workload& w, char *name, std::size_t name_size)
+    {
+      std::snprintf (name, name_size, "hash insert+find: %s", Kind::name);
+
+      using handle_type = typename Kind::template handle<object>;
+      using set_type = std::unordered_set<handle_type,
+                                          typename Kind::template hash<object>,
+                                          typename Kind::template equal<object>>;
+
+      const auto handles = make_shuffled_handles<Kind> (w);
+      bench::report (bench::run (name, 2 * handles.size (), [&] (std::size_t) {
+        set_type set (handles.size ());
+        for (object& o : w.objects)
+          set.insert (Kind::make (o));
+
+        std::size_t found = 0;
+        for (const handle_type& h : handles)
+          found += set.count (h);
+        bench::do_not_optimize (found);
+      }, 3));
+    }
+  };
+
+  template <typename Kind>
+  struct sort
+  {
+    static
+    void
+    run (workload& w, char *name, std::size_t name_size)
+    {
+      std::snprintf (name, name_size, "sort: %s", Kind::name);
+
+      const auto shuffled = make_shuffled_handles<Kind> (w);
+      auto handles = shuffled;
+      bench::report (bench::run (name, handles.size (), [&] (std::size_t) {
+        std::copy (shuffled.begin (), shuffled.end (), handles.begin ());
+        std::sort (handles.begin (), handles.end (), typename Kind::template less<object> { });
+        bench::do_not_optimize (handles.data ());
+      }, 3));
+    }
+  };
+
+  // A circular list through every node in a random order, linked by the handle type.
+  template <typename Kind>
+  struct chase_node
+  {
+    chase_node (void)
+      : value (0),
+        next (Kind::make (*this))
+    { }
+
+    std::uint64_t                                     value;
+    typename Kind::template handle<chase_node<Kind>> next;
+  };
+
+  template <typename Kind>
+  struct chase
+  {
+    static
+    void
+    run (workload& w, char *name, std::size_t name_size)
+    {
+      std::snprintf (name, name_size, "pointer chase: %s", Kind::name);
+
+      const std::size_t n = w.order.size ();
+      std::unique_ptr<chase_node<Kind>[]> nodes (new chase_node<Kind>[n]);
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        chase_node<Kind>& node = nodes[w.order[i]];
+        node.value = i;
+        node.next = Kind::make (nodes[w.order[(i + 1) % n]]);
+      }
+
+      bench::report (bench::run (name, n, [&] (std::size_t) {
+        std::uint64_t sum = 0;
+        chase_node<Kind> *p = &nodes[w.order[0]];
+        for (std::size_t i = 0; i < n; ++i)
+        {
+          sum += p->value;
+          p = Kind::address (p->next);
+        }
+        bench::do_not_optimize (sum);
+      }));
+    }
+  };
+
+  template <template <typename> class Operation>
+  void
+  run_all_kinds (workload& w)
+  {
+    char name[64];
+    Operation<raw_kind>::run (w, name, sizeof (name));
+    Operation<nonnull_kind>::run (w, name, sizeof (name));
+    Operation<reference_wrapper_kind>::run (w, name, sizeof (name));
+    Operation<not_null_kind>::run (w, name, sizeof (name));
+  }
+
+}
+
+int
+main (int argc, char **argv)
+{
+  workload w (bench::iterations (argc, argv, 1 << 20));
+
+  run_all_kinds<construct> (w);
+  run_all_kinds<grow> (w);
+  run_all_kinds<convert> (w);
+  run_all_kinds<compare> (w);
+  run_all_kinds<hash> (w);
+  run_all_kinds<sort> (w);
+  run_all_kinds<chase> (w);
+
+  return 0;
+}
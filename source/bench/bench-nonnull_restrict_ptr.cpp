@@ -0,0 +1,127 @@
+/** bench-nonnull_restrict_ptr.cpp
+ * Measures saxpy-style loops over nonnull_ptr parameters against the same
+ * loops over nonnull_restrict_ptr and raw restrict pointer parameters.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "bench_common.hpp"
+#include "gch/nonnull_restrict_ptr.hpp"
+
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+
+  BENCH_NOINLINE
+  void
+  saxpy (float a, gch::nonnull_ptr<const float> x, gch::nonnull_ptr<float> y, std::size_t n)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      y.get ()[i] += a * x.get ()[i];
+  }
+
+  BENCH_NOINLINE
+  void
+  saxpy (float a, gch::nonnull_restrict_ptr<const float> x, gch::nonnull_restrict_ptr<float> y,
+         std::size_t n)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      y[i] += a * x[i];
+  }
+
+  BENCH_NOINLINE
+  void
+  saxpy (float a, const float *GCH_RESTRICT x, float *GCH_RESTRICT y, std::size_t n)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      y[i] += a * x[i];
+  }
+
+  BENCH_NOINLINE
+  void
+  add (gch::nonnull_ptr<const float> x, gch::nonnull_ptr<const float> y,
+       gch::nonnull_ptr<float> z, std::size_t n)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      z.get ()[i] = x.get ()[i] + y.get ()[i];
+  }
+
+  BENCH_NOINLINE
+  void
+  add (gch::nonnull_restrict_ptr<const float> x, gch::nonnull_restrict_ptr<const float> y,
+       gch::nonnull_restrict_ptr<float> z, std::size_t n)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      z[i] = x[i] + y[i];
+  }
+
+  // Short rows make the runtime overlap checks a larger share of the work.
+  void
+  run_size (std::size_t n, std::size_t total)
+  {
+    const std::size_t rows = total / n;
+    std::vector<float> xs (total, 1.0f);
+    std::vector<float> ys (total, 2.0f);
+    std::vector<float> zs (total, 0.0f);
+
+    char name[64];
+
+    std::snprintf (name, sizeof (name), "saxpy/%zu: nonnull_ptr", n);
+    bench::report (bench::run (name, total, [&] (std::size_t) {
+      for (std::size_t r = 0; r < rows; ++r)
+        saxpy (0.5f, gch::nonnull_ptr<const float> { xs[r * n] },
+               gch::nonnull_ptr<float> { ys[r * n] }, n);
+      bench::do_not_optimize (ys.front ());
+    }));
+
+    std::snprintf (name, sizeof (name), "saxpy/%zu: nonnull_restrict_ptr", n);
+    bench::report (bench::run (name, total, [&] (std::size_t) {
+      for (std::size_t r = 0; r < rows; ++r)
+        saxpy (0.5f, gch::nonnull_restrict_ptr<const float> { xs[r * n] },
+               gch::nonnull_restrict_ptr<float> { ys[r * n] }, n);
+      bench::do_not_optimize (ys.front ());
+    }));
+
+    std::snprintf (name, sizeof (name), "saxpy/%zu: float *__restrict", n);
+    bench::report (bench::run (name, total, [&] (std::size_t) {
+      for (std::size_t r = 0; r < rows; ++r)
+        saxpy (0.5f, &xs[r * n], &ys[r * n], n);
+      bench::do_not_optimize (ys.front ());
+    }));
+
+    std::snprintf (name, sizeof (name), "add/%zu: nonnull_ptr", n);
+    bench::report (bench::run (name, total, [&] (std::size_t) {
+      for (std::size_t r = 0; r < rows; ++r)
+        add (gch::nonnull_ptr<const float> { xs[r * n] },
+             gch::nonnull_ptr<const float> { ys[r * n] },
+             gch::nonnull_ptr<float> { zs[r * n] }, n);
+      bench::do_not_optimize (zs.front ());
+    }));
+
+    std::snprintf (name, sizeof (name), "add/%zu: nonnull_restrict_ptr", n);
+    bench::report (bench::run (name, total, [&] (std::size_t) {
+      for (std::size_t r = 0; r < rows; ++r)
+        add (gch::nonnull_restrict_ptr<const float> { xs[r * n] },
+             gch::nonnull_restrict_ptr<const float> { ys[r * n] },
+             gch::nonnull_restrict_ptr<float> { zs[r * n] }, n);
+      bench::do_not_optimize (zs.front ());
+    }));
+  }
+
+}
+
+int
+main (int argc, char **argv)
+{
+  const std::size_t total = bench::iterations (argc, argv, 1 << 16);
+
+  run_size (16, total);
+  run_size (1024, total);
+
+  return 0;
+}
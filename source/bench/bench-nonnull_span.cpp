@@ -0,0 +1,164 @@
+/** bench-nonnull_span.cpp
+ * Measures small per-batch functions taking nonnull_span against the same
+ * functions taking a pointer and size pair or std::span, which have to
+ * handle the empty case.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "bench_common.hpp"
+#include "gch/nonnull_span.hpp"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+
+  struct batch
+  {
+    std::size_t offset;
+    std::size_t size;
+  };
+
+  BENCH_NOINLINE
+  int
+  batch_max (const int *data, std::size_t size)
+  {
+    if (data == nullptr || size == 0)
+      return 0;
+    int result = data[0];
+    for (std::size_t i = 1; i < size; ++i)
+      result = data[i] > result ? data[i] : result;
+    return result;
+  }
+
+  BENCH_NOINLINE
+  int
+  batch_max (gch::nonnull_span<const int> s)
+  {
+    int result = s.front ();
+    for (std::size_t i = 1; i < s.size (); ++i)
+      result = s[i] > result ? s[i] : result;
+    return result;
+  }
+
+  BENCH_NOINLINE
+  int
+  batch_range (const int *data, std::size_t size)
+  {
+    if (data == nullptr || size == 0)
+      return 0;
+    return data[size - 1] - data[0];
+  }
+
+  BENCH_NOINLINE
+  int
+  batch_range (gch::nonnull_span<const int> s)
+  {
+    return s.back () - s.front ();
+  }
+
+#ifdef GCH_LIB_SPAN
+
+  BENCH_NOINLINE
+  int
+  batch_max (std::span<const int> s)
+  {
+    if (s.empty ())
+      return 0;
+    int result = s.front ();
+    for (std::size_t i = 1; i < s.size (); ++i)
+      result = s[i] > result ? s[i] : result;
+    return result;
+  }
+
+  BENCH_NOINLINE
+  int
+  batch_range (std::span<const int> s)
+  {
+    if (s.empty ())
+      return 0;
+    return s.back () - s.front ();
+  }
+
+#endif
+
+}
+
+int
+main (int argc, char **argv)
+{
+  const std::size_t n = bench::iterations (argc, argv, 1 << 16);
+
+  std::mt19937 gen { 42 };
+  std::vector<int> values (n * 8);
+  for (int& v : values)
+    v = static_cast<int> (gen () % 1000);
+
+  // Batches of one to eight elements.
+  std::vector<batch> batches;
+  batches.reserve (n);
+  std::size_t offset = 0;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const std::size_t size = 1 + gen () % 8;
+    batches.push_back ({ offset, size });
+    offset += size;
+  }
+
+  const int *data = values.data ();
+
+  bench::report (bench::run ("max: pointer and size", n, [&] (std::size_t) {
+    int total = 0;
+    for (const batch& b : batches)
+      total += batch_max (data + b.offset, b.size);
+    bench::do_not_optimize (total);
+  }));
+
+  bench::report (bench::run ("max: nonnull_span", n, [&] (std::size_t) {
+    int total = 0;
+    for (const batch& b : batches)
+      total += batch_max (
+        gch::nonnull_span<const int> (gch::nonnull_ptr<const int> (data[b.offset]), b.size));
+    bench::do_not_optimize (total);
+  }));
+
+#ifdef GCH_LIB_SPAN
+  bench::report (bench::run ("max: std::span", n, [&] (std::size_t) {
+    int total = 0;
+    for (const batch& b : batches)
+      total += batch_max (std::span<const int> (data + b.offset, b.size));
+    bench::do_not_optimize (total);
+  }));
+#endif
+
+  bench::report (bench::run ("back - front: pointer and size", n, [&] (std::size_t) {
+    int total = 0;
+    for (const batch& b : batches)
+      total += batch_range (data + b.offset, b.size);
+    bench::do_not_optimize (total);
+  }));
+
+  bench::report (bench::run ("back - front: nonnull_span", n, [&] (std::size_t) {
+    int total = 0;
+    for (const batch& b : batches)
+      total += batch_range (
+        gch::nonnull_span<const int> (gch::nonnull_ptr<const int> (data[b.offset]), b.size));
+    bench::do_not_optimize (total);
+  }));
+
+#ifdef GCH_LIB_SPAN
+  bench::report (bench::run ("back - front: std::span", n, [&] (std::size_t) {
+    int total = 0;
+    for (const batch& b : batches)
+      total += batch_range (std::span<const int> (data + b.offset, b.size));
+    bench::do_not_optimize (total);
+  }));
+#endif
+
+  return 0;
+}
@@ -0,0 +1,208 @@
+/** bench-nonnull_variant_ptr.cpp
+ * Measures dispatch through `gch::nonnull_variant_ptr` against virtual
+ * calls and `std::variant<gch::nonnull_ptr<Ts>...>`.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "bench_common.hpp"
+#include "gch/nonnull_variant_ptr.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#if defined (__has_include) && __has_include (<variant>) && __cplusplus >= 201703L
+#  include <variant>
+#  define BENCH_HAS_VARIANT
+#endif
+
+namespace
+{
+
+  struct node_base
+  {
+    virtual ~node_base (void) = default;
+
+    virtual
+    unsigned
+    eval (void) const noexcept = 0;
+  };
+
+  struct alignas (8) constant : node_base
+  {
+    unsigned
+    eval (void) const noexcept override
+    {
+      return value;
+    }
+
+    unsigned value = 3;
+  };
+
+  struct alignas (8) negate : node_base
+  {
+    unsigned
+    eval (void) const noexcept override
+    {
+      return 0U - value;
+    }
+
+    unsigned value = 5;
+  };
+
+  struct alignas (8) twice : node_base
+  {
+    unsigned
+    eval (void) const noexcept override
+    {
+      return value * 2;
+    }
+
+    unsigned value = 7;
+  };
+
+  struct alignas (8) square : node_base
+  {
+    unsigned
+    eval (void) const noexcept override
+    {
+      return value * value;
+    }
+
+    unsigned value = 11;
+  };
+
+  struct alignas (8) shift : node_base
+  {
+    unsigned
+    eval (void) const noexcept override
+    {
+      return value << 3;
+    }
+
+    unsigned value = 13;
+  };
+
+  // The visitor calls the functions non-virtually, as the compiler knows the dynamic type.
+  struct evaluator
+  {
+    template <typename T>
+    unsigned
+    operator() (const T& node) const noexcept
+    {
+      return node.T::eval ();
+    }
+
+    template <typename T>
+    unsigned
+    operator() (gch::nonnull_ptr<const T> node) const noexcept
+    {
+      return node->T::eval ();
+    }
+  };
+
+  using variant_ptr = gch::nonnull_variant_ptr<const constant, const negate, const twice,
+                                               const square, const shift>;
+
+  template <typename Ptr, typename F>
+  BENCH_NOINLINE
+  unsigned
+  sum (const std::vector<Ptr>& ptrs, F f)
+  {
+    unsigned total = 0;
+    for (const Ptr& p : ptrs)
+      total += f (p);
+    return total;
+  }
+
+  struct virtual_call
+  {
+    unsigned
+    operator() (gch::nonnull_ptr<const node_base> p) const noexcept
+    {
+      return p->eval ();
+    }
+  };
+
+  struct variant_ptr_visit
+  {
+    unsigned
+    operator() (variant_ptr p) const noexcept
+    {
+      return p.visit (evaluator { });
+    }
+  };
+
+}
+
+int
+main (int argc, char **argv)
+{
+  const std::size_t n = bench::iterations (argc, argv, 1 << 20);
+
+  std::vector<constant> c (n / 5);
+  std::vector<negate>   ng (n / 5);
+  std::vector<twice>    t (n / 5);
+  std::vector<square>   sq (n / 5);
+  std::vector<shift>    sh (n / 5);
+
+  std::vector<std::size_t> kinds;
+  for (std::size_t i = 0; i < n / 5; ++i)
+    for (std::size_t k = 0; k < 5; ++k)
+      kinds.push_back (k);
+  std::shuffle (kinds.begin (), kinds.end (), std::mt19937 { 42 });
+
+  std::vector<gch::nonnull_ptr<const node_base>> vptrs;
+  std::vector<variant_ptr> tptrs;
+  std::size_t next[5] { };
+  for (std::size_t k : kinds)
+  {
+    const std::size_t i = next[k]++;
+    switch (k)
+    {
+      case 0:  vptrs.emplace_back (c[i]);  tptrs.emplace_back (c[i]);  break;
+      case 1:  vptrs.emplace_back (ng[i]); tptrs.emplace_back (ng[i]); break;
+      case 2:  vptrs.emplace_back (t[i]);  tptrs.emplace_back (t[i]);  break;
+      case 3:  vptrs.emplace_back (sq[i]); tptrs.emplace_back (sq[i]); break;
+      default: vptrs.emplace_back (sh[i]); tptrs.emplace_back (sh[i]); break;
+    }
+  }
+
+  const std::size_t ops = vptrs.size ();
+
+  std::printf ("sizeof (nonnull_variant_ptr<5 types>) = %zu\n", sizeof (variant_ptr));
+
+  bench::report (bench::run ("virtual call via nonnull_ptr<Base>", ops, [&] (std::size_t) {
+    bench::do_not_optimize (sum (vptrs, virtual_call { }));
+  }));
+
+  bench::report (bench::run ("nonnull_variant_ptr::visit", ops, [&] (std::size_t) {
+    bench::do_not_optimize (sum (tptrs, variant_ptr_visit { }));
+  }));
+
+#ifdef BENCH_HAS_VARIANT
+  using std_variant = std::variant<gch::nonnull_ptr<const constant>,
+                                   gch::nonnull_ptr<const negate>,
+                                   gch::nonnull_ptr<const twice>,
+                                   gch::nonnull_ptr<const square>,
+                                   gch::nonnull_ptr<const shift>>;
+
+  std::printf ("sizeof (std::variant<nonnull_ptr<Ts>...>) = %zu\n", sizeof (std_variant));
+
+  std::vector<std_variant> sptrs;
+  for (const variant_ptr& p : tptrs)
+    p.visit ([&sptrs] (const auto& node) { sptrs.emplace_back (gch::make_nonnull_ptr (node)); });
+
+  bench::report (bench::run ("std::visit on std::variant<nonnull_ptr<Ts>...>", ops, [&] (std::size_t) {
+    bench::do_not_optimize (sum (sptrs, [] (const std_variant& v) {
+      return std::visit (evaluator { }, v);
+    }));
+  }));
+#endif
+
+  return 0;
+}
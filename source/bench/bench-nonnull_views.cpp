@@ -0,0 +1,148 @@
+/** bench-nonnull_views.cpp
+ * Measures walks over owning containers through the nonnull_ptr range
+ * adaptors against hand-written loops and against copying the pointers
+ * out with std::transform.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "bench_common.hpp"
+#include "gch/nonnull_views.hpp"
+
+#include <cstdio>
+
+#ifdef GCH_LIB_RANGES
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+  struct item
+  {
+    int weight;
+    int value;
+  };
+
+  BENCH_NOINLINE
+  int
+  consume (gch::nonnull_ptr<const item> p) noexcept
+  {
+    return p->weight * p->value;
+  }
+
+  BENCH_NOINLINE
+  int
+  walk_checked (const std::vector<std::unique_ptr<item>>& v)
+  {
+    int total = 0;
+    for (const std::unique_ptr<item>& p : v)
+    {
+      if (p)
+        total += consume (gch::nonnull_ptr<const item> (*p));
+    }
+    return total;
+  }
+
+  BENCH_NOINLINE
+  int
+  walk_view (const std::vector<std::unique_ptr<item>>& v)
+  {
+    int total = 0;
+    for (gch::nonnull_ptr<const item> p : v | gch::views::nonnull)
+      total += consume (p);
+    return total;
+  }
+
+  BENCH_NOINLINE
+  int
+  walk_transformed (const std::vector<std::unique_ptr<item>>& v)
+  {
+    std::vector<gch::nonnull_ptr<const item>> ptrs;
+    ptrs.reserve (v.size ());
+    std::transform (v.begin (), v.end (), std::back_inserter (ptrs),
+                    [] (const std::unique_ptr<item>& p) noexcept {
+                      return gch::nonnull_ptr<const item> (*p);
+                    });
+
+    int total = 0;
+    for (gch::nonnull_ptr<const item> p : ptrs)
+      total += consume (p);
+    return total;
+  }
+
+  BENCH_NOINLINE
+  int
+  walk_deque (const std::deque<item>& d)
+  {
+    int total = 0;
+    for (const item& x : d)
+      total += consume (gch::nonnull_ptr<const item> (x));
+    return total;
+  }
+
+  BENCH_NOINLINE
+  int
+  walk_deque_view (const std::deque<item>& d)
+  {
+    int total = 0;
+    for (gch::nonnull_ptr<const item> p : d | gch::views::addressof)
+      total += consume (p);
+    return total;
+  }
+
+}
+
+int
+main (int argc, char **argv)
+{
+  const std::size_t n = bench::iterations (argc, argv, 1 << 16);
+
+  std::vector<std::unique_ptr<item>> owners;
+  std::deque<item> items;
+  owners.reserve (n);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    owners.push_back (std::make_unique<item> (item { static_cast<int> (i % 7), 3 }));
+    items.push_back (item { static_cast<int> (i % 5), 2 });
+  }
+
+  bench::report (bench::run ("unique_ptr: loop with null checks", n, [&] (std::size_t) {
+    bench::do_not_optimize (walk_checked (owners));
+  }));
+
+  bench::report (bench::run ("unique_ptr: views::nonnull", n, [&] (std::size_t) {
+    bench::do_not_optimize (walk_view (owners));
+  }));
+
+  bench::report (bench::run ("unique_ptr: std::transform copy", n, [&] (std::size_t) {
+    bench::do_not_optimize (walk_transformed (owners));
+  }));
+
+  bench::report (bench::run ("deque: loop", n, [&] (std::size_t) {
+    bench::do_not_optimize (walk_deque (items));
+  }));
+
+  bench::report (bench::run ("deque: views::addressof", n, [&] (std::size_t) {
+    bench::do_not_optimize (walk_deque_view (items));
+  }));
+
+  return 0;
+}
+
+#else
+
+int
+main (void)
+{
+  std::printf ("The range adaptors require C++20 ranges.\n");
+  return 0;
+}
+
+#endif
@@ -0,0 +1,411 @@
+/** bench-work_stealing_deque.cpp
+ * A small fork-join scheduler built on work_stealing_deque, measured on a
+ * recursive Fibonacci and a parallel tree walk against the same scheduler
+ * with mutex-protected deques.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "bench_common.hpp"
+#include "gch/work_stealing_deque.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+  // The same interface as work_stealing_deque, with one lock for both ends.
+  template <typename T>
+  class locked_deque
+  {
+  public:
+    void
+    push (gch::nonnull_ptr<T> p)
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      m_deque.push_back (p.get ());
+    }
+
+    T *
+    pop (void)
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      if (m_deque.empty ())
+        return nullptr;
+      T *p = m_deque.back ();
+      m_deque.pop_back ();
+      return p;
+    }
+
+    T *
+    steal (void)
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      if (m_deque.empty ())
+        return nullptr;
+      T *p = m_deque.front ();
+      m_deque.pop_front ();
+      return p;
+    }
+
+  private:
+    std::mutex      m_mutex;
+    std::deque<T *> m_deque;
+  };
+
+  // A fork-join pool. Worker 0 is the thread which calls `run`; the others steal until
+  // the pool is destroyed. A task which forks pushes one child onto its own deque, runs
+  // the other inline, and then helps with any work it can find until the pushed child
+  // has finished.
+  template <template <typename> class Deque>
+  class fork_join_pool
+  {
+  public:
+    class worker;
+
+    struct task
+    {
+      explicit
+      task (void (*f) (task&, worker&)) noexcept
+        : run (f),
+          pending (nullptr)
+      { }
+
+      void (*run) (task&, worker&);
+      std::atomic<int> *pending;
+    };
+
+    class worker
+    {
+    public:
+      worker (fork_join_pool& pool, std::size_t index)
+        : m_pool (pool),
+          m_state (0x9E3779B97F4A7C15ULL * (index + 1))
+      { }
+
+      void
+      spawn (task& t, std::atomic<int>& pending)
+      {
+        t.pending = &pending;
+        m_deque.push (gch::nonnull_ptr<task> (t));
+      }
+
+      void
+      wait (const std::atomic<int>& pending)
+      {
+        while (pending.load (std::memory_order_acquire) != 0)
+        {
+          if (task *t = find_work ())
+            execute (*t);
+          else
+            std::this_thread::yield ();
+        }
+      }
+
+      void
+      execute (task& t)
+      {
+        t.run (t, *this);
+        if (t.pending != nullptr)
+          t.pending->fetch_sub (1, std::memory_order_release);
+      }
+
+      task *
+      find_work (void)
+      {
+        if (task *t = m_deque.pop ())
+          return t;
+
+        const std::size_t n = m_pool.m_workers.size ();
+        if (n == 1)
+          return nullptr;
+
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 7;
+        m_state ^= m_state << 17;
+        return m_pool.m_workers[static_cast<std::size_t> (m_state % n)]->m_deque.steal ();
+      }
+
+    private:
+      fork_join_pool& m_pool;
+      std::uint64_t   m_state;
+      Deque<task>     m_deque;
+    };
+
+    explicit
+    fork_join_pool (std::size_t threads)
+      : m_stop (false)
+    {
+      for (std::size_t i = 0; i < threads; ++i)
+        m_workers.emplace_back (new worker (*this, i));
+
+      for (std::size_t i = 1; i < threads; ++i)
+      {
+        worker *w = m_workers[i].get ();
+        m_threads.emplace_back ([this, w] () noexcept {
+          while (! m_stop.load (std::memory_order_acquire))
+          {
+            if (task *t = w->find_work ())
+              w->execute (*t);
+            else
+              std::this_thread::yield ();
+          }
+        });
+      }
+    }
+
+    fork_join_pool (const fork_join_pool&) = delete;
+
+    fork_join_pool&
+    operator= (const fork_join_pool&) = delete;
+
+    ~fork_join_pool (void)
+    {
+      m_stop.store (true, std::memory_order_release);
+      for (std::thread& t : m_threads)
+        t.join ();
+    }
+
+    void
+    run (task& root)
+    {
+      m_workers.front ()->execute (root);
+    }
+
+  private:
+    std::vector<std::unique_ptr<worker>> m_workers;
+    std::vector<std::thread>             m_threads;
+    std::atomic<bool>                    m_stop;
+  };
+
+  constexpr int fib_cutoff = 6;
+
+  BENCH_NOINLINE
+  std::uint64_t
+  serial_fib (int n) noexcept
+  {
+    return n < 2 ? static_cast<std::uint64_t> (n) : serial_fib (n - 1) + serial_fib (n - 2);
+  }
+
+  std::size_t
+  count_fib_tasks (int n) noexcept
+  {
+    return n < fib_cutoff ? 1 : 1 + count_fib_tasks (n - 1) + count_fib_tasks (n - 2);
+  }
+
+  template <typename Pool>
+  struct fib_task
+    : Pool::task
+  {
+    explicit
+    fib_task (int n_) noexcept
+      : Pool::task (&execute),
+        n (n_),
+        result (0)
+    { }
+
+    static
+    void
+    execute (typename Pool::task& base, typename Pool::worker& w)
+    {
+      fib_task& self = static_cast<fib_task&> (base);
+      if (self.n < fib_cutoff)
+      {
+        self.result = serial_fib (self.n);
+        return;
+      }
+
+      fib_task a (self.n - 1);
+      fib_task b (self.n - 2);
+      std::atomic<int> pending (1);
+      w.spawn (a, pending);
+      execute (b, w);
+      w.wait (pending);
+      self.result = a.result + b.result;
+    }
+
+    int           n;
+    std::uint64_t result;
+  };
+
+  // A complete binary tree whose nodes are scattered through memory, so that the walk is
+  // bound by pointer chasing rather than arithmetic.
+  struct tree_node
+  {
+    std::uint64_t value;
+    tree_node    *left;
+    tree_node    *right;
+  };
+
+  constexpr unsigned walk_cutoff = 6;
+
+  class tree
+  {
+  public:
+    explicit
+    tree (unsigned depth)
+      : m_depth (depth),
+        m_nodes ((std::size_t (1) << depth) - 1)
+    {
+      std::vector<std::size_t> order (m_nodes.size ());
+      for (std::size_t i = 0; i < order.size (); ++i)
+        order[i] = i;
+
+      std::uint64_t state = 0x2545F4914F6CDD1DULL;
+      for (std::size_t i = order.size (); i > 1; --i)
+      {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        std::swap (order[i - 1], order[state % i]);
+      }
+
+      // Node i in heap order lives at order[i].
+      for (std::size_t i = 0; i < m_nodes.size (); ++i)
+      {
+        tree_node& node = m_nodes[order[i]];
+        node.value = i;
+        const std::size_t l = 2 * i + 1;
+        node.left  = l     < m_nodes.size () ? &m_nodes[order[l]]     : nullptr;
+        node.right = l + 1 < m_nodes.size () ? &m_nodes[order[l + 1]] : nullptr;
+      }
+      m_root = &m_nodes[order[0]];
+    }
+
+    tree_node&
+    root (void) const noexcept
+    {
+      return *m_root;
+    }
+
+    unsigned
+    depth (void) const noexcept
+    {
+      return m_depth;
+    }
+
+    std::size_t
+    size (void) const noexcept
+    {
+      return m_nodes.size ();
+    }
+
+  private:
+    unsigned               m_depth;
+    std::vector<tree_node> m_nodes;
+    tree_node             *m_root;
+  };
+
+  BENCH_NOINLINE
+  std::uint64_t
+  serial_walk (const tree_node *node) noexcept
+  {
+    if (node == nullptr)
+      return 0;
+    return node->value + serial_walk (node->left) + serial_walk (node->right);
+  }
+
+  template <typename Pool>
+  struct walk_task
+    : Pool::task
+  {
+    walk_task (const tree_node& node_, unsigned depth_) noexcept
+      : Pool::task (&execute),
+        node (node_),
+        depth (depth_),
+        result (0)
+    { }
+
+    static
+    void
+    execute (typename Pool::task& base, typename Pool::worker& w)
+    {
+      walk_task& self = static_cast<walk_task&> (base);
+      if (self.depth <= walk_cutoff)
+      {
+        self.result = serial_walk (&self.node);
+        return;
+      }
+
+      walk_task l (*self.node.left, self.depth - 1);
+      walk_task r (*self.node.right, self.depth - 1);
+      std::atomic<int> pending (1);
+      w.spawn (l, pending);
+      execute (r, w);
+      w.wait (pending);
+      self.result = self.node.value + l.result + r.result;
+    }
+
+    const tree_node& node;
+    unsigned         depth;
+    std::uint64_t    result;
+  };
+
+  template <template <typename> class Deque>
+  void
+  run_pool (const char *deque_name, std::size_t threads, int fib_n, const tree& t)
+  {
+    using pool_type = fork_join_pool<Deque>;
+    pool_type pool (threads);
+
+    char name[64];
+    std::snprintf (name, sizeof (name), "fib(%d)/%zu threads: %s", fib_n, threads, deque_name);
+    bench::report (bench::run (name, count_fib_tasks (fib_n), [&] (std::size_t) {
+      fib_task<pool_type> root (fib_n);
+      pool.run (root);
+      bench::do_not_optimize (root.result);
+    }));
+
+    std::snprintf (name, sizeof (name), "tree walk/%zu threads: %s", threads, deque_name);
+    bench::report (bench::run (name, t.size (), [&] (std::size_t) {
+      walk_task<pool_type> root (t.root (), t.depth ());
+      pool.run (root);
+      bench::do_not_optimize (root.result);
+    }));
+  }
+
+}
+
+int
+main (int argc, char **argv)
+{
+  // The argument is the depth of the tree; the tree has 2^depth - 1 nodes.
+  const unsigned depth = static_cast<unsigned> (bench::iterations (argc, argv, 20));
+  const int fib_n = 32;
+  const tree t (depth);
+
+  // Parallel speedup needs as many cores as threads. With fewer, the extra threads only
+  // add contention, which still shows the difference in steal cost between the deques.
+  const std::size_t max_threads =
+    (std::max) (std::size_t (4), static_cast<std::size_t> (std::thread::hardware_concurrency ()));
+
+  char name[64];
+  std::snprintf (name, sizeof (name), "fib(%d): serial", fib_n);
+  bench::report (bench::run (name, count_fib_tasks (fib_n), [&] (std::size_t) {
+    bench::do_not_optimize (serial_fib (fib_n));
+  }));
+
+  bench::report (bench::run ("tree walk: serial", t.size (), [&] (std::size_t) {
+    bench::do_not_optimize (serial_walk (&t.root ()));
+  }));
+
+  for (std::size_t threads = 1; threads <= max_threads; threads *= 2)
+  {
+    run_pool<gch::work_stealing_deque> ("work_stealing_deque", threads, fib_n, t);
+    run_pool<locked_deque> ("std::mutex + std::deque", threads, fib_n, t);
+  }
+
+  return 0;
+}
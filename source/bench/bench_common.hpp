@@ -0,0 +1,207 @@
+/** bench_common.hpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef NONNULL_PTR_BENCH_COMMON_HPP
+#define NONNULL_PTR_BENCH_COMMON_HPP
+
+#include "gch/nonnull_ptr.hpp"
+#include "perf_counters.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+#if defined (__GNUC__) || defined (__clang__)
+#  define BENCH_NOINLINE __attribute__ ((noinline))
+#elif defined (_MSC_VER)
+#  define BENCH_NOINLINE __declspec (noinline)
+#else
+#  define BENCH_NOINLINE
+#endif
+
+// The name of the benchmark target, recorded in the JSON results.
+#ifndef NONNULL_PTR_BENCH_TARGET
+#  define NONNULL_PTR_BENCH_TARGET ""
+#endif
+
+namespace bench
+{
+
+  /**
+   * Prevents the compiler from optimizing away the computation of `value`.
+   *
+   * @param value a value which must be materialized.
+   */
+  template <typename T>
+  inline
+  void
+  do_not_optimize (const T& value)
+  {
+#if defined (__GNUC__) || defined (__clang__)
+    asm volatile ("" : : "r,m" (value) : "memory");
+#else
+    static_cast<void> (*static_cast<const volatile char *> (static_cast<const void *> (&value)));
+#endif
+  }
+
+  /**
+   * Hides the value of `value` from the optimizer so it must be treated as opaque.
+   *
+   * @param value a value which will be treated as unknown afterward.
+   */
+  template <typename T>
+  inline
+  void
+  launder_value (T& value)
+  {
+#if defined (__GNUC__) || defined (__clang__)
+    asm volatile ("" : "+m" (value) : : "memory");
+#else
+    do_not_optimize (value);
+#endif
+  }
+
+  /**
+   * The result of one benchmark.
+   */
+  struct result
+  {
+    const char    *name;
+    std::size_t    iterations;
+    double         ns_per_op;
+    counter_values counters_per_op;
+  };
+
+  /**
+   * Gets the number of iterations from the command line, or uses a default.
+   *
+   * @param argc the argument count passed to `main`.
+   * @param argv the argument vector passed to `main`.
+   * @param default_iterations the iterations used if none were given.
+   * @return the number of iterations.
+   */
+  inline
+  std::size_t
+  iterations (int argc, char **argv, std::size_t default_iterations)
+  {
+    if (argc > 1)
+      return static_cast<std::size_t> (std::strtoull (argv[1], nullptr, 10));
+    return default_iterations;
+  }
+
+  /**
+   * Runs `f (iterations)` several times and keeps the fastest repetition, along with the
+   * hardware counters over it.
+   *
+   * @tparam F a callable taking the number of iterations to perform.
+   * @param name the name of the benchmark.
+   * @param iterations the number of operations performed by one call to `f`.
+   * @param f the benchmark body.
+   * @param repetitions the number of times to repeat the measurement.
+   * @return the best time per operation.
+   */
+  template <typename F>
+  inline
+  result
+  run (const char *name, std::size_t iterations, F f, std::size_t repetitions = 5)
+  {
+    using clock = std::chrono::steady_clock;
+
+    perf_counters& counters = get_perf_counters ();
+
+    double best = -1.0;
+    counter_values best_counters = counter_values ();
+    for (std::size_t i = 0; i < repetitions; ++i)
+    {
+      // The counters are started outside of the timed region.
+      counters.start ();
+      const clock::time_point start = clock::now ();
+      f (iterations);
+      const clock::time_point stop = clock::now ();
+      const counter_values c = counters.stop ();
+
+      const double elapsed = std::chrono::duration<double, std::nano> (stop - start).count ();
+      if (best < 0.0 || elapsed < best)
+      {
+        best          = elapsed;
+        best_counters = c;
+      }
+    }
+
+    const double n = static_cast<double> (iterations == 0 ? 1 : iterations);
+    for (double& v : best_counters.value)
+      v /= n;
+
+    return { name, iterations, iterations == 0 ? 0.0 : best / n, best_counters };
+  }
+
+  /**
+   * Appends a result to `file` as a single-line JSON object.
+   *
+   * @param file an open file.
+   * @param r a benchmark result.
+   */
+  inline
+  void
+  write_json (std::FILE *file, const result& r)
+  {
+    std::fputs ("{\"target\": \"" NONNULL_PTR_BENCH_TARGET "\", \"name\": \"", file);
+    for (const char *c = r.name; *c != '\0'; ++c)
+    {
+      if (*c == '"' || *c == '\\')
+        std::fputc ('\\', file);
+      std::fputc (*c, file);
+    }
+    std::fprintf (file, "\", \"iterations\": %zu, \"ns_per_op\": %.3f",
+                  r.iterations, r.ns_per_op);
+
+    // Only the counters which could be read are written.
+    bool any = false;
+    for (std::size_t i = 0; i < counter_count; ++i)
+    {
+      if (r.counters_per_op.valid[i])
+      {
+        std::fprintf (file, "%s\"%s\": %.4f", any ? ", " : ", \"counters_per_op\": {",
+                      counter_name (i), r.counters_per_op.value[i]);
+        any = true;
+      }
+    }
+    std::fputs (any ? "}}\n" : "}\n", file);
+  }
+
+  /**
+   * Prints a result to stdout. If the environment variable `NONNULL_PTR_BENCH_JSON` names
+   * a file, the result is also appended to it as one line of JSON.
+   *
+   * @param r a benchmark result.
+   */
+  inline
+  void
+  report (const result& r)
+  {
+    std::printf ("%-48s %12.3f ns/op", r.name, r.ns_per_op);
+    for (std::size_t i = 0; i < counter_count; ++i)
+    {
+      if (r.counters_per_op.valid[i])
+        std::printf ("  %9.3f %s", r.counters_per_op.value[i], counter_label (i));
+    }
+    std::printf ("  (%zu iterations)\n", r.iterations);
+
+    if (const char *path = std::getenv ("NONNULL_PTR_BENCH_JSON"))
+    {
+      if (std::FILE *file = std::fopen (path, "a"))
+      {
+        write_json (file, r);
+        std::fclose (file);
+      }
+    }
+  }
+
+} // namespace bench
+
+#endif // NONNULL_PTR_BENCH_COMMON_HPP
@@ -0,0 +1,261 @@
+/** perf_counters.hpp
+ * Defines the hardware counters which the benchmarks read around each
+ * measured region, using perf_event_open on Linux. Where the counters are
+ * unavailable (on other systems, in containers without access to them, or
+ * with a restrictive perf_event_paranoid), they read as invalid and the
+ * benchmarks only report time.
+ *
+ * Setting the environment variable NONNULL_PTR_BENCH_COUNTERS to 0 turns
+ * the counters off.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef NONNULL_PTR_BENCH_PERF_COUNTERS_HPP
+#define NONNULL_PTR_BENCH_PERF_COUNTERS_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined (__linux__) && defined (__has_include)
+#  if __has_include (<linux/perf_event.h>)
+#    define NONNULL_PTR_BENCH_HAS_PERF_EVENT
+#    include <linux/perf_event.h>
+#    include <sys/ioctl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#  endif
+#endif
+
+namespace bench
+{
+
+  /**
+   * The number of counters.
+   */
+  constexpr std::size_t counter_count = 5;
+
+  /**
+   * Gets the name of a counter, as used in the JSON results.
+   *
+   * @param i the index of a counter.
+   * @return the name of the counter.
+   */
+  inline
+  const char *
+  counter_name (std::size_t i) noexcept
+  {
+    static const char *const names[counter_count] = {
+      "cycles", "instructions", "cache_misses", "branch_misses", "dtlb_misses"
+    };
+    return names[i];
+  }
+
+  /**
+   * Gets a short label for a counter, as printed next to the time.
+   *
+   * @param i the index of a counter.
+   * @return the label of the counter.
+   */
+  inline
+  const char *
+  counter_label (std::size_t i) noexcept
+  {
+    static const char *const labels[counter_count] = {
+      "cyc", "ins", "cache-miss", "br-miss", "dtlb-miss"
+    };
+    return labels[i];
+  }
+
+  /**
+   * The values of the counters over a region. A counter which could not be read is not
+   * valid.
+   */
+  struct counter_values
+  {
+    double value[counter_count];
+    bool   valid[counter_count];
+  };
+
+  /**
+   * A set of counters for the calling thread and the threads it creates afterward.
+   */
+  class perf_counters
+  {
+  public:
+    perf_counters (void)
+    {
+      for (int& fd : m_fds)
+        fd = -1;
+
+      const char *env = std::getenv ("NONNULL_PTR_BENCH_COUNTERS");
+      if (env != nullptr && std::strcmp (env, "0") == 0)
+        return;
+
+#ifdef NONNULL_PTR_BENCH_HAS_PERF_EVENT
+      const std::uint32_t types[counter_count] = {
+        PERF_TYPE_HARDWARE,
+        PERF_TYPE_HARDWARE,
+        PERF_TYPE_HARDWARE,
+        PERF_TYPE_HARDWARE,
+        PERF_TYPE_HW_CACHE
+      };
+
+      const std::uint64_t configs[counter_count] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_CACHE_DTLB
+          | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+          | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+      };
+
+      int error = 0;
+      for (std::size_t i = 0; i < counter_count; ++i)
+      {
+        // These are opened separately rather than as a group, so that a counter which the
+        // CPU does not have does not take the others with it.
+        perf_event_attr attr;
+        std::memset (&attr, 0, sizeof (attr));
+        attr.size           = sizeof (attr);
+        attr.type           = types[i];
+        attr.config         = configs[i];
+        attr.disabled       = 1;
+        attr.inherit        = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        m_fds[i] = static_cast<int> (syscall (SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (m_fds[i] < 0 && error == 0)
+          error = errno;
+      }
+
+      if (! available ())
+      {
+        std::fprintf (stderr, "Hardware counters are unavailable (%s), so only time is "
+                              "reported.\n", std::strerror (error));
+      }
+#endif
+    }
+
+    perf_counters (const perf_counters&) = delete;
+    perf_counters& operator= (const perf_counters&) = delete;
+
+    ~perf_counters (void)
+    {
+#ifdef NONNULL_PTR_BENCH_HAS_PERF_EVENT
+      for (int fd : m_fds)
+      {
+        if (fd >= 0)
+          close (fd);
+      }
+#endif
+    }
+
+    /**
+     * Checks whether any counter could be opened.
+     *
+     * @return whether any counter is available.
+     */
+    bool
+    available (void) const noexcept
+    {
+      for (int fd : m_fds)
+      {
+        if (fd >= 0)
+          return true;
+      }
+      return false;
+    }
+
+    /**
+     * Resets and starts the counters.
+     */
+    void
+    start (void) noexcept
+    {
+#ifdef NONNULL_PTR_BENCH_HAS_PERF_EVENT
+      for (int fd : m_fds)
+      {
+        if (fd >= 0)
+        {
+          ioctl (fd, PERF_EVENT_IOC_RESET, 0);
+          ioctl (fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+      }
+#endif
+    }
+
+    /**
+     * Stops the counters and reads them.
+     *
+     * A counter which the kernel multiplexed with others is scaled up to the whole region.
+     *
+     * @return the values of the counters since `start`.
+     */
+    counter_values
+    stop (void) noexcept
+    {
+      counter_values v;
+      for (std::size_t i = 0; i < counter_count; ++i)
+      {
+        v.value[i] = 0.0;
+        v.valid[i] = false;
+      }
+
+#ifdef NONNULL_PTR_BENCH_HAS_PERF_EVENT
+      for (int fd : m_fds)
+      {
+        if (fd >= 0)
+          ioctl (fd, PERF_EVENT_IOC_DISABLE, 0);
+      }
+
+      for (std::size_t i = 0; i < counter_count; ++i)
+      {
+        // The value, the time enabled and the time running.
+        std::uint64_t data[3];
+        if (m_fds[i] < 0
+            || read (m_fds[i], data, sizeof (data)) != static_cast<ssize_t> (sizeof (data))
+            || data[2] == 0)
+        {
+          continue;
+        }
+
+        v.value[i] = static_cast<double> (data[0]) * static_cast<double> (data[1])
+                   / static_cast<double> (data[2]);
+        v.valid[i] = true;
+      }
+#endif
+
+      return v;
+    }
+
+  private:
+    int m_fds[counter_count];
+  };
+
+  /**
+   * Gets the counters of the process, which are opened on the first call.
+   *
+   * @return the counters.
+   */
+  inline
+  perf_counters&
+  get_perf_counters (void)
+  {
+    static perf_counters counters;
+    return counters;
+  }
+
+} // namespace bench
+
+#endif // NONNULL_PTR_BENCH_PERF_COUNTERS_HPP
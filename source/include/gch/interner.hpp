@@ -0,0 +1,309 @@
+/** interner.hpp
+ * Defines a hash-consing table which hands out canonical pointers to
+ * immutable values.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_INTERNER_HPP
+#define GCH_INTERNER_HPP
+
+#include "nonnull_ptr.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  /**
+   * A lockable type which does nothing, for single-threaded interners.
+   */
+  struct null_mutex
+  {
+    void
+    lock (void) noexcept
+    { }
+
+    void
+    unlock (void) noexcept
+    { }
+  };
+
+  /**
+   * A hash-consing table.
+   *
+   * Each distinct value is stored once, and `intern` returns a canonical pointer to it.
+   * Equal values therefore have equal pointers, so equality is the pointer comparison of
+   * `nonnull_ptr` and hashing is `std::hash<nonnull_ptr>`.
+   *
+   * Values are stored in an arena of geometrically growing blocks. They are never moved
+   * or destroyed before the interner, so the pointers remain valid for its lifetime.
+   *
+   * @tparam T the value type, which must be copy- or move-constructible.
+   * @tparam Hash a hash function object for `T`.
+   * @tparam KeyEqual an equality function object for `T`.
+   * @tparam Mutex a lockable type guarding the table. Use `std::mutex` to share an
+   *               interner between threads (see `concurrent_interner`).
+   */
+  template <typename T,
+            typename Hash     = std::hash<T>,
+            typename KeyEqual = std::equal_to<T>,
+            typename Mutex    = null_mutex>
+  class interner
+  {
+  public:
+    using value_type  = T;        /*!< The interned value type  */
+    using hasher      = Hash;     /*!< The hash function type   */
+    using key_equal   = KeyEqual; /*!< The equality function type */
+    using mutex_type  = Mutex;    /*!< The lockable type        */
+    using size_type   = std::size_t;
+    using pointer     = nonnull_ptr<const T>; /*!< The canonical pointer type */
+
+    /**
+     * An account of the memory held by an interner.
+     *
+     * The index is an estimate, since the node layout of `std::unordered_set` is not
+     * observable. Memory owned by the values themselves is not included.
+     */
+    struct memory_usage
+    {
+      size_type count;          /*!< The number of interned values           */
+      size_type arena_reserved; /*!< The bytes allocated for value storage   */
+      size_type arena_used;     /*!< The bytes occupied by interned values   */
+      size_type index;          /*!< The estimated bytes used by the index   */
+    };
+
+  private:
+    struct alignas (T) slot
+    {
+      unsigned char bytes[sizeof (T)];
+    };
+
+    struct block
+    {
+      std::unique_ptr<slot[]> slots;
+      size_type               capacity;
+    };
+
+    struct deref_hash
+    {
+      std::size_t
+      operator() (const T *p) const
+        noexcept (noexcept (std::declval<const Hash&> () (std::declval<const T&> ())))
+      {
+        return hash (*p);
+      }
+
+      Hash hash;
+    };
+
+    struct deref_equal
+    {
+      bool
+      operator() (const T *lhs, const T *rhs) const
+        noexcept (noexcept (std::declval<const KeyEqual&> () (std::declval<const T&> (),
+                                                             std::declval<const T&> ())))
+      {
+        return equal (*lhs, *rhs);
+      }
+
+      KeyEqual equal;
+    };
+
+    using index_type = std::unordered_set<const T *, deref_hash, deref_equal>;
+
+  public:
+    /**
+     * Constructor
+     *
+     * @param initial_block_size the number of values in the first block of the arena.
+     * @param hash the hash function object.
+     * @param equal the equality function object.
+     */
+    explicit
+    interner (size_type initial_block_size = 64,
+              const Hash& hash = Hash (),
+              const KeyEqual& equal = KeyEqual ())
+      : m_index (0, deref_hash { hash }, deref_equal { equal }),
+        m_next_block_size (initial_block_size == 0 ? 1 : initial_block_size)
+    { }
+
+    interner (const interner&)            = delete;
+    interner (interner&&)                 = delete;
+    interner& operator= (const interner&) = delete;
+    interner& operator= (interner&&)      = delete;
+
+    /**
+     * Destructor
+     *
+     * Destroys every interned value. Pointers handed out become dangling.
+     */
+    ~interner (void)
+    {
+      for (const T *p : m_index)
+        p->~T ();
+    }
+
+    /**
+     * Returns the canonical pointer for a value equal to `value`.
+     *
+     * If there is no such value, a copy of `value` is stored first.
+     *
+     * @param value a value.
+     * @return the canonical pointer.
+     */
+    pointer
+    intern (const T& value)
+    {
+      std::lock_guard<Mutex> lock (m_mutex);
+      return insert_unlocked (value);
+    }
+
+    /**
+     * Returns the canonical pointer for a value equal to `value`.
+     *
+     * If there is no such value, `value` is moved into storage first.
+     *
+     * @param value a value.
+     * @return the canonical pointer.
+     */
+    pointer
+    intern (T&& value)
+    {
+      std::lock_guard<Mutex> lock (m_mutex);
+      return insert_unlocked (std::move (value));
+    }
+
+    /**
+     * Looks up the canonical pointer for `value` without inserting.
+     *
+     * @param value a value.
+     * @return the canonical pointer, or `nullptr` if `value` has not been interned.
+     */
+    GCH_NODISCARD
+    const T *
+    find (const T& value) const
+    {
+      std::lock_guard<Mutex> lock (m_mutex);
+      const typename index_type::const_iterator found = m_index.find (&value);
+      return found == m_index.end () ? nullptr : *found;
+    }
+
+    /**
+     * Returns the number of distinct values interned.
+     *
+     * @return the number of values.
+     */
+    GCH_NODISCARD
+    size_type
+    size (void) const
+    {
+      std::lock_guard<Mutex> lock (m_mutex);
+      return m_index.size ();
+    }
+
+    /**
+     * Returns an account of the memory held by the interner.
+     *
+     * @return the memory usage.
+     */
+    GCH_NODISCARD
+    memory_usage
+    usage (void) const
+    {
+      std::lock_guard<Mutex> lock (m_mutex);
+
+      size_type reserved = 0;
+      for (const block& b : m_blocks)
+        reserved += b.capacity * sizeof (slot);
+
+      // Each node holds the pointer, a link, and (usually) a cached hash.
+      const size_type node_size = sizeof (const T *) + sizeof (void *) + sizeof (std::size_t);
+
+      return {
+        m_index.size (),
+        reserved,
+        m_index.size () * sizeof (slot),
+        m_index.bucket_count () * sizeof (void *) + m_index.size () * node_size
+      };
+    }
+
+  private:
+    template <typename U>
+    pointer
+    insert_unlocked (U&& value)
+    {
+      const typename index_type::const_iterator found = m_index.find (&value);
+      if (found != m_index.end ())
+        return pointer { **found };
+
+      slot& s = next_slot ();
+      const T *stored = ::new (static_cast<void *> (&s)) T (std::forward<U> (value));
+      try
+      {
+        m_index.insert (stored);
+      }
+      catch (...)
+      {
+        stored->~T ();
+        throw;
+      }
+
+      ++m_used_in_last;
+      return pointer { *stored };
+    }
+
+    slot&
+    next_slot (void)
+    {
+      if (m_blocks.empty () || m_used_in_last == m_blocks.back ().capacity)
+      {
+        m_blocks.push_back ({ std::unique_ptr<slot[]> (new slot[m_next_block_size]),
+                              m_next_block_size });
+        m_used_in_last    = 0;
+        m_next_block_size *= 2;
+      }
+      return m_blocks.back ().slots[m_used_in_last];
+    }
+
+    index_type         m_index;
+    std::vector<block> m_blocks;
+    size_type          m_used_in_last = 0;
+    size_type          m_next_block_size;
+    mutable Mutex      m_mutex;
+  };
+
+  /**
+   * An interner which may be shared between threads.
+   *
+   * @tparam T the value type.
+   * @tparam Hash a hash function object for `T`.
+   * @tparam KeyEqual an equality function object for `T`.
+   */
+  template <typename T,
+            typename Hash     = std::hash<T>,
+            typename KeyEqual = std::equal_to<T>>
+  using concurrent_interner = interner<T, Hash, KeyEqual, std::mutex>;
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_INTERNER_HPP
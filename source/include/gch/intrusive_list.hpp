@@ -0,0 +1,834 @@
+/** intrusive_list.hpp
+ * Defines a circular, sentinel-headed intrusive doubly linked list whose
+ * links are never null.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_INTRUSIVE_LIST_HPP
+#define GCH_INTRUSIVE_LIST_HPP
+
+#include "nonnull_ptr.hpp"
+#include "nonnull_ptr_member.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  class list_hook;
+
+  template <typename T, list_hook T::*Hook>
+  class intrusive_list;
+
+  /**
+   * The links of an element of an `intrusive_list`.
+   *
+   * An unlinked hook points to itself, so both links are always valid and linking and
+   * unlinking need no null checks. Copying an element does not copy its links; the copy
+   * starts out unlinked.
+   */
+  class list_hook
+  {
+    template <typename T, list_hook T::*Hook>
+    friend class intrusive_list;
+
+  public:
+    /**
+     * Constructor
+     *
+     * Creates an unlinked hook.
+     */
+    list_hook (void) noexcept
+      : m_next (*this),
+        m_prev (*this)
+    { }
+
+    /**
+     * Constructor
+     *
+     * Creates an unlinked hook. The links of `other` are not copied.
+     */
+    list_hook (const list_hook&) noexcept
+      : list_hook ()
+    { }
+
+    /**
+     * Assignment operator
+     *
+     * Does nothing. The links of `other` are not copied.
+     *
+     * @return `*this`
+     */
+    list_hook&
+    operator= (const list_hook&) noexcept
+    {
+      return *this;
+    }
+
+    /**
+     * Destructor
+     *
+     * The hook must not be linked.
+     */
+    ~list_hook (void)
+    {
+      assert (! is_linked () && "An element was destroyed while it was still in a list.");
+    }
+
+    /**
+     * Returns whether the hook is in a list.
+     *
+     * @return whether the hook is linked.
+     */
+    GCH_NODISCARD
+    bool
+    is_linked (void) const noexcept
+    {
+      return m_next.get () != this;
+    }
+
+    /**
+     * Removes the hook from the list containing it, if any, without updating the size of
+     * that list. Prefer `intrusive_list::erase`.
+     */
+    void
+    unlink (void) noexcept
+    {
+      detach ();
+      m_next = nonnull_ptr<list_hook> (*this);
+      m_prev = nonnull_ptr<list_hook> (*this);
+    }
+
+  private:
+    // Joins the neighbours of this hook. Its own links are left stale, so a detached hook
+    // may still be used as a position to link before.
+    void
+    detach (void) noexcept
+    {
+      list_hook& prev = *m_prev;
+      list_hook& next = *m_next;
+      prev.m_next = nonnull_ptr<list_hook> (next);
+      next.m_prev = nonnull_ptr<list_hook> (prev);
+    }
+
+    // Links this hook after `prev`. Only `prev` is read, so the successor's cache line is
+    // written but never loaded.
+    void
+    link_after (list_hook& prev) noexcept
+    {
+      list_hook& next = *prev.m_next;
+      m_prev = nonnull_ptr<list_hook> (prev);
+      m_next = nonnull_ptr<list_hook> (next);
+      next.m_prev = nonnull_ptr<list_hook> (*this);
+      prev.m_next = nonnull_ptr<list_hook> (*this);
+    }
+
+    // Links this hook before `pos`. If this hook was just detached from before `pos`, or
+    // `pos` is this hook, it is linked back in its old place.
+    void
+    link_before (list_hook& pos) noexcept
+    {
+      link_after (*pos.m_prev);
+    }
+
+    // Moves the hooks in [first, last) before this hook.
+    void
+    transfer (list_hook& first, list_hook& last) noexcept
+    {
+      list_hook& before_last = *last.m_prev;
+
+      first.m_prev->m_next = nonnull_ptr<list_hook> (last);
+      last.m_prev = first.m_prev;
+
+      m_prev->m_next = nonnull_ptr<list_hook> (first);
+      first.m_prev = m_prev;
+
+      before_last.m_next = nonnull_ptr<list_hook> (*this);
+      m_prev = nonnull_ptr<list_hook> (before_last);
+    }
+
+    nonnull_ptr<list_hook> m_next;
+    nonnull_ptr<list_hook> m_prev;
+  };
+
+  /**
+   * An intrusive doubly linked list.
+   *
+   * Elements hold a `list_hook` member named by `Hook`, so the list never allocates. The
+   * list is circular and headed by a sentinel hook, so every link is a `nonnull_ptr` and
+   * insertion, erasure and splicing single elements are branch-free. Splicing a whole list
+   * checks whether it is empty. Everything except `clear` takes constant time, including
+   * `size`.
+   *
+   * Elements must outlive their membership of the list. The list unlinks, but does not
+   * destroy, its elements when it is destroyed.
+   *
+   * The list is not copyable. Moving it moves the links, leaving the source empty.
+   *
+   * @tparam T the element type.
+   * @tparam Hook a pointer to the `list_hook` data member of `T`.
+   */
+  template <typename T, list_hook T::*Hook>
+  class intrusive_list
+  {
+  public:
+    using value_type      = T;              /*!< The element type           */
+    using size_type       = std::size_t;    /*!< The size type              */
+    using difference_type = std::ptrdiff_t; /*!< The difference type        */
+    using reference       = T&;             /*!< The reference type         */
+    using const_reference = const T&;       /*!< The const reference type   */
+    using pointer         = T *;            /*!< The pointer type           */
+    using const_pointer   = const T *;      /*!< The const pointer type     */
+
+  private:
+    template <bool IsConst>
+    class basic_iterator
+    {
+      using hook_type = typename std::conditional<IsConst, const list_hook, list_hook>::type;
+
+    public:
+      using difference_type   = std::ptrdiff_t;
+      using value_type        = T;
+      using pointer           = typename std::conditional<IsConst, const T *, T *>::type;
+      using reference         = typename std::conditional<IsConst, const T&, T&>::type;
+      using iterator_category = std::bidirectional_iterator_tag;
+
+      /**
+       * Constructor
+       *
+       * A default constructor, which creates a singular iterator. This only exists
+       * because iterators are required to be default constructible.
+       */
+      basic_iterator (void) noexcept
+        : m_hook (nullptr)
+      { }
+
+      /**
+       * Constructor
+       *
+       * Creates an iterator to the element holding `hook`, or to the end of the list if
+       * `hook` is its sentinel.
+       *
+       * @param hook a hook.
+       */
+      explicit
+      basic_iterator (hook_type& hook) noexcept
+        : m_hook (&hook)
+      { }
+
+      /**
+       * Constructor
+       *
+       * A conversion from an iterator to a const iterator.
+       */
+      template <bool OtherConst,
+                typename std::enable_if<IsConst && ! OtherConst>::type * = nullptr>
+      GCH_IMPLICIT_CONVERSION
+      basic_iterator (const basic_iterator<OtherConst>& other) noexcept
+        : m_hook (other.m_hook)
+      { }
+
+      /**
+       * Returns the element, recovered from its hook with `container_of`.
+       *
+       * @return a reference to the element.
+       */
+      GCH_NODISCARD
+      reference
+      operator* (void) const noexcept
+      {
+        return *container_of (nonnull_ptr<hook_type> (*m_hook), Hook);
+      }
+
+      /**
+       * Returns a pointer to the element.
+       *
+       * @return a pointer to the element.
+       */
+      GCH_NODISCARD
+      pointer
+      operator-> (void) const noexcept
+      {
+        return container_of (nonnull_ptr<hook_type> (*m_hook), Hook).get ();
+      }
+
+      /**
+       * Advances to the next element.
+       *
+       * @return `*this`
+       */
+      basic_iterator&
+      operator++ (void) noexcept
+      {
+        m_hook = m_hook->m_next.get ();
+        return *this;
+      }
+
+      /**
+       * Advances to the next element.
+       *
+       * @return a copy of the iterator from before the increment.
+       */
+      basic_iterator
+      operator++ (int) noexcept
+      {
+        basic_iterator tmp = *this;
+        ++*this;
+        return tmp;
+      }
+
+      /**
+       * Moves to the previous element.
+       *
+       * @return `*this`
+       */
+      basic_iterator&
+      operator-- (void) noexcept
+      {
+        m_hook = m_hook->m_prev.get ();
+        return *this;
+      }
+
+      /**
+       * Moves to the previous element.
+       *
+       * @return a copy of the iterator from before the decrement.
+       */
+      basic_iterator
+      operator-- (int) noexcept
+      {
+        basic_iterator tmp = *this;
+        --*this;
+        return tmp;
+      }
+
+      /**
+       * An equality comparison function.
+       *
+       * @param lhs an iterator.
+       * @param rhs an iterator.
+       * @return whether the iterators refer to the same position.
+       */
+      GCH_NODISCARD friend
+      bool
+      operator== (const basic_iterator& lhs, const basic_iterator& rhs) noexcept
+      {
+        return lhs.m_hook == rhs.m_hook;
+      }
+
+      /**
+       * An inequality comparison function.
+       *
+       * @param lhs an iterator.
+       * @param rhs an iterator.
+       * @return whether the iterators refer to different positions.
+       */
+      GCH_NODISCARD friend
+      bool
+      operator!= (const basic_iterator& lhs, const basic_iterator& rhs) noexcept
+      {
+        return lhs.m_hook != rhs.m_hook;
+      }
+
+    private:
+      friend class intrusive_list;
+      friend class basic_iterator<! IsConst>;
+
+      hook_type *m_hook;
+    };
+
+  public:
+    using iterator               = basic_iterator<false>;  /*!< A bidirectional iterator */
+    using const_iterator         = basic_iterator<true>;   /*!< A constant iterator      */
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    /**
+     * Constructor
+     *
+     * Creates an empty list.
+     */
+    intrusive_list (void) noexcept = default;
+
+    /**
+     * Lists are not copyable, since an element can only be in one list per hook.
+     */
+    intrusive_list (const intrusive_list&) = delete;
+
+    /**
+     * Lists are not copyable.
+     */
+    intrusive_list&
+    operator= (const intrusive_list&) = delete;
+
+    /**
+     * Constructor
+     *
+     * Takes the elements of `other`, leaving it empty.
+     *
+     * @param other another list.
+     */
+    intrusive_list (intrusive_list&& other) noexcept
+    {
+      splice (end (), other);
+    }
+
+    /**
+     * Assignment operator
+     *
+     * Unlinks the current elements and takes the elements of `other`, leaving it empty.
+     *
+     * @param other another list.
+     * @return `*this`
+     */
+    intrusive_list&
+    operator= (intrusive_list&& other) noexcept
+    {
+      if (&other != this)
+      {
+        clear ();
+        splice (end (), other);
+      }
+      return *this;
+    }
+
+    /**
+     * Destructor
+     *
+     * Unlinks every element. The elements are not destroyed.
+     */
+    ~intrusive_list (void)
+    {
+      clear ();
+    }
+
+    /**
+     * Returns an iterator to the first element.
+     *
+     * @return an iterator to the first element.
+     */
+    GCH_NODISCARD
+    iterator
+    begin (void) noexcept
+    {
+      return iterator (*m_head.m_next);
+    }
+
+    /**
+     * Returns an iterator to the first element.
+     *
+     * @return an iterator to the first element.
+     */
+    GCH_NODISCARD
+    const_iterator
+    begin (void) const noexcept
+    {
+      return const_iterator (*m_head.m_next);
+    }
+
+    /**
+     * Returns an iterator to the first element.
+     *
+     * @return an iterator to the first element.
+     */
+    GCH_NODISCARD
+    const_iterator
+    cbegin (void) const noexcept
+    {
+      return begin ();
+    }
+
+    /**
+     * Returns an iterator past the last element.
+     *
+     * @return an iterator past the last element.
+     */
+    GCH_NODISCARD
+    iterator
+    end (void) noexcept
+    {
+      return iterator (m_head);
+    }
+
+    /**
+     * Returns an iterator past the last element.
+     *
+     * @return an iterator past the last element.
+     */
+    GCH_NODISCARD
+    const_iterator
+    end (void) const noexcept
+    {
+      return const_iterator (m_head);
+    }
+
+    /**
+     * Returns an iterator past the last element.
+     *
+     * @return an iterator past the last element.
+     */
+    GCH_NODISCARD
+    const_iterator
+    cend (void) const noexcept
+    {
+      return end ();
+    }
+
+    /**
+     * Returns a reverse iterator to the last element.
+     *
+     * @return a reverse iterator to the last element.
+     */
+    GCH_NODISCARD
+    reverse_iterator
+    rbegin (void) noexcept
+    {
+      return reverse_iterator (end ());
+    }
+
+    /**
+     * Returns a reverse iterator to the last element.
+     *
+     * @return a reverse iterator to the last element.
+     */
+    GCH_NODISCARD
+    const_reverse_iterator
+    rbegin (void) const noexcept
+    {
+      return const_reverse_iterator (end ());
+    }
+
+    /**
+     * Returns a reverse iterator before the first element.
+     *
+     * @return a reverse iterator before the first element.
+     */
+    GCH_NODISCARD
+    reverse_iterator
+    rend (void) noexcept
+    {
+      return reverse_iterator (begin ());
+    }
+
+    /**
+     * Returns a reverse iterator before the first element.
+     *
+     * @return a reverse iterator before the first element.
+     */
+    GCH_NODISCARD
+    const_reverse_iterator
+    rend (void) const noexcept
+    {
+      return const_reverse_iterator (begin ());
+    }
+
+    /**
+     * Returns whether the list is empty.
+     *
+     * @return whether the list is empty.
+     */
+    GCH_NODISCARD
+    bool
+    empty (void) const noexcept
+    {
+      return m_size == 0;
+    }
+
+    /**
+     * Returns the number of elements, in constant time.
+     *
+     * @return the number of elements.
+     */
+    GCH_NODISCARD
+    size_type
+    size (void) const noexcept
+    {
+      return m_size;
+    }
+
+    /**
+     * Returns the first element. The list must not be empty.
+     *
+     * @return the first element.
+     */
+    GCH_NODISCARD
+    reference
+    front (void) noexcept
+    {
+      assert (! empty ());
+      return *begin ();
+    }
+
+    /**
+     * Returns the first element. The list must not be empty.
+     *
+     * @return the first element.
+     */
+    GCH_NODISCARD
+    const_reference
+    front (void) const noexcept
+    {
+      assert (! empty ());
+      return *begin ();
+    }
+
+    /**
+     * Returns the last element. The list must not be empty.
+     *
+     * @return the last element.
+     */
+    GCH_NODISCARD
+    reference
+    back (void) noexcept
+    {
+      assert (! empty ());
+      return *iterator (*m_head.m_prev);
+    }
+
+    /**
+     * Returns the last element. The list must not be empty.
+     *
+     * @return the last element.
+     */
+    GCH_NODISCARD
+    const_reference
+    back (void) const noexcept
+    {
+      assert (! empty ());
+      return *const_iterator (*m_head.m_prev);
+    }
+
+    /**
+     * Returns an iterator to `value`, which must be in this list.
+     *
+     * @param value an element of this list.
+     * @return an iterator to `value`.
+     */
+    GCH_NODISCARD
+    iterator
+    iterator_to (reference value) noexcept
+    {
+      return iterator (value.*Hook);
+    }
+
+    /**
+     * Returns an iterator to `value`, which must be in this list.
+     *
+     * @param value an element of this list.
+     * @return an iterator to `value`.
+     */
+    GCH_NODISCARD
+    const_iterator
+    iterator_to (const_reference value) const noexcept
+    {
+      return const_iterator (value.*Hook);
+    }
+
+    /**
+     * Links `value` before `pos`. `value` must not be in a list.
+     *
+     * @param pos a position in this list.
+     * @param value an element.
+     * @return an iterator to `value`.
+     */
+    iterator
+    insert (const_iterator pos, reference value) noexcept
+    {
+      list_hook& hook = value.*Hook;
+      assert (! hook.is_linked () && "The element is already in a list.");
+      hook.link_before (mutable_hook (pos));
+      ++m_size;
+      return iterator (hook);
+    }
+
+    /**
+     * Links `value` at the front. `value` must not be in a list.
+     *
+     * @param value an element.
+     */
+    void
+    push_front (reference value) noexcept
+    {
+      list_hook& hook = value.*Hook;
+      assert (! hook.is_linked () && "The element is already in a list.");
+      hook.link_after (m_head);
+      ++m_size;
+    }
+
+    /**
+     * Links `value` at the back. `value` must not be in a list.
+     *
+     * @param value an element.
+     */
+    void
+    push_back (reference value) noexcept
+    {
+      insert (end (), value);
+    }
+
+    /**
+     * Unlinks the element at `pos`.
+     *
+     * @param pos an iterator to an element of this list.
+     * @return an iterator to the element after `pos`.
+     */
+    iterator
+    erase (const_iterator pos) noexcept
+    {
+      list_hook& hook = mutable_hook (pos);
+      iterator next (*hook.m_next);
+      hook.unlink ();
+      --m_size;
+      return next;
+    }
+
+    /**
+     * Unlinks `value`, which must be in this list.
+     *
+     * @param value an element of this list.
+     */
+    void
+    erase (reference value) noexcept
+    {
+      erase (iterator_to (value));
+    }
+
+    /**
+     * Unlinks the first element. The list must not be empty.
+     */
+    void
+    pop_front (void) noexcept
+    {
+      assert (! empty ());
+      erase (begin ());
+    }
+
+    /**
+     * Unlinks the last element. The list must not be empty.
+     */
+    void
+    pop_back (void) noexcept
+    {
+      assert (! empty ());
+      erase (iterator (*m_head.m_prev));
+    }
+
+    /**
+     * Unlinks every element, in linear time.
+     */
+    void
+    clear (void) noexcept
+    {
+      while (m_head.m_next.get () != &m_head)
+        m_head.m_next->unlink ();
+      m_size = 0;
+    }
+
+    /**
+     * Moves every element of `other` before `pos`.
+     *
+     * @param pos a position in this list.
+     * @param other another list.
+     */
+    void
+    splice (const_iterator pos, intrusive_list& other) noexcept
+    {
+      if (other.empty ())
+        return;
+      mutable_hook (pos).transfer (*other.m_head.m_next, other.m_head);
+      m_size += other.m_size;
+      other.m_size = 0;
+    }
+
+    /**
+     * Moves the element at `it` in `other` (which may be this list) before `pos`.
+     *
+     * @param pos a position in this list.
+     * @param other the list containing `it`.
+     * @param it an iterator to an element of `other`.
+     */
+    void
+    splice (const_iterator pos, intrusive_list& other, const_iterator it) noexcept
+    {
+      list_hook& hook = mutable_hook (it);
+      hook.detach ();
+      hook.link_before (mutable_hook (pos));
+      --other.m_size;
+      ++m_size;
+    }
+
+    /**
+     * Moves `value`, an element of this list, to the front. This is the usual operation
+     * on a hit in an LRU cache.
+     *
+     * @param value an element of this list.
+     */
+    void
+    move_to_front (reference value) noexcept
+    {
+      list_hook& hook = value.*Hook;
+      hook.detach ();
+      hook.link_after (m_head);
+    }
+
+    /**
+     * Swaps the elements of this list with those of `other`.
+     *
+     * @param other another list.
+     */
+    void
+    swap (intrusive_list& other) noexcept
+    {
+      intrusive_list tmp (std::move (other));
+      other.splice (other.end (), *this);
+      splice (end (), tmp);
+    }
+
+  private:
+    static
+    list_hook&
+    mutable_hook (const_iterator pos) noexcept
+    {
+      return const_cast<list_hook&> (*pos.m_hook);
+    }
+
+    list_hook m_head;
+    size_type m_size = 0;
+  };
+
+  /**
+   * A swap function.
+   *
+   * @tparam T the element type.
+   * @tparam Hook a pointer to the hook member.
+   * @param lhs a list.
+   * @param rhs a list.
+   */
+  template <typename T, list_hook T::*Hook>
+  inline
+  void
+  swap (intrusive_list<T, Hook>& lhs, intrusive_list<T, Hook>& rhs) noexcept
+  {
+    lhs.swap (rhs);
+  }
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_INTRUSIVE_LIST_HPP
@@ -0,0 +1,250 @@
+/** intrusive_mpsc_queue.hpp
+ * Defines an intrusive multi-producer, single-consumer queue whose head
+ * and tail are never null.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_INTRUSIVE_MPSC_QUEUE_HPP
+#define GCH_INTRUSIVE_MPSC_QUEUE_HPP
+
+#include "nonnull_ptr.hpp"
+#include "nonnull_ptr_member.hpp"
+
+#include <atomic>
+#include <cstddef>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  class mpsc_queue_hook;
+
+  template <typename T, mpsc_queue_hook T::*Hook>
+  class intrusive_mpsc_queue;
+
+  /**
+   * The link of an element of an `intrusive_mpsc_queue`.
+   *
+   * Unlike the head and tail of the queue, this link is nullable: a null link is how the
+   * consumer learns that it has reached the newest element, or that a producer has
+   * claimed a place in the queue but not yet published the link to it.
+   */
+  class mpsc_queue_hook
+  {
+    template <typename T, mpsc_queue_hook T::*Hook>
+    friend class intrusive_mpsc_queue;
+
+  public:
+    /**
+     * Constructor
+     *
+     * Creates an unlinked hook.
+     */
+    mpsc_queue_hook (void) noexcept
+      : m_next (nullptr)
+    { }
+
+    /**
+     * Constructor
+     *
+     * Creates an unlinked hook. The link of `other` is not copied.
+     */
+    mpsc_queue_hook (const mpsc_queue_hook&) noexcept
+      : mpsc_queue_hook ()
+    { }
+
+    /**
+     * Assignment operator
+     *
+     * Does nothing. The link of `other` is not copied.
+     *
+     * @return `*this`
+     */
+    mpsc_queue_hook&
+    operator= (const mpsc_queue_hook&) noexcept
+    {
+      return *this;
+    }
+
+  private:
+    std::atomic<mpsc_queue_hook *> m_next;
+  };
+
+  /**
+   * An intrusive multi-producer, single-consumer FIFO queue without locks, after Dmitry
+   * Vyukov's design.
+   *
+   * Elements hold an `mpsc_queue_hook` member named by `Hook`, so the queue never
+   * allocates. A stub hook owned by the queue keeps at least one hook linked at all
+   * times, so the head (written by producers) and the tail (owned by the consumer) are
+   * `nonnull_ptr` and `push` needs no empty-queue case. The links between elements remain
+   * nullable, since they are how producers publish to the consumer.
+   *
+   * `push` is wait-free. `try_pop` is wait-free as well, but because a producer publishes
+   * its element in two steps, a producer preempted between them hides the elements
+   * pushed after it until it resumes. The queue is therefore not strictly lock-free for
+   * the consumer.
+   *
+   * @tparam T the element type.
+   * @tparam Hook a pointer to the `mpsc_queue_hook` data member of `T`.
+   */
+  template <typename T, mpsc_queue_hook T::*Hook>
+  class intrusive_mpsc_queue
+  {
+  public:
+    using value_type = T;   /*!< The element type   */
+    using pointer    = T *; /*!< The pointer type   */
+    using reference  = T&;  /*!< The reference type */
+
+    /**
+     * Constructor
+     *
+     * Creates an empty queue.
+     */
+    intrusive_mpsc_queue (void) noexcept
+      : m_head (nonnull_ptr<mpsc_queue_hook> (m_stub)),
+        m_tail (m_stub)
+    { }
+
+    /**
+     * Queues are neither copyable nor movable, since the links may point to the stub
+     * element inside the queue.
+     */
+    intrusive_mpsc_queue (const intrusive_mpsc_queue&) = delete;
+
+    /**
+     * Queues are neither copyable nor movable, since the links may point to the stub
+     * element inside the queue.
+     */
+    intrusive_mpsc_queue&
+    operator= (const intrusive_mpsc_queue&) = delete;
+
+    /**
+     * Destructor
+     *
+     * Elements still in the queue are abandoned; they are not owned by the queue.
+     */
+    ~intrusive_mpsc_queue (void) = default;
+
+    /**
+     * Appends `value`. This is wait-free: one atomic exchange and one store. It may be
+     * called from any number of threads at once. `value` must not be in a queue.
+     *
+     * @param value an element.
+     */
+    void
+    push (reference value) noexcept
+    {
+      push_hook (value.*Hook);
+    }
+
+    /**
+     * Removes the oldest element. Only one thread may call this at a time.
+     *
+     * This returns null both when the queue is empty and when the oldest element has been
+     * claimed by a producer which has not yet published its link. In the second case the
+     * element becomes visible as soon as that producer finishes its `push`, which takes
+     * constant time, so the consumer should retry later rather than spin.
+     *
+     * @return a pointer to the oldest element, or null.
+     */
+    GCH_NODISCARD
+    pointer
+    try_pop (void) noexcept
+    {
+      mpsc_queue_hook *tail = m_tail.get ();
+      mpsc_queue_hook *next = tail->m_next.load (std::memory_order_acquire);
+
+      // Skip over the stub, which is in the queue whenever it might otherwise empty.
+      if (tail == &m_stub)
+      {
+        if (next == nullptr)
+          return nullptr;
+        m_tail = nonnull_ptr<mpsc_queue_hook> (*next);
+        tail = next;
+        next = next->m_next.load (std::memory_order_acquire);
+      }
+
+      if (next != nullptr)
+      {
+        m_tail = nonnull_ptr<mpsc_queue_hook> (*next);
+        return element (*tail);
+      }
+
+      // `tail` is the newest element unless a producer is between its two steps.
+      if (tail != m_head.load (std::memory_order_acquire).get ())
+        return nullptr;
+
+      // Put the stub behind `tail` so `tail` can be removed without emptying the links.
+      push_hook (m_stub);
+      next = tail->m_next.load (std::memory_order_acquire);
+      if (next != nullptr)
+      {
+        m_tail = nonnull_ptr<mpsc_queue_hook> (*next);
+        return element (*tail);
+      }
+      return nullptr;
+    }
+
+    /**
+     * Returns whether the queue appeared empty at some point during the call. Only the
+     * consumer may call this.
+     *
+     * @return whether the queue was empty.
+     */
+    GCH_NODISCARD
+    bool
+    empty (void) const noexcept
+    {
+      const mpsc_queue_hook *tail = m_tail.get ();
+      return tail == &m_stub && tail->m_next.load (std::memory_order_acquire) == nullptr;
+    }
+
+  private:
+    void
+    push_hook (mpsc_queue_hook& hook) noexcept
+    {
+      hook.m_next.store (nullptr, std::memory_order_relaxed);
+      nonnull_ptr<mpsc_queue_hook> prev =
+        m_head.exchange (nonnull_ptr<mpsc_queue_hook> (hook), std::memory_order_acq_rel);
+      prev->m_next.store (&hook, std::memory_order_release);
+    }
+
+    static
+    pointer
+    element (mpsc_queue_hook& hook) noexcept
+    {
+      return container_of (nonnull_ptr<mpsc_queue_hook> (hook), Hook).get ();
+    }
+
+    /**
+     * A hook which is not part of any element, so that the links never run out.
+     */
+    mpsc_queue_hook m_stub;
+
+    /**
+     * The newest hook, written by producers. It is the stub when nothing has been pushed.
+     */
+    alignas (64) std::atomic<nonnull_ptr<mpsc_queue_hook>> m_head;
+
+    /**
+     * The oldest hook, owned by the consumer.
+     */
+    alignas (64) nonnull_ptr<mpsc_queue_hook> m_tail;
+  };
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_INTRUSIVE_MPSC_QUEUE_HPP
@@ -0,0 +1,1207 @@
+/** intrusive_rbtree.hpp
+ * Defines an intrusive red-black tree whose child links are never null and
+ * whose colour is packed into the parent link.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_INTRUSIVE_RBTREE_HPP
+#define GCH_INTRUSIVE_RBTREE_HPP
+
+#include "nonnull_ptr.hpp"
+#include "nonnull_ptr_member.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  class rbtree_hook;
+
+  template <typename T, rbtree_hook T::*Hook, typename Compare>
+  class intrusive_rbtree;
+
+  // This is not defined here. Tests define it to check the invariants of a tree.
+  struct intrusive_rbtree_access;
+
+  /**
+   * The links of an element of an `intrusive_rbtree`.
+   *
+   * The children of a leaf are the nil sentinel of its tree rather than null, and the
+   * parent of the root is that sentinel, so no link is ever null. The colour is stored in
+   * the low bit of the parent link, which is always zero because of alignment, so a hook
+   * is the size of three pointers. An unlinked hook points to itself.
+   *
+   * Copying an element does not copy its links; the copy starts out unlinked.
+   */
+  class rbtree_hook
+  {
+    template <typename T, rbtree_hook T::*Hook, typename Compare>
+    friend class intrusive_rbtree;
+
+  public:
+    /**
+     * Constructor
+     *
+     * Creates an unlinked hook.
+     */
+    rbtree_hook (void) noexcept
+      : m_left (*this),
+        m_right (*this),
+        m_parent (reinterpret_cast<std::uintptr_t> (this))
+    { }
+
+    /**
+     * Constructor
+     *
+     * Creates an unlinked hook. The links of `other` are not copied.
+     */
+    rbtree_hook (const rbtree_hook&) noexcept
+      : rbtree_hook ()
+    { }
+
+    /**
+     * Assignment operator
+     *
+     * Does nothing. The links of `other` are not copied.
+     *
+     * @return `*this`
+     */
+    rbtree_hook&
+    operator= (const rbtree_hook&) noexcept
+    {
+      return *this;
+    }
+
+    /**
+     * Destructor
+     *
+     * The hook must not be linked.
+     */
+    ~rbtree_hook (void)
+    {
+      assert (! is_linked () && "An element was destroyed while it was still in a tree.");
+    }
+
+    /**
+     * Returns whether the hook is in a tree.
+     *
+     * @return whether the hook is linked.
+     */
+    GCH_NODISCARD
+    bool
+    is_linked (void) const noexcept
+    {
+      return &parent () != this;
+    }
+
+  private:
+    static constexpr std::uintptr_t red_bit = 1;
+
+    rbtree_hook&
+    parent (void) const noexcept
+    {
+      return *reinterpret_cast<rbtree_hook *> (m_parent & ~red_bit);
+    }
+
+    void
+    set_parent (rbtree_hook& p) noexcept
+    {
+      m_parent = reinterpret_cast<std::uintptr_t> (&p) | (m_parent & red_bit);
+    }
+
+    bool
+    is_red (void) const noexcept
+    {
+      return (m_parent & red_bit) != 0;
+    }
+
+    bool
+    is_black (void) const noexcept
+    {
+      return ! is_red ();
+    }
+
+    void
+    set_red (void) noexcept
+    {
+      m_parent |= red_bit;
+    }
+
+    void
+    set_black (void) noexcept
+    {
+      m_parent &= ~red_bit;
+    }
+
+    void
+    copy_color (const rbtree_hook& other) noexcept
+    {
+      m_parent = (m_parent & ~red_bit) | (other.m_parent & red_bit);
+    }
+
+    void
+    reset (void) noexcept
+    {
+      m_left   = nonnull_ptr<rbtree_hook> (*this);
+      m_right  = nonnull_ptr<rbtree_hook> (*this);
+      m_parent = reinterpret_cast<std::uintptr_t> (this);
+    }
+
+    nonnull_ptr<rbtree_hook> m_left;
+    nonnull_ptr<rbtree_hook> m_right;
+
+    /**
+     * The parent, tagged with the colour in its low bit.
+     */
+    std::uintptr_t m_parent;
+  };
+
+  /**
+   * An intrusive red-black tree of unique elements, ordered by `Compare`.
+   *
+   * Elements hold an `rbtree_hook` member named by `Hook`, so the tree never allocates,
+   * and each element carries three words of links instead of the four of a `std::set`
+   * node. Every leaf points to a nil sentinel owned by the tree, which also holds the
+   * root, so the rebalancing code has no null checks and no special case for the root.
+   *
+   * `erase` takes an element and needs no search. Rebalancing after it performs at most
+   * three rotations, though recolouring may walk up to the root. `size` takes constant
+   * time, and `begin` and `clear` are linear in the height and the size respectively.
+   *
+   * Since the leaves point into the tree object, the tree can be neither copied nor
+   * moved. It unlinks, but does not destroy, its elements when it is destroyed.
+   *
+   * @tparam T the element type.
+   * @tparam Hook a pointer to the `rbtree_hook` data member of `T`.
+   * @tparam Compare a strict weak ordering of `T`. Lookup functions also accept keys `K`
+   *                 for which `Compare` can compare `T` with `K` and `K` with `T`.
+   */
+  template <typename T, rbtree_hook T::*Hook, typename Compare = std::less<T>>
+  class intrusive_rbtree
+  {
+  public:
+    using value_type      = T;              /*!< The element type           */
+    using value_compare   = Compare;        /*!< The ordering of elements   */
+    using size_type       = std::size_t;    /*!< The size type              */
+    using difference_type = std::ptrdiff_t; /*!< The difference type        */
+    using reference       = T&;             /*!< The reference type         */
+    using const_reference = const T&;       /*!< The const reference type   */
+    using pointer         = T *;            /*!< The pointer type           */
+    using const_pointer   = const T *;      /*!< The const pointer type     */
+
+  private:
+    template <bool IsConst>
+    class basic_iterator
+    {
+      using hook_type = typename std::conditional<IsConst, const rbtree_hook, rbtree_hook>::type;
+
+    public:
+      using difference_type   = std::ptrdiff_t;
+      using value_type        = T;
+      using pointer           = typename std::conditional<IsConst, const T *, T *>::type;
+      using reference         = typename std::conditional<IsConst, const T&, T&>::type;
+      using iterator_category = std::bidirectional_iterator_tag;
+
+      /**
+       * Constructor
+       *
+       * A default constructor, which creates a singular iterator. This only exists
+       * because iterators are required to be default constructible.
+       */
+      basic_iterator (void) noexcept
+        : m_node (nullptr),
+          m_nil (nullptr)
+      { }
+
+      /**
+       * Constructor
+       *
+       * Creates an iterator to the element holding `node`, or to the end of the tree if
+       * `node` is `nil`.
+       *
+       * @param node a hook in the tree.
+       * @param nil the nil sentinel of the tree.
+       */
+      basic_iterator (hook_type& node, hook_type& nil) noexcept
+        : m_node (&node),
+          m_nil (&nil)
+      { }
+
+      /**
+       * Constructor
+       *
+       * A conversion from an iterator to a const iterator.
+       */
+      template <bool OtherConst,
+                typename std::enable_if<IsConst && ! OtherConst>::type * = nullptr>
+      GCH_IMPLICIT_CONVERSION
+      basic_iterator (const basic_iterator<OtherConst>& other) noexcept
+        : m_node (other.m_node),
+          m_nil (other.m_nil)
+      { }
+
+      /**
+       * Returns the element, recovered from its hook with `container_of`.
+       *
+       * @return a reference to the element.
+       */
+      GCH_NODISCARD
+      reference
+      operator* (void) const noexcept
+      {
+        return *container_of (nonnull_ptr<hook_type> (*m_node), Hook);
+      }
+
+      /**
+       * Returns a pointer to the element.
+       *
+       * @return a pointer to the element.
+       */
+      GCH_NODISCARD
+      pointer
+      operator-> (void) const noexcept
+      {
+        return container_of (nonnull_ptr<hook_type> (*m_node), Hook).get ();
+      }
+
+      /**
+       * Advances to the next element in order.
+       *
+       * @return `*this`
+       */
+      basic_iterator&
+      operator++ (void) noexcept
+      {
+        m_node = &successor (*m_node, *m_nil);
+        return *this;
+      }
+
+      /**
+       * Advances to the next element in order.
+       *
+       * @return a copy of the iterator from before the increment.
+       */
+      basic_iterator
+      operator++ (int) noexcept
+      {
+        basic_iterator tmp = *this;
+        ++*this;
+        return tmp;
+      }
+
+      /**
+       * Moves to the previous element in order.
+       *
+       * @return `*this`
+       */
+      basic_iterator&
+      operator-- (void) noexcept
+      {
+        m_node = &predecessor (*m_node, *m_nil);
+        return *this;
+      }
+
+      /**
+       * Moves to the previous element in order.
+       *
+       * @return a copy of the iterator from before the decrement.
+       */
+      basic_iterator
+      operator-- (int) noexcept
+      {
+        basic_iterator tmp = *this;
+        --*this;
+        return tmp;
+      }
+
+      /**
+       * An equality comparison function.
+       *
+       * @param lhs an iterator.
+       * @param rhs an iterator.
+       * @return whether the iterators refer to the same position.
+       */
+      GCH_NODISCARD friend
+      bool
+      operator== (const basic_iterator& lhs, const basic_iterator& rhs) noexcept
+      {
+        return lhs.m_node == rhs.m_node;
+      }
+
+      /**
+       * An inequality comparison function.
+       *
+       * @param lhs an iterator.
+       * @param rhs an iterator.
+       * @return whether the iterators refer to different positions.
+       */
+      GCH_NODISCARD friend
+      bool
+      operator!= (const basic_iterator& lhs, const basic_iterator& rhs) noexcept
+      {
+        return lhs.m_node != rhs.m_node;
+      }
+
+    private:
+      friend class intrusive_rbtree;
+      friend class basic_iterator<! IsConst>;
+
+      hook_type *m_node;
+      hook_type *m_nil;
+    };
+
+    friend struct intrusive_rbtree_access;
+
+  public:
+    using iterator               = basic_iterator<false>;  /*!< A bidirectional iterator */
+    using const_iterator         = basic_iterator<true>;   /*!< A constant iterator      */
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    /**
+     * Constructor
+     *
+     * Creates an empty tree.
+     *
+     * @param comp the ordering of elements.
+     */
+    explicit
+    intrusive_rbtree (const Compare& comp = Compare ())
+      : m_comp (comp)
+    {
+      m_nil.m_left = nonnull_ptr<rbtree_hook> (m_nil);
+    }
+
+    /**
+     * Trees are neither copyable nor movable, since the leaves point into the tree.
+     */
+    intrusive_rbtree (const intrusive_rbtree&) = delete;
+
+    /**
+     * Trees are neither copyable nor movable, since the leaves point into the tree.
+     */
+    intrusive_rbtree&
+    operator= (const intrusive_rbtree&) = delete;
+
+    /**
+     * Destructor
+     *
+     * Unlinks every element. The elements are not destroyed.
+     */
+    ~intrusive_rbtree (void)
+    {
+      clear ();
+    }
+
+    /**
+     * Returns an iterator to the least element, in time linear in the height.
+     *
+     * @return an iterator to the least element.
+     */
+    GCH_NODISCARD
+    iterator
+    begin (void) noexcept
+    {
+      return make_iterator (minimum (root (), m_nil));
+    }
+
+    /**
+     * Returns an iterator to the least element, in time linear in the height.
+     *
+     * @return an iterator to the least element.
+     */
+    GCH_NODISCARD
+    const_iterator
+    begin (void) const noexcept
+    {
+      return make_iterator (minimum (root (), m_nil));
+    }
+
+    /**
+     * Returns an iterator to the least element, in time linear in the height.
+     *
+     * @return an iterator to the least element.
+     */
+    GCH_NODISCARD
+    const_iterator
+    cbegin (void) const noexcept
+    {
+      return begin ();
+    }
+
+    /**
+     * Returns an iterator past the greatest element.
+     *
+     * @return an iterator past the greatest element.
+     */
+    GCH_NODISCARD
+    iterator
+    end (void) noexcept
+    {
+      return make_iterator (m_nil);
+    }
+
+    /**
+     * Returns an iterator past the greatest element.
+     *
+     * @return an iterator past the greatest element.
+     */
+    GCH_NODISCARD
+    const_iterator
+    end (void) const noexcept
+    {
+      return make_iterator (m_nil);
+    }
+
+    /**
+     * Returns an iterator past the greatest element.
+     *
+     * @return an iterator past the greatest element.
+     */
+    GCH_NODISCARD
+    const_iterator
+    cend (void) const noexcept
+    {
+      return end ();
+    }
+
+    /**
+     * Returns a reverse iterator to the greatest element.
+     *
+     * @return a reverse iterator to the greatest element.
+     */
+    GCH_NODISCARD
+    reverse_iterator
+    rbegin (void) noexcept
+    {
+      return reverse_iterator (end ());
+    }
+
+    /**
+     * Returns a reverse iterator to the greatest element.
+     *
+     * @return a reverse iterator to the greatest element.
+     */
+    GCH_NODISCARD
+    const_reverse_iterator
+    rbegin (void) const noexcept
+    {
+      return const_reverse_iterator (end ());
+    }
+
+    /**
+     * Returns a reverse iterator before the least element.
+     *
+     * @return a reverse iterator before the least element.
+     */
+    GCH_NODISCARD
+    reverse_iterator
+    rend (void) noexcept
+    {
+      return reverse_iterator (begin ());
+    }
+
+    /**
+     * Returns a reverse iterator before the least element.
+     *
+     * @return a reverse iterator before the least element.
+     */
+    GCH_NODISCARD
+    const_reverse_iterator
+    rend (void) const noexcept
+    {
+      return const_reverse_iterator (begin ());
+    }
+
+    /**
+     * Returns whether the tree is empty.
+     *
+     * @return whether the tree is empty.
+     */
+    GCH_NODISCARD
+    bool
+    empty (void) const noexcept
+    {
+      return m_size == 0;
+    }
+
+    /**
+     * Returns the number of elements, in constant time.
+     *
+     * @return the number of elements.
+     */
+    GCH_NODISCARD
+    size_type
+    size (void) const noexcept
+    {
+      return m_size;
+    }
+
+    /**
+     * Returns the ordering of elements.
+     *
+     * @return the ordering of elements.
+     */
+    GCH_NODISCARD
+    value_compare
+    value_comp (void) const
+    {
+      return m_comp;
+    }
+
+    /**
+     * Returns an iterator to `value`, which must be in this tree.
+     *
+     * @param value an element of this tree.
+     * @return an iterator to `value`.
+     */
+    GCH_NODISCARD
+    iterator
+    iterator_to (reference value) noexcept
+    {
+      return make_iterator (value.*Hook);
+    }
+
+    /**
+     * Returns an iterator to `value`, which must be in this tree.
+     *
+     * @param value an element of this tree.
+     * @return an iterator to `value`.
+     */
+    GCH_NODISCARD
+    const_iterator
+    iterator_to (const_reference value) const noexcept
+    {
+      return make_iterator (value.*Hook);
+    }
+
+    /**
+     * Links `value` into the tree unless an equivalent element is already present.
+     * `value` must not be in a tree.
+     *
+     * @param value an element.
+     * @return an iterator to `value` or to the equivalent element, and whether `value`
+     *         was inserted.
+     */
+    std::pair<iterator, bool>
+    insert (reference value)
+    {
+      rbtree_hook& z = value.*Hook;
+      assert (! z.is_linked () && "The element is already in a tree.");
+
+      // Descend with one comparison per level, remembering the last element which is not
+      // greater than `value`. Only that element can be equivalent to `value`.
+      rbtree_hook *parent = &m_nil;
+      rbtree_hook *candidate = &m_nil;
+      nonnull_ptr<rbtree_hook> *link = &m_nil.m_left;
+      while (link->get () != &m_nil)
+      {
+        parent = link->get ();
+        if (m_comp (value, value_of (*parent)))
+          link = &parent->m_left;
+        else
+        {
+          candidate = parent;
+          link = &parent->m_right;
+        }
+      }
+
+      if (candidate != &m_nil && ! m_comp (value_of (*candidate), value))
+        return { make_iterator (*candidate), false };
+
+      z.m_left   = nonnull_ptr<rbtree_hook> (m_nil);
+      z.m_right  = nonnull_ptr<rbtree_hook> (m_nil);
+      z.m_parent = reinterpret_cast<std::uintptr_t> (parent) | rbtree_hook::red_bit;
+      *link = nonnull_ptr<rbtree_hook> (z);
+      ++m_size;
+
+      insert_fixup (z);
+      return { make_iterator (z), true };
+    }
+
+    /**
+     * Unlinks the element at `pos`. No search is needed.
+     *
+     * @param pos an iterator to an element of this tree.
+     * @return an iterator to the element after `pos`.
+     */
+    iterator
+    erase (const_iterator pos) noexcept
+    {
+      rbtree_hook& z = mutable_hook (pos);
+      iterator next = make_iterator (successor (z, m_nil));
+      unlink (z);
+      return next;
+    }
+
+    /**
+     * Unlinks `value`, which must be in this tree. No search is needed.
+     *
+     * @param value an element of this tree.
+     */
+    void
+    erase (reference value) noexcept
+    {
+      unlink (value.*Hook);
+    }
+
+    /**
+     * Unlinks every element, in linear time.
+     */
+    void
+    clear (void) noexcept
+    {
+      // Unlink leaves bottom-up so that each hook is visited a constant number of times.
+      rbtree_hook *node = &root ();
+      while (node != &m_nil)
+      {
+        if (node->m_left.get () != &m_nil)
+          node = node->m_left.get ();
+        else if (node->m_right.get () != &m_nil)
+          node = node->m_right.get ();
+        else
+        {
+          rbtree_hook& parent = node->parent ();
+          if (parent.m_left.get () == node)
+            parent.m_left = nonnull_ptr<rbtree_hook> (m_nil);
+          else
+            parent.m_right = nonnull_ptr<rbtree_hook> (m_nil);
+          node->reset ();
+          node = &parent;
+        }
+      }
+
+      // The rebalancing code may have left a stale parent in the sentinel.
+      m_nil.m_parent = reinterpret_cast<std::uintptr_t> (&m_nil);
+      m_size = 0;
+    }
+
+    /**
+     * Finds the element equivalent to `key`.
+     *
+     * @tparam K the key type.
+     * @param key a key.
+     * @return an iterator to the element, or `end ()` if there is none.
+     */
+    template <typename K>
+    GCH_NODISCARD
+    iterator
+    find (const K& key)
+    {
+      rbtree_hook& lb = lower_bound_hook (key);
+      return make_iterator (&lb == &m_nil || m_comp (key, value_of (lb)) ? m_nil : lb);
+    }
+
+    /**
+     * Finds the element equivalent to `key`.
+     *
+     * @tparam K the key type.
+     * @param key a key.
+     * @return an iterator to the element, or `end ()` if there is none.
+     */
+    template <typename K>
+    GCH_NODISCARD
+    const_iterator
+    find (const K& key) const
+    {
+      return const_cast<intrusive_rbtree&> (*this).find (key);
+    }
+
+    /**
+     * Returns whether there is an element equivalent to `key`.
+     *
+     * @tparam K the key type.
+     * @param key a key.
+     * @return whether there is an element equivalent to `key`.
+     */
+    template <typename K>
+    GCH_NODISCARD
+    bool
+    contains (const K& key) const
+    {
+      return find (key) != end ();
+    }
+
+    /**
+     * Finds the first element which is not less than `key`.
+     *
+     * @tparam K the key type.
+     * @param key a key.
+     * @return an iterator to the element, or `end ()` if there is none.
+     */
+    template <typename K>
+    GCH_NODISCARD
+    iterator
+    lower_bound (const K& key)
+    {
+      return make_iterator (lower_bound_hook (key));
+    }
+
+    /**
+     * Finds the first element which is not less than `key`.
+     *
+     * @tparam K the key type.
+     * @param key a key.
+     * @return an iterator to the element, or `end ()` if there is none.
+     */
+    template <typename K>
+    GCH_NODISCARD
+    const_iterator
+    lower_bound (const K& key) const
+    {
+      return const_cast<intrusive_rbtree&> (*this).lower_bound (key);
+    }
+
+    /**
+     * Finds the first element which is greater than `key`.
+     *
+     * @tparam K the key type.
+     * @param key a key.
+     * @return an iterator to the element, or `end ()` if there is none.
+     */
+    template <typename K>
+    GCH_NODISCARD
+    iterator
+    upper_bound (const K& key)
+    {
+      rbtree_hook *result = &m_nil;
+      rbtree_hook *node = &root ();
+      while (node != &m_nil)
+      {
+        if (m_comp (key, value_of (*node)))
+        {
+          result = node;
+          node = node->m_left.get ();
+        }
+        else
+          node = node->m_right.get ();
+      }
+      return make_iterator (*result);
+    }
+
+    /**
+     * Finds the first element which is greater than `key`.
+     *
+     * @tparam K the key type.
+     * @param key a key.
+     * @return an iterator to the element, or `end ()` if there is none.
+     */
+    template <typename K>
+    GCH_NODISCARD
+    const_iterator
+    upper_bound (const K& key) const
+    {
+      return const_cast<intrusive_rbtree&> (*this).upper_bound (key);
+    }
+
+  private:
+    // Checks that the sentinel and the root are black, that no red node has a red child,
+    // that every path to a leaf has the same number of black nodes, and that the parent
+    // links, the order and the size agree with the child links. This takes linear time.
+    bool
+    verify (void) const
+    {
+      const rbtree_hook& root = *m_nil.m_left;
+      if (m_nil.is_red ())
+        return false;
+      if (&root == &m_nil)
+        return m_size == 0;
+      if (root.is_red () || &root.parent () != &m_nil)
+        return false;
+
+      size_type count = 0;
+      return black_height (root, count) != 0 && count == m_size;
+    }
+
+    // Returns the number of black nodes on each path from `node` to a leaf, including the
+    // sentinel, or 0 if an invariant does not hold below `node`.
+    std::size_t
+    black_height (const rbtree_hook& node, size_type& count) const
+    {
+      if (&node == &m_nil)
+        return 1;
+      ++count;
+
+      const rbtree_hook& l = *node.m_left;
+      const rbtree_hook& r = *node.m_right;
+      if (&l != &m_nil && (&l.parent () != &node || ! m_comp (value_of (l), value_of (node))))
+        return 0;
+      if (&r != &m_nil && (&r.parent () != &node || ! m_comp (value_of (node), value_of (r))))
+        return 0;
+
+      // The sentinel is black, so this also covers the leaves.
+      if (node.is_red () && (l.is_red () || r.is_red ()))
+        return 0;
+
+      const std::size_t height = black_height (l, count);
+      if (height == 0 || height != black_height (r, count))
+        return 0;
+      return height + (node.is_black () ? 1 : 0);
+    }
+
+    template <typename Node>
+    static
+    Node&
+    minimum (Node& node, const rbtree_hook& nil) noexcept
+    {
+      Node *x = &node;
+      while (x->m_left.get () != &nil)
+        x = x->m_left.get ();
+      return *x;
+    }
+
+    template <typename Node>
+    static
+    Node&
+    maximum (Node& node, const rbtree_hook& nil) noexcept
+    {
+      Node *x = &node;
+      while (x->m_right.get () != &nil)
+        x = x->m_right.get ();
+      return *x;
+    }
+
+    template <typename Node>
+    static
+    Node&
+    successor (Node& node, const rbtree_hook& nil) noexcept
+    {
+      if (node.m_right.get () != &nil)
+        return minimum (*node.m_right, nil);
+
+      Node *x = &node;
+      Node *p = &x->parent ();
+      while (p != &nil && x == p->m_right.get ())
+      {
+        x = p;
+        p = &p->parent ();
+      }
+      return *p;
+    }
+
+    // The predecessor of the sentinel is the greatest element, since its left link holds
+    // the root.
+    template <typename Node>
+    static
+    Node&
+    predecessor (Node& node, const rbtree_hook& nil) noexcept
+    {
+      if (node.m_left.get () != &nil)
+        return maximum (*node.m_left, nil);
+
+      Node *x = &node;
+      Node *p = &x->parent ();
+      while (p != &nil && x == p->m_left.get ())
+      {
+        x = p;
+        p = &p->parent ();
+      }
+      return *p;
+    }
+
+    static
+    reference
+    value_of (rbtree_hook& hook) noexcept
+    {
+      return *container_of (nonnull_ptr<rbtree_hook> (hook), Hook);
+    }
+
+    static
+    const_reference
+    value_of (const rbtree_hook& hook) noexcept
+    {
+      return *container_of (nonnull_ptr<const rbtree_hook> (hook), Hook);
+    }
+
+    static
+    rbtree_hook&
+    mutable_hook (const_iterator pos) noexcept
+    {
+      return const_cast<rbtree_hook&> (*pos.m_node);
+    }
+
+    iterator
+    make_iterator (rbtree_hook& node) noexcept
+    {
+      return iterator (node, m_nil);
+    }
+
+    const_iterator
+    make_iterator (const rbtree_hook& node) const noexcept
+    {
+      return const_iterator (node, m_nil);
+    }
+
+    rbtree_hook&
+    root (void) noexcept
+    {
+      return *m_nil.m_left;
+    }
+
+    const rbtree_hook&
+    root (void) const noexcept
+    {
+      return *m_nil.m_left;
+    }
+
+    template <typename K>
+    rbtree_hook&
+    lower_bound_hook (const K& key)
+    {
+      rbtree_hook *result = &m_nil;
+      rbtree_hook *node = &root ();
+      while (node != &m_nil)
+      {
+        if (! m_comp (value_of (*node), key))
+        {
+          result = node;
+          node = node->m_left.get ();
+        }
+        else
+          node = node->m_right.get ();
+      }
+      return *result;
+    }
+
+    // Replaces `old` with `x` in the link from its parent. If `old` is the root, its
+    // parent is the sentinel, whose left link is the root, so there is no special case.
+    static
+    void
+    replace_child (rbtree_hook& old, rbtree_hook& x) noexcept
+    {
+      rbtree_hook& p = old.parent ();
+      if (&old == p.m_left.get ())
+        p.m_left = nonnull_ptr<rbtree_hook> (x);
+      else
+        p.m_right = nonnull_ptr<rbtree_hook> (x);
+      x.set_parent (p);
+    }
+
+    // The parent of the sentinel is only read at the start of `erase_fixup`, so it is
+    // harmless for these to overwrite it when a child is the sentinel.
+    static
+    void
+    rotate_left (rbtree_hook& x) noexcept
+    {
+      rbtree_hook& y = *x.m_right;
+      x.m_right = y.m_left;
+      y.m_left->set_parent (x);
+      replace_child (x, y);
+      y.m_left = nonnull_ptr<rbtree_hook> (x);
+      x.set_parent (y);
+    }
+
+    static
+    void
+    rotate_right (rbtree_hook& x) noexcept
+    {
+      rbtree_hook& y = *x.m_left;
+      x.m_left = y.m_right;
+      y.m_right->set_parent (x);
+      replace_child (x, y);
+      y.m_right = nonnull_ptr<rbtree_hook> (x);
+      x.set_parent (y);
+    }
+
+    void
+    insert_fixup (rbtree_hook& node) noexcept
+    {
+      // The sentinel is black, so this stops at the root.
+      rbtree_hook *z = &node;
+      while (z->parent ().is_red ())
+      {
+        rbtree_hook *p = &z->parent ();
+        rbtree_hook& g = p->parent ();
+        if (p == g.m_left.get ())
+        {
+          rbtree_hook& u = *g.m_right;
+          if (u.is_red ())
+          {
+            p->set_black ();
+            u.set_black ();
+            g.set_red ();
+            z = &g;
+            continue;
+          }
+
+          if (z == p->m_right.get ())
+          {
+            rotate_left (*p);
+            p = z;
+          }
+          p->set_black ();
+          g.set_red ();
+          rotate_right (g);
+        }
+        else
+        {
+          rbtree_hook& u = *g.m_left;
+          if (u.is_red ())
+          {
+            p->set_black ();
+            u.set_black ();
+            g.set_red ();
+            z = &g;
+            continue;
+          }
+
+          if (z == p->m_left.get ())
+          {
+            rotate_right (*p);
+            p = z;
+          }
+          p->set_black ();
+          g.set_red ();
+          rotate_left (g);
+        }
+        break;
+      }
+      root ().set_black ();
+    }
+
+    void
+    unlink (rbtree_hook& z) noexcept
+    {
+      rbtree_hook *x;
+      bool removed_black = z.is_black ();
+
+      if (z.m_left.get () == &m_nil)
+      {
+        x = z.m_right.get ();
+        replace_child (z, *x);
+      }
+      else if (z.m_right.get () == &m_nil)
+      {
+        x = z.m_left.get ();
+        replace_child (z, *x);
+      }
+      else
+      {
+        // Replace `z` with its successor `y`, which has no left child.
+        rbtree_hook& y = minimum (*z.m_right, m_nil);
+        removed_black = y.is_black ();
+        x = y.m_right.get ();
+        if (&y.parent () == &z)
+          x->set_parent (y);
+        else
+        {
+          replace_child (y, *x);
+          y.m_right = z.m_right;
+          y.m_right->set_parent (y);
+        }
+        replace_child (z, y);
+        y.m_left = z.m_left;
+        y.m_left->set_parent (y);
+        y.copy_color (z);
+      }
+
+      if (removed_black)
+        erase_fixup (*x);
+
+      z.reset ();
+      --m_size;
+    }
+
+    void
+    erase_fixup (rbtree_hook& node) noexcept
+    {
+      // `x` may be the sentinel, whose parent was set by `replace_child` above.
+      rbtree_hook *x = &node;
+      while (x != &root () && x->is_black ())
+      {
+        rbtree_hook& p = x->parent ();
+        if (x == p.m_left.get ())
+        {
+          rbtree_hook *w = p.m_right.get ();
+          if (w->is_red ())
+          {
+            w->set_black ();
+            p.set_red ();
+            rotate_left (p);
+            w = p.m_right.get ();
+          }
+
+          if (w->m_left->is_black () && w->m_right->is_black ())
+          {
+            w->set_red ();
+            x = &p;
+            continue;
+          }
+
+          if (w->m_right->is_black ())
+          {
+            w->m_left->set_black ();
+            w->set_red ();
+            rotate_right (*w);
+            w = p.m_right.get ();
+          }
+          w->copy_color (p);
+          p.set_black ();
+          w->m_right->set_black ();
+          rotate_left (p);
+        }
+        else
+        {
+          rbtree_hook *w = p.m_left.get ();
+          if (w->is_red ())
+          {
+            w->set_black ();
+            p.set_red ();
+            rotate_right (p);
+            w = p.m_left.get ();
+          }
+
+          if (w->m_right->is_black () && w->m_left->is_black ())
+          {
+            w->set_red ();
+            x = &p;
+            continue;
+          }
+
+          if (w->m_left->is_black ())
+          {
+            w->m_right->set_black ();
+            w->set_red ();
+            rotate_left (*w);
+            w = p.m_left.get ();
+          }
+          w->copy_color (p);
+          p.set_black ();
+          w->m_left->set_black ();
+          rotate_right (p);
+        }
+        break;
+      }
+      x->set_black ();
+    }
+
+    /**
+     * The sentinel, whose left link is the root. Every leaf points to it.
+     */
+    rbtree_hook m_nil;
+    size_type   m_size = 0;
+    Compare     m_comp;
+  };
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_INTRUSIVE_RBTREE_HPP
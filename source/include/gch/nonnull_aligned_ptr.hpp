@@ -0,0 +1,412 @@
+/** nonnull_aligned_ptr.hpp
+ * Defines a non-nullable pointer which also carries an alignment guarantee.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_NONNULL_ALIGNED_PTR_HPP
+#define GCH_NONNULL_ALIGNED_PTR_HPP
+
+#include "nonnull_ptr.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    /**
+     * Informs the optimizer that `ptr` is aligned to `Align` bytes.
+     *
+     * @tparam Align a power of two.
+     * @tparam T a value type.
+     * @param ptr a pointer which is aligned to `Align` bytes.
+     * @return `ptr`.
+     */
+    template <std::size_t Align, typename T>
+    GCH_NODISCARD inline
+    T *
+    assume_aligned (T *ptr) noexcept
+    {
+#if defined (__cpp_lib_assume_aligned) && __cpp_lib_assume_aligned >= 201811L
+      return std::assume_aligned<Align> (ptr);
+#elif defined (__GNUC__) || defined (__clang__)
+      return static_cast<T *> (__builtin_assume_aligned (ptr, Align));
+#elif defined (_MSC_VER)
+      __assume ((reinterpret_cast<std::uintptr_t> (ptr) & (Align - 1)) == 0);
+      return ptr;
+#else
+      return ptr;
+#endif
+    }
+
+  } // namespace detail
+
+  /**
+   * A pointer wrapper which is not nullable and is aligned to `Align` bytes.
+   *
+   * `get` tells the optimizer about the alignment, so loops over the pointee need no
+   * alignment prologue or unaligned accesses. Alignment is checked on construction in
+   * debug builds.
+   *
+   * @tparam Value the value type of the stored pointer.
+   * @tparam Align the alignment in bytes, a power of two no less than `alignof (Value)`.
+   */
+  template <typename Value, std::size_t Align>
+  class nonnull_aligned_ptr
+  {
+  public:
+    static_assert (! std::is_reference<Value>::value,
+      "nonnull_aligned_ptr expects a value type as a template argument, not a reference.");
+
+    static_assert (Align != 0 && (Align & (Align - 1)) == 0,
+      "The alignment must be a power of two.");
+
+    static_assert (Align >= alignof (Value),
+      "The alignment must be at least the natural alignment of the value type.");
+
+    using value_type   = Value;   /*!< The value type            */
+    using element_type = Value;   /*!< The element type          */
+    using pointer      = Value *; /*!< The pointer type          */
+    using reference    = Value&;  /*!< The reference type        */
+
+    /**
+     * The guaranteed alignment in bytes.
+     */
+    static constexpr std::size_t alignment = Align;
+
+  private:
+    template <typename U>
+    using constructible_from_pointer_to =
+      std::is_constructible<pointer, decltype (&std::declval<U&> ())>;
+
+  public:
+    /**
+     * Constructor
+     *
+     * A deleted default constructor
+     */
+    nonnull_aligned_ptr (void) = delete;
+
+    /**
+     * Constructor
+     *
+     * A copy constructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    nonnull_aligned_ptr (const nonnull_aligned_ptr&) noexcept = default;
+
+    /**
+     * Constructor
+     *
+     * A move constructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    nonnull_aligned_ptr (nonnull_aligned_ptr&&) noexcept = default;
+
+    /**
+     * Assignment operator
+     *
+     * A copy-assignment operator.
+     *
+     * Note: TriviallyCopyable.
+     *
+     * @return `*this`
+     */
+    nonnull_aligned_ptr&
+    operator= (const nonnull_aligned_ptr&) noexcept = default;
+
+    /**
+     * Assignment operator
+     *
+     * A move-assignment operator.
+     *
+     * Note: TriviallyCopyable.
+     *
+     * @return `*this`
+     */
+    nonnull_aligned_ptr&
+    operator= (nonnull_aligned_ptr&&) noexcept = default;
+
+    /**
+     * Destructor
+     *
+     * A trivial destructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    ~nonnull_aligned_ptr (void) = default;
+
+    /**
+     * Constructor
+     *
+     * An explicit constructor for lvalues at an address aligned to `Align` bytes.
+     *
+     * @tparam U a referenced value type.
+     * @param ref an aligned lvalue.
+     */
+    template <typename U,
+              typename std::enable_if<constructible_from_pointer_to<U>::value>::type * = nullptr>
+    explicit
+    nonnull_aligned_ptr (U& ref) noexcept
+      : m_ptr (&ref)
+    {
+      assert (is_aligned (m_ptr) && "The referenced value is not sufficiently aligned.");
+    }
+
+    /**
+     * Constructor
+     *
+     * A deleted constructor for the case where `ref` is an rvalue reference.
+     */
+    template <typename U,
+              typename = typename std::enable_if<constructible_from_pointer_to<U>::value>::type>
+    nonnull_aligned_ptr (const U&&) = delete;
+
+    /**
+     * Constructor
+     *
+     * An explicit constructor from a `nonnull_ptr` to an aligned value.
+     *
+     * @tparam U a referenced value type.
+     * @param other a `nonnull_ptr` whose pointer is aligned to `Align` bytes.
+     */
+    template <typename U,
+              typename std::enable_if<std::is_convertible<U *, pointer>::value>::type * = nullptr>
+    explicit
+    nonnull_aligned_ptr (const nonnull_ptr<U>& other) noexcept
+      : nonnull_aligned_ptr (*other)
+    { }
+
+    /**
+     * Constructor
+     *
+     * A converting constructor from a pointer with an alignment at least as strict.
+     *
+     * @tparam U a referenced value type.
+     * @tparam A the alignment of `other`.
+     * @param other a `nonnull_aligned_ptr`.
+     */
+    template <typename U, std::size_t A,
+              typename std::enable_if<std::is_convertible<U *, pointer>::value
+                                  &&  (A >= Align)>::type * = nullptr>
+    constexpr GCH_IMPLICIT_CONVERSION
+    nonnull_aligned_ptr (const nonnull_aligned_ptr<U, A>& other) noexcept
+      : m_ptr (other.get ())
+    { }
+
+    /**
+     * Constructor
+     *
+     * An explicit constructor from a pointer with a weaker alignment. The pointer must
+     * still be aligned to `Align` bytes.
+     *
+     * @tparam U a referenced value type.
+     * @tparam A the alignment of `other`.
+     * @param other a `nonnull_aligned_ptr` whose pointer is aligned to `Align` bytes.
+     */
+    template <typename U, std::size_t A,
+              typename std::enable_if<std::is_convertible<U *, pointer>::value
+                                  &&  (A < Align)>::type * = nullptr>
+    explicit
+    nonnull_aligned_ptr (const nonnull_aligned_ptr<U, A>& other) noexcept
+      : nonnull_aligned_ptr (*other)
+    { }
+
+    /**
+     * An implicit conversion to `nonnull_ptr`.
+     *
+     * @tparam U a value type such that `U *` is implicitly convertible from `pointer`.
+     * @return a `nonnull_ptr` containing the stored pointer.
+     */
+    template <typename U,
+              typename std::enable_if<std::is_convertible<pointer, U *>::value>::type * = nullptr>
+    GCH_NODISCARD GCH_IMPLICIT_CONVERSION
+    operator nonnull_ptr<U> (void) const noexcept
+    {
+      return nonnull_ptr<U> { *get () };
+    }
+
+    /**
+     * An implicit conversion to `pointer`.
+     *
+     * @return the stored pointer, with the alignment assumption applied.
+     */
+    GCH_NODISCARD GCH_IMPLICIT_CONVERSION
+    operator pointer (void) const noexcept
+    {
+      return get ();
+    }
+
+    /**
+     * Returns the pointer, informing the optimizer of its alignment.
+     *
+     * @return the stored pointer.
+     */
+    GCH_NODISCARD
+    pointer
+    get (void) const noexcept
+    {
+      return detail::assume_aligned<Align> (m_ptr);
+    }
+
+    /**
+     * Returns the dereferenced pointer.
+     *
+     * @return the dereferenced pointer.
+     */
+    GCH_NODISCARD
+    reference
+    operator* (void) const noexcept
+    {
+      return *get ();
+    }
+
+    /**
+     * Returns a pointer to the value.
+     *
+     * @return a pointer to the value.
+     */
+    GCH_NODISCARD
+    pointer
+    operator-> (void) const noexcept
+    {
+      return get ();
+    }
+
+    /**
+     * Swap the contained pointer with that of `other`.
+     *
+     * @param other a reference to another `nonnull_aligned_ptr`.
+     */
+    GCH_CPP14_CONSTEXPR
+    void
+    swap (nonnull_aligned_ptr& other) noexcept
+    {
+      pointer tmp = m_ptr;
+      m_ptr       = other.m_ptr;
+      other.m_ptr = tmp;
+    }
+
+    /**
+     * Checks whether `ptr` is aligned to `Align` bytes.
+     *
+     * @param ptr a pointer.
+     * @return whether `ptr` is suitably aligned.
+     */
+    GCH_NODISCARD static
+    bool
+    is_aligned (const volatile void *ptr) noexcept
+    {
+      return (reinterpret_cast<std::uintptr_t> (ptr) & (Align - 1)) == 0;
+    }
+
+  private:
+    /**
+     * A pointer to a value.
+     */
+    pointer m_ptr;
+  };
+
+  /**
+   * An equality comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam A the alignment of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @tparam B the alignment of `rhs`.
+   * @param lhs a `nonnull_aligned_ptr`.
+   * @param rhs a `nonnull_aligned_ptr`.
+   * @return the result of the equality comparison.
+   */
+  template <typename T, std::size_t A, typename U, std::size_t B>
+  GCH_NODISCARD inline
+  bool
+  operator== (const nonnull_aligned_ptr<T, A>& lhs, const nonnull_aligned_ptr<U, B>& rhs)
+    noexcept
+  {
+    return lhs.get () == rhs.get ();
+  }
+
+  /**
+   * An inequality comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam A the alignment of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @tparam B the alignment of `rhs`.
+   * @param lhs a `nonnull_aligned_ptr`.
+   * @param rhs a `nonnull_aligned_ptr`.
+   * @return the result of the inequality comparison.
+   */
+  template <typename T, std::size_t A, typename U, std::size_t B>
+  GCH_NODISCARD inline
+  bool
+  operator!= (const nonnull_aligned_ptr<T, A>& lhs, const nonnull_aligned_ptr<U, B>& rhs)
+    noexcept
+  {
+    return lhs.get () != rhs.get ();
+  }
+
+  /**
+   * A swap function.
+   *
+   * @tparam T the value type.
+   * @tparam A the alignment.
+   * @param lhs a `nonnull_aligned_ptr`.
+   * @param rhs a `nonnull_aligned_ptr`.
+   */
+  template <typename T, std::size_t A>
+  inline GCH_CPP14_CONSTEXPR
+  void
+  swap (nonnull_aligned_ptr<T, A>& lhs, nonnull_aligned_ptr<T, A>& rhs) noexcept
+  {
+    lhs.swap (rhs);
+  }
+
+  /**
+   * A creation function for `nonnull_aligned_ptr`.
+   *
+   * @tparam Align the alignment of `ref`.
+   * @tparam U a value type.
+   * @param ref a reference to a suitably aligned value.
+   * @return a `nonnull_aligned_ptr` to `ref`.
+   */
+  template <std::size_t Align, typename U>
+  GCH_NODISCARD inline
+  nonnull_aligned_ptr<U, Align>
+  make_nonnull_aligned_ptr (U& ref) noexcept
+  {
+    return nonnull_aligned_ptr<U, Align> { ref };
+  }
+
+  /**
+   * A deleted version for the case where `ref` is an rvalue reference.
+   */
+  template <std::size_t Align, typename U>
+  nonnull_aligned_ptr<U, Align>
+  make_nonnull_aligned_ptr (const U&& ref) = delete;
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_NONNULL_ALIGNED_PTR_HPP
@@ -0,0 +1,417 @@
+/** nonnull_dyn_ptr.hpp
+ * Defines a non-nullable fat pointer which pairs an object with a
+ * statically generated function table.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_NONNULL_DYN_PTR_HPP
+#define GCH_NONNULL_DYN_PTR_HPP
+
+#include "nonnull_ptr.hpp"
+
+#include <type_traits>
+#include <utility>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    /**
+     * Holds the function table of `Interface` for the type `T`.
+     *
+     * There is exactly one table per pair, generated at compile time.
+     *
+     * @tparam Interface an interface description.
+     * @tparam T the type implementing the interface.
+     */
+    template <typename Interface, typename T>
+    struct dyn_table
+    {
+      static constexpr Interface value = Interface::template table_for<T> ();
+    };
+
+#if ! defined (__cpp_inline_variables) || __cpp_inline_variables < 201606L
+
+    template <typename Interface, typename T>
+    constexpr Interface dyn_table<Interface, T>::value;
+
+#endif
+
+    template <typename Interface, typename T, typename = void>
+    struct has_dyn_table
+      : std::false_type
+    { };
+
+    template <typename Interface, typename T>
+    struct has_dyn_table<
+      Interface, T,
+      typename std::enable_if<
+        std::is_same<decltype (Interface::template table_for<T> ()), Interface>::value>::type>
+      : std::true_type
+    { };
+
+  } // namespace detail
+
+  /**
+   * A non-nullable pointer to an object of any type which implements `Interface`.
+   *
+   * This pairs a pointer to the object with the function table for the object's type,
+   * so unrelated types may be referenced without a common base class or vtable pointer.
+   *
+   * `Interface` is a literal aggregate of function pointers, the first parameter of each
+   * being `void *` or `const void *`, which refers to the object. It must provide
+   *
+   *   template <typename T>
+   *   static constexpr Interface table_for (void) noexcept;
+   *
+   * which returns the table for `T`. If `Interface` is const-qualified then only functions
+   * taking `const void *` may be called, and const objects may be referenced.
+   *
+   * @tparam Interface the interface description, optionally const-qualified.
+   * @tparam InlineTable whether to store the table by value instead of by pointer. This
+   *                     defaults to true for interfaces of a single function, in which
+   *                     case calls need no load from the table.
+   */
+  template <typename Interface,
+            bool InlineTable = (sizeof (Interface) <= sizeof (void *))>
+  class nonnull_dyn_ptr
+  {
+  public:
+    using interface_type = typename std::remove_const<Interface>::type; /*!< The table type */
+    using object_pointer = typename std::conditional<std::is_const<Interface>::value,
+                                                     const void *,
+                                                     void *>::type; /*!< The erased pointer */
+
+  private:
+    static_assert (! std::is_reference<Interface>::value,
+      "nonnull_dyn_ptr expects an interface type as a template argument, not a reference.");
+
+    static_assert (std::is_trivially_copyable<interface_type>::value,
+      "The interface should be an aggregate of function pointers.");
+
+    using table_storage = typename std::conditional<InlineTable,
+                                                    interface_type,
+                                                    const interface_type *>::type;
+
+    template <typename U>
+    using binds_to = std::integral_constant<bool,
+          std::is_convertible<U *, object_pointer>::value
+      &&  detail::has_dyn_table<interface_type, typename std::remove_cv<U>::type>::value>;
+
+    template <typename, bool>
+    friend class nonnull_dyn_ptr;
+
+  public:
+    /**
+     * Constructor
+     *
+     * A deleted default constructor
+     */
+    nonnull_dyn_ptr (void) = delete;
+
+    /**
+     * Constructor
+     *
+     * A copy constructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    nonnull_dyn_ptr (const nonnull_dyn_ptr&) noexcept = default;
+
+    /**
+     * Constructor
+     *
+     * A move constructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    nonnull_dyn_ptr (nonnull_dyn_ptr&&) noexcept = default;
+
+    /**
+     * Assignment operator
+     *
+     * A copy-assignment operator.
+     *
+     * Note: TriviallyCopyable.
+     *
+     * @return `*this`
+     */
+    nonnull_dyn_ptr&
+    operator= (const nonnull_dyn_ptr&) noexcept = default;
+
+    /**
+     * Assignment operator
+     *
+     * A move-assignment operator.
+     *
+     * Note: TriviallyCopyable.
+     *
+     * @return `*this`
+     */
+    nonnull_dyn_ptr&
+    operator= (nonnull_dyn_ptr&&) noexcept = default;
+
+    /**
+     * Destructor
+     *
+     * A trivial destructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    ~nonnull_dyn_ptr (void) = default;
+
+    /**
+     * Constructor
+     *
+     * A constructor for lvalues of any type which implements the interface.
+     *
+     * @tparam U the type of the referenced object.
+     * @param ref an lvalue reference to an object.
+     */
+    template <typename U,
+              typename std::enable_if<binds_to<U>::value>::type * = nullptr>
+    constexpr explicit
+    nonnull_dyn_ptr (U& ref) noexcept
+      : m_object (&ref),
+        m_table (table_for<typename std::remove_cv<U>::type> (
+          std::integral_constant<bool, InlineTable> { }))
+    { }
+
+    /**
+     * Constructor
+     *
+     * A deleted constructor for the case where `ref` is an rvalue reference.
+     */
+    template <typename U,
+              typename = typename std::enable_if<binds_to<U>::value>::type>
+    nonnull_dyn_ptr (const U&&) = delete;
+
+    /**
+     * Constructor
+     *
+     * A converting constructor from a `nonnull_ptr`.
+     *
+     * @tparam U the type of the referenced object.
+     * @param ptr a `nonnull_ptr` to an object which implements the interface.
+     */
+    template <typename U,
+              typename std::enable_if<binds_to<U>::value>::type * = nullptr>
+    constexpr GCH_IMPLICIT_CONVERSION
+    nonnull_dyn_ptr (const nonnull_ptr<U>& ptr) noexcept
+      : nonnull_dyn_ptr (*ptr)
+    { }
+
+    /**
+     * Constructor
+     *
+     * A converting constructor which adds const-qualification to the interface.
+     *
+     * @tparam I a less-qualified interface.
+     * @param other a `nonnull_dyn_ptr` with a non-const interface.
+     */
+    template <typename I,
+              typename std::enable_if<std::is_const<Interface>::value
+                                  &&  std::is_same<I, interface_type>::value>::type * = nullptr>
+    constexpr GCH_IMPLICIT_CONVERSION
+    nonnull_dyn_ptr (const nonnull_dyn_ptr<I, InlineTable>& other) noexcept
+      : m_object (other.m_object),
+        m_table (other.m_table)
+    { }
+
+    /**
+     * Returns the type-erased pointer to the object.
+     *
+     * @return the stored pointer.
+     */
+    GCH_NODISCARD constexpr
+    object_pointer
+    object (void) const noexcept
+    {
+      return m_object;
+    }
+
+    /**
+     * Returns the function table for the type of the object.
+     *
+     * @return a reference to the function table.
+     */
+    GCH_NODISCARD constexpr
+    const interface_type&
+    table (void) const noexcept
+    {
+      return get_table (m_table);
+    }
+
+    /**
+     * Calls a function of the interface with the object as the first argument.
+     *
+     * @tparam R the return type of the function.
+     * @tparam Self the type of the erased object pointer, `void` or `const void`.
+     * @tparam Params the remaining parameter types of the function.
+     * @tparam Args the argument types.
+     * @param fn a pointer to a member of the interface.
+     * @param args the remaining arguments.
+     * @return the result of the call.
+     */
+    template <typename R, typename Self, typename ...Params, typename ...Args>
+    R
+    call (R (*interface_type::*fn) (Self *, Params...), Args&&... args) const
+    {
+      static_assert (std::is_convertible<object_pointer, Self *>::value,
+        "A function taking `void *` may not be called through a const interface.");
+      return (table ().*fn) (m_object, std::forward<Args> (args)...);
+    }
+
+    /**
+     * Swap the contents with those of `other`.
+     *
+     * @param other a reference to another `nonnull_dyn_ptr`.
+     */
+    GCH_CPP14_CONSTEXPR
+    void
+    swap (nonnull_dyn_ptr& other) noexcept
+    {
+      nonnull_dyn_ptr tmp = *this;
+      *this = other;
+      other = tmp;
+    }
+
+  private:
+    template <typename T>
+    static constexpr
+    interface_type
+    table_for (std::true_type) noexcept
+    {
+      return detail::dyn_table<interface_type, T>::value;
+    }
+
+    template <typename T>
+    static constexpr
+    const interface_type *
+    table_for (std::false_type) noexcept
+    {
+      return &detail::dyn_table<interface_type, T>::value;
+    }
+
+    static constexpr
+    const interface_type&
+    get_table (const interface_type& table) noexcept
+    {
+      return table;
+    }
+
+    static constexpr
+    const interface_type&
+    get_table (const interface_type *table) noexcept
+    {
+      return *table;
+    }
+
+    /**
+     * A pointer to the object.
+     */
+    object_pointer m_object;
+
+    /**
+     * The function table, or a pointer to it.
+     */
+    table_storage m_table;
+  };
+
+  /**
+   * An equality comparison function.
+   *
+   * Compares the addresses of the referenced objects.
+   *
+   * @tparam I the interface of `lhs`.
+   * @tparam J the interface of `rhs`.
+   * @param lhs a `nonnull_dyn_ptr`.
+   * @param rhs a `nonnull_dyn_ptr`.
+   * @return the result of the equality comparison.
+   */
+  template <typename I, bool IInline, typename J, bool JInline>
+  GCH_NODISCARD constexpr
+  bool
+  operator== (const nonnull_dyn_ptr<I, IInline>& lhs, const nonnull_dyn_ptr<J, JInline>& rhs)
+    noexcept
+  {
+    return lhs.object () == rhs.object ();
+  }
+
+  /**
+   * An inequality comparison function.
+   *
+   * Compares the addresses of the referenced objects.
+   *
+   * @tparam I the interface of `lhs`.
+   * @tparam J the interface of `rhs`.
+   * @param lhs a `nonnull_dyn_ptr`.
+   * @param rhs a `nonnull_dyn_ptr`.
+   * @return the result of the inequality comparison.
+   */
+  template <typename I, bool IInline, typename J, bool JInline>
+  GCH_NODISCARD constexpr
+  bool
+  operator!= (const nonnull_dyn_ptr<I, IInline>& lhs, const nonnull_dyn_ptr<J, JInline>& rhs)
+    noexcept
+  {
+    return lhs.object () != rhs.object ();
+  }
+
+  /**
+   * A swap function.
+   *
+   * @tparam I the interface.
+   * @param lhs a `nonnull_dyn_ptr`.
+   * @param rhs a `nonnull_dyn_ptr`.
+   */
+  template <typename I, bool Inline>
+  inline GCH_CPP14_CONSTEXPR
+  void
+  swap (nonnull_dyn_ptr<I, Inline>& lhs, nonnull_dyn_ptr<I, Inline>& rhs) noexcept
+  {
+    lhs.swap (rhs);
+  }
+
+  /**
+   * A creation function for `nonnull_dyn_ptr`.
+   *
+   * @tparam Interface the interface description.
+   * @tparam U the type of the referenced object.
+   * @param ref a reference to an object which implements the interface.
+   * @return a `nonnull_dyn_ptr` referencing `ref`.
+   */
+  template <typename Interface, typename U>
+  GCH_NODISCARD constexpr
+  nonnull_dyn_ptr<Interface>
+  make_nonnull_dyn_ptr (U& ref) noexcept
+  {
+    return nonnull_dyn_ptr<Interface> { ref };
+  }
+
+  /**
+   * A deleted version for the case where `ref` is an rvalue reference.
+   */
+  template <typename Interface, typename U>
+  GCH_NODISCARD constexpr
+  nonnull_dyn_ptr<Interface>
+  make_nonnull_dyn_ptr (const U&& ref) = delete;
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_NONNULL_DYN_PTR_HPP
@@ -0,0 +1,309 @@
+/** nonnull_function_ref.hpp
+ * Defines a non-owning reference to a callable which is never empty.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_NONNULL_FUNCTION_REF_HPP
+#define GCH_NONNULL_FUNCTION_REF_HPP
+
+#include "nonnull_ptr.hpp"
+
+#include <type_traits>
+#include <utility>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    template <typename Void, typename R, typename F, typename ...Args>
+    struct is_invocable_r_impl
+      : std::false_type
+    { };
+
+    template <typename R, typename F, typename ...Args>
+    struct is_invocable_r_impl<
+      typename std::enable_if<
+        std::is_void<R>::value
+        ||  std::is_convertible<decltype (std::declval<F> () (std::declval<Args> ()...)),
+                                R>::value>::type,
+      R, F, Args...>
+      : std::true_type
+    { };
+
+    /**
+     * A C++11 stand-in for `std::is_invocable_r` restricted to call expressions.
+     *
+     * @tparam R the required return type.
+     * @tparam F the callable type.
+     * @tparam Args the argument types.
+     */
+    template <typename R, typename F, typename ...Args>
+    struct is_invocable_r
+      : is_invocable_r_impl<void, R, F, Args...>
+    { };
+
+  } // namespace detail
+
+  template <typename Signature>
+  class nonnull_function_ref;
+
+  /**
+   * A non-owning reference to a callable which is not nullable.
+   *
+   * This is two words large (an object pointer and a call thunk) and is trivially copyable.
+   * Since there is no empty state, calling it never requires a check.
+   *
+   * @tparam R the return type of the signature.
+   * @tparam Args the parameter types of the signature.
+   */
+  template <typename R, typename ...Args>
+  class nonnull_function_ref<R (Args...)>
+  {
+    union storage
+    {
+      constexpr explicit
+      storage (const void *ptr) noexcept
+        : object (ptr)
+      { }
+
+      constexpr explicit
+      storage (void (*ptr) (void)) noexcept
+        : function (ptr)
+      { }
+
+      const void *object;
+      void (*function) (void);
+    };
+
+    using thunk_type = R (*) (storage, Args...);
+
+    template <typename F>
+    using is_referenceable_callable = std::integral_constant<bool,
+          ! std::is_same<typename std::remove_cv<F>::type, nonnull_function_ref>::value
+      &&  ! std::is_function<F>::value
+      &&  detail::is_invocable_r<R, F&, Args...>::value>;
+
+    template <typename F>
+    using is_referenceable_function = std::integral_constant<bool,
+          std::is_function<F>::value
+      &&  detail::is_invocable_r<R, F&, Args...>::value>;
+
+  public:
+    using result_type = R; /*!< The return type of the referenced signature */
+
+    /**
+     * Constructor
+     *
+     * A deleted default constructor
+     */
+    nonnull_function_ref (void) = delete;
+
+    /**
+     * Constructor
+     *
+     * A copy constructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    nonnull_function_ref (const nonnull_function_ref&) noexcept = default;
+
+    /**
+     * Constructor
+     *
+     * A move constructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    nonnull_function_ref (nonnull_function_ref&&) noexcept = default;
+
+    /**
+     * Assignment operator
+     *
+     * A copy-assignment operator.
+     *
+     * Note: TriviallyCopyable.
+     *
+     * @return `*this`
+     */
+    nonnull_function_ref&
+    operator= (const nonnull_function_ref&) noexcept = default;
+
+    /**
+     * Assignment operator
+     *
+     * A move-assignment operator.
+     *
+     * Note: TriviallyCopyable.
+     *
+     * @return `*this`
+     */
+    nonnull_function_ref&
+    operator= (nonnull_function_ref&&) noexcept = default;
+
+    /**
+     * Destructor
+     *
+     * A trivial destructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    ~nonnull_function_ref (void) = default;
+
+    /**
+     * Constructor
+     *
+     * A converting constructor for lvalue callable objects.
+     *
+     * The callable is not copied, so it must outlive `*this`.
+     *
+     * @tparam F the type of the callable object.
+     * @param f an lvalue callable object.
+     */
+    template <typename F,
+              typename std::enable_if<is_referenceable_callable<F>::value>::type * = nullptr>
+    constexpr GCH_IMPLICIT_CONVERSION
+    nonnull_function_ref (F& f) noexcept
+      : m_storage (&f),
+        m_thunk (&invoke_object<F>)
+    { }
+
+    /**
+     * Constructor
+     *
+     * A converting constructor for functions.
+     *
+     * @tparam F a function type.
+     * @param f a reference to a function.
+     */
+    template <typename F,
+              typename std::enable_if<is_referenceable_function<F>::value>::type * = nullptr>
+    GCH_IMPLICIT_CONVERSION
+    nonnull_function_ref (F& f) noexcept
+      : m_storage (reinterpret_cast<void (*) (void)> (&f)),
+        m_thunk (&invoke_function<F>)
+    { }
+
+    /**
+     * Constructor
+     *
+     * A deleted constructor for the case where `f` is an rvalue reference.
+     *
+     * We don't want to allow rvalue references because we do not sustain the object lifetime.
+     */
+    template <typename F,
+              typename = typename std::enable_if<is_referenceable_callable<F>::value>::type>
+    nonnull_function_ref (const F&&) = delete;
+
+    /**
+     * Constructor
+     *
+     * A converting constructor for a `nonnull_ptr` to a callable object.
+     *
+     * @tparam F the type of the callable object.
+     * @param ptr a `nonnull_ptr` to a callable object.
+     */
+    template <typename F,
+              typename std::enable_if<is_referenceable_callable<F>::value>::type * = nullptr>
+    constexpr GCH_IMPLICIT_CONVERSION
+    nonnull_function_ref (const nonnull_ptr<F>& ptr) noexcept
+      : nonnull_function_ref (*ptr)
+    { }
+
+    /**
+     * Invokes the referenced callable.
+     *
+     * @param args the arguments to forward to the callable.
+     * @return the result of the invocation.
+     */
+    R
+    operator() (Args... args) const
+    {
+      return m_thunk (m_storage, std::forward<Args> (args)...);
+    }
+
+    /**
+     * Swap the referenced callable with that of `other`.
+     *
+     * @param other a reference to another `nonnull_function_ref`.
+     */
+    GCH_CPP14_CONSTEXPR
+    void
+    swap (nonnull_function_ref& other) noexcept
+    {
+      nonnull_function_ref tmp = *this;
+      *this = other;
+      other = tmp;
+    }
+
+  private:
+    template <typename F>
+    static
+    R
+    invoke_object (storage s, Args... args)
+    {
+      return static_cast<R> (
+        (*static_cast<F *> (const_cast<void *> (s.object))) (std::forward<Args> (args)...));
+    }
+
+    template <typename F>
+    static
+    R
+    invoke_function (storage s, Args... args)
+    {
+      return static_cast<R> (
+        reinterpret_cast<F *> (s.function) (std::forward<Args> (args)...));
+    }
+
+    /**
+     * A pointer to the callable object or function.
+     */
+    storage m_storage;
+
+    /**
+     * A pointer to the function which invokes the callable.
+     */
+    thunk_type m_thunk;
+  };
+
+  /**
+   * A swap function.
+   *
+   * Swaps the two `nonnull_function_ref`s of the same type.
+   *
+   * @tparam Signature the function signature.
+   * @param lhs a `nonnull_function_ref`.
+   * @param rhs a `nonnull_function_ref`.
+   */
+  template <typename Signature>
+  inline GCH_CPP14_CONSTEXPR
+  void
+  swap (nonnull_function_ref<Signature>& lhs, nonnull_function_ref<Signature>& rhs) noexcept
+  {
+    lhs.swap (rhs);
+  }
+
+#ifdef GCH_CTAD_SUPPORT
+
+  template <typename R, typename ...Args>
+  nonnull_function_ref (R (&) (Args...)) -> nonnull_function_ref<R (Args...)>;
+
+#endif
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_NONNULL_FUNCTION_REF_HPP
@@ -0,0 +1,637 @@
+/** nonnull_iterator.hpp
+ * Defines a contiguous iterator which is created from a non-null pointer.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_NONNULL_ITERATOR_HPP
+#define GCH_NONNULL_ITERATOR_HPP
+
+#include "nonnull_ptr.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  /**
+   * A contiguous iterator over objects of type `Value`.
+   *
+   * `nonnull_ptr` is a rebindable reference and has no arithmetic. This is the iterator
+   * counterpart: it is created from a reference or a `nonnull_ptr` and has the full set of
+   * pointer operations, so it models `std::contiguous_iterator` (with concepts) and is a
+   * random access iterator otherwise. Arithmetic within an object or array never yields a
+   * null pointer, so a `nonnull_iterator` is never null unless it is singular.
+   *
+   * `std::to_address` and `std::pointer_traits<nonnull_iterator>::to_address` give the
+   * underlying pointer, as does `get`. Standard libraries which unwrap contiguous iterators
+   * in their algorithms (libc++, for example) then use their pointer fast paths. libstdc++
+   * only unwraps its own iterators, so pass `get ()` to reach `memmove` and `memcmp` there.
+   *
+   * @tparam Value the value type of the stored pointer.
+   */
+  template <typename Value>
+  class nonnull_iterator
+  {
+  public:
+    static_assert (! std::is_reference<Value>::value,
+      "nonnull_iterator expects a value type as a template argument, not a reference.");
+
+    // std::iterator_traits
+    using difference_type   = std::ptrdiff_t;                       /*!< The difference type */
+    using value_type        = typename std::remove_cv<Value>::type; /*!< The value type      */
+    using pointer           = Value *;                              /*!< The pointer type    */
+    using reference         = Value&;                               /*!< The reference type  */
+    using iterator_category = std::random_access_iterator_tag;
+#ifdef GCH_LIB_CONCEPTS
+    using iterator_concept  = std::contiguous_iterator_tag;
+#endif
+
+    // std::pointer_traits
+    using element_type = Value; /*!< The element type of the stored pointer */
+
+  private:
+    template <typename U>
+    using constructible_from_pointer_to =
+      std::is_constructible<pointer, decltype (&std::declval<U&> ())>;
+
+  public:
+    /**
+     * Constructor
+     *
+     * A default constructor, which creates a singular iterator. This only exists because
+     * iterators are required to be default constructible; a singular iterator may only
+     * be assigned to or destroyed.
+     */
+    constexpr
+    nonnull_iterator (void) noexcept
+      : m_ptr (nullptr)
+    { }
+
+    /**
+     * Constructor
+     *
+     * A copy constructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    nonnull_iterator (const nonnull_iterator&) noexcept = default;
+
+    /**
+     * Constructor
+     *
+     * A move constructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    nonnull_iterator (nonnull_iterator&&) noexcept = default;
+
+    /**
+     * Assignment operator
+     *
+     * A copy-assignment operator.
+     *
+     * Note: TriviallyCopyable.
+     *
+     * @return `*this`
+     */
+    nonnull_iterator&
+    operator= (const nonnull_iterator&) noexcept = default;
+
+    /**
+     * Assignment operator
+     *
+     * A move-assignment operator.
+     *
+     * Note: TriviallyCopyable.
+     *
+     * @return `*this`
+     */
+    nonnull_iterator&
+    operator= (nonnull_iterator&&) noexcept = default;
+
+    /**
+     * Destructor
+     *
+     * A trivial destructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    ~nonnull_iterator (void) = default;
+
+    /**
+     * Constructor
+     *
+     * An explicit constructor for an iterator to `ref`.
+     *
+     * @tparam U a referenced value type.
+     * @param ref an lvalue.
+     */
+    template <typename U,
+              typename std::enable_if<constructible_from_pointer_to<U>::value>::type * = nullptr>
+    constexpr explicit
+    nonnull_iterator (U& ref) noexcept
+      : m_ptr (&ref)
+    { }
+
+    /**
+     * Constructor
+     *
+     * A deleted constructor for the case where `ref` is an rvalue reference.
+     */
+    template <typename U,
+              typename = typename std::enable_if<constructible_from_pointer_to<U>::value>::type>
+    nonnull_iterator (const U&&) = delete;
+
+    /**
+     * Constructor
+     *
+     * An explicit constructor from a `nonnull_ptr`.
+     *
+     * @tparam U a referenced value type.
+     * @param other a `nonnull_ptr`.
+     */
+    template <typename U,
+              typename std::enable_if<std::is_convertible<U *, pointer>::value>::type * = nullptr>
+    constexpr explicit
+    nonnull_iterator (const nonnull_ptr<U>& other) noexcept
+      : m_ptr (other.get ())
+    { }
+
+    /**
+     * Constructor
+     *
+     * A converting constructor from another `nonnull_iterator`, for example from an
+     * iterator to a constant iterator.
+     *
+     * @tparam U a referenced value type.
+     * @param other a `nonnull_iterator`.
+     */
+    template <typename U,
+              typename std::enable_if<std::is_convertible<U *, pointer>::value>::type * = nullptr>
+    constexpr GCH_IMPLICIT_CONVERSION
+    nonnull_iterator (const nonnull_iterator<U>& other) noexcept
+      : m_ptr (other.get ())
+    { }
+
+    /**
+     * Returns the pointer.
+     *
+     * @return the stored pointer.
+     */
+    GCH_NODISCARD constexpr
+    pointer
+    get (void) const noexcept
+    {
+      return m_ptr;
+    }
+
+    /**
+     * Returns the dereferenced pointer.
+     *
+     * @return the dereferenced pointer.
+     */
+    GCH_NODISCARD constexpr
+    reference
+    operator* (void) const noexcept
+    {
+      return *m_ptr;
+    }
+
+    /**
+     * Returns the pointer.
+     *
+     * @return the stored pointer.
+     */
+    GCH_NODISCARD constexpr
+    pointer
+    operator-> (void) const noexcept
+    {
+      return m_ptr;
+    }
+
+    /**
+     * Returns the element `n` positions away.
+     *
+     * @param n an offset.
+     * @return the element at `n`.
+     */
+    GCH_NODISCARD constexpr
+    reference
+    operator[] (difference_type n) const noexcept
+    {
+      return m_ptr[n];
+    }
+
+    /**
+     * Advances to the next element.
+     *
+     * @return `*this`
+     */
+    GCH_CPP14_CONSTEXPR
+    nonnull_iterator&
+    operator++ (void) noexcept
+    {
+      ++m_ptr;
+      return *this;
+    }
+
+    /**
+     * Advances to the next element.
+     *
+     * @return a copy of the iterator before it was advanced.
+     */
+    GCH_CPP14_CONSTEXPR
+    nonnull_iterator
+    operator++ (int) noexcept
+    {
+      nonnull_iterator tmp = *this;
+      ++m_ptr;
+      return tmp;
+    }
+
+    /**
+     * Moves to the previous element.
+     *
+     * @return `*this`
+     */
+    GCH_CPP14_CONSTEXPR
+    nonnull_iterator&
+    operator-- (void) noexcept
+    {
+      --m_ptr;
+      return *this;
+    }
+
+    /**
+     * Moves to the previous element.
+     *
+     * @return a copy of the iterator before it was moved.
+     */
+    GCH_CPP14_CONSTEXPR
+    nonnull_iterator
+    operator-- (int) noexcept
+    {
+      nonnull_iterator tmp = *this;
+      --m_ptr;
+      return tmp;
+    }
+
+    /**
+     * Advances by `n` elements.
+     *
+     * @param n an offset.
+     * @return `*this`
+     */
+    GCH_CPP14_CONSTEXPR
+    nonnull_iterator&
+    operator+= (difference_type n) noexcept
+    {
+      m_ptr += n;
+      return *this;
+    }
+
+    /**
+     * Moves back by `n` elements.
+     *
+     * @param n an offset.
+     * @return `*this`
+     */
+    GCH_CPP14_CONSTEXPR
+    nonnull_iterator&
+    operator-= (difference_type n) noexcept
+    {
+      m_ptr -= n;
+      return *this;
+    }
+
+    /**
+     * Returns an iterator advanced by `n` elements.
+     *
+     * @param n an offset.
+     * @return an iterator advanced by `n` elements.
+     */
+    GCH_NODISCARD constexpr
+    nonnull_iterator
+    operator+ (difference_type n) const noexcept
+    {
+      return nonnull_iterator (m_ptr + n, tag { });
+    }
+
+    /**
+     * Returns an iterator moved back by `n` elements.
+     *
+     * @param n an offset.
+     * @return an iterator moved back by `n` elements.
+     */
+    GCH_NODISCARD constexpr
+    nonnull_iterator
+    operator- (difference_type n) const noexcept
+    {
+      return nonnull_iterator (m_ptr - n, tag { });
+    }
+
+    /**
+     * Swap the contained pointer with that of `other`.
+     *
+     * @param other a reference to another `nonnull_iterator`.
+     */
+    GCH_CPP14_CONSTEXPR
+    void
+    swap (nonnull_iterator& other) noexcept
+    {
+      pointer tmp = m_ptr;
+      m_ptr       = other.m_ptr;
+      other.m_ptr = tmp;
+    }
+
+  private:
+    struct tag
+    { };
+
+    constexpr
+    nonnull_iterator (pointer ptr, tag) noexcept
+      : m_ptr (ptr)
+    { }
+
+    /**
+     * A pointer to the current element.
+     */
+    pointer m_ptr;
+  };
+
+  /**
+   * Returns an iterator advanced by `n` elements.
+   *
+   * @tparam T the value type.
+   * @param n an offset.
+   * @param it an iterator.
+   * @return an iterator advanced by `n` elements.
+   */
+  template <typename T>
+  GCH_NODISCARD constexpr
+  nonnull_iterator<T>
+  operator+ (typename nonnull_iterator<T>::difference_type n, const nonnull_iterator<T>& it)
+    noexcept
+  {
+    return it + n;
+  }
+
+  /**
+   * Returns the distance between two iterators.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs a `nonnull_iterator`.
+   * @param rhs a `nonnull_iterator` into the same sequence as `lhs`.
+   * @return the number of elements from `rhs` to `lhs`.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  auto
+  operator- (const nonnull_iterator<T>& lhs, const nonnull_iterator<U>& rhs) noexcept
+    -> decltype (lhs.get () - rhs.get ())
+  {
+    return lhs.get () - rhs.get ();
+  }
+
+  /**
+   * An equality comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs a `nonnull_iterator`.
+   * @param rhs a `nonnull_iterator`.
+   * @return the result of the equality comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator== (const nonnull_iterator<T>& lhs, const nonnull_iterator<U>& rhs) noexcept
+  {
+    return lhs.get () == rhs.get ();
+  }
+
+#ifdef GCH_LIB_THREE_WAY_COMPARISON
+
+  /**
+   * A three-way comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs a `nonnull_iterator`.
+   * @param rhs a `nonnull_iterator` into the same sequence as `lhs`.
+   * @return the result of the three-way comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  std::strong_ordering
+  operator<=> (const nonnull_iterator<T>& lhs, const nonnull_iterator<U>& rhs) noexcept
+  {
+    return lhs.get () <=> rhs.get ();
+  }
+
+#else
+
+  /**
+   * An inequality comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs a `nonnull_iterator`.
+   * @param rhs a `nonnull_iterator`.
+   * @return the result of the inequality comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator!= (const nonnull_iterator<T>& lhs, const nonnull_iterator<U>& rhs) noexcept
+  {
+    return lhs.get () != rhs.get ();
+  }
+
+  /**
+   * A less-than comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs a `nonnull_iterator`.
+   * @param rhs a `nonnull_iterator` into the same sequence as `lhs`.
+   * @return the result of the less-than comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator< (const nonnull_iterator<T>& lhs, const nonnull_iterator<U>& rhs) noexcept
+  {
+    return lhs.get () < rhs.get ();
+  }
+
+  /**
+   * A greater-than comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs a `nonnull_iterator`.
+   * @param rhs a `nonnull_iterator` into the same sequence as `lhs`.
+   * @return the result of the greater-than comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator> (const nonnull_iterator<T>& lhs, const nonnull_iterator<U>& rhs) noexcept
+  {
+    return rhs.get () < lhs.get ();
+  }
+
+  /**
+   * A less-than-equal comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs a `nonnull_iterator`.
+   * @param rhs a `nonnull_iterator` into the same sequence as `lhs`.
+   * @return the result of the less-than-equal comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator<= (const nonnull_iterator<T>& lhs, const nonnull_iterator<U>& rhs) noexcept
+  {
+    return ! (rhs.get () < lhs.get ());
+  }
+
+  /**
+   * A greater-than-equal comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs a `nonnull_iterator`.
+   * @param rhs a `nonnull_iterator` into the same sequence as `lhs`.
+   * @return the result of the greater-than-equal comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator>= (const nonnull_iterator<T>& lhs, const nonnull_iterator<U>& rhs) noexcept
+  {
+    return ! (lhs.get () < rhs.get ());
+  }
+
+#endif
+
+  /**
+   * A swap function.
+   *
+   * @tparam T the value type.
+   * @param lhs a `nonnull_iterator`.
+   * @param rhs a `nonnull_iterator`.
+   */
+  template <typename T>
+  inline GCH_CPP14_CONSTEXPR
+  void
+  swap (nonnull_iterator<T>& lhs, nonnull_iterator<T>& rhs) noexcept
+  {
+    lhs.swap (rhs);
+  }
+
+  /**
+   * A creation function for `nonnull_iterator`.
+   *
+   * @tparam U a value type.
+   * @param ref a reference to the element.
+   * @return a `nonnull_iterator` to `ref`.
+   */
+  template <typename U>
+  GCH_NODISCARD constexpr
+  nonnull_iterator<U>
+  make_nonnull_iterator (U& ref) noexcept
+  {
+    return nonnull_iterator<U> { ref };
+  }
+
+  /**
+   * A deleted version for the case where `ref` is an rvalue reference.
+   */
+  template <typename U>
+  nonnull_iterator<U>
+  make_nonnull_iterator (const U&& ref) = delete;
+
+#ifdef GCH_CTAD_SUPPORT
+
+  template <typename U>
+  nonnull_iterator (U&) -> nonnull_iterator<U>;
+
+  template <typename U>
+  nonnull_iterator (nonnull_ptr<U>) -> nonnull_iterator<U>;
+
+#endif
+
+} // namespace gch
+
+namespace std
+{
+
+  /**
+   * A specialization of `std::pointer_traits` for `gch::nonnull_iterator`.
+   *
+   * This provides `to_address`, which is what `std::to_address` uses to find the
+   * underlying pointer of a contiguous iterator.
+   *
+   * @tparam T the value type of `gch::nonnull_iterator`.
+   */
+  template <typename T>
+  struct pointer_traits<gch::nonnull_iterator<T>>
+  {
+    using pointer         = gch::nonnull_iterator<T>; /*!< The iterator type   */
+    using element_type    = T;                        /*!< The element type    */
+    using difference_type = std::ptrdiff_t;           /*!< The difference type */
+
+    template <typename U>
+    using rebind = gch::nonnull_iterator<U>;          /*!< A rebound iterator type */
+
+    /**
+     * Returns an iterator to `ref`.
+     *
+     * @param ref a reference to an element.
+     * @return an iterator to `ref`.
+     */
+    GCH_NODISCARD static constexpr
+    pointer
+    pointer_to (T& ref) noexcept
+    {
+      return pointer (ref);
+    }
+
+    /**
+     * Returns the underlying pointer.
+     *
+     * @param it an iterator.
+     * @return the stored pointer of `it`.
+     */
+    GCH_NODISCARD static constexpr
+    T *
+    to_address (const pointer& it) noexcept
+    {
+      return it.get ();
+    }
+  };
+
+} // namespace std
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_NONNULL_ITERATOR_HPP
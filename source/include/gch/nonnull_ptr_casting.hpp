@@ -0,0 +1,181 @@
+/** nonnull_ptr_casting.hpp
+ * Defines RTTI-free `isa`, `isa_any`, `cast`, and `dyn_cast` for `nonnull_ptr`.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_NONNULL_PTR_CASTING_HPP
+#define GCH_NONNULL_PTR_CASTING_HPP
+
+#include "nonnull_ptr.hpp"
+
+#include <cassert>
+#include <type_traits>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  /**
+   * Determines whether an object of static type `From` is a `To`.
+   *
+   * By default this calls `To::classof (const From *)`, which usually compares a kind
+   * field stored in the base class. This may be specialized instead, for example to use
+   * a kind trait for types which may not be modified. Upcasts are always successful and
+   * do not require either.
+   *
+   * @tparam To the cv-unqualified target type.
+   * @tparam From the cv-unqualified static type of the object.
+   */
+  template <typename To, typename From, typename Enable = void>
+  struct isa_traits
+  {
+    static constexpr
+    bool
+    doit (const From& from) noexcept
+    {
+      return To::classof (&from);
+    }
+  };
+
+  template <typename To, typename From>
+  struct isa_traits<To, From, typename std::enable_if<std::is_base_of<To, From>::value>::type>
+  {
+    static constexpr
+    bool
+    doit (const From&) noexcept
+    {
+      return true;
+    }
+  };
+
+  namespace detail
+  {
+
+    template <typename To, typename From>
+    using cast_result_t = typename std::conditional<std::is_const<From>::value,
+                                                    const To,
+                                                    To>::type;
+
+  } // namespace detail
+
+  /**
+   * Checks whether the object referenced by `ptr` is a `To`.
+   *
+   * @tparam To the type to check for.
+   * @tparam From the value type of `ptr`.
+   * @param ptr a `nonnull_ptr`.
+   * @return whether the object is a `To`.
+   */
+  template <typename To, typename From>
+  GCH_NODISCARD constexpr
+  bool
+  isa (const nonnull_ptr<From>& ptr) noexcept
+  {
+    return isa_traits<typename std::remove_cv<To>::type,
+                      typename std::remove_cv<From>::type>::doit (*ptr);
+  }
+
+  namespace detail
+  {
+
+    template <typename ...Ts>
+    struct isa_any_impl;
+
+    template <>
+    struct isa_any_impl<>
+    {
+      template <typename From>
+      static constexpr
+      bool
+      doit (const nonnull_ptr<From>&) noexcept
+      {
+        return false;
+      }
+    };
+
+    template <typename To, typename ...Rest>
+    struct isa_any_impl<To, Rest...>
+    {
+      template <typename From>
+      static constexpr
+      bool
+      doit (const nonnull_ptr<From>& ptr) noexcept
+      {
+        return gch::isa<To> (ptr) || isa_any_impl<Rest...>::doit (ptr);
+      }
+    };
+
+  } // namespace detail
+
+  /**
+   * Checks whether the object referenced by `ptr` is any of the types given.
+   *
+   * This is not an overload of `isa`, since `isa<To, From>` with `From` given explicitly
+   * would be ambiguous with it.
+   *
+   * @tparam To the first type to check for.
+   * @tparam Rest the remaining types to check for.
+   * @tparam From the value type of `ptr`.
+   * @param ptr a `nonnull_ptr`.
+   * @return whether the object is any of the types given.
+   */
+  template <typename To, typename ...Rest, typename From>
+  GCH_NODISCARD constexpr
+  bool
+  isa_any (const nonnull_ptr<From>& ptr) noexcept
+  {
+    return detail::isa_any_impl<To, Rest...>::doit (ptr);
+  }
+
+  /**
+   * Casts `ptr` to a `nonnull_ptr` to `To`, preserving const-qualification.
+   *
+   * There is no check in release builds; the object must be a `To`.
+   *
+   * @tparam To the target type.
+   * @tparam From the value type of `ptr`.
+   * @param ptr a `nonnull_ptr`.
+   * @return a `nonnull_ptr` to the same object as a `To`.
+   */
+  template <typename To, typename From>
+  GCH_NODISCARD GCH_CPP14_CONSTEXPR
+  nonnull_ptr<detail::cast_result_t<To, From>>
+  cast (const nonnull_ptr<From>& ptr) noexcept
+  {
+    assert (gch::isa<To> (ptr) && "cast to an incompatible type");
+    return nonnull_ptr<detail::cast_result_t<To, From>> {
+      static_cast<detail::cast_result_t<To, From>&> (*ptr)
+    };
+  }
+
+  /**
+   * Casts `ptr` to a pointer to `To` if the object is a `To`.
+   *
+   * @tparam To the target type.
+   * @tparam From the value type of `ptr`.
+   * @param ptr a `nonnull_ptr`.
+   * @return a pointer to the same object as a `To`, or `nullptr` if it is not a `To`.
+   */
+  template <typename To, typename From>
+  GCH_NODISCARD GCH_CPP14_CONSTEXPR
+  detail::cast_result_t<To, From> *
+  dyn_cast (const nonnull_ptr<From>& ptr) noexcept
+  {
+    return gch::isa<To> (ptr) ? gch::cast<To> (ptr).get () : nullptr;
+  }
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_NONNULL_PTR_CASTING_HPP
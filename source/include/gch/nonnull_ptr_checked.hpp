@@ -0,0 +1,384 @@
+/** nonnull_ptr_checked.hpp
+ * Defines the checks which nonnull_ptr makes when GCH_NONNULL_PTR_CHECKED
+ * is defined. Binding to a null address is always reported, and a sample
+ * of bindings and dereferences is checked against a registry of poisoned
+ * (freed) memory, which catches use-after-free through a long-lived
+ * nonnull_ptr at a fraction of the cost of a sanitizer.
+ *
+ * This is included by nonnull_ptr_core.hpp; it is not meant to be included
+ * on its own.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_NONNULL_PTR_CHECKED_HPP
+#define GCH_NONNULL_PTR_CHECKED_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <type_traits>
+
+#ifndef GCH_NONNULL_PTR_CHECKED_SAMPLE_PERIOD
+#  define GCH_NONNULL_PTR_CHECKED_SAMPLE_PERIOD 1000
+#endif
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  namespace checked
+  {
+
+    /**
+     * The kinds of misuse which the checked mode detects.
+     */
+    enum class violation_kind
+    {
+      null,    /*!< A nonnull_ptr was bound to a null address.        */
+      poisoned /*!< A nonnull_ptr was bound to or dereferenced into
+                    memory which has been poisoned.                    */
+    };
+
+    /**
+     * A description of a detected misuse.
+     */
+    struct violation
+    {
+      violation_kind       kind;          /*!< What was detected.                      */
+      const volatile void *address;       /*!< The address in the nonnull_ptr.         */
+      const volatile void *poison_begin;  /*!< The start of the poisoned range, if any */
+      const volatile void *poison_end;    /*!< The end of the poisoned range, if any   */
+    };
+
+    /**
+     * A function which is called with each violation. If it returns, the program continues.
+     */
+    using violation_handler = void (*) (const violation&);
+
+    namespace detail
+    {
+
+      inline
+      void
+      default_violation_handler (const violation& v) noexcept
+      {
+        if (v.kind == violation_kind::null)
+          std::fprintf (stderr, "gch::nonnull_ptr: bound to a null address.\n");
+        else
+        {
+          std::fprintf (stderr,
+                        "gch::nonnull_ptr: %p is in the poisoned range [%p, %p).\n",
+                        const_cast<const void *> (v.address),
+                        const_cast<const void *> (v.poison_begin),
+                        const_cast<const void *> (v.poison_end));
+        }
+        std::abort ();
+      }
+
+      struct registry
+      {
+        registry (void) noexcept
+          : handler (&default_violation_handler),
+            sample_period (GCH_NONNULL_PTR_CHECKED_SAMPLE_PERIOD),
+            poisoned_ranges (0)
+        { }
+
+        std::atomic<violation_handler>          handler;
+        std::atomic<std::uint32_t>              sample_period;
+        std::atomic<std::size_t>                poisoned_ranges;
+        std::mutex                              mutex;
+        std::map<std::uintptr_t, std::uintptr_t> poisoned; // begin -> end, disjoint
+      };
+
+      // The registry is never destroyed, so that nonnull_ptrs in static storage can still
+      // be checked while the program exits.
+      inline
+      registry&
+      get_registry (void) noexcept
+      {
+        static registry& r = *new registry;
+        return r;
+      }
+
+      // The number of checks each thread skips before it takes the next sample. It starts at
+      // zero so that it is initialized statically and the first call takes a sample.
+      inline
+      std::uint32_t&
+      countdown (void) noexcept
+      {
+        static thread_local std::uint32_t c = 0;
+        return c;
+      }
+
+      inline
+      bool
+      skip_sample (void) noexcept
+      {
+        std::uint32_t& c = countdown ();
+        if (c > 1)
+        {
+          --c;
+          return true;
+        }
+        return false;
+      }
+
+      // The address of a reference can be assumed to be non-null, so it has to be hidden
+      // from the optimizer before it is compared with null.
+      inline
+      std::uintptr_t
+      opaque_address (const volatile void *p) noexcept
+      {
+        std::uintptr_t a = reinterpret_cast<std::uintptr_t> (p);
+#if defined (__GNUC__) || defined (__clang__)
+        __asm__ ("" : "+r" (a));
+#else
+        a = *static_cast<volatile std::uintptr_t *> (&a);
+#endif
+        return a;
+      }
+
+      inline
+      void
+      report (const violation& v) noexcept
+      {
+        get_registry ().handler.load (std::memory_order_acquire) (v);
+      }
+
+      // Restarts the countdown and, unless sampling is off, checks the address.
+      GCH_NONNULL_PTR_SLOW_PATH inline
+      void
+      take_sample (const volatile void *p) noexcept
+      {
+        registry& r = get_registry ();
+        const std::uint32_t period = r.sample_period.load (std::memory_order_relaxed);
+        countdown () = period;
+        if (period == 0 || r.poisoned_ranges.load (std::memory_order_acquire) == 0)
+          return;
+
+        const std::uintptr_t a = reinterpret_cast<std::uintptr_t> (p);
+        violation v { violation_kind::poisoned, p, nullptr, nullptr };
+        {
+          std::lock_guard<std::mutex> lock (r.mutex);
+          auto it = r.poisoned.upper_bound (a);
+          if (it == r.poisoned.begin ())
+            return;
+          --it;
+          if (a >= it->second)
+            return;
+          v.poison_begin = reinterpret_cast<const volatile void *> (it->first);
+          v.poison_end   = reinterpret_cast<const volatile void *> (it->second);
+        }
+        report (v);
+      }
+
+    } // namespace detail
+
+    /**
+     * Sets the function which is called with each violation.
+     *
+     * The default prints the violation and aborts.
+     *
+     * @param handler a violation handler.
+     * @return the previous handler.
+     */
+    inline
+    violation_handler
+    set_violation_handler (violation_handler handler) noexcept
+    {
+      return detail::get_registry ().handler.exchange (handler, std::memory_order_acq_rel);
+    }
+
+    /**
+     * Sets how often bindings and dereferences are checked against the poisoned memory.
+     *
+     * One in every `period` operations on each thread is checked. A period of 1 checks
+     * every operation and a period of 0 turns the sampled checks off. Threads pick up the
+     * new period when they take their next sample. The default is
+     * GCH_NONNULL_PTR_CHECKED_SAMPLE_PERIOD.
+     *
+     * @param period the sampling period.
+     */
+    inline
+    void
+    set_sample_period (std::uint32_t period) noexcept
+    {
+      detail::get_registry ().sample_period.store (period, std::memory_order_relaxed);
+      detail::countdown () = 0;
+    }
+
+    /**
+     * Marks a range of memory as poisoned.
+     *
+     * Call this when the memory is freed. Poisoned memory should be unpoisoned
+     * when it is allocated again. A range which overlaps or touches ranges that
+     * are already poisoned is merged with them.
+     *
+     * @param p the start of the range.
+     * @param size the size of the range in bytes.
+     */
+    inline
+    void
+    poison (const volatile void *p, std::size_t size)
+    {
+      if (size == 0)
+        return;
+
+      detail::registry& r = detail::get_registry ();
+      std::uintptr_t begin = reinterpret_cast<std::uintptr_t> (p);
+      std::uintptr_t end   = begin + size;
+      std::lock_guard<std::mutex> lock (r.mutex);
+
+      // The ranges are kept disjoint, so that a lookup only has to check the one which
+      // starts nearest below an address.
+      auto first = r.poisoned.upper_bound (begin);
+      if (first != r.poisoned.begin () && std::prev (first)->second >= begin)
+        --first;
+      const auto last = r.poisoned.upper_bound (end);
+      for (auto it = first; it != last; ++it)
+      {
+        begin = (std::min) (begin, it->first);
+        end   = (std::max) (end, it->second);
+      }
+      r.poisoned.erase (first, last);
+      r.poisoned.emplace (begin, end);
+      r.poisoned_ranges.store (r.poisoned.size (), std::memory_order_release);
+    }
+
+    /**
+     * Removes a range of memory from the poisoned ranges.
+     *
+     * Call this when memory is allocated again. Only the given range is removed, so
+     * the neighbours it was merged with stay poisoned.
+     *
+     * @param p the start of the range.
+     * @param size the size of the range in bytes.
+     */
+    inline
+    void
+    unpoison (const volatile void *p, std::size_t size)
+    {
+      if (size == 0)
+        return;
+
+      detail::registry& r = detail::get_registry ();
+      const std::uintptr_t begin = reinterpret_cast<std::uintptr_t> (p);
+      const std::uintptr_t end   = begin + size;
+      std::lock_guard<std::mutex> lock (r.mutex);
+
+      auto first = r.poisoned.upper_bound (begin);
+      if (first != r.poisoned.begin () && std::prev (first)->second > begin)
+        --first;
+      const auto last = r.poisoned.lower_bound (end);
+      if (first == last)
+        return;
+
+      // The first and last overlapping ranges may stick out of the removed range, and
+      // those parts stay poisoned.
+      const std::uintptr_t head = first->first;
+      const std::uintptr_t tail = std::prev (last)->second;
+      r.poisoned.erase (first, last);
+      if (head < begin)
+        r.poisoned.emplace (head, begin);
+      if (end < tail)
+        r.poisoned.emplace (end, tail);
+      r.poisoned_ranges.store (r.poisoned.size (), std::memory_order_release);
+    }
+
+    /**
+     * Checks whether an address is in poisoned memory.
+     *
+     * @param p an address.
+     * @return whether `p` is in a poisoned range.
+     */
+    inline
+    bool
+    is_poisoned (const volatile void *p)
+    {
+      detail::registry& r = detail::get_registry ();
+      const std::uintptr_t a = reinterpret_cast<std::uintptr_t> (p);
+      std::lock_guard<std::mutex> lock (r.mutex);
+      auto it = r.poisoned.upper_bound (a);
+      return it != r.poisoned.begin () && a < std::prev (it)->second;
+    }
+
+    /**
+     * Checks an address to which a nonnull_ptr is being bound.
+     *
+     * A null address is always reported. Poisoned memory is reported when
+     * the operation is sampled.
+     *
+     * @param p an address.
+     */
+    inline
+    void
+    on_bind (const volatile void *p) noexcept
+    {
+      if (detail::opaque_address (p) == 0)
+        detail::report (violation { violation_kind::null, p, nullptr, nullptr });
+      else if (! detail::skip_sample ())
+        detail::take_sample (p);
+    }
+
+    /**
+     * Checks an address through which a nonnull_ptr is being dereferenced.
+     *
+     * Poisoned memory is reported when the operation is sampled.
+     *
+     * @param p an address.
+     */
+    inline
+    void
+    on_dereference (const volatile void *p) noexcept
+    {
+      if (! detail::skip_sample ())
+        detail::take_sample (p);
+    }
+
+    namespace detail
+    {
+
+      // These return their argument, so that the hooks can wrap an expression. Constant
+      // evaluation cannot reach freed memory, so the checks are skipped there, which keeps
+      // nonnull_ptr usable in constant expressions.
+      template <typename Pointer>
+      constexpr
+      Pointer
+      bind (Pointer p) noexcept
+      {
+        return GCH_NONNULL_PTR_IS_CONSTANT_EVALUATED () ? p : (on_bind (p), p);
+      }
+
+      template <typename Pointer>
+      constexpr
+      Pointer
+      dereference (Pointer p) noexcept
+      {
+        return GCH_NONNULL_PTR_IS_CONSTANT_EVALUATED () ? p : (on_dereference (p), p);
+      }
+
+    } // namespace detail
+
+  } // namespace checked
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_NONNULL_PTR_CHECKED_HPP
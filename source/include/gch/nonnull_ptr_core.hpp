@@ -0,0 +1,1298 @@
+/** nonnull_ptr_core.hpp
+ * Defines an pointer wrapper which is not nullable, without the hashing
+ * which needs <functional>. Before C++20 the ordering comparisons still
+ * need <functional> for std::less.
+ *
+ * Copyright © 2020 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_NONNULL_PTR_CORE_HPP
+#define GCH_NONNULL_PTR_CORE_HPP
+
+#include "nonnull_ptr_fwd.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#ifdef __clang__
+#  ifndef GCH_CLANG
+#    define GCH_CLANG
+#  endif
+#  if defined (__cplusplus) && __cplusplus >= 201703L
+#    ifndef GCH_CLANG_17
+#      define GCH_CLANG_17
+#    endif
+#  endif
+#endif
+
+#ifndef GCH_CPP14_CONSTEXPR
+#  if defined (__cpp_constexpr) && __cpp_constexpr >= 201304L
+#    define GCH_CPP14_CONSTEXPR constexpr
+#    ifndef GCH_HAS_CPP14_CONSTEXPR
+#      define GCH_HAS_CPP14_CONSTEXPR
+#    endif
+#  else
+#    define GCH_CPP14_CONSTEXPR
+#  endif
+#endif
+
+#ifndef GCH_CPP17_CONSTEXPR
+#  if defined (__cpp_constexpr) && __cpp_constexpr >= 201603L
+#    define GCH_CPP17_CONSTEXPR constexpr
+#    ifndef GCH_HAS_CPP17_CONSTEXPR
+#      define GCH_HAS_CPP17_CONSTEXPR
+#    endif
+#  else
+#    define GCH_CPP17_CONSTEXPR
+#  endif
+#endif
+
+#ifndef GCH_CPP20_CONSTEXPR
+#  if defined (__cpp_constexpr) && __cpp_constexpr >= 201907L
+#    define GCH_CPP20_CONSTEXPR constexpr
+#    ifndef GCH_HAS_CPP20_CONSTEXPR
+#      define GCH_HAS_CPP20_CONSTEXPR
+#    endif
+#  else
+#    define GCH_CPP20_CONSTEXPR
+#  endif
+#endif
+
+#ifndef GCH_CPP20_CONSTEVAL
+#  if defined (__cpp_consteval) && __cpp_consteval >= 201811L
+#    define GCH_CPP20_CONSTEVAL consteval
+#  else
+#    define GCH_CPP20_CONSTEVAL constexpr
+#  endif
+#endif
+
+#ifndef GCH_NODISCARD
+#  if defined (__has_cpp_attribute) && __has_cpp_attribute (nodiscard) >= 201603L
+#    if ! defined (__clang__) || defined (GCH_CLANG_17)
+#      define GCH_NODISCARD [[nodiscard]]
+#    else
+#      define GCH_NODISCARD
+#    endif
+#  else
+#    define GCH_NODISCARD
+#  endif
+#endif
+
+#ifndef GCH_IMPLICIT_CONVERSION
+#  if defined (__cpp_conditional_explicit) && __cpp_conditional_explicit >= 201806L
+#    define GCH_IMPLICIT_CONVERSION explicit (false)
+#  else
+#    define GCH_IMPLICIT_CONVERSION /* implicit */
+#  endif
+#endif
+
+#if defined (__cpp_deduction_guides) && __cpp_deduction_guides >= 201703L
+#  ifndef GCH_CTAD_SUPPORT
+#    define GCH_CTAD_SUPPORT
+#  endif
+#endif
+
+#if defined (__cpp_concepts) && __cpp_concepts >= 201907L
+#  ifndef GCH_CONCEPTS
+#    define GCH_CONCEPTS
+#  endif
+#  if defined (__has_include) && __has_include (<concepts>)
+#    include <concepts>
+#    if defined (__cpp_lib_concepts) && __cpp_lib_concepts >= 202002L
+#      if ! defined (GCH_LIB_CONCEPTS) && ! defined (GCH_DISABLE_CONCEPTS)
+#        define GCH_LIB_CONCEPTS
+#      endif
+#    endif
+#  endif
+#endif
+
+#if defined (__cpp_impl_three_way_comparison) && __cpp_impl_three_way_comparison >= 201907L
+#  ifndef GCH_IMPL_THREE_WAY_COMPARISON
+#    define GCH_IMPL_THREE_WAY_COMPARISON
+#  endif
+#  if defined (__has_include) && __has_include(<compare>)
+#    include <compare>
+#    if defined (__cpp_lib_three_way_comparison) && __cpp_lib_three_way_comparison >= 201907L
+#      ifndef GCH_LIB_THREE_WAY_COMPARISON
+#        define GCH_LIB_THREE_WAY_COMPARISON
+#      endif
+#    endif
+#  endif
+#endif
+
+// Before C++20 the ordering comparisons need std::less.
+#ifndef GCH_LIB_THREE_WAY_COMPARISON
+#  include <functional>
+#endif
+
+#ifndef GCH_NONNULL_PTR_IS_CONSTANT_EVALUATED
+#  if defined (__cpp_lib_is_constant_evaluated) && __cpp_lib_is_constant_evaluated >= 201811L
+#    define GCH_NONNULL_PTR_IS_CONSTANT_EVALUATED() std::is_constant_evaluated ()
+#  elif defined (__has_builtin)
+#    if __has_builtin (__builtin_is_constant_evaluated)
+#      define GCH_NONNULL_PTR_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated ()
+#    endif
+#  endif
+#endif
+
+#if ! defined (GCH_NONNULL_PTR_IS_CONSTANT_EVALUATED) && defined (__GNUC__) && __GNUC__ >= 9
+#  define GCH_NONNULL_PTR_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated ()
+#endif
+
+// Without a way to tell, the hooks below are never skipped, so in the checked and
+// instrumented modes nonnull_ptr is not usable in constant expressions.
+#ifndef GCH_NONNULL_PTR_IS_CONSTANT_EVALUATED
+#  define GCH_NONNULL_PTR_IS_CONSTANT_EVALUATED() false
+#endif
+
+// Functions which the hooks below only call on rare paths. Keeping them out of line means
+// the inlined part of each operation stays small.
+#ifndef GCH_NONNULL_PTR_SLOW_PATH
+#  if defined (__GNUC__) || defined (__clang__)
+#    define GCH_NONNULL_PTR_SLOW_PATH __attribute__ ((noinline, cold))
+#  elif defined (_MSC_VER)
+#    define GCH_NONNULL_PTR_SLOW_PATH __declspec (noinline)
+#  else
+#    define GCH_NONNULL_PTR_SLOW_PATH
+#  endif
+#endif
+
+// The hooks wrap the address whenever a nonnull_ptr is bound to a reference and whenever it
+// is dereferenced, and must return it. They expand to the address itself unless
+// GCH_NONNULL_PTR_CHECKED is defined, in which case they check it (see
+// nonnull_ptr_checked.hpp). Every translation unit in a program must agree on them.
+#ifdef GCH_NONNULL_PTR_CHECKED
+#  include "nonnull_ptr_checked.hpp"
+#  ifndef GCH_NONNULL_PTR_BIND_HOOK
+#    define GCH_NONNULL_PTR_BIND_HOOK(P) ::gch::checked::detail::bind (P)
+#  endif
+#  ifndef GCH_NONNULL_PTR_DEREFERENCE_HOOK
+#    define GCH_NONNULL_PTR_DEREFERENCE_HOOK(P) ::gch::checked::detail::dereference (P)
+#  endif
+#else
+#  ifndef GCH_NONNULL_PTR_BIND_HOOK
+#    define GCH_NONNULL_PTR_BIND_HOOK(P) (P)
+#  endif
+#  ifndef GCH_NONNULL_PTR_DEREFERENCE_HOOK
+#    define GCH_NONNULL_PTR_DEREFERENCE_HOOK(P) (P)
+#  endif
+#endif
+
+// The instrumentation hook wraps the address whenever a nonnull_ptr is bound, dereferenced,
+// rebound or compared, and must return it. EVENT names the operation and T is the value
+// type of the nonnull_ptr. It expands to the address itself unless
+// GCH_NONNULL_PTR_INSTRUMENT is defined, in which case it counts the operation (see
+// nonnull_ptr_instrument.hpp).
+#ifdef GCH_NONNULL_PTR_INSTRUMENT
+#  include "nonnull_ptr_instrument.hpp"
+#  ifndef GCH_NONNULL_PTR_INSTRUMENT_HOOK
+#    define GCH_NONNULL_PTR_INSTRUMENT_HOOK(EVENT, T, P) \
+       ::gch::instrument::detail::record<::gch::instrument::event::EVENT, T> (P)
+#  endif
+#else
+#  ifndef GCH_NONNULL_PTR_INSTRUMENT_HOOK
+#    define GCH_NONNULL_PTR_INSTRUMENT_HOOK(EVENT, T, P) (P)
+#  endif
+#endif
+
+// The trace hook wraps the address whenever a nonnull_ptr is dereferenced, and must return
+// it. T is the value type of the nonnull_ptr. It expands to the address itself unless
+// GCH_NONNULL_PTR_TRACE is defined, in which case it records the address while a trace is
+// running (see nonnull_ptr_trace.hpp).
+#ifdef GCH_NONNULL_PTR_TRACE
+#  include "nonnull_ptr_trace.hpp"
+#  ifndef GCH_NONNULL_PTR_TRACE_HOOK
+#    define GCH_NONNULL_PTR_TRACE_HOOK(T, P) ::gch::trace::detail::dereference<T> (P)
+#  endif
+#else
+#  ifndef GCH_NONNULL_PTR_TRACE_HOOK
+#    define GCH_NONNULL_PTR_TRACE_HOOK(T, P) (P)
+#  endif
+#endif
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  /**
+   * A pointer wrapper which is not nullable.
+   *
+   * @tparam Value the value type of the stored pointer.
+   */
+  template <typename Value>
+  class nonnull_ptr
+  {
+  public:
+    static_assert(! std::is_reference<Value>::value,
+      "nonnull_ptr expects a value type as a template argument, not a reference.");
+
+    // std::iterator_traits
+    using difference_type   = std::ptrdiff_t; /*!< The same difference type as stored pointer */
+    using value_type        = Value;          /*!< An alias for `element_type`          */
+    using pointer           = Value *;        /*!< The pointer type to the value type   */
+    using reference         = Value&;         /*!< The reference type to be wrapped     */
+    using iterator_category = std::random_access_iterator_tag;
+#ifdef GCH_LIB_CONCEPTS
+    using iterator_concept  = std::contiguous_iterator_tag;
+#endif
+
+    // std::pointer_traits
+    using element_type = Value;               /*!< The element type of the stored pointer */
+
+    template <typename U>
+    using rebind = nonnull_ptr<U>;            /*!< A template for rebinding this type */
+
+    // other
+    using const_reference = const Value&;     /*!< A constant reference to `Value`      */
+    using const_pointer   = const Value *;    /*!< A constant pointer to `Value`        */
+
+  private:
+    // With concepts, the templates below are constrained with requires-clauses, which the
+    // compiler checks after deduction and caches, rather than with enable_if, which costs a
+    // class template instantiation for every candidate in every overload set.
+#ifdef GCH_LIB_CONCEPTS
+    template <typename U>
+    static constexpr bool constructible_from_pointer_to_v =
+      std::is_constructible_v<pointer, decltype (&std::declval<U&> ())>;
+#else
+    template <typename U>
+    using constructible_from_pointer_to =
+      std::is_constructible<pointer, decltype (&std::declval<U&> ())>;
+#endif
+
+  public:
+    /**
+     * Constructor
+     *
+     * A deleted default constructor
+     */
+    nonnull_ptr (void) = delete;
+
+    /**
+     * Constructor
+     *
+     * A copy constructor.
+     *
+     * The value of `other` is copied into `*this`.
+     *
+     * Note: TriviallyCopyable.
+     */
+    nonnull_ptr (const nonnull_ptr&) noexcept = default;
+
+    /**
+     * Constructor
+     *
+     * A move constructor.
+     *
+     * The value of `other` is copied into `*this`.
+     *
+     * Note: TriviallyCopyable.
+     */
+    nonnull_ptr (nonnull_ptr&&) noexcept = default;
+
+    /**
+     * Assignment operator
+     *
+     * A copy-assignment operator.
+     *
+     * The resultant state of `*this` is equivalent
+     * to that of `other`.
+     *
+     * Note: TriviallyCopyable.
+     *
+     * @return `*this`
+     */
+    nonnull_ptr&
+    operator= (const nonnull_ptr&) noexcept = default;
+
+    /**
+     * Assignment operator
+     *
+     * A move-assignment operator.
+     *
+     * Sets the state of `*this` to that of `other`.
+     * It is implementation defined if `other` contains
+     * a value after this.
+     *
+     * Note: TriviallyCopyable.
+     *
+     * @return `*this`
+     */
+    nonnull_ptr&
+    operator= (nonnull_ptr&&) noexcept = default;
+
+    /**
+     * Destructor
+     *
+     * A trivial destructor.
+     *
+     * Note: TriviallyCopyable.
+     *
+     */
+    ~nonnull_ptr (void) = default;
+
+    /**
+     * Constructor
+     *
+     * An explicit converting constructor for reference
+     * types explicitly convertible to `pointer`.
+     *
+     * @tparam U a referenced value type.
+     * @param ref a argument from which `pointer` may be explicitly constructed.
+     */
+#ifdef GCH_LIB_CONCEPTS
+    template <typename U>
+      requires constructible_from_pointer_to_v<U>
+#else
+    template <typename U,
+              typename std::enable_if<constructible_from_pointer_to<U>::value>::type * = nullptr>
+#endif
+    constexpr explicit
+    nonnull_ptr (U& ref) noexcept
+      : m_ptr (GCH_NONNULL_PTR_INSTRUMENT_HOOK (bind, value_type, GCH_NONNULL_PTR_BIND_HOOK (&ref)))
+    { }
+
+    /**
+     * Constructor
+     *
+     * A deleted constructor for the case where `ref` is an rvalue reference.
+     */
+#ifdef GCH_LIB_CONCEPTS
+    template <typename U>
+      requires constructible_from_pointer_to_v<U>
+#else
+    template <typename U,
+              typename = typename std::enable_if<constructible_from_pointer_to<U>::value>::type>
+#endif
+    nonnull_ptr (const U&&) = delete;
+
+#ifdef GCH_LIB_CONCEPTS
+
+    /**
+     * Constructor
+     *
+     * A copy constructor from another nonnull_ptr for the case
+     * where `pointer` is constructible from `U *`. It is explicit
+     * unless `U *` is implicitly convertible to type `pointer`.
+     *
+     * The conversion goes through a reference so that an adjustment
+     * to a base class is not guarded by a null check.
+     *
+     * @tparam U a referenced value type.
+     * @param other a nonnull_ptr which contains a pointer from
+     *              which `pointer` may be constructed.
+     */
+    template <typename U>
+      requires std::is_constructible_v<pointer, U *>
+    constexpr explicit (! std::is_convertible_v<U *, pointer>)
+    nonnull_ptr (const nonnull_ptr<U>& other) noexcept
+      : m_ptr (&static_cast<reference> (*other.get ()))
+    { }
+
+#else
+
+    /**
+     * Constructor
+     *
+     * A copy constructor from another nonnull_ptr for the case
+     * where `U *` is implicitly convertible to type `pointer`.
+     *
+     * The conversion goes through a reference so that an adjustment
+     * to a base class is not guarded by a null check.
+     *
+     * @tparam U a referenced value type.
+     * @param other a nonnull_ptr whose pointer is implicitly
+     *              convertible to type `pointer`.
+     */
+    template <typename U,
+              typename std::enable_if<std::is_constructible<pointer, U *>::value
+                                  &&  std::is_convertible<U *, pointer>::value>::type * = nullptr>
+    constexpr GCH_IMPLICIT_CONVERSION
+    nonnull_ptr (const nonnull_ptr<U>& other) noexcept
+      : m_ptr (&static_cast<reference> (*other.get ()))
+    { }
+
+    /**
+     * Constructor
+     *
+     * A copy constructor from another nonnull_ptr for the case
+     * where `pointer` is explicitly constructible from `U *`.
+     *
+     * @tparam U a referenced value type.
+     * @param other a nonnull_ptr which contains a pointer from
+     *              which `pointer` may be explicitly constructed.
+     */
+    template <typename U,
+              typename std::enable_if<std::is_constructible<pointer, U *>::value
+                                  &&! std::is_convertible<U *, pointer>::value>::type * = nullptr>
+    constexpr explicit
+    nonnull_ptr (const nonnull_ptr<U>& other) noexcept
+      : m_ptr (other.get ())
+    { }
+
+#endif
+
+    /**
+     * An implicit conversion to `pointer`.
+     *
+     * This is so we can use `nonnull_ptr` with decaying semantics.
+     *
+     * @return the stored pointer.
+     */
+    GCH_NODISCARD constexpr GCH_IMPLICIT_CONVERSION
+    operator pointer (void) const noexcept
+    {
+      return m_ptr;
+    }
+
+    /**
+     * An explicit conversion to `reference`.
+     *
+     * This is provided because the class basically
+     * acts as a rebindable reference wrapper.
+     *
+     * @return the dereferenced pointer
+     */
+    GCH_NODISCARD constexpr explicit
+    operator reference (void) const noexcept
+    {
+      return *m_ptr;
+    }
+
+    /**
+     * Returns the pointer.
+     *
+     * @return the stored pointer
+     */
+    GCH_NODISCARD constexpr
+    pointer
+    get (void) const noexcept
+    {
+      return m_ptr;
+    }
+
+    /**
+     * Returns the dereferenced pointer.
+     *
+     * @return the dereferenced pointer.
+     */
+    GCH_NODISCARD constexpr
+    reference
+    operator* (void) const noexcept
+    {
+      return *GCH_NONNULL_PTR_TRACE_HOOK (
+                value_type,
+                GCH_NONNULL_PTR_INSTRUMENT_HOOK (dereference, value_type,
+                                                 GCH_NONNULL_PTR_DEREFERENCE_HOOK (m_ptr)));
+    }
+
+    /**
+     * Returns a pointer to the value.
+     *
+     * The return is the same as from `get`.
+     *
+     * @return a pointer to the value.
+     */
+    GCH_NODISCARD constexpr
+    pointer
+    operator-> (void) const noexcept
+    {
+      return GCH_NONNULL_PTR_TRACE_HOOK (
+               value_type,
+               GCH_NONNULL_PTR_INSTRUMENT_HOOK (dereference, value_type,
+                                                GCH_NONNULL_PTR_DEREFERENCE_HOOK (m_ptr)));
+    }
+
+    /**
+     * Returns a pointer to a data member of the value.
+     *
+     * This is `&p->*member`, but the result keeps the non-null guarantee.
+     *
+     * @tparam Member the type of the data member.
+     * @tparam Class the class of which `Member` is a member (`Value` or a base of it).
+     * @param member a pointer to a data member.
+     * @return a `nonnull_ptr` to the member, with the cv-qualification of `Value`.
+     */
+#ifdef GCH_LIB_CONCEPTS
+    template <typename Member, typename Class>
+      requires std::is_member_object_pointer_v<Member Class::*>
+#else
+    template <typename Member, typename Class,
+              typename std::enable_if<std::is_member_object_pointer<Member Class::*>::value>::type
+                * = nullptr>
+#endif
+    GCH_NODISCARD constexpr
+    auto
+    project (Member Class::*member) const noexcept
+      -> nonnull_ptr<
+           typename std::remove_reference<decltype (std::declval<reference> ().*member)>::type>
+    {
+      return nonnull_ptr<typename std::remove_reference<decltype ((*m_ptr).*member)>::type> {
+        (*m_ptr).*member
+      };
+    }
+
+    /**
+     * Swap the contained pointer with that of `other`.
+     *
+     * @param other a reference to another `nonnull_ptr`.
+     */
+    GCH_CPP14_CONSTEXPR
+    void
+    swap (nonnull_ptr& other) noexcept
+    {
+      // manually implemented so we can lower the constexpr version requirements to c++14
+      pointer tmp = m_ptr;
+      m_ptr       = other.m_ptr;
+      other.m_ptr = tmp;
+    }
+
+    /**
+     * Sets the contained pointer.
+     *
+     * Internally, sets the a pointer to the address of the referenced value.
+     *
+     * @tparam U a reference type convertible to `reference`.
+     * @param ref an lvalue reference.
+     * @return the argument `ref`.
+     */
+#ifdef GCH_LIB_CONCEPTS
+    template <typename U>
+      requires constructible_from_pointer_to_v<U>
+#else
+    template <typename U,
+              typename = typename std::enable_if<constructible_from_pointer_to<U>::value>::type>
+#endif
+    GCH_CPP14_CONSTEXPR
+    reference
+    emplace (U& ref) noexcept
+    {
+      return *(m_ptr = pointer (
+                 GCH_NONNULL_PTR_INSTRUMENT_HOOK (rebind, value_type,
+                                                  GCH_NONNULL_PTR_BIND_HOOK (&ref))));
+    }
+
+    /**
+     * A deleted version for rvalue references.
+     *
+     * We don't want to allow rvalue references because the internal pointer
+     * does not sustain the object lifetime.
+     */
+#ifdef GCH_LIB_CONCEPTS
+    template <typename U>
+      requires constructible_from_pointer_to_v<U>
+#else
+    template <typename U,
+              typename = typename std::enable_if<constructible_from_pointer_to<U>::value>::type>
+#endif
+    reference
+    emplace (const U&&) = delete;
+
+    /**
+     * Sets the contained pointer.
+     *
+     * Sets the pointer to the pointer contained by another nonnull_ptr,
+     * where `pointer` is constructible from `U *`.
+     *
+     * @tparam U a referenced value type.
+     * @param other a nonnull_ptr which contains a pointer from
+     *              which `pointer` may be constructed.
+     * @return a reference to the contained pointer.
+     */
+#ifdef GCH_LIB_CONCEPTS
+    template <typename U>
+      requires std::is_constructible_v<pointer, U *>
+#else
+    template <typename U,
+              typename = typename std::enable_if<std::is_constructible<pointer, U *>::value>::type>
+#endif
+    GCH_CPP14_CONSTEXPR
+    reference
+    emplace (const nonnull_ptr<U>& other) noexcept
+    {
+      return *(m_ptr = pointer (
+                 GCH_NONNULL_PTR_INSTRUMENT_HOOK (rebind, value_type, other.get ())));
+    }
+
+    /**
+     * Constructs a nonnull_ptr using the argument.
+     *
+     * This is for use with std::pointer_traits.
+     *
+     * @param ref a reference of type `element_type&`.
+     * @return a nonnull_ptr containing a pointer to `ref`.
+     */
+    static constexpr
+    nonnull_ptr
+    pointer_to (element_type& ref) noexcept
+    {
+      return nonnull_ptr { ref };
+    }
+
+  private:
+    /**
+     * A pointer to a value.
+     */
+    pointer m_ptr;
+  };
+
+  /**
+   * An equality comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs a `nonnull_ptr`.
+   * @param rhs a `nonnull_ptr`.
+   * @return the result of the equality comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator== (const nonnull_ptr<T>& lhs, const nonnull_ptr<U>& rhs)
+    noexcept (noexcept (lhs.get () == rhs.get ()))
+  {
+    return GCH_NONNULL_PTR_INSTRUMENT_HOOK (compare, T, lhs.get ()) == rhs.get ();
+  }
+
+  /**
+   * An inequality comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs a `nonnull_ptr`.
+   * @param rhs a `nonnull_ptr`.
+   * @return the result of the inequality comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator!= (const nonnull_ptr<T>& lhs, const nonnull_ptr<U>& rhs)
+    noexcept (noexcept (lhs.get () != rhs.get ()))
+  {
+    return GCH_NONNULL_PTR_INSTRUMENT_HOOK (compare, T, lhs.get ()) != rhs.get ();
+  }
+
+#ifdef GCH_LIB_THREE_WAY_COMPARISON
+
+  /**
+   * A three-way comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs a `nonnull_ptr`.
+   * @param rhs a `nonnull_ptr`.
+   * @return the result of the three-way comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  std::compare_three_way_result_t<typename nonnull_ptr<T>::pointer,
+                                  typename nonnull_ptr<U>::pointer>
+  operator<=> (const nonnull_ptr<T>& lhs, const nonnull_ptr<U>& rhs)
+    noexcept (noexcept (std::compare_three_way { } (lhs.get (), rhs.get ())))
+    requires std::three_way_comparable_with<typename nonnull_ptr<T>::pointer,
+                                            typename nonnull_ptr<U>::pointer>
+  {
+    return std::compare_three_way { } (GCH_NONNULL_PTR_INSTRUMENT_HOOK (compare, T, lhs.get ()),
+                                       rhs.get ());
+  }
+
+#endif
+
+  /**
+   * An equality comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @return the result of the equality comparison.
+   */
+  template <typename T>
+  GCH_NODISCARD GCH_CPP20_CONSTEVAL
+  bool
+  operator== (const nonnull_ptr<T>&, std::nullptr_t) noexcept
+  {
+    return false;
+  }
+
+#ifdef GCH_LIB_THREE_WAY_COMPARISON
+
+  /**
+   * A three-way comparison function.
+   *
+   * @tparam T the value type of `rhs`.
+   * @return the result of the three-way comparison.
+   */
+  template <typename T>
+  GCH_NODISCARD GCH_CPP20_CONSTEVAL
+  std::strong_ordering
+  operator<=> (const nonnull_ptr<T>&, std::nullptr_t) noexcept
+  {
+    return std::strong_ordering::greater;
+  }
+
+#else
+
+  /**
+   * An equality comparison function.
+   *
+   * @tparam T the value type of `rhs`.
+   * @return the result of the equality comparison.
+   */
+  template <typename T>
+  GCH_NODISCARD GCH_CPP20_CONSTEVAL
+  bool
+  operator== (std::nullptr_t, const nonnull_ptr<T>&) noexcept
+  {
+    return false;
+  }
+
+  /**
+   * An inequality comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @return the result of the inequality comparison.
+   */
+  template <typename T>
+  GCH_NODISCARD GCH_CPP20_CONSTEVAL
+  bool
+  operator!= (const nonnull_ptr<T>&, std::nullptr_t) noexcept
+  {
+    return true;
+  }
+
+  /**
+   * An inequality comparison function.
+   *
+   * @tparam T the value type of `rhs`.
+   * @return the result of the inequality comparison.
+   */
+  template <typename T>
+  GCH_NODISCARD GCH_CPP20_CONSTEVAL
+  bool
+  operator!= (std::nullptr_t, const nonnull_ptr<T>&) noexcept
+  {
+    return true;
+  }
+
+  /**
+   * A less-than comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @return the result of the less-than comparison.
+   */
+  template <typename T>
+  GCH_NODISCARD GCH_CPP20_CONSTEVAL
+  bool
+  operator< (const nonnull_ptr<T>&, std::nullptr_t) noexcept
+  {
+    return false;
+  }
+
+  /**
+   * A less-than comparison function.
+   *
+   * @tparam T the value type of `rhs`.
+   * @return the result of the less-than comparison.
+   */
+  template <typename T>
+  GCH_NODISCARD GCH_CPP20_CONSTEVAL
+  bool
+  operator< (std::nullptr_t, const nonnull_ptr<T>&) noexcept
+  {
+    return true;
+  }
+
+  /**
+   * A greater-than-equal comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @return the result of the greater-than-equal comparison.
+   */
+  template <typename T>
+  GCH_NODISCARD GCH_CPP20_CONSTEVAL
+  bool
+  operator>= (const nonnull_ptr<T>&, std::nullptr_t) noexcept
+  {
+    return true;
+  }
+
+  /**
+   * A greater-than-equal comparison function.
+   *
+   * @tparam T the value type of `rhs`.
+   * @return the result of the greater-than-equal comparison.
+   */
+  template <typename T>
+  GCH_NODISCARD GCH_CPP20_CONSTEVAL
+  bool
+  operator>= (std::nullptr_t, const nonnull_ptr<T>&) noexcept
+  {
+    return false;
+  }
+
+  /**
+   * A greater-than comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @return the result of the greater-than comparison.
+   */
+  template <typename T>
+  GCH_NODISCARD GCH_CPP20_CONSTEVAL
+  bool
+  operator> (const nonnull_ptr<T>&, std::nullptr_t) noexcept
+  {
+    return true;
+  }
+
+  /**
+   * A greater-than comparison function.
+   *
+   * @tparam T the value type of `rhs`.
+   * @return the result of the greater-than comparison.
+   */
+  template <typename T>
+  GCH_NODISCARD GCH_CPP20_CONSTEVAL
+  bool
+  operator> (std::nullptr_t, const nonnull_ptr<T>&) noexcept
+  {
+    return false;
+  }
+
+  /**
+   * A less-than-equal comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @return the result of the less-than-equal comparison.
+   */
+  template <typename T>
+  GCH_NODISCARD GCH_CPP20_CONSTEVAL
+  bool
+  operator<= (const nonnull_ptr<T>&, std::nullptr_t) noexcept
+  {
+    return false;
+  }
+
+  /**
+   * A less-than-equal comparison function.
+   *
+   * @tparam T the value type of `rhs`.
+   * @return the result of the less-than-equal comparison.
+   */
+  template <typename T>
+  GCH_NODISCARD GCH_CPP20_CONSTEVAL
+  bool
+  operator<= (std::nullptr_t, const nonnull_ptr<T>&) noexcept
+  {
+    return true;
+  }
+
+#endif
+
+  /**
+   * An equality comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U a value type which is comparable to `T *`.
+   * @param lhs a `nonnull_ptr`.
+   * @param rhs a comparable pointer.
+   * @return the result of the equality comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator== (const nonnull_ptr<T>& lhs, U *rhs)
+    noexcept (noexcept (lhs.get () == rhs))
+  {
+    return GCH_NONNULL_PTR_INSTRUMENT_HOOK (compare, T, lhs.get ()) == rhs;
+  }
+
+  /**
+   * An equality comparison function.
+   *
+   * @tparam T the value type of `rhs`.
+   * @tparam U a value type which is comparable to `T *`.
+   * @param lhs a comparable pointer.
+   * @param rhs a `nonnull_ptr`.
+   * @return the result of the equality comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator== (U *lhs, const nonnull_ptr<T>& rhs)
+    noexcept (noexcept (lhs == rhs.get ()))
+  {
+    return lhs == GCH_NONNULL_PTR_INSTRUMENT_HOOK (compare, T, rhs.get ());
+  }
+
+  /**
+   * An inequality comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U a value type which is comparable to `T *`.
+   * @param lhs a `nonnull_ptr`.
+   * @param rhs a comparable pointer.
+   * @return the result of the inequality comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator!= (const nonnull_ptr<T>& lhs, U *rhs)
+    noexcept (noexcept (lhs.get () != rhs))
+  {
+    return GCH_NONNULL_PTR_INSTRUMENT_HOOK (compare, T, lhs.get ()) != rhs;
+  }
+
+  /**
+   * An inequality comparison function.
+   *
+   * @tparam T the value type of `rhs`.
+   * @tparam U a value type which is comparable to `T *`.
+   * @param lhs a comparable pointer.
+   * @param rhs a `nonnull_ptr`.
+   * @return the result of the inequality comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator!= (U *lhs, const nonnull_ptr<T>& rhs)
+    noexcept (noexcept (lhs != rhs.get ()))
+  {
+    return lhs != GCH_NONNULL_PTR_INSTRUMENT_HOOK (compare, T, rhs.get ());
+  }
+
+#ifdef GCH_LIB_THREE_WAY_COMPARISON
+
+  /**
+   * A three-way comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U a value type which is comparable to `T *`.
+   * @param lhs an `nonnull_ptr`.
+   * @param rhs a comparable lvalue reference.
+   * @return the result of the three-way comparison.
+   *
+   * @see std::optional::operator<=>
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  std::compare_three_way_result_t<typename nonnull_ptr<T>::pointer, U *>
+  operator<=> (const nonnull_ptr<T>& lhs, U *rhs)
+    noexcept (noexcept (std::compare_three_way { } (lhs.get (), rhs)))
+    requires std::three_way_comparable_with<typename nonnull_ptr<T>::pointer, U *>
+  {
+    return std::compare_three_way { } (GCH_NONNULL_PTR_INSTRUMENT_HOOK (compare, T, lhs.get ()),
+                                       rhs);
+  }
+
+#endif
+
+  namespace detail
+  {
+
+    // The pointer type to which both operands convert. With concepts this is spelled as
+    // the conditional expression which std::common_type evaluates for two pointers, which
+    // saves its instantiations for every pair of types which is compared.
+#ifdef GCH_LIB_CONCEPTS
+    template <typename P, typename Q>
+    using common_pointer_t = decltype (false ? P (nullptr) : Q (nullptr));
+#else
+    template <typename P, typename Q>
+    using common_pointer_t = typename std::common_type<P, Q>::type;
+#endif
+
+    // The strict total order over pointers. std::less and std::compare_three_way give
+    // the same order, and from C++20 the latter needs only <compare>.
+    template <typename P, typename Q>
+    constexpr
+    bool
+    pointer_less (P lhs, Q rhs) noexcept
+    {
+#ifdef GCH_LIB_THREE_WAY_COMPARISON
+      return std::compare_three_way { } (lhs, rhs) < 0;
+#else
+      return std::less<common_pointer_t<P, Q>> { } (lhs, rhs);
+#endif
+    }
+
+  } // namespace detail
+
+  /**
+   * A less-than comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs a `nonnull_ptr`.
+   * @param rhs a `nonnull_ptr`.
+   * @return the result of the less-than comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator< (const nonnull_ptr<T>& lhs, const nonnull_ptr<U>& rhs)
+    noexcept
+  {
+    return detail::pointer_less (GCH_NONNULL_PTR_INSTRUMENT_HOOK (compare, T, lhs.get ()),
+                                 rhs.get ());
+  }
+
+  /**
+   * A greater-than-equal comparison function
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs a `nonnull_ptr`.
+   * @param rhs a `nonnull_ptr`.
+   * @return the result of the greater-than-equal comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator>= (const nonnull_ptr<T>& lhs, const nonnull_ptr<U>& rhs)
+    noexcept (noexcept (! gch::operator< (lhs, rhs)))
+  {
+    return ! gch::operator< (lhs, rhs);
+  }
+
+  /**
+   * A greater-than comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs a `nonnull_ptr`.
+   * @param rhs a `nonnull_ptr`.
+   * @return the result of the greater-than comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator> (const nonnull_ptr<T>& lhs, const nonnull_ptr<U>& rhs)
+    noexcept (noexcept (gch::operator< (rhs, lhs)))
+  {
+    return gch::operator< (rhs, lhs);
+  }
+
+  /**
+   * A less-than-equal comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs a `nonnull_ptr`.
+   * @param rhs a `nonnull_ptr`.
+   * @return the result of the less-than-equal comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator<= (const nonnull_ptr<T>& lhs, const nonnull_ptr<U>& rhs)
+    noexcept (noexcept (gch::operator>= (rhs, lhs)))
+  {
+    return gch::operator>= (rhs, lhs);
+  }
+
+  /**
+   * A less-than comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U a value type which is comparable to `T *`.
+   * @param lhs a `nonnull_ptr`.
+   * @param rhs a comparable pointer.
+   * @return the result of the less-than comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator< (const nonnull_ptr<T>& lhs, U *rhs)
+    noexcept
+  {
+    return detail::pointer_less (GCH_NONNULL_PTR_INSTRUMENT_HOOK (compare, T, lhs.get ()), rhs);
+  }
+
+  /**
+   * A less-than comparison function.
+   *
+   * @tparam T the value type of `rhs`.
+   * @tparam U a value type which is comparable to `T *`.
+   * @param lhs a comparable pointer.
+   * @param rhs a `nonnull_ptr`.
+   * @return the result of the less-than comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator< (U *lhs, const nonnull_ptr<T>& rhs)
+    noexcept
+  {
+    return detail::pointer_less (lhs, GCH_NONNULL_PTR_INSTRUMENT_HOOK (compare, T, rhs.get ()));
+  }
+
+  /**
+   * A greater-than-equal comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U a value type which is comparable to `T *`.
+   * @param lhs a `nonnull_ptr`.
+   * @param rhs a comparable pointer.
+   * @return the result of the greater-than-equal comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator>= (const nonnull_ptr<T>& lhs, U *rhs)
+    noexcept (noexcept (! (gch::operator< (lhs, rhs))))
+  {
+    return ! gch::operator< (lhs, rhs);
+  }
+
+  /**
+   * A greater-than-equal comparison function.
+   *
+   * @tparam T the value type of `rhs`.
+   * @tparam U a value type which is comparable to `T *`.
+   * @param lhs a comparable pointer.
+   * @param rhs a `nonnull_ptr`.
+   * @return the result of the greater-than-equal comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator>= (U *lhs, const nonnull_ptr<T>& rhs)
+    noexcept (noexcept (! gch::operator< (lhs, rhs)))
+  {
+    return ! gch::operator< (lhs, rhs);
+  }
+
+  /**
+   * A greater-than comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U a value type which is comparable to `T *`.
+   * @param lhs a `nonnull_ptr`.
+   * @param rhs a comparable pointer.
+   * @return the result of the greater-than comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator> (const nonnull_ptr<T>& lhs, U *rhs)
+    noexcept (noexcept (gch::operator< (rhs, lhs)))
+  {
+    return gch::operator< (rhs, lhs);
+  }
+
+  /**
+   * A greater-than comparison function.
+   *
+   * @tparam T the value type of `rhs`.
+   * @tparam U a value type which is comparable to `T *`.
+   * @param lhs a comparable pointer.
+   * @param rhs a `nonnull_ptr`.
+   * @return the result of the greater-than comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator> (U *lhs, const nonnull_ptr<T>& rhs)
+    noexcept (noexcept (gch::operator< (rhs, lhs)))
+  {
+    return gch::operator< (rhs, lhs);
+  }
+
+  /**
+   * A less-than-equal comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U a value type which is comparable to `T *`.
+   * @param lhs a `nonnull_ptr`.
+   * @param rhs a comparable pointer.
+   * @return the result of the less-than-equal comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator<= (const nonnull_ptr<T>& lhs, U *rhs)
+    noexcept (noexcept (gch::operator>= (rhs, lhs)))
+  {
+    return gch::operator>= (rhs, lhs);
+  }
+
+  /**
+   * A less-than-equal comparison function.
+   *
+   * @tparam T the value type of `rhs`.
+   * @tparam U a value type which is comparable to `T *`.
+   * @param lhs a comparable pointer.
+   * @param rhs a `nonnull_ptr`.
+   * @return the result of the less-than-equal comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator<= (U *lhs, const nonnull_ptr<T>& rhs)
+    noexcept (noexcept (gch::operator>= (rhs, lhs)))
+  {
+    return gch::operator>= (rhs, lhs);
+  }
+
+  /**
+   * A swap function.
+   *
+   * Swaps the two `nonnull_ptr`s of the same type.
+   *
+   * @tparam T the value type pointed to by the `nonnull_ptr`s
+   * @param lhs a `nonnull_ptr`.
+   * @param rhs a `nonnull_ptr`.
+   */
+  template <typename T>
+  inline GCH_CPP14_CONSTEXPR
+  void
+  swap (nonnull_ptr<T>& lhs, nonnull_ptr<T>& rhs) noexcept
+  {
+    lhs.swap (rhs);
+  }
+
+  /**
+   * An nonnull_ptr creation function.
+   *
+   * Creates a `nonnull_ptr` with the specified argument.
+   *
+   * @tparam U a value type.
+   * @param ref a reference.
+   * @return a `nonnull_ptr` created from the argument.
+   */
+  template <typename U>
+  GCH_NODISCARD constexpr
+  nonnull_ptr<U>
+  make_nonnull_ptr (U& ref) noexcept
+  {
+    return nonnull_ptr<U> { ref };
+  }
+
+  /**
+   * A deleted version for the case where `ref` is an rvalue reference.
+   */
+  template <typename U>
+  GCH_NODISCARD constexpr
+  nonnull_ptr<U>
+  make_nonnull_ptr (const U&& ref) = delete;
+
+#ifdef GCH_CTAD_SUPPORT
+
+  template <typename U>
+  nonnull_ptr (U&) -> nonnull_ptr<U>;
+
+#endif
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_NONNULL_PTR_CORE_HPP
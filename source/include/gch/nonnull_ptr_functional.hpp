@@ -0,0 +1,55 @@
+/** nonnull_ptr_functional.hpp
+ * Defines the specialization of std::hash for nonnull_ptr.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_NONNULL_PTR_FUNCTIONAL_HPP
+#define GCH_NONNULL_PTR_FUNCTIONAL_HPP
+
+#include "nonnull_ptr_core.hpp"
+
+#include <cstddef>
+#include <functional>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace std
+{
+
+  /**
+   * A specialization of `std::hash` for `gch::nonnull_ptr`.
+   *
+   * @tparam T the value type of `gch::nonnull_ptr`.
+   */
+  template <typename T>
+  struct hash<gch::nonnull_ptr<T>>
+  {
+    /**
+     * An invokable operator.
+     *
+     * We just forward to std::hash on the underlying pointer.
+     *
+     * @param ptr a reference to a value of type `gch::nonnull_ptr`.
+     * @return a hash of the argument.
+     */
+    std::size_t
+    operator() (const gch::nonnull_ptr<T>& ptr) const noexcept
+    {
+      return std::hash<typename gch::nonnull_ptr<T>::pointer> { } (ptr.get ());
+    }
+  };
+
+} // namespace std
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_NONNULL_PTR_FUNCTIONAL_HPP
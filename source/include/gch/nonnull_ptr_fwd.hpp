@@ -0,0 +1,43 @@
+/** nonnull_ptr_fwd.hpp
+ * Declares nonnull_ptr, for headers which only name it.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_NONNULL_PTR_FWD_HPP
+#define GCH_NONNULL_PTR_FWD_HPP
+
+#ifdef __clang__
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  /**
+   * A pointer wrapper which is not nullable. Defined in nonnull_ptr_core.hpp.
+   *
+   * @tparam Value the value type of the stored pointer.
+   */
+  template <typename Value>
+  class nonnull_ptr;
+
+  /**
+   * A convenience alias for const pointers.
+   *
+   * @tparam T an unqualified value type.
+   */
+  template <typename T>
+  using nonnull_cptr = nonnull_ptr<const T>;
+
+} // namespace gch
+
+#ifdef __clang__
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_NONNULL_PTR_FWD_HPP
@@ -0,0 +1,664 @@
+/** nonnull_ptr_instrument.hpp
+ * Defines the counters which nonnull_ptr updates when
+ * GCH_NONNULL_PTR_INSTRUMENT is defined. Each binding, dereference,
+ * rebinding and comparison is counted per value type in thread-local
+ * storage, and also per call site when GCH_NONNULL_PTR_INSTRUMENT_CALL_SITES
+ * is defined. The counts are flushed to a global registry, from which they
+ * can be dumped as text or JSON.
+ *
+ * This is included by nonnull_ptr_core.hpp; it is not meant to be included
+ * on its own.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_NONNULL_PTR_INSTRUMENT_HPP
+#define GCH_NONNULL_PTR_INSTRUMENT_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// Whether every value type is instrumented. Define this as 0 and specialize
+// gch::instrument::is_instrumented to select the value types.
+#ifndef GCH_NONNULL_PTR_INSTRUMENT_ALL_TYPES
+#  define GCH_NONNULL_PTR_INSTRUMENT_ALL_TYPES 1
+#endif
+
+// The number of distinct call sites which each thread counts between flushes. It must be
+// a power of two. Operations from further sites are only counted as dropped.
+#ifndef GCH_NONNULL_PTR_INSTRUMENT_SITE_CAPACITY
+#  define GCH_NONNULL_PTR_INSTRUMENT_SITE_CAPACITY 256
+#endif
+
+#if defined (__GNUC__) || defined (__clang__)
+#  define GCH_NONNULL_PTR_INSTRUMENT_SIGNATURE __PRETTY_FUNCTION__
+#  define GCH_NONNULL_PTR_INSTRUMENT_NOINLINE __attribute__ ((noinline))
+#  define GCH_NONNULL_PTR_INSTRUMENT_RETURN_ADDRESS() __builtin_return_address (0)
+#elif defined (_MSC_VER)
+#  include <intrin.h>
+#  define GCH_NONNULL_PTR_INSTRUMENT_SIGNATURE __FUNCSIG__
+#  define GCH_NONNULL_PTR_INSTRUMENT_NOINLINE __declspec (noinline)
+#  define GCH_NONNULL_PTR_INSTRUMENT_RETURN_ADDRESS() _ReturnAddress ()
+#else
+#  define GCH_NONNULL_PTR_INSTRUMENT_SIGNATURE __func__
+#  define GCH_NONNULL_PTR_INSTRUMENT_NOINLINE
+#  define GCH_NONNULL_PTR_INSTRUMENT_RETURN_ADDRESS() nullptr
+#endif
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  namespace instrument
+  {
+
+    /**
+     * The operations on nonnull_ptr which are counted.
+     */
+    enum class event : unsigned char
+    {
+      bind,        /*!< Construction from a reference.      */
+      dereference, /*!< `operator*` or `operator->`.        */
+      rebind,      /*!< `emplace`.                          */
+      compare      /*!< An equality or ordering comparison. */
+    };
+
+    /**
+     * The number of kinds of event.
+     */
+    constexpr std::size_t event_count = 4;
+
+    /**
+     * Gets the name of an event, as used in the dumps.
+     *
+     * @param e an event.
+     * @return the name of `e`.
+     */
+    inline
+    const char *
+    event_name (event e) noexcept
+    {
+      switch (e)
+      {
+        case event::bind:        return "bind";
+        case event::dereference: return "dereference";
+        case event::rebind:      return "rebind";
+        case event::compare:     return "compare";
+        default:                 return "unknown";
+      }
+    }
+
+    /**
+     * Whether operations on `nonnull_ptr<Value>` are counted.
+     *
+     * This is true for every type unless GCH_NONNULL_PTR_INSTRUMENT_ALL_TYPES is
+     * defined as 0. Specialize it to select or exclude value types. The operations
+     * on excluded types compile to the same code as when instrumentation is off.
+     *
+     * @tparam Value a value type without cv-qualifiers.
+     */
+    template <typename Value>
+    struct is_instrumented
+      : std::integral_constant<bool, GCH_NONNULL_PTR_INSTRUMENT_ALL_TYPES != 0>
+    { };
+
+    /**
+     * The counts for one value type.
+     */
+    struct type_counts
+    {
+      std::uint64_t
+      count (event e) const noexcept
+      {
+        return counts[static_cast<std::size_t> (e)];
+      }
+
+      std::uint64_t
+      total (void) const noexcept
+      {
+        std::uint64_t n = 0;
+        for (std::uint64_t c : counts)
+          n += c;
+        return n;
+      }
+
+      std::string                            type;   /*!< The name of the value type. */
+      std::array<std::uint64_t, event_count> counts; /*!< The counts, by event.       */
+    };
+
+    /**
+     * The count of one event on one value type from one call site.
+     */
+    struct site_counts
+    {
+      std::string   type;  /*!< The name of the value type.          */
+      event         kind;  /*!< The operation.                       */
+      const void   *site;  /*!< The return address of the call site. */
+      std::uint64_t count; /*!< The number of operations.            */
+    };
+
+    /**
+     * The counts in the registry, each sorted from most to least frequent.
+     */
+    struct snapshot
+    {
+      std::vector<type_counts> types;         /*!< The counts by value type.               */
+      std::vector<site_counts> sites;         /*!< The counts by call site, if kept.       */
+      std::uint64_t            dropped_sites; /*!< Operations from sites past the capacity. */
+    };
+
+    namespace detail
+    {
+
+      template <typename T>
+      const char *
+      type_signature (void)
+      {
+        return GCH_NONNULL_PTR_INSTRUMENT_SIGNATURE;
+      }
+
+      // Extracts `T` from the signature of type_signature<T>.
+      inline
+      std::string
+      type_name (const char *signature)
+      {
+        const std::string s (signature);
+#if defined (_MSC_VER) && ! defined (__clang__)
+        const std::string prefix ("type_signature<");
+        const std::string::size_type b = s.find (prefix);
+        const std::string::size_type e = s.rfind (">(void)");
+        if (b != std::string::npos && e != std::string::npos && b + prefix.size () < e)
+          return s.substr (b + prefix.size (), e - b - prefix.size ());
+#else
+        // "[with T = int]" from GCC, and "[T = int]" from Clang.
+        std::string::size_type b = s.find ("T = ");
+        if (b != std::string::npos)
+        {
+          b += 4;
+          std::string::size_type e = s.find (';', b);
+          if (e == std::string::npos)
+            e = s.rfind (']');
+          if (e != std::string::npos && b < e)
+            return s.substr (b, e - b);
+        }
+#endif
+        return s;
+      }
+
+      // The totals for a value type. This is constant-initialized, and is linked into the
+      // registry once it has been flushed.
+      struct type_entry
+      {
+        const char *(*signature) (void);
+        std::uint64_t totals[event_count];
+        type_entry   *next;
+        bool          registered;
+      };
+
+      template <typename T>
+      struct type_entry_for
+      {
+        static type_entry entry;
+      };
+
+      template <typename T>
+      type_entry type_entry_for<T>::entry = { &type_signature<T>, { }, nullptr, false };
+
+      struct site_key
+      {
+        friend
+        bool
+        operator== (const site_key& lhs, const site_key& rhs) noexcept
+        {
+          return lhs.entry == rhs.entry && lhs.kind == rhs.kind && lhs.site == rhs.site;
+        }
+
+        type_entry *entry;
+        event       kind;
+        const void *site;
+      };
+
+      struct site_key_hash
+      {
+        std::size_t
+        operator() (const site_key& k) const noexcept
+        {
+          const std::size_t h = std::hash<const void *> { } (k.site);
+          return (h ^ std::hash<const void *> { } (k.entry)) * 31U
+               + static_cast<std::size_t> (k.kind);
+        }
+      };
+
+      using site_map = std::unordered_map<site_key, std::uint64_t, site_key_hash>;
+
+      static_assert ((GCH_NONNULL_PTR_INSTRUMENT_SITE_CAPACITY
+                      & (GCH_NONNULL_PTR_INSTRUMENT_SITE_CAPACITY - 1)) == 0
+                     && GCH_NONNULL_PTR_INSTRUMENT_SITE_CAPACITY != 0,
+                     "GCH_NONNULL_PTR_INSTRUMENT_SITE_CAPACITY must be a power of two.");
+
+      // The site counts of one thread. This is an open-addressed table of a fixed size, so
+      // that counting never allocates. A slot is free while its entry is null.
+      struct site_table
+      {
+        struct slot
+        {
+          site_key      key;
+          std::uint64_t count;
+        };
+
+        static constexpr std::size_t capacity = GCH_NONNULL_PTR_INSTRUMENT_SITE_CAPACITY;
+
+        void
+        add (const site_key& k) noexcept
+        {
+          std::size_t i = site_key_hash { } (k);
+          for (std::size_t n = 0; n < capacity; ++n, ++i)
+          {
+            slot& x = slots[i & (capacity - 1)];
+            if (x.key.entry == nullptr)
+              x.key = k;
+            else if (! (x.key == k))
+              continue;
+            ++x.count;
+            return;
+          }
+          ++dropped;
+        }
+
+        void
+        clear (void) noexcept
+        {
+          for (slot& x : slots)
+            x = slot { };
+          dropped = 0;
+        }
+
+        std::array<slot, capacity> slots = { };
+        std::uint64_t              dropped = 0;
+      };
+
+      struct registry
+      {
+        std::mutex    mutex;
+        type_entry   *types = nullptr;
+        site_map      sites;
+        std::uint64_t dropped_sites = 0;
+      };
+
+      // The registry is never destroyed, so that threads which exit during static
+      // destruction can still flush to it.
+      inline
+      registry&
+      get_registry (void)
+      {
+        static registry& r = *new registry;
+        return r;
+      }
+
+      // The counts of one thread for a value type. This is constant-initialized, so that
+      // the hot path is an increment of thread-local storage without a guard.
+      struct local_counts
+      {
+        std::uint64_t counts[event_count];
+        type_entry   *entry;
+        local_counts *next;
+      };
+
+      template <typename T>
+      local_counts&
+      get_local_counts (void) noexcept
+      {
+        static thread_local local_counts c = { { }, nullptr, nullptr };
+        return c;
+      }
+
+      // The counts which a thread has not flushed yet. They are flushed when it exits.
+      struct thread_state
+      {
+        thread_state (void) = default;
+        thread_state (const thread_state&) = delete;
+        thread_state& operator= (const thread_state&) = delete;
+        ~thread_state (void);
+
+        local_counts *head = nullptr;
+        site_table    sites;
+      };
+
+      inline
+      thread_state&
+      get_thread_state (void)
+      {
+        static thread_local thread_state s;
+        return s;
+      }
+
+      // Must be called with the registry locked.
+      inline
+      void
+      register_type (registry& r, type_entry& e) noexcept
+      {
+        if (! e.registered)
+        {
+          e.registered = true;
+          e.next       = r.types;
+          r.types      = &e;
+        }
+      }
+
+      inline
+      void
+      flush_thread (thread_state& s)
+      {
+        registry& r = get_registry ();
+        std::lock_guard<std::mutex> lock (r.mutex);
+        for (local_counts *c = s.head; c != nullptr; c = c->next)
+        {
+          register_type (r, *c->entry);
+          for (std::size_t i = 0; i < event_count; ++i)
+          {
+            c->entry->totals[i] += c->counts[i];
+            c->counts[i] = 0;
+          }
+        }
+
+        for (const site_table::slot& x : s.sites.slots)
+        {
+          if (x.key.entry != nullptr)
+          {
+            register_type (r, *x.key.entry);
+            r.sites[x.key] += x.count;
+          }
+        }
+        r.dropped_sites += s.sites.dropped;
+        s.sites.clear ();
+      }
+
+      inline
+      thread_state::
+      ~thread_state (void)
+      {
+        flush_thread (*this);
+      }
+
+      GCH_NONNULL_PTR_SLOW_PATH inline
+      void
+      attach (local_counts& c, type_entry& e)
+      {
+        thread_state& s = get_thread_state ();
+        c.entry = &e;
+        c.next  = s.head;
+        s.head  = &c;
+      }
+
+      template <event E, typename T>
+      inline
+      void
+      count_event (void) noexcept
+      {
+        local_counts& c = get_local_counts<T> ();
+        if (c.entry == nullptr)
+          attach (c, type_entry_for<T>::entry);
+        ++c.counts[static_cast<std::size_t> (E)];
+      }
+
+#ifdef GCH_NONNULL_PTR_INSTRUMENT_CALL_SITES
+
+      // This is kept out of line so that its return address is in the function into which
+      // the operation was inlined.
+      template <event E, typename T>
+      GCH_NONNULL_PTR_INSTRUMENT_NOINLINE
+      void
+      count_site (void) noexcept
+      {
+        count_event<E, T> ();
+        const site_key k { &type_entry_for<T>::entry, E,
+                           GCH_NONNULL_PTR_INSTRUMENT_RETURN_ADDRESS () };
+        get_thread_state ().sites.add (k);
+      }
+
+#endif
+
+      template <event E, typename T, typename Pointer>
+      constexpr
+      Pointer
+      record (Pointer p, std::false_type) noexcept
+      {
+        return p;
+      }
+
+      template <event E, typename T, typename Pointer>
+      constexpr
+      Pointer
+      record (Pointer p, std::true_type) noexcept
+      {
+#ifdef GCH_NONNULL_PTR_INSTRUMENT_CALL_SITES
+        return GCH_NONNULL_PTR_IS_CONSTANT_EVALUATED () ? p : (count_site<E, T> (), p);
+#else
+        return GCH_NONNULL_PTR_IS_CONSTANT_EVALUATED () ? p : (count_event<E, T> (), p);
+#endif
+      }
+
+      // This returns its argument, so that the hook can wrap an expression. Operations
+      // during constant evaluation are not counted.
+      template <event E, typename T, typename Pointer>
+      constexpr
+      Pointer
+      record (Pointer p) noexcept
+      {
+        using value_type = typename std::remove_cv<T>::type;
+        return record<E, value_type> (p, is_instrumented<value_type> { });
+      }
+
+      inline
+      void
+      write_json_string (std::FILE *out, const std::string& s)
+      {
+        std::fputc ('"', out);
+        for (char c : s)
+        {
+          if (c == '"' || c == '\\')
+            std::fputc ('\\', out);
+          std::fputc (c, out);
+        }
+        std::fputc ('"', out);
+      }
+
+    } // namespace detail
+
+    /**
+     * Flushes the counts of the calling thread to the registry.
+     *
+     * Each thread flushes its counts when it exits.
+     */
+    inline
+    void
+    flush (void)
+    {
+      detail::flush_thread (detail::get_thread_state ());
+    }
+
+    /**
+     * Clears the registry and the counts of the calling thread.
+     *
+     * Counts which other threads have not flushed yet are kept.
+     */
+    inline
+    void
+    reset (void)
+    {
+      detail::thread_state& s = detail::get_thread_state ();
+      for (detail::local_counts *c = s.head; c != nullptr; c = c->next)
+        std::fill (std::begin (c->counts), std::end (c->counts), std::uint64_t { 0 });
+      s.sites.clear ();
+
+      detail::registry& r = detail::get_registry ();
+      std::lock_guard<std::mutex> lock (r.mutex);
+      for (detail::type_entry *e = r.types; e != nullptr; e = e->next)
+        std::fill (std::begin (e->totals), std::end (e->totals), std::uint64_t { 0 });
+      r.sites.clear ();
+      r.dropped_sites = 0;
+    }
+
+    /**
+     * Flushes the calling thread and copies the counts in the registry.
+     *
+     * @return the counts, each sorted from most to least frequent.
+     */
+    inline
+    snapshot
+    take_snapshot (void)
+    {
+      flush ();
+
+      snapshot result { { }, { }, 0 };
+      {
+        detail::registry& r = detail::get_registry ();
+        std::lock_guard<std::mutex> lock (r.mutex);
+        for (detail::type_entry *e = r.types; e != nullptr; e = e->next)
+        {
+          type_counts t { detail::type_name (e->signature ()), { } };
+          std::copy (std::begin (e->totals), std::end (e->totals), t.counts.begin ());
+          if (t.total () != 0)
+            result.types.push_back (std::move (t));
+        }
+
+        for (const detail::site_map::value_type& kv : r.sites)
+        {
+          result.sites.push_back (site_counts { detail::type_name (kv.first.entry->signature ()),
+                                                kv.first.kind, kv.first.site, kv.second });
+        }
+        result.dropped_sites = r.dropped_sites;
+      }
+
+      std::stable_sort (result.types.begin (), result.types.end (),
+                        [] (const type_counts& lhs, const type_counts& rhs) {
+                          return lhs.total () != rhs.total () ? lhs.total () > rhs.total ()
+                                                              : lhs.type < rhs.type;
+                        });
+
+      std::stable_sort (result.sites.begin (), result.sites.end (),
+                        [] (const site_counts& lhs, const site_counts& rhs) {
+                          if (lhs.count != rhs.count)
+                            return lhs.count > rhs.count;
+                          return std::less<const void *> { } (lhs.site, rhs.site);
+                        });
+
+      return result;
+    }
+
+    /**
+     * Writes the counts in the registry as a table.
+     *
+     * Call sites are return addresses, which can be resolved with a tool like addr2line
+     * (after subtracting the load address of a position-independent executable).
+     *
+     * @param out the stream to which to write.
+     */
+    inline
+    void
+    dump_text (std::FILE *out)
+    {
+      const snapshot s = take_snapshot ();
+
+      std::fprintf (out, "%-40s %12s %12s %12s %12s\n",
+                    "type", "bind", "dereference", "rebind", "compare");
+      for (const type_counts& t : s.types)
+      {
+        std::fprintf (out, "%-40s %12llu %12llu %12llu %12llu\n", t.type.c_str (),
+                      static_cast<unsigned long long> (t.count (event::bind)),
+                      static_cast<unsigned long long> (t.count (event::dereference)),
+                      static_cast<unsigned long long> (t.count (event::rebind)),
+                      static_cast<unsigned long long> (t.count (event::compare)));
+      }
+
+      if (! s.sites.empty ())
+      {
+        std::fprintf (out, "\n%-18s %-40s %-12s %12s\n", "site", "type", "event", "count");
+        for (const site_counts& c : s.sites)
+        {
+          std::fprintf (out, "0x%016llx %-40s %-12s %12llu\n",
+                        static_cast<unsigned long long> (
+                          reinterpret_cast<std::uintptr_t> (c.site)),
+                        c.type.c_str (), event_name (c.kind),
+                        static_cast<unsigned long long> (c.count));
+        }
+      }
+
+      if (s.dropped_sites != 0)
+      {
+        std::fprintf (out, "\n%llu operations came from sites past the capacity.\n",
+                      static_cast<unsigned long long> (s.dropped_sites));
+      }
+    }
+
+    /**
+     * Writes the counts in the registry as a JSON object.
+     *
+     * The object has an array "types" of objects with the name of each value type and a
+     * count for each event, and an array "sites" of objects with the call site (as a hex
+     * string), value type, event and count. "dropped_sites" counts the operations from
+     * sites past GCH_NONNULL_PTR_INSTRUMENT_SITE_CAPACITY.
+     *
+     * @param out the stream to which to write.
+     */
+    inline
+    void
+    dump_json (std::FILE *out)
+    {
+      const snapshot s = take_snapshot ();
+
+      std::fputs ("{\"types\":[", out);
+      for (std::size_t i = 0; i < s.types.size (); ++i)
+      {
+        const type_counts& t = s.types[i];
+        std::fputs (i == 0 ? "{\"type\":" : ",{\"type\":", out);
+        detail::write_json_string (out, t.type);
+        for (std::size_t j = 0; j < event_count; ++j)
+        {
+          std::fprintf (out, ",\"%s\":%llu", event_name (static_cast<event> (j)),
+                        static_cast<unsigned long long> (t.counts[j]));
+        }
+        std::fputc ('}', out);
+      }
+
+      std::fputs ("],\"sites\":[", out);
+      for (std::size_t i = 0; i < s.sites.size (); ++i)
+      {
+        const site_counts& c = s.sites[i];
+        std::fprintf (out, "%s{\"site\":\"0x%llx\",\"type\":", i == 0 ? "" : ",",
+                      static_cast<unsigned long long> (
+                        reinterpret_cast<std::uintptr_t> (c.site)));
+        detail::write_json_string (out, c.type);
+        std::fprintf (out, ",\"event\":\"%s\",\"count\":%llu}", event_name (c.kind),
+                      static_cast<unsigned long long> (c.count));
+      }
+      std::fprintf (out, "],\"dropped_sites\":%llu}\n",
+                    static_cast<unsigned long long> (s.dropped_sites));
+    }
+
+  } // namespace instrument
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_NONNULL_PTR_INSTRUMENT_HPP
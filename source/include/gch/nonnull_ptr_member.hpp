@@ -0,0 +1,135 @@
+/** nonnull_ptr_member.hpp
+ * Defines `container_of`, which recovers a `nonnull_ptr` to an enclosing
+ * object from a `nonnull_ptr` to one of its data members.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_NONNULL_PTR_MEMBER_HPP
+#define GCH_NONNULL_PTR_MEMBER_HPP
+
+#include "nonnull_ptr.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if (defined (__GNUC__) || defined (__clang__)) && ! defined (_MSC_VER)
+#  ifndef GCH_ITANIUM_MEMBER_POINTERS
+#    define GCH_ITANIUM_MEMBER_POINTERS
+#  endif
+#endif
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    template <typename From, typename To>
+    struct copy_cv
+    {
+      using type = To;
+    };
+
+    template <typename From, typename To>
+    struct copy_cv<const From, To>
+    {
+      using type = const To;
+    };
+
+    template <typename From, typename To>
+    struct copy_cv<volatile From, To>
+    {
+      using type = volatile To;
+    };
+
+    template <typename From, typename To>
+    struct copy_cv<const volatile From, To>
+    {
+      using type = const volatile To;
+    };
+
+    /**
+     * Returns the offset in bytes of a data member from the start of its class.
+     *
+     * A pointer to a data member is represented by that offset with the Itanium C++ ABI,
+     * and, for a standard-layout class, with the Microsoft ABI as well, so this is a copy
+     * which folds to a constant. Other ABIs and classes are rejected, since there is no
+     * well-defined way to measure the offset from a pointer to a member.
+     *
+     * @tparam Member the type of the member.
+     * @tparam Class the class type.
+     * @param member a pointer to a data member of `Class`.
+     * @return the offset of `member`.
+     */
+    template <typename Member, typename Class>
+    inline
+    std::ptrdiff_t
+    member_offset (Member Class::*member) noexcept
+    {
+#ifndef GCH_ITANIUM_MEMBER_POINTERS
+      static_assert (std::is_standard_layout<Class>::value,
+                     "container_of needs a standard-layout class without the Itanium C++ ABI.");
+#endif
+
+      using offset_type = typename std::conditional<sizeof (member) == sizeof (std::ptrdiff_t),
+                                                    std::ptrdiff_t, std::int32_t>::type;
+      static_assert (sizeof (member) == sizeof (offset_type),
+                     "Unexpected representation of a pointer to data member.");
+      offset_type offset;
+      std::memcpy (&offset, &member, sizeof (offset));
+      return offset;
+    }
+
+  } // namespace detail
+
+  /**
+   * Returns a pointer to the object of which `*p` is the data member `member`.
+   *
+   * This is the inverse of `nonnull_ptr::project`, and compiles to a single subtraction.
+   * `*p` must actually be the `member` subobject of a `Class`. Without the Itanium C++ ABI,
+   * `Class` must be standard-layout.
+   *
+   * @tparam T the value type of `p`.
+   * @tparam Member the type of the member.
+   * @tparam Class the class type.
+   * @param p a pointer to the member subobject.
+   * @param member a pointer to a data member of `Class`.
+   * @return a `nonnull_ptr` to the enclosing `Class`, with the cv-qualification of `T`.
+   */
+  template <typename T, typename Member, typename Class,
+            typename std::enable_if<
+              std::is_member_object_pointer<Member Class::*>::value
+          &&  std::is_same<typename std::remove_cv<T>::type,
+                           typename std::remove_cv<Member>::type>::value>::type * = nullptr>
+  GCH_NODISCARD inline
+  nonnull_ptr<typename detail::copy_cv<T, Class>::type>
+  container_of (const nonnull_ptr<T>& p, Member Class::*member) noexcept
+  {
+    using result_type = typename detail::copy_cv<T, Class>::type;
+    using byte_type   = typename detail::copy_cv<T, unsigned char>::type;
+    using void_type   = typename detail::copy_cv<T, void>::type;
+
+    byte_type *bytes = reinterpret_cast<byte_type *> (p.get ()) - detail::member_offset (member);
+    return nonnull_ptr<result_type> {
+      *static_cast<result_type *> (static_cast<void_type *> (bytes))
+    };
+  }
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_NONNULL_PTR_MEMBER_HPP
@@ -0,0 +1,483 @@
+/** nonnull_ptr_trace.hpp
+ * Defines the tracer which nonnull_ptr feeds when GCH_NONNULL_PTR_TRACE is
+ * defined. While a trace is running, each dereference appends the address
+ * and the value type to a lock-free ring buffer owned by the thread, and a
+ * writer thread drains the buffers into a binary trace file. The file can be
+ * replayed through the cache model in source/tools/tracesim.cpp.
+ *
+ * This is included by nonnull_ptr_core.hpp; it is not meant to be included
+ * on its own.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_NONNULL_PTR_TRACE_HPP
+#define GCH_NONNULL_PTR_TRACE_HPP
+
+#include "nonnull_ptr_instrument.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// The number of records in the buffer of each thread. This must be a power of two. A thread
+// which fills its buffer waits for the writer to drain it.
+#ifndef GCH_NONNULL_PTR_TRACE_BUFFER_SIZE
+#  define GCH_NONNULL_PTR_TRACE_BUFFER_SIZE 65536
+#endif
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  namespace trace
+  {
+
+    /**
+     * The layout of a trace file.
+     *
+     * All integers are little-endian. The file starts with `magic` and `version`
+     * (a `u32`), and the rest is a sequence of chunks. Each chunk starts with a `u32`
+     * kind and a `u32` count:
+     *
+     *   - chunk_kind::records is followed by `count` records, each a `u64` address
+     *     and a `u32` type ID.
+     *   - chunk_kind::type is followed by a `u32` type ID and a name of `count` bytes.
+     *
+     * The records of each thread are in program order, but records of different threads
+     * are only interleaved in the order they were drained. Type IDs are numbered from 0 in
+     * the order of their type chunks, and a type chunk comes before every record which
+     * uses it.
+     */
+    namespace format
+    {
+
+      constexpr char          magic[8]    = { 'G', 'C', 'H', 'T', 'R', 'A', 'C', 'E' };
+      constexpr std::uint32_t version     = 1;
+      constexpr std::size_t   record_size = 12;
+
+      enum class chunk_kind : std::uint32_t
+      {
+        records = 1, /*!< A run of records.       */
+        type    = 2  /*!< The name of a type ID. */
+      };
+
+    } // namespace format
+
+    namespace detail
+    {
+
+      static_assert (GCH_NONNULL_PTR_TRACE_BUFFER_SIZE > 0
+                     && (GCH_NONNULL_PTR_TRACE_BUFFER_SIZE
+                         & (GCH_NONNULL_PTR_TRACE_BUFFER_SIZE - 1)) == 0,
+                     "GCH_NONNULL_PTR_TRACE_BUFFER_SIZE must be a power of two.");
+
+      constexpr std::uint64_t buffer_size = GCH_NONNULL_PTR_TRACE_BUFFER_SIZE;
+
+      struct record
+      {
+        std::uint64_t address;
+        std::uint32_t type;
+      };
+
+      // A single-producer, single-consumer ring. The owning thread advances `head` and the
+      // writer advances `tail`. It is freed by the writer once its thread has exited and
+      // it has been drained.
+      struct ring
+      {
+        ring (void)
+          : slots (new record[buffer_size])
+        { }
+
+        std::unique_ptr<record[]>  slots;
+        std::atomic<std::uint64_t> head { 0 };
+        std::atomic<std::uint64_t> tail { 0 };
+        std::atomic<bool>          retired { false };
+        std::uint64_t              cached_tail   = 0;     // Only used by the owning thread.
+        std::uint64_t              drain_head    = 0;     // Only used by the writer.
+        bool                       drain_retired = false; // Only used by the writer.
+        ring                      *next          = nullptr;
+      };
+
+      struct registry
+      {
+        std::mutex               mutex;
+        std::condition_variable  wake;
+        ring                    *rings = nullptr;
+        std::vector<std::string> types;
+        std::FILE               *file = nullptr;
+        std::size_t              written_types = 0;
+        bool                     stopping = false;
+        std::thread              writer;
+        std::vector<char>        buffer;
+      };
+
+      // The registry is never destroyed, so that threads which exit during static
+      // destruction can still retire their rings.
+      inline
+      registry&
+      get_registry (void)
+      {
+        static registry& r = *new registry;
+        return r;
+      }
+
+      // This is constant-initialized, so checking it needs no guard.
+      inline
+      std::atomic<bool>&
+      active (void) noexcept
+      {
+        static std::atomic<bool> a { false };
+        return a;
+      }
+
+      struct local_state
+      {
+        ring *r;
+        bool  exited;
+      };
+
+      inline
+      local_state&
+      get_local_state (void) noexcept
+      {
+        static thread_local local_state s = { nullptr, false };
+        return s;
+      }
+
+      // Retires the ring of a thread when it exits.
+      struct ring_owner
+      {
+        ring_owner (void) = default;
+        ring_owner (const ring_owner&) = delete;
+        ring_owner& operator= (const ring_owner&) = delete;
+
+        ~ring_owner (void)
+        {
+          local_state& s = get_local_state ();
+          s.exited = true;
+          if (s.r != nullptr)
+          {
+            s.r->retired.store (true, std::memory_order_release);
+            s.r = nullptr;
+          }
+        }
+      };
+
+      GCH_NONNULL_PTR_SLOW_PATH inline
+      ring *
+      attach (local_state& s)
+      {
+        static thread_local ring_owner owner;
+        static_cast<void> (owner);
+
+        ring *r = new ring;
+        registry& reg = get_registry ();
+        {
+          std::lock_guard<std::mutex> lock (reg.mutex);
+          r->next   = reg.rings;
+          reg.rings = r;
+        }
+        s.r = r;
+        return r;
+      }
+
+      inline
+      std::uint32_t
+      register_type (std::string name)
+      {
+        registry& r = get_registry ();
+        std::lock_guard<std::mutex> lock (r.mutex);
+        r.types.push_back (std::move (name));
+        return static_cast<std::uint32_t> (r.types.size () - 1);
+      }
+
+      template <typename T>
+      std::uint32_t
+      type_id (void)
+      {
+        static const std::uint32_t id = register_type (
+          instrument::detail::type_name (instrument::detail::type_signature<T> ()));
+        return id;
+      }
+
+      // Waits for the writer to make room. Returns false if the trace stopped meanwhile.
+      GCH_NONNULL_PTR_SLOW_PATH inline
+      bool
+      wait_for_space (ring& r, std::uint64_t head) noexcept
+      {
+        for (;;)
+        {
+          r.cached_tail = r.tail.load (std::memory_order_acquire);
+          if (head - r.cached_tail < buffer_size)
+            return true;
+          if (! active ().load (std::memory_order_relaxed))
+            return false;
+          get_registry ().wake.notify_one ();
+          std::this_thread::yield ();
+        }
+      }
+
+      inline
+      void
+      push (std::uint32_t type, const volatile void *p) noexcept
+      {
+        local_state& s = get_local_state ();
+        ring *r = s.r;
+        if (r == nullptr)
+        {
+          if (s.exited)
+            return;
+          r = attach (s);
+        }
+
+        const std::uint64_t h = r->head.load (std::memory_order_relaxed);
+        if (h - r->cached_tail >= buffer_size && ! wait_for_space (*r, h))
+          return;
+
+        r->slots[h & (buffer_size - 1)] = record { reinterpret_cast<std::uintptr_t> (p), type };
+        r->head.store (h + 1, std::memory_order_release);
+      }
+
+      template <typename T>
+      inline
+      void
+      on_dereference (const volatile void *p) noexcept
+      {
+        if (active ().load (std::memory_order_relaxed))
+          push (type_id<typename std::remove_cv<T>::type> (), p);
+      }
+
+      // This returns its argument, so that the hook can wrap an expression. Dereferences
+      // during constant evaluation are not traced.
+      template <typename T, typename Pointer>
+      constexpr
+      Pointer
+      dereference (Pointer p) noexcept
+      {
+        return GCH_NONNULL_PTR_IS_CONSTANT_EVALUATED () ? p : (on_dereference<T> (p), p);
+      }
+
+      template <typename Integer>
+      inline
+      char *
+      encode (char *out, Integer x) noexcept
+      {
+        for (std::size_t i = 0; i < sizeof (Integer); ++i)
+          *out++ = static_cast<char> ((x >> (8 * i)) & 0xFFU);
+        return out;
+      }
+
+      inline
+      void
+      put_u32 (std::vector<char>& out, std::uint32_t x)
+      {
+        out.resize (out.size () + 4);
+        encode (&out.back () - 3, x);
+      }
+
+      inline
+      void
+      put_chunk (std::vector<char>& out, format::chunk_kind kind, std::uint32_t count)
+      {
+        put_u32 (out, static_cast<std::uint32_t> (kind));
+        put_u32 (out, count);
+      }
+
+      // Writes the records of `r` in [first, last). Must be called with the registry locked.
+      inline
+      void
+      write_records (registry& reg, const ring& r, std::uint64_t first, std::uint64_t last)
+      {
+        // Limit the size of a chunk so that the count fits and the buffer stays small.
+        const std::uint64_t max_chunk = buffer_size;
+        while (first != last)
+        {
+          const std::uint64_t n = last - first < max_chunk ? last - first : max_chunk;
+          reg.buffer.clear ();
+          put_chunk (reg.buffer, format::chunk_kind::records, static_cast<std::uint32_t> (n));
+          reg.buffer.resize (reg.buffer.size () + n * format::record_size);
+          char *out = reg.buffer.data () + 8;
+          for (std::uint64_t i = first; i != first + n; ++i)
+          {
+            const record& rec = r.slots[i & (buffer_size - 1)];
+            out = encode (encode (out, rec.address), rec.type);
+          }
+          std::fwrite (reg.buffer.data (), 1, reg.buffer.size (), reg.file);
+          first += n;
+        }
+      }
+
+      // Writes the names of new types. Must be called with the registry locked.
+      inline
+      void
+      write_types (registry& reg)
+      {
+        for (; reg.written_types < reg.types.size (); ++reg.written_types)
+        {
+          const std::string& name = reg.types[reg.written_types];
+          reg.buffer.clear ();
+          put_chunk (reg.buffer, format::chunk_kind::type,
+                     static_cast<std::uint32_t> (name.size ()));
+          put_u32 (reg.buffer, static_cast<std::uint32_t> (reg.written_types));
+          reg.buffer.insert (reg.buffer.end (), name.begin (), name.end ());
+          std::fwrite (reg.buffer.data (), 1, reg.buffer.size (), reg.file);
+        }
+      }
+
+      // Drains every ring, and frees the rings of threads which have exited. Must be called
+      // with the registry locked.
+      //
+      // A thread registers a type before it pushes a record of it, so writing the types
+      // after the heads are read puts every type chunk before the records which use it.
+      inline
+      void
+      drain (registry& reg)
+      {
+        for (ring *r = reg.rings; r != nullptr; r = r->next)
+        {
+          // Check this first, so that the last records of an exiting thread are drained.
+          r->drain_retired = r->retired.load (std::memory_order_acquire);
+          r->drain_head    = r->head.load (std::memory_order_acquire);
+        }
+
+        if (reg.file != nullptr)
+          write_types (reg);
+
+        ring **link = &reg.rings;
+        while (*link != nullptr)
+        {
+          ring& r = **link;
+          const std::uint64_t first = r.tail.load (std::memory_order_relaxed);
+          const std::uint64_t last  = r.drain_head;
+          if (first != last && reg.file != nullptr)
+            write_records (reg, r, first, last);
+          r.tail.store (last, std::memory_order_release);
+
+          if (r.drain_retired)
+          {
+            *link = r.next;
+            delete &r;
+          }
+          else
+            link = &r.next;
+        }
+      }
+
+      inline
+      void
+      run_writer (registry& reg)
+      {
+        std::unique_lock<std::mutex> lock (reg.mutex);
+        while (! reg.stopping)
+        {
+          reg.wake.wait_for (lock, std::chrono::milliseconds (1));
+          drain (reg);
+        }
+        drain (reg);
+      }
+
+    } // namespace detail
+
+    /**
+     * Starts tracing dereferences into a file.
+     *
+     * Records from before the trace started are discarded.
+     *
+     * @param path the path of the trace file, which is overwritten.
+     * @return whether the trace started. It fails if the file cannot be opened or if a
+     *         trace is already running.
+     */
+    inline
+    bool
+    start (const char *path)
+    {
+      detail::registry& reg = detail::get_registry ();
+      std::lock_guard<std::mutex> lock (reg.mutex);
+      if (reg.file != nullptr)
+        return false;
+
+      reg.file = std::fopen (path, "wb");
+      if (reg.file == nullptr)
+        return false;
+
+      reg.buffer.assign (format::magic, format::magic + sizeof (format::magic));
+      detail::put_u32 (reg.buffer, format::version);
+      std::fwrite (reg.buffer.data (), 1, reg.buffer.size (), reg.file);
+
+      for (detail::ring *r = reg.rings; r != nullptr; r = r->next)
+        r->tail.store (r->head.load (std::memory_order_acquire), std::memory_order_release);
+
+      reg.written_types = 0;
+      reg.stopping      = false;
+      reg.writer        = std::thread (&detail::run_writer, std::ref (reg));
+      detail::active ().store (true, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * Stops tracing, writes the remaining records and closes the file.
+     *
+     * Dereferences which race with this may be dropped. This does nothing if no trace
+     * is running.
+     */
+    inline
+    void
+    stop (void)
+    {
+      detail::registry& reg = detail::get_registry ();
+      std::thread writer;
+      {
+        std::lock_guard<std::mutex> lock (reg.mutex);
+        if (reg.file == nullptr)
+          return;
+        detail::active ().store (false, std::memory_order_release);
+        reg.stopping = true;
+        writer       = std::move (reg.writer);
+      }
+
+      reg.wake.notify_all ();
+      writer.join ();
+
+      std::lock_guard<std::mutex> lock (reg.mutex);
+      std::fclose (reg.file);
+      reg.file = nullptr;
+    }
+
+    /**
+     * Checks whether a trace is running.
+     *
+     * @return whether a trace is running.
+     */
+    inline
+    bool
+    is_running (void) noexcept
+    {
+      return detail::active ().load (std::memory_order_acquire);
+    }
+
+  } // namespace trace
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_NONNULL_PTR_TRACE_HPP
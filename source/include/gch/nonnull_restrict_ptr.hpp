@@ -0,0 +1,336 @@
+/** nonnull_restrict_ptr.hpp
+ * Defines a non-nullable pointer which promises not to alias.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_NONNULL_RESTRICT_PTR_HPP
+#define GCH_NONNULL_RESTRICT_PTR_HPP
+
+#include "nonnull_ptr.hpp"
+
+#include <type_traits>
+
+#ifndef GCH_RESTRICT
+#  if defined (__GNUC__) || defined (__clang__) || defined (_MSC_VER)
+#    define GCH_RESTRICT __restrict
+#  else
+#    define GCH_RESTRICT
+#  endif
+#endif
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  /**
+   * A pointer wrapper which is not nullable and is `restrict`-qualified.
+   *
+   * This is meant for kernel parameters. While a `nonnull_restrict_ptr` parameter is in
+   * scope, the object it points to must only be accessed through pointers based on it,
+   * so the compiler may assume that it does not alias other parameters. Loops over two
+   * or three such parameters then need no runtime overlap checks. The promise is not
+   * checked; breaking it is undefined behavior.
+   *
+   * For example:
+   *
+   *   void
+   *   saxpy (float a, nonnull_restrict_ptr<const float> x, nonnull_restrict_ptr<float> y,
+   *          std::size_t n)
+   *   {
+   *     for (std::size_t i = 0; i < n; ++i)
+   *       y[i] += a * x[i];
+   *   }
+   *
+   * GCC applies the qualifier of the stored pointer when the wrapper is passed by value.
+   * Compilers which only honor `restrict` on pointer parameters themselves (Clang, for
+   * example) treat this like a `nonnull_ptr`; there, pass `get ()` on to a function with
+   * `GCH_RESTRICT` pointer parameters instead.
+   *
+   * @tparam Value the value type of the stored pointer.
+   */
+  template <typename Value>
+  class nonnull_restrict_ptr
+  {
+  public:
+    static_assert (! std::is_reference<Value>::value,
+      "nonnull_restrict_ptr expects a value type as a template argument, not a reference.");
+
+    using value_type   = Value;   /*!< The value type            */
+    using element_type = Value;   /*!< The element type          */
+    using pointer      = Value *; /*!< The pointer type          */
+    using reference    = Value&;  /*!< The reference type        */
+
+  private:
+    template <typename U>
+    using constructible_from_pointer_to =
+      std::is_constructible<pointer, decltype (&std::declval<U&> ())>;
+
+  public:
+    /**
+     * Constructor
+     *
+     * A deleted default constructor
+     */
+    nonnull_restrict_ptr (void) = delete;
+
+    /**
+     * Constructor
+     *
+     * A copy constructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    nonnull_restrict_ptr (const nonnull_restrict_ptr&) noexcept = default;
+
+    /**
+     * Constructor
+     *
+     * A move constructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    nonnull_restrict_ptr (nonnull_restrict_ptr&&) noexcept = default;
+
+    /**
+     * Assignment operator
+     *
+     * A copy-assignment operator.
+     *
+     * Note: TriviallyCopyable.
+     *
+     * @return `*this`
+     */
+    nonnull_restrict_ptr&
+    operator= (const nonnull_restrict_ptr&) noexcept = default;
+
+    /**
+     * Assignment operator
+     *
+     * A move-assignment operator.
+     *
+     * Note: TriviallyCopyable.
+     *
+     * @return `*this`
+     */
+    nonnull_restrict_ptr&
+    operator= (nonnull_restrict_ptr&&) noexcept = default;
+
+    /**
+     * Destructor
+     *
+     * A trivial destructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    ~nonnull_restrict_ptr (void) = default;
+
+    /**
+     * Constructor
+     *
+     * An explicit constructor for lvalues which are not otherwise accessed while this
+     * pointer is in use.
+     *
+     * @tparam U a referenced value type.
+     * @param ref an lvalue.
+     */
+    template <typename U,
+              typename std::enable_if<constructible_from_pointer_to<U>::value>::type * = nullptr>
+    constexpr explicit
+    nonnull_restrict_ptr (U& ref) noexcept
+      : m_ptr (&ref)
+    { }
+
+    /**
+     * Constructor
+     *
+     * A deleted constructor for the case where `ref` is an rvalue reference.
+     */
+    template <typename U,
+              typename = typename std::enable_if<constructible_from_pointer_to<U>::value>::type>
+    nonnull_restrict_ptr (const U&&) = delete;
+
+    /**
+     * Constructor
+     *
+     * An explicit constructor from a `nonnull_ptr`.
+     *
+     * @tparam U a referenced value type.
+     * @param other a `nonnull_ptr`.
+     */
+    template <typename U,
+              typename std::enable_if<std::is_convertible<U *, pointer>::value>::type * = nullptr>
+    constexpr explicit
+    nonnull_restrict_ptr (const nonnull_ptr<U>& other) noexcept
+      : m_ptr (other.get ())
+    { }
+
+    /**
+     * An implicit conversion to `nonnull_ptr`.
+     *
+     * The result is based on this pointer, so it may be used to access the value.
+     *
+     * @tparam U a value type such that `U *` is implicitly convertible from `pointer`.
+     * @return a `nonnull_ptr` containing the stored pointer.
+     */
+    template <typename U,
+              typename std::enable_if<std::is_convertible<pointer, U *>::value>::type * = nullptr>
+    GCH_NODISCARD constexpr GCH_IMPLICIT_CONVERSION
+    operator nonnull_ptr<U> (void) const noexcept
+    {
+      return nonnull_ptr<U> { *m_ptr };
+    }
+
+    /**
+     * An implicit conversion to `pointer`.
+     *
+     * @return the stored pointer.
+     */
+    GCH_NODISCARD constexpr GCH_IMPLICIT_CONVERSION
+    operator pointer (void) const noexcept
+    {
+      return m_ptr;
+    }
+
+    /**
+     * Returns the pointer.
+     *
+     * @return the stored pointer.
+     */
+    GCH_NODISCARD constexpr
+    pointer
+    get (void) const noexcept
+    {
+      return m_ptr;
+    }
+
+    /**
+     * Returns the dereferenced pointer.
+     *
+     * @return the dereferenced pointer.
+     */
+    GCH_NODISCARD constexpr
+    reference
+    operator* (void) const noexcept
+    {
+      return *m_ptr;
+    }
+
+    /**
+     * Returns a pointer to the value.
+     *
+     * @return a pointer to the value.
+     */
+    GCH_NODISCARD constexpr
+    pointer
+    operator-> (void) const noexcept
+    {
+      return m_ptr;
+    }
+
+    /**
+     * Swap the contained pointer with that of `other`.
+     *
+     * @param other a reference to another `nonnull_restrict_ptr`.
+     */
+    GCH_CPP14_CONSTEXPR
+    void
+    swap (nonnull_restrict_ptr& other) noexcept
+    {
+      pointer tmp = m_ptr;
+      m_ptr       = other.m_ptr;
+      other.m_ptr = tmp;
+    }
+
+  private:
+    /**
+     * A `restrict`-qualified pointer to a value.
+     */
+    pointer GCH_RESTRICT m_ptr;
+  };
+
+  /**
+   * An equality comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs a `nonnull_restrict_ptr`.
+   * @param rhs a `nonnull_restrict_ptr`.
+   * @return the result of the equality comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator== (const nonnull_restrict_ptr<T>& lhs, const nonnull_restrict_ptr<U>& rhs) noexcept
+  {
+    return lhs.get () == rhs.get ();
+  }
+
+  /**
+   * An inequality comparison function.
+   *
+   * @tparam T the value type of `lhs`.
+   * @tparam U the value type of `rhs`.
+   * @param lhs a `nonnull_restrict_ptr`.
+   * @param rhs a `nonnull_restrict_ptr`.
+   * @return the result of the inequality comparison.
+   */
+  template <typename T, typename U>
+  GCH_NODISCARD constexpr
+  bool
+  operator!= (const nonnull_restrict_ptr<T>& lhs, const nonnull_restrict_ptr<U>& rhs) noexcept
+  {
+    return lhs.get () != rhs.get ();
+  }
+
+  /**
+   * A swap function.
+   *
+   * @tparam T the value type.
+   * @param lhs a `nonnull_restrict_ptr`.
+   * @param rhs a `nonnull_restrict_ptr`.
+   */
+  template <typename T>
+  inline GCH_CPP14_CONSTEXPR
+  void
+  swap (nonnull_restrict_ptr<T>& lhs, nonnull_restrict_ptr<T>& rhs) noexcept
+  {
+    lhs.swap (rhs);
+  }
+
+  /**
+   * A creation function for `nonnull_restrict_ptr`.
+   *
+   * @tparam U a value type.
+   * @param ref a reference to a value.
+   * @return a `nonnull_restrict_ptr` to `ref`.
+   */
+  template <typename U>
+  GCH_NODISCARD constexpr
+  nonnull_restrict_ptr<U>
+  make_nonnull_restrict_ptr (U& ref) noexcept
+  {
+    return nonnull_restrict_ptr<U> { ref };
+  }
+
+  /**
+   * A deleted version for the case where `ref` is an rvalue reference.
+   */
+  template <typename U>
+  nonnull_restrict_ptr<U>
+  make_nonnull_restrict_ptr (const U&& ref) = delete;
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_NONNULL_RESTRICT_PTR_HPP
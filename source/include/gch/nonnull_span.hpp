@@ -0,0 +1,822 @@
+/** nonnull_span.hpp
+ * Defines a view of a contiguous sequence which is never null and never empty.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_NONNULL_SPAN_HPP
+#define GCH_NONNULL_SPAN_HPP
+
+#include "nonnull_ptr.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined (__has_include)
+#  if __has_include (<version>)
+#    include <version>
+#  endif
+#endif
+
+#if defined (__cpp_lib_span) && __cpp_lib_span >= 202002L
+#  ifndef GCH_LIB_SPAN
+#    define GCH_LIB_SPAN
+#  endif
+#  include <span>
+#endif
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  /**
+   * The extent of a `nonnull_span` whose size is only known at runtime.
+   */
+  constexpr std::size_t dynamic_extent = (std::numeric_limits<std::size_t>::max) ();
+
+  template <typename T, std::size_t Extent = dynamic_extent>
+  class nonnull_span;
+
+  namespace detail
+  {
+
+    template <typename T>
+    struct is_nonnull_span
+      : std::false_type
+    { };
+
+    template <typename T, std::size_t Extent>
+    struct is_nonnull_span<nonnull_span<T, Extent>>
+      : std::true_type
+    { };
+
+    template <typename T>
+    struct is_std_array
+      : std::false_type
+    { };
+
+    template <typename T, std::size_t N>
+    struct is_std_array<std::array<T, N>>
+      : std::true_type
+    { };
+
+    template <typename C, typename = void>
+    struct span_container_element
+    { };
+
+    template <typename C>
+    struct span_container_element<
+      C,
+      typename std::enable_if<
+        std::is_pointer<decltype (std::declval<C&> ().data ())>::value
+    &&  std::is_convertible<decltype (std::declval<C&> ().size ()), std::size_t>::value>::type>
+    {
+      using type = typename std::remove_pointer<decltype (std::declval<C&> ().data ())>::type;
+    };
+
+    // Whether a span of `T` may view the elements of a container `C`.
+    template <typename T, typename C, typename = void>
+    struct is_span_compatible_container
+      : std::false_type
+    { };
+
+    template <typename T, typename C>
+    struct is_span_compatible_container<
+      T, C, typename std::enable_if<! std::is_array<C>::value
+                                &&  ! is_nonnull_span<C>::value
+                                &&  ! is_std_array<C>::value>::type>
+      : std::is_convertible<typename span_container_element<C>::type (*)[], T (*)[]>
+    { };
+
+    /**
+     * Storage for the size of a span with a static extent.
+     *
+     * @tparam Extent the extent.
+     */
+    template <std::size_t Extent>
+    class span_extent
+    {
+    public:
+      constexpr explicit
+      span_extent (std::size_t) noexcept
+      { }
+
+      GCH_NODISCARD constexpr
+      std::size_t
+      size (void) const noexcept
+      {
+        return Extent;
+      }
+    };
+
+    template <>
+    class span_extent<dynamic_extent>
+    {
+    public:
+      constexpr explicit
+      span_extent (std::size_t size) noexcept
+        : m_size (size)
+      { }
+
+      GCH_NODISCARD constexpr
+      std::size_t
+      size (void) const noexcept
+      {
+        return m_size;
+      }
+
+    private:
+      std::size_t m_size;
+    };
+
+  } // namespace detail
+
+  /**
+   * A view of a contiguous sequence of at least one object.
+   *
+   * This is like `std::span`, except that the data pointer is never null and the size is
+   * never zero. The size is checked once, when the span is created (in debug builds, or in
+   * every build through `make_nonnull_span_checked`), so `front`, `back` and `data`
+   * involve no emptiness checks. With a static `Extent` the
+   * span is a single pointer.
+   *
+   * @tparam T the element type.
+   * @tparam Extent the number of elements, or `dynamic_extent`.
+   */
+  template <typename T, std::size_t Extent>
+  class nonnull_span
+    : private detail::span_extent<Extent>
+  {
+    using extent_base = detail::span_extent<Extent>;
+
+  public:
+    static_assert (! std::is_reference<T>::value,
+      "nonnull_span expects an object type as a template argument, not a reference.");
+
+    static_assert (Extent != 0, "A nonnull_span may not be empty.");
+
+    using element_type     = T;                                  /*!< The element type */
+    using value_type       = typename std::remove_cv<T>::type;   /*!< The value type   */
+    using size_type        = std::size_t;                        /*!< The size type    */
+    using difference_type  = std::ptrdiff_t;                     /*!< The difference type */
+    using pointer          = T *;                                /*!< The pointer type */
+    using const_pointer    = const T *;                          /*!< The const pointer type */
+    using reference        = T&;                                 /*!< The reference type */
+    using const_reference  = const T&;                           /*!< The const reference type */
+    using iterator         = T *;                                /*!< The iterator type */
+    using reverse_iterator = std::reverse_iterator<iterator>;    /*!< The reverse iterator type */
+
+    /**
+     * The number of elements, or `dynamic_extent`.
+     */
+    static constexpr std::size_t extent = Extent;
+
+  private:
+    template <typename U>
+    using is_compatible_element = std::is_convertible<U (*)[], T (*)[]>;
+
+    template <std::size_t N>
+    using is_compatible_extent =
+      std::integral_constant<bool, N != 0 && (Extent == dynamic_extent || Extent == N)>;
+
+  public:
+    /**
+     * Constructor
+     *
+     * A deleted default constructor
+     */
+    nonnull_span (void) = delete;
+
+    /**
+     * Constructor
+     *
+     * A copy constructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    nonnull_span (const nonnull_span&) noexcept = default;
+
+    /**
+     * Constructor
+     *
+     * A move constructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    nonnull_span (nonnull_span&&) noexcept = default;
+
+    /**
+     * Assignment operator
+     *
+     * A copy-assignment operator.
+     *
+     * Note: TriviallyCopyable.
+     *
+     * @return `*this`
+     */
+    nonnull_span&
+    operator= (const nonnull_span&) noexcept = default;
+
+    /**
+     * Assignment operator
+     *
+     * A move-assignment operator.
+     *
+     * Note: TriviallyCopyable.
+     *
+     * @return `*this`
+     */
+    nonnull_span&
+    operator= (nonnull_span&&) noexcept = default;
+
+    /**
+     * Destructor
+     *
+     * A trivial destructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    ~nonnull_span (void) = default;
+
+    /**
+     * Constructor
+     *
+     * A constructor from a pointer to the first element and a nonzero size. If `Extent`
+     * is static, `count` must equal `Extent`. This is only checked by assertions; use
+     * `make_nonnull_span_checked` when the size comes from input.
+     *
+     * @param first a pointer to the first element.
+     * @param count the number of elements.
+     */
+    GCH_CPP14_CONSTEXPR
+    nonnull_span (nonnull_ptr<T> first, size_type count) noexcept
+      : extent_base (count),
+        m_data (first)
+    {
+      assert (count != 0 && "A nonnull_span may not be empty.");
+      assert ((Extent == dynamic_extent || count == Extent) && "The size must match the extent.");
+    }
+
+    /**
+     * Constructor
+     *
+     * A constructor from an array.
+     *
+     * @tparam N the size of the array.
+     * @param arr an array.
+     */
+    template <std::size_t N,
+              typename std::enable_if<is_compatible_extent<N>::value>::type * = nullptr>
+    constexpr GCH_IMPLICIT_CONVERSION
+    nonnull_span (element_type (&arr)[N]) noexcept
+      : extent_base (N),
+        m_data (arr[0])
+    { }
+
+    /**
+     * Constructor
+     *
+     * A constructor from a `std::array`.
+     *
+     * @tparam U the element type of the array.
+     * @tparam N the size of the array.
+     * @param arr an array.
+     */
+    template <typename U, std::size_t N,
+              typename std::enable_if<is_compatible_element<U>::value
+                                  &&  is_compatible_extent<N>::value>::type * = nullptr>
+    constexpr GCH_IMPLICIT_CONVERSION
+    nonnull_span (std::array<U, N>& arr) noexcept
+      : extent_base (N),
+        m_data (*arr.data ())
+    { }
+
+    /**
+     * Constructor
+     *
+     * A constructor from a `const std::array`.
+     *
+     * @tparam U the element type of the array.
+     * @tparam N the size of the array.
+     * @param arr an array.
+     */
+    template <typename U, std::size_t N,
+              typename std::enable_if<is_compatible_element<const U>::value
+                                  &&  is_compatible_extent<N>::value>::type * = nullptr>
+    constexpr GCH_IMPLICIT_CONVERSION
+    nonnull_span (const std::array<U, N>& arr) noexcept
+      : extent_base (N),
+        m_data (*arr.data ())
+    { }
+
+    /**
+     * Constructor
+     *
+     * A constructor from a contiguous container with `data` and `size` members. The
+     * container must not be empty. This is only checked by assertions, so it is not
+     * checked at all in release builds. It is explicit since it makes that claim. Use
+     * `make_nonnull_span_checked` for containers which may be empty.
+     *
+     * @tparam Container a container type.
+     * @param c a non-empty container.
+     */
+    template <typename Container,
+              typename std::enable_if<
+                detail::is_span_compatible_container<T, Container>::value>::type * = nullptr>
+    GCH_CPP14_CONSTEXPR explicit
+    nonnull_span (Container& c) noexcept (noexcept (c.data ()) && noexcept (c.size ()))
+      : nonnull_span (checked_data (c.data ()), static_cast<size_type> (c.size ()))
+    { }
+
+    /**
+     * Constructor
+     *
+     * A deleted constructor for the case where `c` is an rvalue.
+     */
+    template <typename Container,
+              typename = typename std::enable_if<
+                detail::is_span_compatible_container<T, Container>::value>::type>
+    nonnull_span (const Container&&) = delete;
+
+    /**
+     * Constructor
+     *
+     * A converting constructor from another `nonnull_span`. Conversions from a dynamic to
+     * a static extent are explicit.
+     *
+     * @tparam U the element type of `other`.
+     * @tparam N the extent of `other`.
+     * @param other a `nonnull_span`.
+     */
+    template <typename U, std::size_t N,
+              typename std::enable_if<is_compatible_element<U>::value
+                                  &&  (Extent == dynamic_extent || N == Extent)>::type * = nullptr>
+    constexpr GCH_IMPLICIT_CONVERSION
+    nonnull_span (const nonnull_span<U, N>& other) noexcept
+      : extent_base (other.size ()),
+        m_data (other.data ())
+    { }
+
+    /**
+     * Constructor
+     *
+     * An explicit converting constructor from a `nonnull_span` with a dynamic extent.
+     * The size of `other` must equal `Extent`.
+     *
+     * @tparam U the element type of `other`.
+     * @param other a `nonnull_span`.
+     */
+    template <typename U,
+              typename std::enable_if<is_compatible_element<U>::value
+                                  &&  Extent != dynamic_extent>::type * = nullptr>
+    GCH_CPP14_CONSTEXPR explicit
+    nonnull_span (const nonnull_span<U, dynamic_extent>& other) noexcept
+      : nonnull_span (nonnull_ptr<T> (other.data ()), other.size ())
+    { }
+
+#ifdef GCH_LIB_SPAN
+
+    /**
+     * An implicit conversion to `std::span`.
+     *
+     * @tparam U the element type of the result.
+     * @tparam N the extent of the result.
+     * @return a `std::span` of the same elements.
+     */
+    template <typename U, std::size_t N,
+              typename std::enable_if<std::is_convertible<T (*)[], U (*)[]>::value
+                                  &&  (N == std::dynamic_extent || N == Extent)>::type * = nullptr>
+    GCH_NODISCARD constexpr
+    operator std::span<U, N> (void) const noexcept
+    {
+      return std::span<U, N> (data ().get (), size ());
+    }
+
+#endif
+
+    /**
+     * Returns the number of elements.
+     *
+     * @return the number of elements, which is never zero.
+     */
+    GCH_NODISCARD constexpr
+    size_type
+    size (void) const noexcept
+    {
+      return extent_base::size ();
+    }
+
+    /**
+     * Returns the size of the sequence in bytes.
+     *
+     * @return the size of the sequence in bytes.
+     */
+    GCH_NODISCARD constexpr
+    size_type
+    size_bytes (void) const noexcept
+    {
+      return size () * sizeof (element_type);
+    }
+
+    /**
+     * Returns `false`. This is provided for generic code.
+     *
+     * @return `false`.
+     */
+    GCH_NODISCARD constexpr
+    bool
+    empty (void) const noexcept
+    {
+      return false;
+    }
+
+    /**
+     * Returns a pointer to the first element.
+     *
+     * @return a pointer to the first element.
+     */
+    GCH_NODISCARD constexpr
+    nonnull_ptr<element_type>
+    data (void) const noexcept
+    {
+      return m_data;
+    }
+
+    /**
+     * Returns the first element.
+     *
+     * @return the first element.
+     */
+    GCH_NODISCARD constexpr
+    reference
+    front (void) const noexcept
+    {
+      return *m_data;
+    }
+
+    /**
+     * Returns the last element.
+     *
+     * @return the last element.
+     */
+    GCH_NODISCARD constexpr
+    reference
+    back (void) const noexcept
+    {
+      return m_data.get ()[size () - 1];
+    }
+
+    /**
+     * Returns the element at position `idx`, which must be less than `size ()`.
+     *
+     * @param idx an index.
+     * @return the element at `idx`.
+     */
+    GCH_NODISCARD GCH_CPP14_CONSTEXPR
+    reference
+    operator[] (size_type idx) const noexcept
+    {
+      assert (idx < size () && "Index out of range.");
+      return m_data.get ()[idx];
+    }
+
+    /**
+     * Returns an iterator to the first element.
+     *
+     * @return an iterator to the first element.
+     */
+    GCH_NODISCARD constexpr
+    iterator
+    begin (void) const noexcept
+    {
+      return m_data.get ();
+    }
+
+    /**
+     * Returns an iterator past the last element.
+     *
+     * @return an iterator past the last element.
+     */
+    GCH_NODISCARD constexpr
+    iterator
+    end (void) const noexcept
+    {
+      return m_data.get () + size ();
+    }
+
+    /**
+     * Returns a reverse iterator to the last element.
+     *
+     * @return a reverse iterator to the last element.
+     */
+    GCH_NODISCARD GCH_CPP17_CONSTEXPR
+    reverse_iterator
+    rbegin (void) const noexcept
+    {
+      return reverse_iterator (end ());
+    }
+
+    /**
+     * Returns a reverse iterator before the first element.
+     *
+     * @return a reverse iterator before the first element.
+     */
+    GCH_NODISCARD GCH_CPP17_CONSTEXPR
+    reverse_iterator
+    rend (void) const noexcept
+    {
+      return reverse_iterator (begin ());
+    }
+
+    /**
+     * Returns a span of the first `Count` elements.
+     *
+     * @tparam Count the number of elements, which must be nonzero.
+     * @return a span of the first `Count` elements.
+     */
+    template <std::size_t Count>
+    GCH_NODISCARD GCH_CPP14_CONSTEXPR
+    nonnull_span<element_type, Count>
+    first (void) const noexcept
+    {
+      static_assert (Extent == dynamic_extent || Count <= Extent, "Count is out of range.");
+      assert (Count <= size () && "Count is out of range.");
+      return nonnull_span<element_type, Count> (m_data, Count);
+    }
+
+    /**
+     * Returns a span of the first `count` elements.
+     *
+     * @param count the number of elements, which must be nonzero.
+     * @return a span of the first `count` elements.
+     */
+    GCH_NODISCARD GCH_CPP14_CONSTEXPR
+    nonnull_span<element_type>
+    first (size_type count) const noexcept
+    {
+      assert (count <= size () && "Count is out of range.");
+      return nonnull_span<element_type> (m_data, count);
+    }
+
+    /**
+     * Returns a span of the last `Count` elements.
+     *
+     * @tparam Count the number of elements, which must be nonzero.
+     * @return a span of the last `Count` elements.
+     */
+    template <std::size_t Count>
+    GCH_NODISCARD GCH_CPP14_CONSTEXPR
+    nonnull_span<element_type, Count>
+    last (void) const noexcept
+    {
+      static_assert (Extent == dynamic_extent || Count <= Extent, "Count is out of range.");
+      assert (Count <= size () && "Count is out of range.");
+      return nonnull_span<element_type, Count> (element_at (size () - Count), Count);
+    }
+
+    /**
+     * Returns a span of the last `count` elements.
+     *
+     * @param count the number of elements, which must be nonzero.
+     * @return a span of the last `count` elements.
+     */
+    GCH_NODISCARD GCH_CPP14_CONSTEXPR
+    nonnull_span<element_type>
+    last (size_type count) const noexcept
+    {
+      assert (count <= size () && "Count is out of range.");
+      return nonnull_span<element_type> (element_at (size () - count), count);
+    }
+
+    /**
+     * Returns a span of `Count` elements starting at `Offset`.
+     *
+     * @tparam Offset the index of the first element.
+     * @tparam Count the number of elements, which must be nonzero.
+     * @return a span of `Count` elements starting at `Offset`.
+     */
+    template <std::size_t Offset, std::size_t Count>
+    GCH_NODISCARD GCH_CPP14_CONSTEXPR
+    nonnull_span<element_type, Count>
+    subspan (void) const noexcept
+    {
+      static_assert (Extent == dynamic_extent || (Offset < Extent && Count <= Extent - Offset),
+                     "The subspan is out of range.");
+      assert (Offset < size () && Count <= size () - Offset && "The subspan is out of range.");
+      return nonnull_span<element_type, Count> (element_at (Offset), Count);
+    }
+
+    /**
+     * Returns a span of `count` elements starting at `offset`.
+     *
+     * @param offset the index of the first element.
+     * @param count the number of elements, which must be nonzero.
+     * @return a span of `count` elements starting at `offset`.
+     */
+    GCH_NODISCARD GCH_CPP14_CONSTEXPR
+    nonnull_span<element_type>
+    subspan (size_type offset, size_type count) const noexcept
+    {
+      assert (offset < size () && count <= size () - offset && "The subspan is out of range.");
+      return nonnull_span<element_type> (element_at (offset), count);
+    }
+
+    /**
+     * Returns a span of the elements from `offset` to the end.
+     *
+     * @param offset the index of the first element, which must be less than `size ()`.
+     * @return a span of the elements from `offset` to the end.
+     */
+    GCH_NODISCARD GCH_CPP14_CONSTEXPR
+    nonnull_span<element_type>
+    subspan (size_type offset) const noexcept
+    {
+      assert (offset < size () && "The subspan is out of range.");
+      return nonnull_span<element_type> (element_at (offset), size () - offset);
+    }
+
+    /**
+     * Swap the contents with those of `other`.
+     *
+     * @param other a reference to another `nonnull_span`.
+     */
+    GCH_CPP14_CONSTEXPR
+    void
+    swap (nonnull_span& other) noexcept
+    {
+      nonnull_span tmp = *this;
+      *this = other;
+      other = tmp;
+    }
+
+  private:
+    constexpr
+    nonnull_ptr<element_type>
+    element_at (size_type idx) const noexcept
+    {
+      return nonnull_ptr<element_type> (m_data.get ()[idx]);
+    }
+
+    template <typename U>
+    static GCH_CPP14_CONSTEXPR
+    nonnull_ptr<element_type>
+    checked_data (U *ptr) noexcept
+    {
+      assert (ptr != nullptr && "The container has no data.");
+      return nonnull_ptr<element_type> (*ptr);
+    }
+
+    /**
+     * A pointer to the first element.
+     */
+    nonnull_ptr<element_type> m_data;
+  };
+
+#if ! defined (__cpp_inline_variables) || __cpp_inline_variables < 201606L
+  template <typename T, std::size_t Extent>
+  constexpr std::size_t nonnull_span<T, Extent>::extent;
+#endif
+
+  /**
+   * A swap function.
+   *
+   * @tparam T the element type.
+   * @tparam Extent the extent.
+   * @param lhs a `nonnull_span`.
+   * @param rhs a `nonnull_span`.
+   */
+  template <typename T, std::size_t Extent>
+  inline GCH_CPP14_CONSTEXPR
+  void
+  swap (nonnull_span<T, Extent>& lhs, nonnull_span<T, Extent>& rhs) noexcept
+  {
+    lhs.swap (rhs);
+  }
+
+  /**
+   * A creation function for a `nonnull_span` with a dynamic extent over a non-empty
+   * container. The container must not be empty, which is only checked by assertions.
+   *
+   * @tparam Container a contiguous container type.
+   * @param c a non-empty container.
+   * @return a `nonnull_span` of the elements of `c`.
+   */
+  template <typename Container,
+            typename T = typename detail::span_container_element<Container>::type>
+  GCH_NODISCARD inline GCH_CPP14_CONSTEXPR
+  nonnull_span<T>
+  make_nonnull_span (Container& c) noexcept (noexcept (c.data ()) && noexcept (c.size ()))
+  {
+    return nonnull_span<T> (c);
+  }
+
+  /**
+   * A deleted version for the case where `c` is an rvalue.
+   */
+  template <typename Container>
+  void
+  make_nonnull_span (const Container&& c) = delete;
+
+  /**
+   * A creation function for a `nonnull_span` with a dynamic extent.
+   *
+   * @tparam T the element type.
+   * @param first a pointer to the first element.
+   * @param count the number of elements, which must be nonzero.
+   * @return a `nonnull_span` of `count` elements starting at `first`.
+   */
+  template <typename T>
+  GCH_NODISCARD inline GCH_CPP14_CONSTEXPR
+  nonnull_span<T>
+  make_nonnull_span (nonnull_ptr<T> first, std::size_t count) noexcept
+  {
+    return nonnull_span<T> (first, count);
+  }
+
+  /**
+   * A creation function for a `nonnull_span` with a dynamic extent over a container,
+   * which checks that the container is not empty in every build.
+   *
+   * @tparam Container a contiguous container type.
+   * @param c a container.
+   * @return a `nonnull_span` of the elements of `c`.
+   * @throws std::invalid_argument if `c` is empty.
+   */
+  template <typename Container,
+            typename T = typename detail::span_container_element<Container>::type>
+  GCH_NODISCARD inline
+  nonnull_span<T>
+  make_nonnull_span_checked (Container& c)
+  {
+    if (c.size () == 0 || c.data () == nullptr)
+      throw std::invalid_argument ("A nonnull_span may not be empty.");
+    return nonnull_span<T> (c);
+  }
+
+  /**
+   * A deleted version for the case where `c` is an rvalue.
+   */
+  template <typename Container>
+  void
+  make_nonnull_span_checked (const Container&& c) = delete;
+
+  /**
+   * A creation function for a `nonnull_span` with a dynamic extent, which checks that
+   * `count` is nonzero in every build.
+   *
+   * @tparam T the element type.
+   * @param first a pointer to the first element.
+   * @param count the number of elements.
+   * @return a `nonnull_span` of `count` elements starting at `first`.
+   * @throws std::invalid_argument if `count` is zero.
+   */
+  template <typename T>
+  GCH_NODISCARD inline
+  nonnull_span<T>
+  make_nonnull_span_checked (nonnull_ptr<T> first, std::size_t count)
+  {
+    if (count == 0)
+      throw std::invalid_argument ("A nonnull_span may not be empty.");
+    return nonnull_span<T> (first, count);
+  }
+
+#ifdef GCH_CTAD_SUPPORT
+
+  template <typename T, std::size_t N>
+  nonnull_span (T (&)[N]) -> nonnull_span<T, N>;
+
+  template <typename T, std::size_t N>
+  nonnull_span (std::array<T, N>&) -> nonnull_span<T, N>;
+
+  template <typename T, std::size_t N>
+  nonnull_span (const std::array<T, N>&) -> nonnull_span<const T, N>;
+
+  template <typename T>
+  nonnull_span (nonnull_ptr<T>, std::size_t) -> nonnull_span<T>;
+
+  template <typename Container>
+  nonnull_span (Container&)
+    -> nonnull_span<typename detail::span_container_element<Container>::type>;
+
+#endif
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_NONNULL_SPAN_HPP
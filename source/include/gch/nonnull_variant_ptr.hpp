@@ -0,0 +1,532 @@
+/** nonnull_variant_ptr.hpp
+ * Defines a non-nullable pointer to one of a closed set of types, with
+ * the alternative index stored in the alignment bits of the pointer.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_NONNULL_VARIANT_PTR_HPP
+#define GCH_NONNULL_VARIANT_PTR_HPP
+
+#include "nonnull_ptr.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    [[noreturn]] inline
+    void
+    unreachable (void) noexcept
+    {
+#if defined (__GNUC__) || defined (__clang__)
+      __builtin_unreachable ();
+#elif defined (_MSC_VER)
+      __assume (0);
+#endif
+    }
+
+    template <typename T, typename ...Ts>
+    struct variant_ptr_index
+      : std::integral_constant<std::size_t, 0>
+    { };
+
+    template <typename T, typename ...Rest>
+    struct variant_ptr_index<T, T, Rest...>
+      : std::integral_constant<std::size_t, 0>
+    { };
+
+    template <typename T, typename U, typename ...Rest>
+    struct variant_ptr_index<T, U, Rest...>
+      : std::integral_constant<std::size_t, 1 + variant_ptr_index<T, Rest...>::value>
+    { };
+
+    template <std::size_t I, typename ...Ts>
+    struct variant_ptr_alternative;
+
+    template <typename T, typename ...Rest>
+    struct variant_ptr_alternative<0, T, Rest...>
+    {
+      using type = T;
+    };
+
+    template <std::size_t I, typename T, typename ...Rest>
+    struct variant_ptr_alternative<I, T, Rest...>
+      : variant_ptr_alternative<I - 1, Rest...>
+    { };
+
+    template <typename ...Ts>
+    struct variant_ptr_min_align;
+
+    template <typename T>
+    struct variant_ptr_min_align<T>
+      : std::integral_constant<std::size_t, alignof (T)>
+    { };
+
+    template <typename T, typename ...Rest>
+    struct variant_ptr_min_align<T, Rest...>
+      : std::integral_constant<std::size_t,
+                               (alignof (T) < variant_ptr_min_align<Rest...>::value)
+                             ? alignof (T)
+                             : variant_ptr_min_align<Rest...>::value>
+    { };
+
+    constexpr
+    std::size_t
+    variant_ptr_tag_bits (std::size_t count) noexcept
+    {
+      return count <= 1 ? 0 : 1 + variant_ptr_tag_bits ((count + 1) / 2);
+    }
+
+  } // namespace detail
+
+  /**
+   * A non-nullable pointer to an object whose type is one of `Ts...`.
+   *
+   * The index of the alternative is stored in the low bits of the pointer, which are
+   * always zero because of alignment, so this is the size of one pointer. Every
+   * alternative must therefore be aligned to at least the next power of two greater than
+   * or equal to `sizeof... (Ts)`.
+   *
+   * The alignment requirement is only checked when an object is bound, so the
+   * alternatives may be incomplete where the type is merely named.
+   *
+   * @tparam Ts the alternative value types, which are distinct.
+   */
+  template <typename ...Ts>
+  class nonnull_variant_ptr
+  {
+  public:
+    static_assert (sizeof... (Ts) >= 1,
+      "nonnull_variant_ptr requires at least one alternative.");
+
+    static_assert (sizeof... (Ts) <= 16,
+      "nonnull_variant_ptr supports at most 16 alternatives.");
+
+    /**
+     * The number of low bits used to store the index.
+     */
+    static constexpr std::size_t tag_bits = detail::variant_ptr_tag_bits (sizeof... (Ts));
+
+    /**
+     * The index of the alternative `T`, or `sizeof... (Ts)` if `T` is not an alternative.
+     *
+     * @tparam T a value type.
+     */
+    template <typename T>
+    using index_of = detail::variant_ptr_index<T, Ts...>;
+
+    /**
+     * The alternative at index `I`.
+     *
+     * @tparam I an index less than `sizeof... (Ts)`.
+     */
+    template <std::size_t I>
+    using alternative = typename detail::variant_ptr_alternative<I, Ts...>::type;
+
+  private:
+    static constexpr std::uintptr_t tag_mask = (std::uintptr_t (1) << tag_bits) - 1;
+
+    template <typename U>
+    using is_alternative = std::integral_constant<bool, (index_of<U>::value < sizeof... (Ts))>;
+
+    // An lvalue of `U` binds to the alternative `U`, or else to `const U`.
+    template <typename U>
+    using binding_index = std::integral_constant<std::size_t,
+                                                 is_alternative<U>::value
+                                               ? index_of<U>::value
+                                               : index_of<const U>::value>;
+
+    template <typename U>
+    using binds_to = std::integral_constant<bool, (binding_index<U>::value < sizeof... (Ts))>;
+
+    template <typename F>
+    using visit_result = decltype (std::declval<F> () (std::declval<alternative<0>&> ()));
+
+  public:
+    /**
+     * Constructor
+     *
+     * A deleted default constructor
+     */
+    nonnull_variant_ptr (void) = delete;
+
+    /**
+     * Constructor
+     *
+     * A copy constructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    nonnull_variant_ptr (const nonnull_variant_ptr&) noexcept = default;
+
+    /**
+     * Constructor
+     *
+     * A move constructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    nonnull_variant_ptr (nonnull_variant_ptr&&) noexcept = default;
+
+    /**
+     * Assignment operator
+     *
+     * A copy-assignment operator.
+     *
+     * Note: TriviallyCopyable.
+     *
+     * @return `*this`
+     */
+    nonnull_variant_ptr&
+    operator= (const nonnull_variant_ptr&) noexcept = default;
+
+    /**
+     * Assignment operator
+     *
+     * A move-assignment operator.
+     *
+     * Note: TriviallyCopyable.
+     *
+     * @return `*this`
+     */
+    nonnull_variant_ptr&
+    operator= (nonnull_variant_ptr&&) noexcept = default;
+
+    /**
+     * Destructor
+     *
+     * A trivial destructor.
+     *
+     * Note: TriviallyCopyable.
+     */
+    ~nonnull_variant_ptr (void) = default;
+
+    /**
+     * Constructor
+     *
+     * A converting constructor for lvalue references to one of the alternatives.
+     *
+     * If `U` is not an alternative but `const U` is, then the latter is held.
+     *
+     * @tparam U an alternative.
+     * @param ref an lvalue reference.
+     */
+    template <typename U,
+              typename std::enable_if<binds_to<U>::value>::type * = nullptr>
+    GCH_IMPLICIT_CONVERSION
+    nonnull_variant_ptr (U& ref) noexcept
+      : m_bits (encode<U> (&ref))
+    { }
+
+    /**
+     * Constructor
+     *
+     * A deleted constructor for the case where `ref` is an rvalue reference.
+     */
+    template <typename U,
+              typename = typename std::enable_if<binds_to<U>::value>::type>
+    nonnull_variant_ptr (const U&&) = delete;
+
+    /**
+     * Constructor
+     *
+     * A converting constructor from a `nonnull_ptr` to one of the alternatives.
+     *
+     * @tparam U an alternative.
+     * @param ptr a `nonnull_ptr`.
+     */
+    template <typename U,
+              typename std::enable_if<binds_to<U>::value>::type * = nullptr>
+    GCH_IMPLICIT_CONVERSION
+    nonnull_variant_ptr (const nonnull_ptr<U>& ptr) noexcept
+      : m_bits (encode<U> (ptr.get ()))
+    { }
+
+    /**
+     * Returns the index of the alternative which is held.
+     *
+     * @return the index.
+     */
+    GCH_NODISCARD
+    std::size_t
+    index (void) const noexcept
+    {
+      return static_cast<std::size_t> (m_bits & tag_mask);
+    }
+
+    /**
+     * Checks whether the alternative `T` is held.
+     *
+     * @tparam T an alternative.
+     * @return whether `T` is held.
+     */
+    template <typename T>
+    GCH_NODISCARD
+    bool
+    holds (void) const noexcept
+    {
+      static_assert (is_alternative<T>::value, "T must be one of the alternatives.");
+      return index () == index_of<T>::value;
+    }
+
+    /**
+     * Returns a pointer to the alternative `T`.
+     *
+     * The behavior is undefined if `T` is not held. This is checked by an assertion.
+     *
+     * @tparam T an alternative.
+     * @return a `nonnull_ptr` to the held object.
+     */
+    template <typename T>
+    GCH_NODISCARD
+    nonnull_ptr<T>
+    get (void) const noexcept
+    {
+      static_assert (is_alternative<T>::value, "T must be one of the alternatives.");
+      assert (holds<T> () && "T is not the held alternative.");
+      return nonnull_ptr<T> { *decode<T> () };
+    }
+
+    /**
+     * Returns a pointer to the alternative `T` if it is held.
+     *
+     * @tparam T an alternative.
+     * @return a pointer to the held object, or `nullptr` if `T` is not held.
+     */
+    template <typename T>
+    GCH_NODISCARD
+    T *
+    get_if (void) const noexcept
+    {
+      return holds<T> () ? decode<T> () : nullptr;
+    }
+
+    /**
+     * Calls `f` with a reference to the held object.
+     *
+     * This is a switch over the index, so it will usually compile to a jump table.
+     *
+     * @tparam F the type of a callable accepting an lvalue reference to each alternative.
+     * @param f a callable.
+     * @return the result of the call, which is of the same type for each alternative.
+     */
+    template <typename F>
+    visit_result<F>
+    visit (F&& f) const
+    {
+#define GCH_NONNULL_VARIANT_PTR_CASE(I)                                 \
+      case I:                                                           \
+        return visit_case<I> (std::forward<F> (f),                      \
+                              std::integral_constant<bool, (I < sizeof... (Ts))> { })
+
+      switch (index ())
+      {
+        GCH_NONNULL_VARIANT_PTR_CASE (0);
+        GCH_NONNULL_VARIANT_PTR_CASE (1);
+        GCH_NONNULL_VARIANT_PTR_CASE (2);
+        GCH_NONNULL_VARIANT_PTR_CASE (3);
+        GCH_NONNULL_VARIANT_PTR_CASE (4);
+        GCH_NONNULL_VARIANT_PTR_CASE (5);
+        GCH_NONNULL_VARIANT_PTR_CASE (6);
+        GCH_NONNULL_VARIANT_PTR_CASE (7);
+        GCH_NONNULL_VARIANT_PTR_CASE (8);
+        GCH_NONNULL_VARIANT_PTR_CASE (9);
+        GCH_NONNULL_VARIANT_PTR_CASE (10);
+        GCH_NONNULL_VARIANT_PTR_CASE (11);
+        GCH_NONNULL_VARIANT_PTR_CASE (12);
+        GCH_NONNULL_VARIANT_PTR_CASE (13);
+        GCH_NONNULL_VARIANT_PTR_CASE (14);
+        GCH_NONNULL_VARIANT_PTR_CASE (15);
+        default:
+          detail::unreachable ();
+      }
+
+#undef GCH_NONNULL_VARIANT_PTR_CASE
+    }
+
+    /**
+     * Swap the contents with those of `other`.
+     *
+     * @param other a reference to another `nonnull_variant_ptr`.
+     */
+    void
+    swap (nonnull_variant_ptr& other) noexcept
+    {
+      const std::uintptr_t tmp = m_bits;
+      m_bits       = other.m_bits;
+      other.m_bits = tmp;
+    }
+
+    /**
+     * Returns the address of the held object.
+     *
+     * @return the untagged pointer.
+     */
+    GCH_NODISCARD
+    const void *
+    address (void) const noexcept
+    {
+      return reinterpret_cast<const void *> (m_bits & ~tag_mask);
+    }
+
+  private:
+    template <typename U>
+    static
+    std::uintptr_t
+    encode (U *ptr) noexcept
+    {
+      static_assert (detail::variant_ptr_min_align<Ts...>::value >= (std::size_t (1) << tag_bits),
+        "All alternatives must be aligned enough to leave room for the index.");
+      return reinterpret_cast<std::uintptr_t> (ptr) | binding_index<U>::value;
+    }
+
+    template <typename T>
+    T *
+    decode (void) const noexcept
+    {
+      return reinterpret_cast<T *> (m_bits & ~tag_mask);
+    }
+
+    template <std::size_t I, typename F>
+    visit_result<F>
+    visit_case (F&& f, std::true_type) const
+    {
+      return std::forward<F> (f) (*decode<alternative<I>> ());
+    }
+
+    template <std::size_t I, typename F>
+    [[noreturn]]
+    visit_result<F>
+    visit_case (F&&, std::false_type) const
+    {
+      detail::unreachable ();
+    }
+
+    /**
+     * The pointer to the object, tagged with the index in its low bits.
+     */
+    std::uintptr_t m_bits;
+  };
+
+  /**
+   * An equality comparison function.
+   *
+   * @tparam Ts the alternatives.
+   * @param lhs a `nonnull_variant_ptr`.
+   * @param rhs a `nonnull_variant_ptr`.
+   * @return whether both refer to the same object as the same alternative.
+   */
+  template <typename ...Ts>
+  GCH_NODISCARD inline
+  bool
+  operator== (const nonnull_variant_ptr<Ts...>& lhs, const nonnull_variant_ptr<Ts...>& rhs)
+    noexcept
+  {
+    return lhs.address () == rhs.address () && lhs.index () == rhs.index ();
+  }
+
+  /**
+   * An inequality comparison function.
+   *
+   * @tparam Ts the alternatives.
+   * @param lhs a `nonnull_variant_ptr`.
+   * @param rhs a `nonnull_variant_ptr`.
+   * @return whether the two refer to different objects or alternatives.
+   */
+  template <typename ...Ts>
+  GCH_NODISCARD inline
+  bool
+  operator!= (const nonnull_variant_ptr<Ts...>& lhs, const nonnull_variant_ptr<Ts...>& rhs)
+    noexcept
+  {
+    return ! (lhs == rhs);
+  }
+
+  /**
+   * A swap function.
+   *
+   * @tparam Ts the alternatives.
+   * @param lhs a `nonnull_variant_ptr`.
+   * @param rhs a `nonnull_variant_ptr`.
+   */
+  template <typename ...Ts>
+  inline
+  void
+  swap (nonnull_variant_ptr<Ts...>& lhs, nonnull_variant_ptr<Ts...>& rhs) noexcept
+  {
+    lhs.swap (rhs);
+  }
+
+  /**
+   * Calls `f` with a reference to the object held by `v`.
+   *
+   * @tparam F the type of the visitor.
+   * @tparam Ts the alternatives.
+   * @param f a callable accepting an lvalue reference to each alternative.
+   * @param v a `nonnull_variant_ptr`.
+   * @return the result of the call.
+   */
+  template <typename F, typename ...Ts>
+  inline
+  auto
+  visit (F&& f, const nonnull_variant_ptr<Ts...>& v)
+    -> decltype (v.visit (std::forward<F> (f)))
+  {
+    return v.visit (std::forward<F> (f));
+  }
+
+  /**
+   * Checks whether `v` holds the alternative `T`.
+   *
+   * @tparam T an alternative.
+   * @tparam Ts the alternatives.
+   * @param v a `nonnull_variant_ptr`.
+   * @return whether `T` is held.
+   */
+  template <typename T, typename ...Ts>
+  GCH_NODISCARD inline
+  bool
+  holds_alternative (const nonnull_variant_ptr<Ts...>& v) noexcept
+  {
+    return v.template holds<T> ();
+  }
+
+  /**
+   * Returns a pointer to the alternative `T` if it is held by `v`.
+   *
+   * @tparam T an alternative.
+   * @tparam Ts the alternatives.
+   * @param v a `nonnull_variant_ptr`.
+   * @return a pointer to the held object, or `nullptr` if `T` is not held.
+   */
+  template <typename T, typename ...Ts>
+  GCH_NODISCARD inline
+  T *
+  get_if (const nonnull_variant_ptr<Ts...>& v) noexcept
+  {
+    return v.template get_if<T> ();
+  }
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_NONNULL_VARIANT_PTR_HPP
@@ -0,0 +1,182 @@
+/** nonnull_views.hpp
+ * Defines range adaptors between ranges of objects, ranges of nullable
+ * pointers, and ranges of nonnull_ptr.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_NONNULL_VIEWS_HPP
+#define GCH_NONNULL_VIEWS_HPP
+
+#include "nonnull_ptr.hpp"
+
+#include <cassert>
+#include <type_traits>
+#include <utility>
+
+#if defined (GCH_LIB_CONCEPTS) && defined (__has_include)
+#  if __has_include (<ranges>)
+#    include <ranges>
+#    if defined (__cpp_lib_ranges) && __cpp_lib_ranges >= 201911L
+#      ifndef GCH_LIB_RANGES
+#        define GCH_LIB_RANGES
+#      endif
+#    endif
+#  endif
+#endif
+
+#ifdef GCH_LIB_RANGES
+
+#include <algorithm>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  namespace detail
+  {
+
+    /**
+     * Maps an lvalue to a `nonnull_ptr` to it.
+     */
+    struct addressof_fn
+    {
+      template <typename T>
+      GCH_NODISCARD constexpr
+      nonnull_ptr<T>
+      operator() (T& ref) const noexcept
+      {
+        return nonnull_ptr<T> (ref);
+      }
+
+      template <typename T>
+      void
+      operator() (const T&&) const = delete;
+    };
+
+    /**
+     * Maps a nullable pointer-like object to a `nonnull_ptr` to its pointee.
+     */
+    struct nonnull_fn
+    {
+      template <typename P>
+        requires requires (const P& p) { *p; p == nullptr; }
+              &&  std::is_lvalue_reference_v<decltype (*std::declval<const P&> ())>
+      GCH_NODISCARD constexpr
+      nonnull_ptr<std::remove_reference_t<decltype (*std::declval<const P&> ())>>
+      operator() (const P& p) const noexcept (noexcept (*p))
+      {
+        assert (! (p == nullptr) && "The range contains a null pointer.");
+        return nonnull_ptr<std::remove_reference_t<decltype (*p)>> (*p);
+      }
+    };
+
+    /**
+     * Dereferences a pointer-like object.
+     */
+    struct deref_fn
+    {
+      template <typename P>
+        requires std::is_lvalue_reference_v<decltype (*std::declval<const P&> ())>
+      GCH_NODISCARD constexpr
+      decltype (auto)
+      operator() (const P& p) const noexcept (noexcept (*p))
+      {
+        return *p;
+      }
+    };
+
+    /**
+     * A range adaptor closure which applies `Fn` to each element.
+     *
+     * The result is a `std::ranges::transform_view`, so after inlining the loop is the
+     * same as one over the underlying range.
+     *
+     * @tparam Fn an empty function object type.
+     */
+    template <typename Fn>
+    struct transform_closure
+    {
+      template <std::ranges::viewable_range R>
+        requires std::regular_invocable<const Fn&, std::ranges::range_reference_t<R>>
+      GCH_NODISCARD constexpr
+      auto
+      operator() (R&& r) const
+      {
+        return std::views::transform (std::forward<R> (r), Fn { });
+      }
+
+      template <std::ranges::viewable_range R>
+        requires std::regular_invocable<const Fn&, std::ranges::range_reference_t<R>>
+      GCH_NODISCARD friend constexpr
+      auto
+      operator| (R&& r, const transform_closure& self)
+      {
+        return self (std::forward<R> (r));
+      }
+    };
+
+  } // namespace detail
+
+  namespace views
+  {
+
+    /**
+     * A range adaptor from a range of lvalues to a range of `nonnull_ptr` to them.
+     *
+     * For example, `deque | gch::views::addressof` is a range of `nonnull_ptr<T>`.
+     */
+    inline constexpr detail::transform_closure<detail::addressof_fn> addressof { };
+
+    /**
+     * A range adaptor from a range of nullable pointers (such as `T *` or
+     * `std::unique_ptr<T>`) to a range of `nonnull_ptr` to their pointees.
+     *
+     * The pointers are trusted to be non-null. This is asserted for each element in debug
+     * builds, but not checked otherwise. Use `all_nonnull` to validate a range once before
+     * adapting it.
+     */
+    inline constexpr detail::transform_closure<detail::nonnull_fn> nonnull { };
+
+    /**
+     * A range adaptor from a range of `nonnull_ptr` (or other pointers) to a range of
+     * references to their pointees.
+     */
+    inline constexpr detail::transform_closure<detail::deref_fn> deref { };
+
+  } // namespace views
+
+  /**
+   * Checks that no element of a range of nullable pointers is null.
+   *
+   * @tparam R a range type.
+   * @param r a range of nullable pointers.
+   * @return whether every element of `r` is non-null.
+   */
+  template <std::ranges::input_range R>
+    requires requires (std::ranges::range_reference_t<R> p) { p == nullptr; }
+  GCH_NODISCARD constexpr
+  bool
+  all_nonnull (R&& r)
+  {
+    return std::ranges::none_of (r, [] (const auto& p) noexcept (noexcept (p == nullptr)) {
+      return p == nullptr;
+    });
+  }
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_LIB_RANGES
+
+#endif // GCH_NONNULL_VIEWS_HPP
@@ -0,0 +1,311 @@
+/** work_stealing_deque.hpp
+ * Defines a Chase-Lev work-stealing deque of nonnull_ptr which uses null as
+ * its empty result.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_WORK_STEALING_DEQUE_HPP
+#define GCH_WORK_STEALING_DEQUE_HPP
+
+#include "nonnull_ptr.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic push
+#  pragma clang diagnostic ignored "-Wdocumentation" // Ignore @tparam warnings.
+#endif
+
+namespace gch
+{
+
+  /**
+   * A lock-free work-stealing deque of `nonnull_ptr<T>`, after Chase and Lev, with the
+   * memory orderings of Lê, Pop, Cohen and Zappa Nardelli.
+   *
+   * One thread, the owner, pushes and pops at the bottom. Any thread may steal from the
+   * top. Since the elements are never null, `pop` and `steal` return a plain pointer
+   * which is null when there was nothing to take, so no `std::optional` is needed.
+   *
+   * The buffer is a ring which doubles when full. Thieves may still be reading a buffer
+   * after the owner has replaced it, so replaced buffers are retired rather than freed.
+   * Each steal counts itself in while it uses a buffer, and the owner frees the retired
+   * buffers on a later `push` once it sees no steal in flight. A steal which starts after
+   * that can only load the current buffer.
+   *
+   * @tparam T the pointee type.
+   */
+  template <typename T>
+  class work_stealing_deque
+  {
+    class buffer
+    {
+    public:
+      explicit
+      buffer (std::size_t capacity)
+        : m_mask (capacity - 1),
+          m_slots (new std::atomic<T *>[capacity])
+      {
+        assert ((capacity & m_mask) == 0 && "The capacity must be a power of two.");
+      }
+
+      std::size_t
+      capacity (void) const noexcept
+      {
+        return m_mask + 1;
+      }
+
+      T *
+      get (std::int64_t i) const noexcept
+      {
+        return m_slots[static_cast<std::size_t> (i) & m_mask].load (std::memory_order_relaxed);
+      }
+
+      void
+      put (std::int64_t i, T *p) noexcept
+      {
+        m_slots[static_cast<std::size_t> (i) & m_mask].store (p, std::memory_order_relaxed);
+      }
+
+    private:
+      std::size_t                         m_mask;
+      std::unique_ptr<std::atomic<T *>[]> m_slots;
+    };
+
+  public:
+    using value_type = nonnull_ptr<T>; /*!< The element type */
+    using size_type  = std::size_t;    /*!< The size type    */
+
+    /**
+     * Constructor
+     *
+     * Creates an empty deque.
+     *
+     * @param capacity the initial capacity, which is rounded up to a power of two.
+     */
+    explicit
+    work_stealing_deque (size_type capacity = 64)
+      : m_top (0),
+        m_bottom (0),
+        m_buffer (new buffer (round_up (capacity))),
+        m_thieves (0)
+    { }
+
+    /**
+     * Deques are neither copyable nor movable, since other threads refer to them.
+     */
+    work_stealing_deque (const work_stealing_deque&) = delete;
+
+    /**
+     * Deques are neither copyable nor movable, since other threads refer to them.
+     */
+    work_stealing_deque&
+    operator= (const work_stealing_deque&) = delete;
+
+    /**
+     * Destructor
+     *
+     * Frees the buffers. No other thread may be using the deque.
+     */
+    ~work_stealing_deque (void)
+    {
+      delete m_buffer.load (std::memory_order_relaxed);
+    }
+
+    /**
+     * Pushes `p` onto the bottom. Only the owner may call this. It allocates only when
+     * the buffer is full, and frees retired buffers once no steal is in flight.
+     *
+     * @param p a pointer.
+     */
+    void
+    push (nonnull_ptr<T> p)
+    {
+      const std::int64_t b = m_bottom.load (std::memory_order_relaxed);
+      const std::int64_t t = m_top.load (std::memory_order_acquire);
+      buffer *a = m_buffer.load (std::memory_order_relaxed);
+      if (static_cast<std::uint64_t> (b - t) >= a->capacity ())
+        a = grow (*a, t, b);
+      else if (! m_retired.empty ())
+        reclaim ();
+
+      a->put (b, p.get ());
+      std::atomic_thread_fence (std::memory_order_release);
+      m_bottom.store (b + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Pops from the bottom. Only the owner may call this.
+     *
+     * @return the most recently pushed pointer, or null if the deque was empty or a thief
+     *         took the last element first.
+     */
+    GCH_NODISCARD
+    T *
+    pop (void) noexcept
+    {
+      const std::int64_t b = m_bottom.load (std::memory_order_relaxed) - 1;
+      buffer *a = m_buffer.load (std::memory_order_relaxed);
+      m_bottom.store (b, std::memory_order_relaxed);
+      std::atomic_thread_fence (std::memory_order_seq_cst);
+      std::int64_t t = m_top.load (std::memory_order_relaxed);
+
+      if (t > b)
+      {
+        m_bottom.store (b + 1, std::memory_order_relaxed);
+        return nullptr;
+      }
+
+      T *p = a->get (b);
+      if (t == b)
+      {
+        // This is the last element, so race the thieves for it.
+        if (! m_top.compare_exchange_strong (t, t + 1, std::memory_order_seq_cst,
+                                             std::memory_order_relaxed))
+          p = nullptr;
+        m_bottom.store (b + 1, std::memory_order_relaxed);
+      }
+      return p;
+    }
+
+    /**
+     * Steals from the top. Any thread may call this.
+     *
+     * @return the least recently pushed pointer, or null if the deque was empty or
+     *         another thread took the element first.
+     */
+    GCH_NODISCARD
+    T *
+    steal (void) noexcept
+    {
+      std::int64_t t = m_top.load (std::memory_order_acquire);
+      std::atomic_thread_fence (std::memory_order_seq_cst);
+      const std::int64_t b = m_bottom.load (std::memory_order_acquire);
+
+      if (t >= b)
+        return nullptr;
+
+      // Announce the steal before loading the buffer, so that the owner does not free it
+      // while it is read. This pairs with the store and load in `reclaim`.
+      m_thieves.fetch_add (1, std::memory_order_seq_cst);
+      T *p = m_buffer.load (std::memory_order_seq_cst)->get (t);
+      m_thieves.fetch_sub (1, std::memory_order_release);
+
+      if (! m_top.compare_exchange_strong (t, t + 1, std::memory_order_seq_cst,
+                                           std::memory_order_relaxed))
+        return nullptr;
+      return p;
+    }
+
+    /**
+     * Returns whether the deque appeared empty. The result may be stale by the time it is
+     * used if other threads are active.
+     *
+     * @return whether the deque appeared empty.
+     */
+    GCH_NODISCARD
+    bool
+    empty (void) const noexcept
+    {
+      return size () == 0;
+    }
+
+    /**
+     * Returns the number of elements. The result may be stale by the time it is used if
+     * other threads are active.
+     *
+     * @return the number of elements.
+     */
+    GCH_NODISCARD
+    size_type
+    size (void) const noexcept
+    {
+      const std::int64_t b = m_bottom.load (std::memory_order_relaxed);
+      const std::int64_t t = m_top.load (std::memory_order_relaxed);
+      return b > t ? static_cast<size_type> (b - t) : 0;
+    }
+
+    /**
+     * Returns the capacity of the current buffer. Only the owner may call this.
+     *
+     * @return the capacity.
+     */
+    GCH_NODISCARD
+    size_type
+    capacity (void) const noexcept
+    {
+      return m_buffer.load (std::memory_order_relaxed)->capacity ();
+    }
+
+  private:
+    static
+    size_type
+    round_up (size_type capacity) noexcept
+    {
+      size_type result = 1;
+      while (result < capacity)
+        result *= 2;
+      return result;
+    }
+
+    buffer *
+    grow (buffer& old, std::int64_t t, std::int64_t b)
+    {
+      // Make room first so that retiring `old` cannot throw after it is replaced.
+      m_retired.reserve (m_retired.size () + 1);
+      std::unique_ptr<buffer> next (new buffer (2 * old.capacity ()));
+      for (std::int64_t i = t; i < b; ++i)
+        next->put (i, old.get (i));
+
+      m_buffer.store (next.get (), std::memory_order_seq_cst);
+      m_retired.emplace_back (&old);
+      buffer *result = next.release ();
+      reclaim ();
+      return result;
+    }
+
+    /**
+     * Frees the retired buffers if no steal is in flight.
+     *
+     * Every retired buffer was replaced before this load. If it sees no thieves, then
+     * any steal which had loaded a retired buffer has finished with it, and any later
+     * steal announces itself after this load and so loads a newer buffer.
+     */
+    void
+    reclaim (void) noexcept
+    {
+      if (m_thieves.load (std::memory_order_seq_cst) == 0)
+        m_retired.clear ();
+    }
+
+    alignas (64) std::atomic<std::int64_t> m_top;
+    alignas (64) std::atomic<std::int64_t> m_bottom;
+    std::atomic<buffer *>                  m_buffer;
+
+    /**
+     * The number of steals which may be reading a buffer.
+     */
+    alignas (64) std::atomic<std::size_t> m_thieves;
+
+    /**
+     * Buffers which have been replaced, kept until no thief can still read them.
+     */
+    std::vector<std::unique_ptr<buffer>> m_retired;
+  };
+
+} // namespace gch
+
+#ifdef GCH_CLANG
+#  pragma clang diagnostic pop
+#endif
+
+#endif // GCH_WORK_STEALING_DEQUE_HPP
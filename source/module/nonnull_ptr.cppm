@@ -0,0 +1,46 @@
+/** nonnull_ptr.cppm
+ * The module gch.nonnull_ptr, which exports nonnull_ptr and its free
+ * functions.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+module;
+
+#include "gch/nonnull_ptr.hpp"
+
+export module gch.nonnull_ptr;
+
+export
+namespace gch
+{
+
+  using gch::nonnull_ptr;
+  using gch::nonnull_cptr;
+  using gch::make_nonnull_ptr;
+  using gch::swap;
+
+  using gch::operator==;
+  using gch::operator!=;
+  using gch::operator<;
+  using gch::operator>;
+  using gch::operator<=;
+  using gch::operator>=;
+#ifdef GCH_LIB_THREE_WAY_COMPARISON
+  using gch::operator<=>;
+#endif
+
+}
+
+// Declarations in the global module fragment which nothing in the module refers to may be
+// discarded, and nothing here names the specialization of std::hash. Naming one of its
+// instances keeps it reachable, so that importers can hash a nonnull_ptr.
+namespace gch::detail
+{
+
+  using nonnull_ptr_hash_anchor = std::hash<nonnull_ptr<const void>>;
+
+}
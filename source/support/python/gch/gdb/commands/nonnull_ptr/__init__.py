@@ -0,0 +1,8 @@
+import gdb
+
+def register_commands():
+  from .locality import NonnullPtrPrefixCommand, NonnullPtrLocalityCommand
+  NonnullPtrPrefixCommand()
+  NonnullPtrLocalityCommand()
+
+register_commands()
@@ -0,0 +1,525 @@
+import gdb
+import re
+import struct
+
+_NONNULL_PTR_RE = re.compile(r'^gch::nonnull_ptr<.*>$')
+_VECTOR_RE = re.compile(r'^std::(__\w+::)?vector<.*>$')
+
+# The members which hold the bounds of a std::vector, for libstdc++ and libc++.
+_VECTOR_BOUNDS = (('_M_start', '_M_finish'), ('__begin_', '__end_'))
+
+# Spans which are at most this far apart are read together.
+_MERGE_GAP = 4096
+
+# Spans are not merged past this size, so that a read never pulls in much more than it needs.
+_MAX_MERGED_READ = 1 << 24
+
+# How deep to look into the members of a type for nonnull_ptrs.
+_MAX_MEMBER_DEPTH = 16
+
+class Layout(object):
+  'Where the nonnull_ptrs are in an object of some type'
+
+  def __init__(self, name, size):
+    self.name = name
+    self.size = size
+    self.pointers = []  # (offset, pointee layout)
+    self.arrays = []    # (offset, count, element layout)
+    self.vectors = []   # (begin offset, end offset, element layout)
+    self.holds_pointers = False
+
+  def empty(self):
+    return not self.holds_pointers
+
+  def bare_pointer(self, pointer_size):
+    'Check whether this is exactly one nonnull_ptr, so that arrays of it can be unpacked at once.'
+    return (self.size == pointer_size and len(self.pointers) == 1 and self.pointers[0][0] == 0
+            and not self.arrays and not self.vectors)
+
+def _find_member(t, name, depth=0):
+  '''Find the first member called `name` in `t` or in its bases and members.
+
+  Returns (byte offset, type), or None.'''
+  t = t.strip_typedefs()
+  if depth > _MAX_MEMBER_DEPTH or t.code not in (gdb.TYPE_CODE_STRUCT, gdb.TYPE_CODE_UNION):
+    return None
+  for f in t.fields():
+    if hasattr(f, 'bitpos') and f.name == name:
+      return f.bitpos // 8, f.type
+  for f in t.fields():
+    if not hasattr(f, 'bitpos'):
+      continue
+    found = _find_member(f.type, name, depth + 1)
+    if found is not None:
+      return f.bitpos // 8 + found[0], found[1]
+  return None
+
+class LayoutCache(object):
+  'Layouts of the types seen so far, which may refer to each other'
+
+  def __init__(self):
+    self.layouts = {}
+    self.pending = 0
+
+  def get(self, t):
+    t = t.strip_typedefs().unqualified()
+    name = str(t)
+    layout = self.layouts.get(name)
+    if layout is None:
+      try:
+        size = t.sizeof
+      except gdb.error:
+        size = 0
+      layout = Layout(name, size)
+      # This goes in before the members are collected, so that recursive types terminate.
+      self.layouts[name] = layout
+      self.pending += 1
+      self._collect(t, 0, layout, 0)
+      self.pending -= 1
+      if self.pending == 0:
+        self._mark_holders()
+    return layout
+
+  def _mark_holders(self):
+    '''Mark the layouts which lead to a nonnull_ptr.
+
+    This waits until the layouts are complete, since those of recursive types refer to each
+    other while they are being collected.'''
+    changed = True
+    while changed:
+      changed = False
+      for layout in self.layouts.values():
+        if not layout.holds_pointers and (
+            layout.pointers
+            or any(e.holds_pointers for _, _, e in layout.arrays)
+            or any(e.holds_pointers for _, _, e in layout.vectors)):
+          layout.holds_pointers = True
+          changed = True
+
+  def _collect(self, t, offset, layout, depth):
+    t = t.strip_typedefs()
+    if depth > _MAX_MEMBER_DEPTH:
+      return
+
+    if t.code == gdb.TYPE_CODE_ARRAY:
+      low, high = t.range()
+      element = self.get(t.target())
+      if high >= low and element.size > 0:
+        layout.arrays.append((offset, high - low + 1, element))
+      return
+
+    # Members of a union overlap, so there is no telling which one is live.
+    if t.code != gdb.TYPE_CODE_STRUCT:
+      return
+
+    name = str(t.unqualified())
+    if _NONNULL_PTR_RE.match(name):
+      ptr = _find_member(t, 'm_ptr')
+      if ptr is not None:
+        layout.pointers.append((offset + ptr[0], self.get(ptr[1].strip_typedefs().target())))
+      return
+
+    if _VECTOR_RE.match(name):
+      for begin_name, end_name in _VECTOR_BOUNDS:
+        begin = _find_member(t, begin_name)
+        end = _find_member(t, end_name)
+        if begin is not None and end is not None:
+          element = self.get(begin[1].strip_typedefs().target())
+          if element.size > 0:
+            layout.vectors.append((offset + begin[0], offset + end[0], element))
+          return
+      return
+
+    for f in t.fields():
+      if hasattr(f, 'bitpos'):
+        self._collect(f.type, offset + f.bitpos // 8, layout, depth + 1)
+
+def _format_size(n):
+  for unit in ('B', 'KiB', 'MiB', 'GiB', 'TiB'):
+    if n < 1024 or unit == 'TiB':
+      return f'{n:g} {unit}' if unit == 'B' else f'{n:.1f} {unit}'
+    n /= 1024
+
+def _format_power(k):
+  'Format 2**k as a size with no fraction.'
+  units = ('B', 'KiB', 'MiB', 'GiB', 'TiB', 'PiB', 'EiB')
+  return f'{1 << (k % 10)} {units[k // 10]}'
+
+def _fan_in_bucket(count):
+  'Put 1, 2, 3-4, 5-8, ... in buckets 0, 1, 2, 3, ...'
+  return (count - 1).bit_length()
+
+class _TypeStats(object):
+  def __init__(self, name, size):
+    self.name = name
+    self.size = size
+    self.edges = 0
+    self.pointees = set()
+
+class LocalityStats(object):
+  'Statistics over the addresses held by a set of nonnull_ptrs'
+
+  def __init__(self, line_size, page_size):
+    self.line_size = line_size
+    self.page_size = page_size
+    self.edges = 0
+    self.nodes = 0
+    self.reads = 0
+    self.bytes_read = 0
+    self.unreadable = 0
+    self.null = 0
+    self.truncated = False
+    self.fan_in = {}
+    self.types = {}
+    self.distances = {}
+    self.pairs = 0
+    self.forward = 0
+    self.same_line = 0
+    self.same_page = 0
+
+  def add_sequence(self, pointees):
+    '''Add the pointees of nonnull_ptrs which are next to each other, in order.
+
+    `pointees` holds (address, layout) for each nonnull_ptr, where the layout has the name and
+    size of the pointee type.'''
+    # This runs for every nonnull_ptr, so the attributes are looked up once.
+    fan_in = self.fan_in
+    types = self.types
+    distances = self.distances
+    line_size = self.line_size
+    page_size = self.page_size
+    previous = None
+    t = None
+    null = 0
+    for address, pointee in pointees:
+      if address == 0:
+        # A nonnull_ptr is never null, so this is a corrupt or uninitialized object.
+        null += 1
+        previous = None
+        continue
+
+      fan_in[address] = fan_in.get(address, 0) + 1
+
+      if t is None or t.name != pointee.name:
+        t = types.get(pointee.name)
+        if t is None:
+          t = types[pointee.name] = _TypeStats(pointee.name, pointee.size)
+      t.edges += 1
+      t.pointees.add(address)
+
+      if previous is not None:
+        distance = address - previous
+        if distance > 0:
+          self.forward += 1
+        if address // line_size == previous // line_size:
+          self.same_line += 1
+        if address // page_size == previous // page_size:
+          self.same_page += 1
+        bucket = abs(distance).bit_length()
+        distances[bucket] = distances.get(bucket, 0) + 1
+        self.pairs += 1
+      previous = address
+    self.null += null
+    self.edges += len(pointees) - null
+
+  @staticmethod
+  def _spread(pointees, size, unit):
+    'Count the units which the objects touch.'
+    units = set()
+    for address in pointees:
+      first = address // unit
+      last = (address + max(size, 1) - 1) // unit
+      units.update(range(first, last + 1))
+    return len(units)
+
+  def report(self, write, title, top):
+    write(f'nonnull_ptr locality of {title}\n')
+    write(f'  nonnull_ptrs:   {self.edges}\n')
+    write(f'  pointees:       {len(self.fan_in)}\n')
+    write(f'  objects walked: {self.nodes}\n')
+    write(f'  memory read:    {_format_size(self.bytes_read)} in {self.reads} reads\n')
+    if self.null:
+      write(f'  null pointers:  {self.null} (the memory is likely corrupt)\n')
+    if self.unreadable:
+      write(f'  unreadable:     {self.unreadable} objects\n')
+    if self.truncated:
+      write('  (stopped at the limit; pass -limit to walk further)\n')
+    if not self.edges:
+      return
+
+    low = min(self.fan_in)
+    high = max(self.fan_in)
+    write(f'  address span:   {low:#x} - {high:#x} ({_format_size(high - low)})\n')
+
+    write('\nPointee types:\n')
+    write(f'  {"edges":>10} {"pointees":>10} {"size":>6} {"lines":>10} {"line use":>8} '
+          f'{"pages":>8} {"page use":>8}  type\n')
+    for name, t in sorted(self.types.items(), key=lambda kv: -kv[1].edges):
+      lines = self._spread(t.pointees, t.size, self.line_size)
+      pages = self._spread(t.pointees, t.size, self.page_size)
+      # The share of the memory in the touched lines and pages that the pointees take up.
+      used = len(t.pointees) * t.size
+      line_use = 100.0 * min(used / (lines * self.line_size), 1.0)
+      page_use = 100.0 * min(used / (pages * self.page_size), 1.0)
+      write(f'  {t.edges:>10} {len(t.pointees):>10} {t.size:>6} {lines:>10} {line_use:>7.1f}% '
+            f'{pages:>8} {page_use:>7.1f}%  {name}\n')
+
+    if self.pairs:
+      write(f'\nDistance between consecutive pointees ({self.pairs} pairs):\n')
+      write(f'  forward:        {100.0 * self.forward / self.pairs:.1f}%\n')
+      write(f'  same line:      {100.0 * self.same_line / self.pairs:.1f}%\n')
+      write(f'  same page:      {100.0 * self.same_page / self.pairs:.1f}%\n')
+      peak = max(self.distances.values())
+      for bucket in sorted(self.distances):
+        count = self.distances[bucket]
+        if bucket == 0:
+          label = '0'
+        else:
+          label = f'[{_format_power(bucket - 1)}, {_format_power(bucket)})'
+        bar = '#' * max(1, 40 * count // peak)
+        write(f'  {label:>22} {count:>10}  {bar}\n')
+
+    fan_in = {}
+    for count in self.fan_in.values():
+      bucket = _fan_in_bucket(count)
+      fan_in[bucket] = fan_in.get(bucket, 0) + 1
+    write('\nFan-in (nonnull_ptrs per pointee):\n')
+    for bucket in sorted(fan_in):
+      if bucket == 0:
+        label = '1'
+      else:
+        first = (1 << (bucket - 1)) + 1
+        last = 1 << bucket
+        label = f'{first}' if first == last else f'{first}-{last}'
+      write(f'  {label:>22} {fan_in[bucket]:>10}\n')
+
+    if top > 0:
+      owners = {}
+      for name, t in self.types.items():
+        for address in t.pointees:
+          owners.setdefault(address, name)
+      write('\nMost referenced pointees:\n')
+      ranked = sorted(self.fan_in.items(), key=lambda kv: (-kv[1], kv[0]))[:top]
+      for address, count in ranked:
+        write(f'  {address:#22x} {count:>10}  {owners[address]}\n')
+
+def _try_read(read_memory, address, size, stats):
+  try:
+    data = memoryview(read_memory(address, size))
+  except gdb.MemoryError:
+    return None
+  stats.reads += 1
+  stats.bytes_read += size
+  return data
+
+def read_spans(read_memory, spans, stats):
+  '''Read the spans with as few reads as possible.
+
+  `spans` holds (address, size, payload). Spans which are close together are read at once.
+  Yields (payload, address, memoryview) for each span that could be read.'''
+  spans.sort(key=lambda s: s[0])
+  i = 0
+  while i < len(spans):
+    start = spans[i][0]
+    end = start + spans[i][1]
+    j = i + 1
+    while j < len(spans) and spans[j][0] <= end + _MERGE_GAP:
+      next_end = max(end, spans[j][0] + spans[j][1])
+      if next_end - start > _MAX_MERGED_READ:
+        break
+      end = next_end
+      j += 1
+
+    group = spans[i:j]
+    i = j
+    data = _try_read(read_memory, start, end - start, stats)
+    if data is not None:
+      for address, size, payload in group:
+        yield payload, address, data[address - start:address - start + size]
+      continue
+
+    if len(group) == 1:
+      stats.unreadable += 1
+      continue
+
+    # Some part of the merged range is unmapped, so read the spans one at a time.
+    for address, size, payload in group:
+      data = _try_read(read_memory, address, size, stats)
+      if data is not None:
+        yield payload, address, data
+      else:
+        stats.unreadable += 1
+
+class Walker(object):
+  'Walk the nonnull_ptrs which are reachable from an object'
+
+  def __init__(self, read_memory, pointer_size, little_endian, stats, limit, depth):
+    self.read_memory = read_memory
+    self.pointer_size = pointer_size
+    self.pointer_format = ('<' if little_endian else '>') + ('Q' if pointer_size == 8 else 'I')
+    self.stats = stats
+    self.limit = limit
+    self.depth = depth
+    self.visited = set()
+
+  def _unpack(self, data, offset):
+    return struct.unpack_from(self.pointer_format, data, offset)[0]
+
+  def _scan(self, layout, data, offset, sequence, children, ranges):
+    'Collect the nonnull_ptrs of one object, along with the ranges held by its vectors.'
+    for member_offset, pointee in layout.pointers:
+      address = self._unpack(data, offset + member_offset)
+      sequence.append((address, pointee))
+    for member_offset, count, element in layout.arrays:
+      if element.empty():
+        continue
+      self._scan_elements(element, data, offset + member_offset, count, sequence, children,
+                          ranges)
+    for begin_offset, end_offset, element in layout.vectors:
+      begin = self._unpack(data, offset + begin_offset)
+      end = self._unpack(data, offset + end_offset)
+      if not element.empty() and begin != 0 and begin <= end:
+        ranges.append((begin, (end - begin) // element.size, element))
+
+  def _scan_elements(self, element, data, offset, count, sequence, children, ranges):
+    if element.bare_pointer(self.pointer_size):
+      pointee = element.pointers[0][1]
+      fmt = self.pointer_format[0] + str(count) + self.pointer_format[1]
+      sequence.extend((a, pointee) for a in struct.unpack_from(fmt, data, offset))
+      return
+    for i in range(count):
+      # Elements which hold nonnull_ptrs among other things each make their own sequence.
+      inner = []
+      self._scan(element, data, offset + i * element.size, inner, children, ranges)
+      children.append(inner)
+
+  def _record(self, sequence, frontier):
+    '''Count a sequence of nonnull_ptrs, and queue the pointees that are new. Pass None as
+    `frontier` to not follow the pointees.'''
+    remaining = self.limit - self.stats.edges
+    if len(sequence) > remaining:
+      sequence = sequence[:remaining]
+      self.stats.truncated = True
+    self.stats.add_sequence(sequence)
+    if frontier is None:
+      return
+    visited = self.visited
+    for address, pointee in sequence:
+      if address == 0 or pointee.empty() or pointee.size == 0:
+        continue
+      key = (address, pointee.name)
+      if key not in visited:
+        visited.add(key)
+        frontier.append((address, pointee.size, (pointee, 1)))
+
+  def walk(self, spans):
+    '''Walk from the given spans, in breadth-first order.
+
+    Each span is (address, size, (layout, count)), for `count` objects with `layout`.'''
+    level = 0
+    frontier = []
+    while spans and self.stats.edges < self.limit:
+      ranges = []
+      for (layout, count), address, data in read_spans(self.read_memory, spans, self.stats):
+        self.stats.nodes += count
+        sequence = []
+        children = []
+        if count == 1:
+          self._scan(layout, data, 0, sequence, children, ranges)
+        else:
+          self._scan_elements(layout, data, 0, count, sequence, children, ranges)
+        # The pointees at the last level are counted, but not read.
+        follow = frontier if level + 1 < self.depth else None
+        self._record(sequence, follow)
+        for inner in children:
+          self._record(inner, follow)
+
+      # The contents of vectors belong to the objects that hold them, so they are read at the
+      # same depth.
+      spans = []
+      for address, count, element in ranges:
+        remaining = self.limit - self.stats.edges
+        if count > remaining:
+          count = max(remaining, 0)
+          self.stats.truncated = True
+        if count > 0:
+          spans.append((address, count * element.size, (element, count)))
+      if not spans:
+        spans = frontier
+        frontier = []
+        level += 1
+
+def _little_endian():
+  return 'little' in gdb.execute('show endian', to_string=True)
+
+class NonnullPtrPrefixCommand(gdb.Command):
+  'Commands for inspecting gch::nonnull_ptr.'
+
+  def __init__(self):
+    super(NonnullPtrPrefixCommand, self).__init__('nonnull-ptr', gdb.COMMAND_DATA, prefix=True)
+
+class NonnullPtrLocalityCommand(gdb.Command):
+  '''Report the memory locality of the nonnull_ptrs reachable from an expression.
+
+Usage: nonnull-ptr locality [-depth N] [-limit N] [-line-size N] [-page-size N] [-top N] EXPR
+
+EXPR is an object which holds gch::nonnull_ptrs, directly, in arrays and
+std::vectors, or in the members of its members. A pointer to such an object
+is followed. The pointees are walked in turn, so that a graph which is
+linked by nonnull_ptrs is covered up to -depth hops (no limit by default),
+or until -limit nonnull_ptrs (1000000 by default) have been seen.
+
+The report gives the cache lines and pages touched by each pointee type,
+a histogram of the distances between the pointees of adjacent nonnull_ptrs,
+the fan-in of the pointees and the -top (10 by default) most referenced
+pointees. Memory is read in large batches, so this also works on big cores.'''
+
+  _OPTIONS = ('-depth', '-limit', '-line-size', '-page-size', '-top')
+
+  def __init__(self):
+    super(NonnullPtrLocalityCommand, self).__init__('nonnull-ptr locality', gdb.COMMAND_DATA,
+                                                    gdb.COMPLETE_EXPRESSION)
+
+  def _parse(self, arg):
+    options = {'-depth': 1 << 62, '-limit': 1000000, '-line-size': 64, '-page-size': 4096,
+               '-top': 10}
+    rest = arg.strip()
+    while rest.startswith('-'):
+      word, _, tail = rest.partition(' ')
+      if word == '--':
+        rest = tail.strip()
+        break
+      if word not in self._OPTIONS:
+        break
+      value, _, rest = tail.strip().partition(' ')
+      try:
+        options[word] = int(gdb.parse_and_eval(value))
+      except (gdb.error, ValueError):
+        raise gdb.GdbError(f'{word} needs a number')
+      rest = rest.strip()
+    if not rest:
+      raise gdb.GdbError('nonnull-ptr locality needs an expression')
+    if options['-line-size'] <= 0 or options['-page-size'] <= 0:
+      raise gdb.GdbError('The line and page sizes must be positive.')
+    return options, rest
+
+  def invoke(self, arg, from_tty):
+    options, expression = self._parse(arg)
+    value = gdb.parse_and_eval(expression)
+    t = value.type.strip_typedefs()
+    if t.code in (gdb.TYPE_CODE_PTR, gdb.TYPE_CODE_REF, gdb.TYPE_CODE_RVALUE_REF):
+      value = value.dereference() if t.code == gdb.TYPE_CODE_PTR else value.referenced_value()
+    if value.address is None:
+      raise gdb.GdbError(f'{expression} is not in memory.')
+
+    layouts = LayoutCache()
+    layout = layouts.get(value.type)
+    if layout.empty():
+      raise gdb.GdbError(f'No nonnull_ptrs were found in {value.type}.')
+
+    inferior = gdb.selected_inferior()
+    stats = LocalityStats(options['-line-size'], options['-page-size'])
+    walker = Walker(inferior.read_memory, gdb.lookup_type('void').pointer().sizeof,
+                    _little_endian(), stats, options['-limit'], options['-depth'])
+    walker.walk([(int(value.address), layout.size, (layout, 1))])
+    stats.report(gdb.write, expression, options['-top'])
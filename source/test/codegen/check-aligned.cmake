@@ -0,0 +1,50 @@
+# Checks that kernels taking nonnull_aligned_ptr use no unaligned vector accesses and no
+# more instructions than the same kernels taking nonnull_ptr.
+#
+# Usage: cmake -D OBJDUMP=<objdump> -D OBJECTS=<object> -P check-aligned.cmake
+
+cmake_minimum_required (VERSION 3.15)
+
+include (${CMAKE_CURRENT_LIST_DIR}/codegen.cmake)
+
+codegen_disassemble ("${OBJDUMP}" "${OBJECTS}" obj)
+
+set (failed FALSE)
+foreach (kernel reduce scale)
+  set (plain ${kernel}_nonnull_ptr)
+  set (aligned ${kernel}_nonnull_aligned_ptr)
+  codegen_require (obj ${plain})
+  codegen_require (obj ${aligned})
+
+  list (LENGTH obj_${plain} plain_count)
+  list (LENGTH obj_${aligned} aligned_count)
+
+  set (unaligned_accesses)
+  foreach (insn IN LISTS obj_${aligned})
+    if (insn MATCHES "^v?mov(dqu|dqu8|dqu16|dqu32|dqu64|ups|upd) ")
+      list (APPEND unaligned_accesses "${insn}")
+    endif ()
+  endforeach ()
+
+  if (unaligned_accesses)
+    message ("${aligned} has unaligned vector accesses: ${unaligned_accesses}")
+    set (failed TRUE)
+  endif ()
+
+  if (aligned_count GREATER plain_count)
+    message ("${aligned} has ${aligned_count} instructions, but ${plain} has ${plain_count}.")
+    set (failed TRUE)
+  endif ()
+
+  message ("${kernel}: ${plain_count} instructions with nonnull_ptr, "
+           "${aligned_count} with nonnull_aligned_ptr")
+
+  if (failed)
+    codegen_print (obj ${plain})
+    codegen_print (obj ${aligned})
+  endif ()
+endforeach ()
+
+if (failed)
+  message (FATAL_ERROR "Alignment was not propagated to the vectorizer.")
+endif ()
@@ -0,0 +1,35 @@
+# Checks that the basic operations on `nonnull_ptr` compile to the same instructions as
+# the same operations on raw pointers, including how arguments are passed.
+#
+# Usage: cmake -D OBJDUMP=<objdump> -D OBJECTS=<object> -P check-core.cmake
+
+cmake_minimum_required (VERSION 3.15)
+
+include (${CMAKE_CURRENT_LIST_DIR}/codegen.cmake)
+
+codegen_disassemble ("${OBJDUMP}" "${OBJECTS}" obj)
+
+set (failed FALSE)
+foreach (operation pass deref arrow upcast equal less equal_mixed swap assign hash)
+  set (raw ${operation}_raw)
+  set (wrapped ${operation}_nonnull_ptr)
+  codegen_require (obj ${raw})
+  codegen_require (obj ${wrapped})
+
+  codegen_normalize (obj ${raw} raw_insns)
+  codegen_normalize (obj ${wrapped} wrapped_insns)
+
+  list (LENGTH wrapped_insns wrapped_count)
+  message ("${operation}: ${wrapped_count} instructions")
+
+  if (NOT raw_insns STREQUAL wrapped_insns)
+    message ("${wrapped} differs from ${raw}.")
+    codegen_print (obj ${raw})
+    codegen_print (obj ${wrapped})
+    set (failed TRUE)
+  endif ()
+endforeach ()
+
+if (failed)
+  message (FATAL_ERROR "nonnull_ptr is not free.")
+endif ()
@@ -0,0 +1,35 @@
+# Checks that `project` and `container_of` compile to the same instructions as the
+# equivalent raw pointer arithmetic.
+#
+# Usage: cmake -D OBJDUMP=<objdump> -D OBJECTS=<object> -P check-member.cmake
+
+cmake_minimum_required (VERSION 3.15)
+
+include (${CMAKE_CURRENT_LIST_DIR}/codegen.cmake)
+
+codegen_disassemble ("${OBJDUMP}" "${OBJECTS}" obj)
+
+set (failed FALSE)
+foreach (operation project container_of)
+  set (raw ${operation}_raw)
+  set (wrapped ${operation}_nonnull_ptr)
+  codegen_require (obj ${raw})
+  codegen_require (obj ${wrapped})
+
+  codegen_normalize (obj ${raw} raw_insns)
+  codegen_normalize (obj ${wrapped} wrapped_insns)
+
+  list (LENGTH wrapped_insns wrapped_count)
+  message ("${operation}: ${wrapped_count} instructions")
+
+  if (NOT raw_insns STREQUAL wrapped_insns)
+    message ("${wrapped} differs from ${raw}.")
+    codegen_print (obj ${raw})
+    codegen_print (obj ${wrapped})
+    set (failed TRUE)
+  endif ()
+endforeach ()
+
+if (failed)
+  message (FATAL_ERROR "Member projection is not free.")
+endif ()
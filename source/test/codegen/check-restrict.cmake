@@ -0,0 +1,35 @@
+# Checks that kernels taking nonnull_restrict_ptr are smaller than the same kernels taking
+# nonnull_ptr, which must check for overlap at runtime before using vector instructions.
+#
+# Usage: cmake -D OBJDUMP=<objdump> -D OBJECTS=<object> -P check-restrict.cmake
+
+cmake_minimum_required (VERSION 3.15)
+
+include (${CMAKE_CURRENT_LIST_DIR}/codegen.cmake)
+
+codegen_disassemble ("${OBJDUMP}" "${OBJECTS}" obj)
+
+set (failed FALSE)
+foreach (kernel saxpy add)
+  set (plain ${kernel}_nonnull_ptr)
+  set (restricted ${kernel}_nonnull_restrict_ptr)
+  codegen_require (obj ${plain})
+  codegen_require (obj ${restricted})
+
+  list (LENGTH obj_${plain} plain_count)
+  list (LENGTH obj_${restricted} restricted_count)
+
+  message ("${kernel}: ${plain_count} instructions with nonnull_ptr, "
+           "${restricted_count} with nonnull_restrict_ptr")
+
+  if (NOT restricted_count LESS plain_count)
+    message ("${restricted} is no smaller than ${plain}.")
+    codegen_print (obj ${plain})
+    codegen_print (obj ${restricted})
+    set (failed TRUE)
+  endif ()
+endforeach ()
+
+if (failed)
+  message (FATAL_ERROR "The no-alias guarantee was not used.")
+endif ()
@@ -0,0 +1,41 @@
+# Checks that loops through the range adaptors compile to the same instructions as the
+# loops written by hand over the underlying ranges.
+#
+# Usage: cmake -D OBJDUMP=<objdump> -D OBJECTS=<object> -P check-views.cmake
+
+cmake_minimum_required (VERSION 3.15)
+
+include (${CMAKE_CURRENT_LIST_DIR}/codegen.cmake)
+
+codegen_disassemble ("${OBJDUMP}" "${OBJECTS}" obj)
+
+if ("views_unavailable" IN_LIST obj_FUNCTIONS)
+  message ("Ranges are not available; nothing to check.")
+  return ()
+endif ()
+
+set (failed FALSE)
+foreach (adaptor nonnull addressof deref)
+  set (raw ${adaptor}_raw)
+  set (view ${adaptor}_view)
+  codegen_require (obj ${raw})
+  codegen_require (obj ${view})
+
+  codegen_normalize (obj ${raw} raw_insns)
+  codegen_normalize (obj ${view} view_insns)
+
+  list (LENGTH raw_insns raw_count)
+  list (LENGTH view_insns view_count)
+  message ("${adaptor}: ${raw_count} instructions by hand, ${view_count} through the view")
+
+  if (NOT raw_insns STREQUAL view_insns)
+    message ("${view} differs from ${raw}.")
+    codegen_print (obj ${raw})
+    codegen_print (obj ${view})
+    set (failed TRUE)
+  endif ()
+endforeach ()
+
+if (failed)
+  message (FATAL_ERROR "The range adaptors are not free.")
+endif ()
@@ -0,0 +1,56 @@
+/** codegen-aligned.cpp
+ * Kernels whose disassembly is checked by check-aligned.cmake.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "gch/nonnull_aligned_ptr.hpp"
+
+#include <cstddef>
+
+// Each kernel is written once for `nonnull_ptr` and once for `nonnull_aligned_ptr`. The
+// names have C linkage so the script can find them in the disassembly.
+
+extern "C"
+{
+
+  int
+  reduce_nonnull_ptr (gch::nonnull_ptr<const int> p, std::size_t n)
+  {
+    const int *data = p.get ();
+    int total = 0;
+    for (std::size_t i = 0; i < n; ++i)
+      total += data[i];
+    return total;
+  }
+
+  int
+  reduce_nonnull_aligned_ptr (gch::nonnull_aligned_ptr<const int, 64> p, std::size_t n)
+  {
+    const int *data = p.get ();
+    int total = 0;
+    for (std::size_t i = 0; i < n; ++i)
+      total += data[i];
+    return total;
+  }
+
+  void
+  scale_nonnull_ptr (gch::nonnull_ptr<float> p, std::size_t n)
+  {
+    float *data = p.get ();
+    for (std::size_t i = 0; i < n; ++i)
+      data[i] *= 2.0f;
+  }
+
+  void
+  scale_nonnull_aligned_ptr (gch::nonnull_aligned_ptr<float, 64> p, std::size_t n)
+  {
+    float *data = p.get ();
+    for (std::size_t i = 0; i < n; ++i)
+      data[i] *= 2.0f;
+  }
+
+}
@@ -0,0 +1,170 @@
+/** codegen-core.cpp
+ * Functions whose disassembly is checked by check-core.cmake.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "gch/nonnull_ptr.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+struct first_base
+{
+  long a;
+};
+
+struct second_base
+{
+  long b;
+};
+
+struct derived
+  : first_base,
+    second_base
+{
+  long c;
+};
+
+extern "C"
+{
+
+  void sink_raw (int *p);
+  void sink_nonnull_ptr (gch::nonnull_ptr<int> p);
+
+}
+
+// Each operation is written once with raw pointers and once with `nonnull_ptr`. A raw
+// pointer which the `nonnull_ptr` version knows to be non-null is formed through a
+// reference, so that both versions give the compiler the same facts. The names have C
+// linkage so the script can find them.
+
+extern "C"
+{
+
+  void
+  pass_raw (int *p)
+  {
+    sink_raw (p);
+  }
+
+  void
+  pass_nonnull_ptr (gch::nonnull_ptr<int> p)
+  {
+    sink_nonnull_ptr (p);
+  }
+
+  int
+  deref_raw (int *p)
+  {
+    return *p;
+  }
+
+  int
+  deref_nonnull_ptr (gch::nonnull_ptr<int> p)
+  {
+    return *p;
+  }
+
+  long
+  arrow_raw (derived *p)
+  {
+    return p->c;
+  }
+
+  long
+  arrow_nonnull_ptr (gch::nonnull_ptr<derived> p)
+  {
+    return p->c;
+  }
+
+  second_base *
+  upcast_raw (derived *p)
+  {
+    return &static_cast<second_base&> (*p);
+  }
+
+  second_base *
+  upcast_nonnull_ptr (gch::nonnull_ptr<derived> p)
+  {
+    return gch::nonnull_ptr<second_base> (p).get ();
+  }
+
+  bool
+  equal_raw (int *lhs, int *rhs)
+  {
+    return lhs == rhs;
+  }
+
+  bool
+  equal_nonnull_ptr (gch::nonnull_ptr<int> lhs, gch::nonnull_ptr<int> rhs)
+  {
+    return lhs == rhs;
+  }
+
+  bool
+  less_raw (int *lhs, int *rhs)
+  {
+    return std::less<int *> { } (lhs, rhs);
+  }
+
+  bool
+  less_nonnull_ptr (gch::nonnull_ptr<int> lhs, gch::nonnull_ptr<int> rhs)
+  {
+    return lhs < rhs;
+  }
+
+  bool
+  equal_mixed_raw (int *lhs, int *rhs)
+  {
+    return lhs == rhs;
+  }
+
+  bool
+  equal_mixed_nonnull_ptr (gch::nonnull_ptr<int> lhs, int *rhs)
+  {
+    return lhs == rhs;
+  }
+
+  void
+  swap_raw (int **lhs, int **rhs)
+  {
+    std::swap (*lhs, *rhs);
+  }
+
+  void
+  swap_nonnull_ptr (gch::nonnull_ptr<int> *lhs, gch::nonnull_ptr<int> *rhs)
+  {
+    using std::swap;
+    swap (*lhs, *rhs);
+  }
+
+  void
+  assign_raw (int **lhs, int *rhs)
+  {
+    *lhs = rhs;
+  }
+
+  void
+  assign_nonnull_ptr (gch::nonnull_ptr<int> *lhs, gch::nonnull_ptr<int> rhs)
+  {
+    *lhs = rhs;
+  }
+
+  std::size_t
+  hash_raw (int *p)
+  {
+    return std::hash<int *> { } (p);
+  }
+
+  std::size_t
+  hash_nonnull_ptr (gch::nonnull_ptr<int> p)
+  {
+    return std::hash<gch::nonnull_ptr<int>> { } (p);
+  }
+
+}
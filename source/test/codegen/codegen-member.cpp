@@ -0,0 +1,57 @@
+/** codegen-member.cpp
+ * Functions whose disassembly is checked by check-member.cmake.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "gch/nonnull_ptr_member.hpp"
+
+#include <cstddef>
+
+struct hook
+{
+  void *next;
+  void *prev;
+};
+
+struct node
+{
+  int    key;
+  double weight;
+  hook   h;
+};
+
+// Each operation is written once with raw pointers and offsetof, and once with
+// `project` and `container_of`. The names have C linkage so the script can find them.
+
+extern "C"
+{
+
+  hook *
+  project_raw (node *p)
+  {
+    return &p->h;
+  }
+
+  hook *
+  project_nonnull_ptr (gch::nonnull_ptr<node> p)
+  {
+    return p.project (&node::h).get ();
+  }
+
+  node *
+  container_of_raw (hook *h)
+  {
+    return reinterpret_cast<node *> (reinterpret_cast<unsigned char *> (h) - offsetof (node, h));
+  }
+
+  node *
+  container_of_nonnull_ptr (gch::nonnull_ptr<hook> h)
+  {
+    return gch::container_of (h, &node::h).get ();
+  }
+
+}
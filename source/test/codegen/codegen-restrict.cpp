@@ -0,0 +1,56 @@
+/** codegen-restrict.cpp
+ * Kernels whose disassembly is checked by check-restrict.cmake.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "gch/nonnull_restrict_ptr.hpp"
+
+#include <cstddef>
+
+// Each kernel is written once for `nonnull_ptr` and once for `nonnull_restrict_ptr`. The
+// names have C linkage so the script can find them in the disassembly.
+
+extern "C"
+{
+
+  void
+  saxpy_nonnull_ptr (float a, gch::nonnull_ptr<const float> x, gch::nonnull_ptr<float> y,
+                     std::size_t n)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      y.get ()[i] += a * x.get ()[i];
+  }
+
+  void
+  saxpy_nonnull_restrict_ptr (float a,
+                              gch::nonnull_restrict_ptr<const float> x,
+                              gch::nonnull_restrict_ptr<float> y,
+                              std::size_t n)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      y[i] += a * x[i];
+  }
+
+  void
+  add_nonnull_ptr (gch::nonnull_ptr<const float> x, gch::nonnull_ptr<const float> y,
+                   gch::nonnull_ptr<float> z, std::size_t n)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      z.get ()[i] = x.get ()[i] + y.get ()[i];
+  }
+
+  void
+  add_nonnull_restrict_ptr (gch::nonnull_restrict_ptr<const float> x,
+                            gch::nonnull_restrict_ptr<const float> y,
+                            gch::nonnull_restrict_ptr<float> z,
+                            std::size_t n)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      z[i] = x[i] + y[i];
+  }
+
+}
@@ -0,0 +1,87 @@
+/** codegen-views.cpp
+ * Kernels whose disassembly is checked by check-views.cmake.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "gch/nonnull_views.hpp"
+
+#ifdef GCH_LIB_RANGES
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+// Each loop is written once over the underlying range by hand, and once through an
+// adaptor. The names have C linkage so the script can find them in the disassembly.
+
+extern "C"
+{
+
+  int
+  nonnull_raw (const std::vector<std::unique_ptr<int>>& v)
+  {
+    int total = 0;
+    for (const std::unique_ptr<int>& p : v)
+      total += *p.get ();
+    return total;
+  }
+
+  int
+  nonnull_view (const std::vector<std::unique_ptr<int>>& v)
+  {
+    int total = 0;
+    for (gch::nonnull_ptr<int> p : v | gch::views::nonnull)
+      total += *p;
+    return total;
+  }
+
+  int
+  addressof_raw (const std::deque<int>& d)
+  {
+    int total = 0;
+    for (const int& x : d)
+      total += *&x;
+    return total;
+  }
+
+  int
+  addressof_view (const std::deque<int>& d)
+  {
+    int total = 0;
+    for (gch::nonnull_ptr<const int> p : d | gch::views::addressof)
+      total += *p;
+    return total;
+  }
+
+  int
+  deref_raw (const std::vector<int *>& v)
+  {
+    int total = 0;
+    for (int *p : v)
+      total += *p;
+    return total;
+  }
+
+  int
+  deref_view (const std::vector<gch::nonnull_ptr<int>>& v)
+  {
+    int total = 0;
+    for (int x : v | gch::views::deref)
+      total += x;
+    return total;
+  }
+
+}
+
+#else
+
+extern "C"
+void
+views_unavailable (void)
+{ }
+
+#endif
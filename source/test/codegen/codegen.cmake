@@ -0,0 +1,134 @@
+# Helpers for the codegen tests, for use in script mode.
+
+# Disassembles OBJECT and sets, in the caller's scope, <PREFIX>_FUNCTIONS to the list of
+# symbols and <PREFIX>_<symbol> to the list of instructions of each symbol. Instructions
+# are stored as they appear in the output of objdump, without addresses or raw bytes.
+function (codegen_disassemble OBJDUMP OBJECT PREFIX)
+  execute_process (
+    COMMAND
+      ${OBJDUMP} -d --no-show-raw-insn --no-addresses ${OBJECT}
+    OUTPUT_VARIABLE
+      disassembly
+    RESULT_VARIABLE
+      result
+  )
+
+  if (NOT result EQUAL 0)
+    # Older versions of objdump do not have --no-addresses.
+    execute_process (
+      COMMAND
+        ${OBJDUMP} -d --no-show-raw-insn ${OBJECT}
+      OUTPUT_VARIABLE
+        disassembly
+      RESULT_VARIABLE
+        result
+    )
+  endif ()
+
+  if (NOT result EQUAL 0)
+    message (FATAL_ERROR "Could not disassemble ${OBJECT}.")
+  endif ()
+
+  string (REPLACE ";" "\;" disassembly "${disassembly}")
+  string (REPLACE "\n" ";" lines "${disassembly}")
+
+  set (functions)
+  set (current)
+  foreach (line IN LISTS lines)
+    if (line MATCHES "^([0-9a-f]+ )?<([^>]+)>:$")
+      set (current "${CMAKE_MATCH_2}")
+      list (APPEND functions "${current}")
+      set (insns_${current})
+    elseif (current AND line MATCHES "^[ \t]+([0-9a-f]+:)?[ \t]*([a-z].*)$")
+      string (REGEX REPLACE "[ \t]+" " " insn "${CMAKE_MATCH_2}")
+      string (STRIP "${insn}" insn)
+      list (APPEND insns_${current} "${insn}")
+    endif ()
+  endforeach ()
+
+  set (${PREFIX}_FUNCTIONS "${functions}" PARENT_SCOPE)
+  foreach (fn IN LISTS functions)
+    set (${PREFIX}_${fn} "${insns_${fn}}" PARENT_SCOPE)
+  endforeach ()
+endfunction ()
+
+# Fails if FUNCTION was not found by codegen_disassemble.
+function (codegen_require PREFIX FUNCTION)
+  if (NOT "${FUNCTION}" IN_LIST ${PREFIX}_FUNCTIONS)
+    message (FATAL_ERROR "Function ${FUNCTION} not found in the disassembly.")
+  endif ()
+endfunction ()
+
+# Prints the instructions of FUNCTION.
+function (codegen_print PREFIX FUNCTION)
+  message ("${FUNCTION}:")
+  foreach (insn IN LISTS ${PREFIX}_${FUNCTION})
+    message ("  ${insn}")
+  endforeach ()
+endfunction ()
+
+# Sets OUT to the instructions of FUNCTION with addresses, symbol names, comments and
+# alignment padding removed, so that functions at different places in the object can be
+# compared.
+#
+# A register-register compare whose flags are read only by the next instruction is also
+# put in a canonical operand order, mirroring the condition of that instruction. Compilers
+# pick either order depending on how the operands reached them, and both are the same code.
+function (codegen_normalize PREFIX FUNCTION OUT)
+  set (insns)
+  foreach (insn IN LISTS ${PREFIX}_${FUNCTION})
+    if (insn MATCHES "^((data16|cs|ds) )*(nop[wl]?( .*)?|xchg %ax,%ax)$")
+      continue ()
+    endif ()
+    string (REGEX REPLACE " *#.*$" "" insn "${insn}")
+    string (REGEX REPLACE "([0-9a-f]+ )?<[^>]*>" "<label>" insn "${insn}")
+    list (APPEND insns "${insn}")
+  endforeach ()
+
+  set (mirrored_a  b)
+  set (mirrored_ae be)
+  set (mirrored_b  a)
+  set (mirrored_be ae)
+  set (mirrored_g  l)
+  set (mirrored_ge le)
+  set (mirrored_l  g)
+  set (mirrored_le ge)
+  set (mirrored_e  e)
+  set (mirrored_ne ne)
+  set (flag_reader "^(set|j|cmov)(n?[abgelz]|[abgl]e|n[abgl]e?)[bwlq]? ")
+  set (condition "^(set|j|cmov)(a|ae|b|be|g|ge|l|le|e|ne)([bwlq]? .*)$")
+
+  list (LENGTH insns count)
+  set (result)
+  set (i 0)
+  while (i LESS count)
+    list (GET insns ${i} insn)
+    math (EXPR next "${i} + 1")
+    math (EXPR after "${i} + 2")
+    if (insn MATCHES "^cmp([bwlq]?) (%[a-z0-9]+),(%[a-z0-9]+)$"
+        AND CMAKE_MATCH_2 STRGREATER CMAKE_MATCH_3
+        AND next LESS count)
+      set (suffix "${CMAKE_MATCH_1}")
+      set (lhs "${CMAKE_MATCH_2}")
+      set (rhs "${CMAKE_MATCH_3}")
+      list (GET insns ${next} reader)
+      set (reads_again FALSE)
+      if (after LESS count)
+        list (GET insns ${after} third)
+        if ("${third} " MATCHES "${flag_reader}" OR third MATCHES "^(adc|sbb)")
+          set (reads_again TRUE)
+        endif ()
+      endif ()
+      if (NOT reads_again AND reader MATCHES "${condition}")
+        list (APPEND result "cmp${suffix} ${rhs},${lhs}")
+        list (APPEND result "${CMAKE_MATCH_1}${mirrored_${CMAKE_MATCH_2}}${CMAKE_MATCH_3}")
+        math (EXPR i "${i} + 2")
+        continue ()
+      endif ()
+    endif ()
+    list (APPEND result "${insn}")
+    math (EXPR i "${i} + 1")
+  endwhile ()
+
+  set (${OUT} "${result}" PARENT_SCOPE)
+endfunction ()
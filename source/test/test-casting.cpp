@@ -0,0 +1,162 @@
+/** test-casting.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/nonnull_ptr_casting.hpp"
+
+enum class shape_kind
+{
+  circle,
+  square,
+  rounded_square,
+  last_square
+};
+
+struct shape
+{
+  shape_kind kind;
+};
+
+struct circle : shape
+{
+  constexpr explicit
+  circle (int r) noexcept
+    : shape { shape_kind::circle },
+      radius (r)
+  { }
+
+  static constexpr
+  bool
+  classof (const shape *s) noexcept
+  {
+    return s->kind == shape_kind::circle;
+  }
+
+  int radius;
+};
+
+struct square : shape
+{
+  static constexpr
+  bool
+  classof (const shape *s) noexcept
+  {
+    return s->kind >= shape_kind::square && s->kind <= shape_kind::last_square;
+  }
+
+  int side;
+};
+
+struct rounded_square : square
+{
+  static constexpr
+  bool
+  classof (const shape *s) noexcept
+  {
+    return s->kind == shape_kind::rounded_square;
+  }
+};
+
+// A type which cannot be modified to add `classof`.
+struct external_base
+{
+  bool is_special;
+};
+
+struct external_special : external_base
+{ };
+
+namespace gch
+{
+
+  template <>
+  struct isa_traits<external_special, external_base>
+  {
+    static constexpr
+    bool
+    doit (const external_base& b) noexcept
+    {
+      return b.is_special;
+    }
+  };
+
+}
+
+using shape_ptr  = gch::nonnull_ptr<shape>;
+using shape_cptr = gch::nonnull_ptr<const shape>;
+
+static_assert (std::is_same<decltype (gch::cast<circle> (std::declval<shape_ptr> ())),
+                            gch::nonnull_ptr<circle>>::value, "");
+static_assert (std::is_same<decltype (gch::cast<circle> (std::declval<shape_cptr> ())),
+                            gch::nonnull_ptr<const circle>>::value, "");
+static_assert (std::is_same<decltype (gch::dyn_cast<circle> (std::declval<shape_cptr> ())),
+                            const circle *>::value, "");
+
+static constexpr circle g_circle { 2 };
+static constexpr gch::nonnull_ptr<const shape> g_shape { g_circle };
+static_assert (gch::isa<circle> (g_shape), "");
+static_assert (! gch::isa<square> (g_shape), "");
+static_assert (gch::isa_any<square, circle> (g_shape), "");
+static_assert (gch::isa<circle, const shape> (g_shape), "");
+
+int
+main (void)
+{
+  circle c { 1 };
+
+  square s;
+  s.kind = shape_kind::square;
+  s.side = 2;
+
+  rounded_square r;
+  r.kind = shape_kind::rounded_square;
+  r.side = 3;
+
+  gch::nonnull_ptr<shape> pc (c);
+  gch::nonnull_ptr<shape> ps (s);
+  gch::nonnull_ptr<shape> pr (r);
+
+  CHECK (gch::isa<circle> (pc));
+  CHECK (! gch::isa<circle> (ps));
+  CHECK (gch::isa<square> (ps));
+  CHECK (gch::isa<square> (pr));
+  CHECK (gch::isa<rounded_square> (pr));
+  CHECK (! gch::isa<rounded_square> (ps));
+  CHECK ((gch::isa_any<circle, rounded_square> (pr)));
+  CHECK (! (gch::isa_any<circle, rounded_square> (ps)));
+  CHECK ((gch::isa_any<shape> (pc)));
+
+  // Naming the source type picks the single-type check.
+  CHECK ((gch::isa<circle, shape> (pc)));
+  CHECK (! (gch::isa<circle, shape> (ps)));
+  CHECK ((gch::isa<shape, shape> (ps)));
+
+  // Upcasts need no classof.
+  CHECK (gch::isa<shape> (gch::nonnull_ptr<circle> (c)));
+
+  gch::nonnull_ptr<circle> cc = gch::cast<circle> (pc);
+  CHECK (cc == &c);
+  CHECK (cc->radius == 1);
+
+  gch::nonnull_ptr<const square> cs = gch::cast<square> (gch::nonnull_ptr<const shape> (pr));
+  CHECK (cs->side == 3);
+
+  CHECK (gch::dyn_cast<circle> (pc) == &c);
+  CHECK (gch::dyn_cast<circle> (ps) == nullptr);
+
+  if (square *sq = gch::dyn_cast<square> (pr))
+    sq->side = 4;
+  CHECK (r.side == 4);
+
+  external_special e;
+  e.is_special = true;
+  external_base b { false };
+  CHECK (gch::isa<external_special> (gch::nonnull_ptr<external_base> (e)));
+  CHECK (gch::dyn_cast<external_special> (gch::nonnull_ptr<external_base> (b)) == nullptr);
+
+  return 0;
+}
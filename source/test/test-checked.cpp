@@ -0,0 +1,146 @@
+/** test-checked.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_NONNULL_PTR_CHECKED
+#  define GCH_NONNULL_PTR_CHECKED
+#endif
+
+#include "test_common.hpp"
+
+#include <memory>
+
+namespace
+{
+
+  gch::checked::violation g_last { };
+  int g_violations = 0;
+
+  void
+  record (const gch::checked::violation& v)
+  {
+    g_last = v;
+    ++g_violations;
+  }
+
+  struct node
+  {
+    int value;
+  };
+
+}
+
+// The checks are skipped during constant evaluation.
+static constexpr int g_x = 7;
+static constexpr gch::nonnull_ptr<const int> g_px { g_x };
+static_assert (*g_px == 7, "");
+
+int
+main (void)
+{
+  gch::checked::set_violation_handler (&record);
+  gch::checked::set_sample_period (1);
+
+  std::unique_ptr<node[]> nodes (new node[4] { { 0 }, { 1 }, { 2 }, { 3 } });
+  gch::nonnull_ptr<node> p (nodes[1]);
+  gch::nonnull_ptr<node> q (nodes[2]);
+  CHECK (p->value == 1);
+  CHECK (g_violations == 0);
+
+  // Dereferencing into poisoned memory is reported, both through * and ->.
+  gch::checked::poison (&nodes[1], sizeof (node));
+  CHECK (gch::checked::is_poisoned (&nodes[1]));
+  CHECK (! gch::checked::is_poisoned (&nodes[2]));
+
+  CHECK ((*p).value == 1);
+  CHECK (g_violations == 1);
+  CHECK (g_last.kind == gch::checked::violation_kind::poisoned);
+  CHECK (g_last.address == &nodes[1]);
+  CHECK (g_last.poison_begin == &nodes[1]);
+  CHECK (g_last.poison_end == &nodes[2]);
+
+  CHECK (p->value == 1);
+  CHECK (g_violations == 2);
+
+  CHECK (q->value == 2);
+  CHECK (g_violations == 2);
+
+  // So is binding to it.
+  gch::nonnull_ptr<node> r (nodes[2]);
+  r.emplace (nodes[1]);
+  CHECK (g_violations == 3);
+
+  gch::checked::unpoison (&nodes[1], sizeof (node));
+  CHECK (! gch::checked::is_poisoned (&nodes[1]));
+  CHECK (p->value == 1);
+  CHECK (g_violations == 3);
+
+  // Unpoisoning part of a range leaves the rest of it poisoned.
+  gch::checked::poison (&nodes[0], 4 * sizeof (node));
+  CHECK (gch::checked::is_poisoned (&nodes[3]));
+  gch::checked::unpoison (&nodes[2], sizeof (node));
+  CHECK (gch::checked::is_poisoned (&nodes[0]));
+  CHECK (gch::checked::is_poisoned (&nodes[1]));
+  CHECK (! gch::checked::is_poisoned (&nodes[2]));
+  CHECK (! gch::checked::is_poisoned (&nodes[2].value));
+  CHECK (gch::checked::is_poisoned (&nodes[3]));
+  gch::checked::unpoison (&nodes[0], 4 * sizeof (node));
+  CHECK (! gch::checked::is_poisoned (&nodes[0]));
+  CHECK (! gch::checked::is_poisoned (&nodes[3]));
+
+  // Nested, overlapping and adjacent ranges are merged, so no range hides another.
+  gch::checked::poison (&nodes[1], sizeof (node));
+  gch::checked::poison (&nodes[0], 4 * sizeof (node));
+  CHECK (gch::checked::is_poisoned (&nodes[0]));
+  CHECK (gch::checked::is_poisoned (&nodes[2].value));
+  CHECK (gch::checked::is_poisoned (&nodes[3]));
+  gch::checked::unpoison (&nodes[0], 4 * sizeof (node));
+  CHECK (! gch::checked::is_poisoned (&nodes[2]));
+
+  gch::checked::poison (&nodes[1], 2 * sizeof (node));
+  gch::checked::poison (&nodes[0], 2 * sizeof (node));
+  CHECK (gch::checked::is_poisoned (&nodes[2]));
+  gch::checked::poison (&nodes[3], sizeof (node));
+
+  // Allocating one block again keeps its freed neighbours poisoned.
+  gch::checked::unpoison (&nodes[3], sizeof (node));
+  CHECK (gch::checked::is_poisoned (&nodes[0]));
+  CHECK (gch::checked::is_poisoned (&nodes[2]));
+  CHECK (! gch::checked::is_poisoned (&nodes[3]));
+  gch::checked::unpoison (&nodes[1], sizeof (node));
+  CHECK (gch::checked::is_poisoned (&nodes[0]));
+  CHECK (! gch::checked::is_poisoned (&nodes[1]));
+  CHECK (gch::checked::is_poisoned (&nodes[2]));
+  gch::checked::unpoison (&nodes[0], 4 * sizeof (node));
+  CHECK (! gch::checked::is_poisoned (&nodes[0]));
+  CHECK (! gch::checked::is_poisoned (&nodes[2]));
+
+  // A null address is always reported. Binding a reference to one is undefined, so this
+  // calls the check directly.
+  g_violations = 0;
+  gch::checked::on_bind (nullptr);
+  CHECK (g_violations == 1);
+  CHECK (g_last.kind == gch::checked::violation_kind::null);
+
+  // One operation in each period is checked.
+  gch::checked::poison (&nodes[1], sizeof (node));
+  g_violations = 0;
+  gch::checked::set_sample_period (10);
+  int sum = 0;
+  for (int i = 0; i < 100; ++i)
+    sum += p->value;
+  CHECK (sum == 100);
+  CHECK (g_violations == 10);
+
+  gch::checked::set_sample_period (0);
+  g_violations = 0;
+  for (int i = 0; i < 100; ++i)
+    sum += p->value;
+  CHECK (g_violations == 0);
+
+  gch::checked::unpoison (&nodes[1], sizeof (node));
+  return 0;
+}
@@ -74,6 +74,35 @@ template std::strong_ordering gch::operator<=> (const nonnull_ptr<int>&, const i
 static_assert (std::is_trivially_copyable<gch::nonnull_ptr<int>>::value, "");
 static_assert (std::is_trivially_destructible<gch::nonnull_ptr<int>>::value, "");
 
+// The constructors have the same overload sets with and without concepts.
+using base_ptr    = gch::nonnull_ptr<base>;
+using derived_ptr = gch::nonnull_ptr<derived>;
+static_assert (std::is_constructible<base_ptr, derived&>::value, "");
+static_assert (! std::is_constructible<base_ptr, derived&&>::value, "");
+static_assert (! std::is_constructible<derived_ptr, base&>::value, "");
+static_assert (! std::is_convertible<derived&, base_ptr>::value, "");
+static_assert (std::is_convertible<derived_ptr, base_ptr>::value, "");
+static_assert (! std::is_constructible<derived_ptr, base_ptr>::value, "");
+static_assert (std::is_convertible<gch::nonnull_ptr<int>, gch::nonnull_ptr<const int>>::value, "");
+static_assert (! std::is_constructible<gch::nonnull_ptr<int>, gch::nonnull_ptr<const int>>::value,
+               "");
+
+// So does emplace.
+template <typename P, typename Q, typename = void>
+struct can_emplace
+  : std::false_type
+{ };
+
+template <typename P, typename Q>
+struct can_emplace<P, Q, decltype (static_cast<void> (
+                           std::declval<P&> ().emplace (std::declval<const Q&> ())))>
+  : std::true_type
+{ };
+
+static_assert (can_emplace<base_ptr, derived_ptr>::value, "");
+static_assert (! can_emplace<derived_ptr, base_ptr>::value, "");
+static_assert (! can_emplace<gch::nonnull_ptr<int>, gch::nonnull_ptr<const int>>::value, "");
+
 static constexpr int g_x = 0;
 static constexpr gch::nonnull_ptr<const int> g_rx { g_x };
 
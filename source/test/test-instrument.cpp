@@ -0,0 +1,184 @@
+/** test-instrument.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_NONNULL_PTR_INSTRUMENT
+#  define GCH_NONNULL_PTR_INSTRUMENT
+#endif
+
+#ifndef GCH_NONNULL_PTR_INSTRUMENT_CALL_SITES
+#  define GCH_NONNULL_PTR_INSTRUMENT_CALL_SITES
+#endif
+
+#define GCH_NONNULL_PTR_INSTRUMENT_ALL_TYPES 0
+#define GCH_NONNULL_PTR_INSTRUMENT_SITE_CAPACITY 16
+
+#include "test_common.hpp"
+
+#include <cstdio>
+#include <string>
+#include <thread>
+
+namespace
+{
+
+  struct node
+  {
+    int value;
+  };
+
+  struct ignored
+  {
+    int value;
+  };
+
+}
+
+namespace gch
+{
+
+  namespace instrument
+  {
+
+    template <>
+    struct is_instrumented<node>
+      : std::true_type
+    { };
+
+  }
+
+}
+
+namespace
+{
+
+  const gch::instrument::type_counts *
+  find_type (const gch::instrument::snapshot& s, const std::string& name)
+  {
+    for (const gch::instrument::type_counts& t : s.types)
+    {
+      if (t.type.find (name) != std::string::npos)
+        return &t;
+    }
+    return nullptr;
+  }
+
+  // Each instantiation dereferences `p` from a call site of its own.
+  template <int N>
+  GCH_NONNULL_PTR_INSTRUMENT_NOINLINE
+  int
+  touch (gch::nonnull_ptr<node> p)
+  {
+    return p->value + touch<N - 1> (p);
+  }
+
+  template <>
+  GCH_NONNULL_PTR_INSTRUMENT_NOINLINE
+  int
+  touch<0> (gch::nonnull_ptr<node>)
+  {
+    return 0;
+  }
+
+}
+
+// Operations during constant evaluation are not counted.
+static constexpr int g_x = 7;
+static constexpr gch::nonnull_ptr<const int> g_px { g_x };
+static_assert (*g_px == 7, "");
+
+int
+main (void)
+{
+  gch::instrument::reset ();
+
+  node nodes[2] = { { 1 }, { 2 } };
+  gch::nonnull_ptr<node> p (nodes[0]);
+  gch::nonnull_ptr<node> q (nodes[1]);
+  gch::nonnull_cptr<node> c (nodes[1]);
+  CHECK (p->value + (*c).value == 3);
+  CHECK (p != q);
+  CHECK (p < c);
+  CHECK (p == &nodes[0]);
+  p.emplace (nodes[1]);
+  p.emplace (q);
+  CHECK (p == q);
+
+  // Only the selected types are counted.
+  ignored i { 3 };
+  gch::nonnull_ptr<ignored> r (i);
+  CHECK (r->value == 3);
+
+  gch::instrument::snapshot s = gch::instrument::take_snapshot ();
+  CHECK (s.types.size () == 1);
+  const gch::instrument::type_counts *t = find_type (s, "node");
+  CHECK (t != nullptr);
+  CHECK (t->count (gch::instrument::event::bind) == 3);
+  CHECK (t->count (gch::instrument::event::dereference) == 2);
+  CHECK (t->count (gch::instrument::event::rebind) == 2);
+  CHECK (t->count (gch::instrument::event::compare) == 4);
+  CHECK (find_type (s, "ignored") == nullptr);
+
+  // The dereferences come from two different call sites in this function.
+  std::uint64_t dereference_sites = 0;
+  for (const gch::instrument::site_counts& site : s.sites)
+  {
+    CHECK (site.site != nullptr);
+    if (site.kind == gch::instrument::event::dereference)
+      dereference_sites += site.count;
+  }
+  CHECK (dereference_sites == 2);
+
+  // A thread flushes its counts when it exits.
+  std::thread worker ([&nodes] () noexcept {
+    gch::nonnull_ptr<node> w (nodes[0]);
+    for (int n = 0; n < 10; ++n)
+      ++w->value;
+  });
+  worker.join ();
+  CHECK (nodes[0].value == 11);
+
+  s = gch::instrument::take_snapshot ();
+  t = find_type (s, "node");
+  CHECK (t != nullptr);
+  CHECK (t->count (gch::instrument::event::bind) == 4);
+  CHECK (t->count (gch::instrument::event::dereference) == 12);
+
+  std::FILE *f = std::tmpfile ();
+  CHECK (f != nullptr);
+  gch::instrument::dump_json (f);
+  std::rewind (f);
+  std::string json;
+  for (int ch = std::fgetc (f); ch != EOF; ch = std::fgetc (f))
+    json.push_back (static_cast<char> (ch));
+  std::fclose (f);
+  CHECK (json.compare (0, 10, "{\"types\":[") == 0);
+  CHECK (json.find ("\"dereference\":12") != std::string::npos);
+  CHECK (json.find ("\"event\":\"rebind\"") != std::string::npos);
+  CHECK (json.find ("\"dropped_sites\":0}") != std::string::npos);
+
+  // The sites past the capacity of a thread are only counted as dropped. How many sites
+  // there are depends on what was inlined, but every operation is counted once.
+  gch::instrument::reset ();
+  gch::nonnull_ptr<node> n (nodes[1]);
+  CHECK (touch<20> (n) == 20 * nodes[1].value);
+  s = gch::instrument::take_snapshot ();
+  t = find_type (s, "node");
+  CHECK (t != nullptr);
+  CHECK (t->count (gch::instrument::event::dereference) == 20);
+  CHECK (s.sites.size () <= 16);
+  std::uint64_t site_total = s.dropped_sites;
+  for (const gch::instrument::site_counts& site : s.sites)
+    site_total += site.count;
+  CHECK (site_total == t->total ());
+
+  gch::instrument::reset ();
+  CHECK (gch::instrument::take_snapshot ().types.empty ());
+  CHECK (gch::instrument::take_snapshot ().sites.empty ());
+  CHECK (gch::instrument::take_snapshot ().dropped_sites == 0);
+
+  return 0;
+}
@@ -0,0 +1,113 @@
+/** test-interner.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/interner.hpp"
+
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+struct point
+{
+  int x;
+  int y;
+};
+
+struct point_hash
+{
+  std::size_t
+  operator() (const point& p) const noexcept
+  {
+    return std::hash<int> { } (p.x) * 31U + std::hash<int> { } (p.y);
+  }
+};
+
+struct point_equal
+{
+  bool
+  operator() (const point& lhs, const point& rhs) const noexcept
+  {
+    return lhs.x == rhs.x && lhs.y == rhs.y;
+  }
+};
+
+static
+int
+test_concurrent (void)
+{
+  gch::concurrent_interner<std::string> table;
+
+  const std::string words[] { "alpha", "beta", "gamma", "delta" };
+  const std::string *seen[4][4] { };
+
+  std::thread threads[4];
+  for (std::size_t t = 0; t < 4; ++t)
+  {
+    threads[t] = std::thread ([&table, &words, &seen, t] {
+      for (std::size_t w = 0; w < 4; ++w)
+        seen[t][w] = table.intern (words[(w + t) % 4]).get ();
+    });
+  }
+
+  for (std::thread& t : threads)
+    t.join ();
+
+  CHECK (table.size () == 4);
+  for (std::size_t t = 0; t < 4; ++t)
+  {
+    for (std::size_t w = 0; w < 4; ++w)
+    {
+      const std::string& word = words[(w + t) % 4];
+      CHECK (seen[t][w] == table.find (word));
+    }
+  }
+
+  return 0;
+}
+
+int
+main (void)
+{
+  gch::interner<std::string> strings (2);
+
+  const gch::nonnull_ptr<const std::string> a0 = strings.intern ("a");
+  const gch::nonnull_ptr<const std::string> b0 = strings.intern (std::string ("b"));
+  std::string a_copy = "a";
+  const gch::nonnull_ptr<const std::string> a1 = strings.intern (a_copy);
+
+  CHECK (a0 == a1);
+  CHECK (a0 != b0);
+  CHECK (*a0 == "a");
+  CHECK (strings.size () == 2);
+  CHECK (strings.find ("a") == a0);
+  CHECK (strings.find ("c") == nullptr);
+
+  // Interning more values than fit in a block must not move earlier values.
+  for (int i = 0; i < 100; ++i)
+    strings.intern (std::to_string (i));
+  CHECK (strings.size () == 102);
+  CHECK (strings.intern ("a") == a0);
+  CHECK (*b0 == "b");
+
+  gch::interner<std::string>::memory_usage usage = strings.usage ();
+  CHECK (usage.count == 102);
+  CHECK (usage.arena_used == 102 * sizeof (std::string));
+  CHECK (usage.arena_reserved >= usage.arena_used);
+  CHECK (usage.index > 0);
+
+  // Canonical pointers can be hashed as pointers.
+  std::unordered_set<gch::nonnull_ptr<const std::string>> set;
+  set.insert (strings.intern ("x"));
+  CHECK (set.count (strings.intern (std::string ("x"))) == 1);
+
+  gch::interner<point, point_hash, point_equal> points;
+  CHECK (points.intern (point { 1, 2 }) == points.intern (point { 1, 2 }));
+  CHECK (points.intern (point { 1, 2 }) != points.intern (point { 2, 1 }));
+
+  return test_concurrent ();
+}
@@ -0,0 +1,174 @@
+/** test-intrusive_list.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/intrusive_list.hpp"
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+
+struct entry
+{
+  explicit
+  entry (int v) noexcept
+    : value (v)
+  { }
+
+  int            value;
+  gch::list_hook lru;
+  gch::list_hook bucket;
+};
+
+using lru_list    = gch::intrusive_list<entry, &entry::lru>;
+using bucket_list = gch::intrusive_list<entry, &entry::bucket>;
+
+static_assert (! std::is_copy_constructible<lru_list>::value, "");
+static_assert (std::is_nothrow_move_constructible<lru_list>::value, "");
+static_assert (std::is_same<std::iterator_traits<lru_list::iterator>::iterator_category,
+                            std::bidirectional_iterator_tag>::value, "");
+static_assert (std::is_convertible<lru_list::iterator, lru_list::const_iterator>::value, "");
+static_assert (! std::is_convertible<lru_list::const_iterator, lru_list::iterator>::value, "");
+
+template <typename List>
+static
+bool
+equals (const List& l, std::initializer_list<int> expected)
+{
+  if (l.size () != expected.size ()
+      ||  static_cast<std::size_t> (std::distance (l.begin (), l.end ())) != expected.size ())
+    return false;
+
+  return std::equal (l.begin (), l.end (), expected.begin (),
+                     [] (const entry& e, int v) noexcept { return e.value == v; })
+     &&  std::equal (l.rbegin (), l.rend (),
+                     std::reverse_iterator<const int *> (expected.end ()),
+                     [] (const entry& e, int v) noexcept { return e.value == v; });
+}
+
+int
+main (void)
+{
+  entry a (1);
+  entry b (2);
+  entry c (3);
+  entry d (4);
+
+  CHECK (! a.lru.is_linked ());
+
+  {
+    lru_list l;
+    CHECK (l.empty ());
+    CHECK (l.begin () == l.end ());
+
+    l.push_back (a);
+    l.push_back (b);
+    l.push_front (c);
+    CHECK (equals (l, { 3, 1, 2 }));
+    CHECK (a.lru.is_linked ());
+    CHECK (&l.front () == &c);
+    CHECK (&l.back () == &b);
+
+    // An element can be in one list per hook.
+    bucket_list bl;
+    bl.push_back (b);
+    bl.push_back (a);
+    CHECK (equals (bl, { 2, 1 }));
+    CHECK (equals (l, { 3, 1, 2 }));
+
+    // Insertion before an iterator returns an iterator to the new element.
+    lru_list::iterator it = l.insert (l.iterator_to (a), d);
+    CHECK (&*it == &d);
+    CHECK (it->value == 4);
+    CHECK (equals (l, { 3, 4, 1, 2 }));
+
+    // Erasure returns the following iterator and leaves the element unlinked.
+    it = l.erase (it);
+    CHECK (&*it == &a);
+    CHECK (! d.lru.is_linked ());
+    CHECK (equals (l, { 3, 1, 2 }));
+
+    // Moving an element to the front, including the front element itself.
+    l.move_to_front (b);
+    CHECK (equals (l, { 2, 3, 1 }));
+    l.move_to_front (b);
+    CHECK (equals (l, { 2, 3, 1 }));
+
+    // Splicing an element before itself or its successor is a no-op.
+    l.splice (l.iterator_to (a), l, l.iterator_to (c));
+    CHECK (equals (l, { 2, 3, 1 }));
+    l.splice (l.iterator_to (c), l, l.iterator_to (c));
+    CHECK (equals (l, { 2, 3, 1 }));
+    l.splice (l.end (), l, l.begin ());
+    CHECK (equals (l, { 3, 1, 2 }));
+
+    // Splicing between lists updates both sizes.
+    lru_list other;
+    other.push_back (d);
+    l.splice (l.begin (), other, other.begin ());
+    CHECK (other.empty ());
+    CHECK (equals (l, { 4, 3, 1, 2 }));
+
+    l.erase (d);
+    other.push_back (d);
+    other.splice (other.begin (), l);
+    CHECK (l.empty ());
+    CHECK (equals (other, { 3, 1, 2, 4 }));
+
+    // Splicing an empty list does nothing.
+    other.splice (other.begin (), l);
+    CHECK (equals (other, { 3, 1, 2, 4 }));
+
+    // Moving and swapping move the links.
+    lru_list moved (std::move (other));
+    CHECK (other.empty ());
+    CHECK (equals (moved, { 3, 1, 2, 4 }));
+
+    moved.erase (d);
+    l.push_back (d);
+
+    swap (l, moved);
+    CHECK (equals (l, { 3, 1, 2 }));
+    CHECK (equals (moved, { 4 }));
+
+    moved = std::move (l);
+    CHECK (l.empty ());
+    CHECK (! d.lru.is_linked ());
+    CHECK (equals (moved, { 3, 1, 2 }));
+
+    moved.pop_front ();
+    moved.pop_back ();
+    CHECK (equals (moved, { 1 }));
+    CHECK (! c.lru.is_linked ());
+    CHECK (! b.lru.is_linked ());
+
+    const lru_list& cl = moved;
+    CHECK (&cl.front () == &a);
+    CHECK (cl.iterator_to (a) == cl.begin ());
+
+    bl.clear ();
+    CHECK (bl.empty ());
+    CHECK (! a.bucket.is_linked ());
+    CHECK (! b.bucket.is_linked ());
+  }
+
+  // Destroying a list unlinks its elements.
+  CHECK (! a.lru.is_linked ());
+
+  // Copying an element does not copy its links.
+  {
+    lru_list l;
+    l.push_back (a);
+    entry copy (a);
+    CHECK (! copy.lru.is_linked ());
+    copy = a;
+    CHECK (! copy.lru.is_linked ());
+    CHECK (a.lru.is_linked ());
+  }
+
+  return 0;
+}
@@ -0,0 +1,117 @@
+/** test-intrusive_mpsc_queue.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/intrusive_mpsc_queue.hpp"
+
+#include <thread>
+#include <vector>
+
+struct message
+{
+  message (void) noexcept
+    : producer (0),
+      sequence (0)
+  { }
+
+  message (int p, int s) noexcept
+    : producer (p),
+      sequence (s)
+  { }
+
+  int                  producer;
+  int                  sequence;
+  gch::mpsc_queue_hook hook;
+};
+
+using queue = gch::intrusive_mpsc_queue<message, &message::hook>;
+
+static_assert (! std::is_copy_constructible<queue>::value, "");
+
+int
+main (void)
+{
+  {
+    queue q;
+    CHECK (q.empty ());
+    CHECK (q.try_pop () == nullptr);
+
+    message a (0, 1);
+    message b (0, 2);
+    message c (0, 3);
+
+    q.push (a);
+    CHECK (! q.empty ());
+    CHECK (q.try_pop () == &a);
+    CHECK (q.try_pop () == nullptr);
+    CHECK (q.empty ());
+
+    q.push (b);
+    q.push (c);
+    q.push (a);
+    CHECK (q.try_pop () == &b);
+    CHECK (q.try_pop () == &c);
+    CHECK (q.try_pop () == &a);
+    CHECK (q.try_pop () == nullptr);
+
+    // Elements may be pushed again once popped.
+    q.push (b);
+    CHECK (q.try_pop () == &b);
+    CHECK (q.empty ());
+  }
+
+  // Several producers: every message arrives once, in order per producer.
+  {
+    const int producers = 4;
+    const int per_producer = 20000;
+
+    std::vector<std::vector<message>> messages (producers);
+    for (int p = 0; p < producers; ++p)
+    {
+      messages[static_cast<std::size_t> (p)].resize (per_producer);
+      for (int s = 0; s < per_producer; ++s)
+        messages[static_cast<std::size_t> (p)][static_cast<std::size_t> (s)] = message (p, s);
+    }
+
+    queue q;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+    {
+      std::vector<message>& mine = messages[static_cast<std::size_t> (p)];
+      threads.emplace_back ([&q, &mine] () noexcept {
+        for (message& m : mine)
+          q.push (m);
+      });
+    }
+
+    std::vector<int> next (producers, 0);
+    int received = 0;
+    bool in_order = true;
+    while (received < producers * per_producer)
+    {
+      if (message *m = q.try_pop ())
+      {
+        int& expected = next[static_cast<std::size_t> (m->producer)];
+        in_order = in_order && m->sequence == expected;
+        ++expected;
+        ++received;
+      }
+      else
+        std::this_thread::yield ();
+    }
+
+    for (std::thread& t : threads)
+      t.join ();
+
+    CHECK (in_order);
+    CHECK (q.try_pop () == nullptr);
+    for (int n : next)
+      CHECK (n == per_producer);
+  }
+
+  return 0;
+}
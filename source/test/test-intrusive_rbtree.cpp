@@ -0,0 +1,213 @@
+/** test-intrusive_rbtree.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/intrusive_rbtree.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <set>
+#include <vector>
+
+struct order
+{
+  order (void) noexcept
+    : price (0)
+  { }
+
+  explicit
+  order (int p) noexcept
+    : price (p)
+  { }
+
+  int              price;
+  gch::rbtree_hook hook;
+};
+
+struct by_price
+{
+  bool
+  operator() (const order& lhs, const order& rhs) const noexcept
+  {
+    return lhs.price < rhs.price;
+  }
+
+  bool
+  operator() (const order& lhs, int rhs) const noexcept
+  {
+    return lhs.price < rhs;
+  }
+
+  bool
+  operator() (int lhs, const order& rhs) const noexcept
+  {
+    return lhs < rhs.price;
+  }
+};
+
+using book = gch::intrusive_rbtree<order, &order::hook, by_price>;
+
+static_assert (! std::is_copy_constructible<book>::value, "");
+static_assert (! std::is_move_constructible<book>::value, "");
+static_assert (sizeof (gch::rbtree_hook) == 3 * sizeof (void *), "");
+static_assert (std::is_same<std::iterator_traits<book::iterator>::iterator_category,
+                            std::bidirectional_iterator_tag>::value, "");
+static_assert (std::is_convertible<book::iterator, book::const_iterator>::value, "");
+
+namespace gch
+{
+
+  struct intrusive_rbtree_access
+  {
+    template <typename Tree>
+    static
+    bool
+    verify (const Tree& t)
+    {
+      return t.verify ();
+    }
+  };
+
+}
+
+static
+bool
+is_red_black (const book& b)
+{
+  return gch::intrusive_rbtree_access::verify (b);
+}
+
+static
+bool
+matches (const book& b, const std::set<int>& expected)
+{
+  if (b.size () != expected.size ()
+      ||  static_cast<std::size_t> (std::distance (b.begin (), b.end ())) != expected.size ())
+    return false;
+
+  return std::equal (b.begin (), b.end (), expected.begin (),
+                     [] (const order& o, int p) noexcept { return o.price == p; })
+     &&  std::equal (b.rbegin (), b.rend (), expected.rbegin (),
+                     [] (const order& o, int p) noexcept { return o.price == p; });
+}
+
+int
+main (void)
+{
+  {
+    order a (10);
+    order b (20);
+    order c (30);
+    order dup (20);
+
+    book bk;
+    CHECK (bk.empty ());
+    CHECK (bk.begin () == bk.end ());
+    CHECK (bk.find (10) == bk.end ());
+
+    CHECK (bk.insert (b).second);
+    CHECK (bk.insert (a).second);
+    CHECK (bk.insert (c).second);
+    CHECK (a.hook.is_linked ());
+
+    // Equivalent elements are rejected.
+    std::pair<book::iterator, bool> res = bk.insert (dup);
+    CHECK (! res.second);
+    CHECK (&*res.first == &b);
+    CHECK (! dup.hook.is_linked ());
+
+    CHECK (matches (bk, { 10, 20, 30 }));
+    CHECK (&*bk.find (20) == &b);
+    CHECK (bk.contains (30));
+    CHECK (! bk.contains (25));
+    CHECK (&*bk.lower_bound (15) == &b);
+    CHECK (&*bk.lower_bound (20) == &b);
+    CHECK (&*bk.upper_bound (20) == &c);
+    CHECK (bk.upper_bound (30) == bk.end ());
+    CHECK (&*std::prev (bk.end ()) == &c);
+
+    // Erasure by iterator returns the next position.
+    book::iterator it = bk.erase (bk.iterator_to (b));
+    CHECK (&*it == &c);
+    CHECK (! b.hook.is_linked ());
+    CHECK (matches (bk, { 10, 30 }));
+
+    bk.erase (a);
+    CHECK (matches (bk, { 30 }));
+
+    const book& cbk = bk;
+    CHECK (cbk.find (30)->price == 30);
+    CHECK (cbk.iterator_to (c) == cbk.begin ());
+
+    bk.insert (a);
+    bk.insert (b);
+    bk.clear ();
+    CHECK (bk.empty ());
+    CHECK (! a.hook.is_linked ());
+    CHECK (! c.hook.is_linked ());
+
+    // The tree can be reused after clearing.
+    bk.insert (c);
+    CHECK (matches (bk, { 30 }));
+  }
+
+  // Random insertions and erasures agree with std::set.
+  {
+    const int n = 2000;
+    std::vector<order> orders (n);
+    for (int i = 0; i < n; ++i)
+      orders[static_cast<std::size_t> (i)].price = i;
+
+    book bk;
+    std::set<int> expected;
+
+    std::uint32_t state = 12345;
+    for (int step = 0; step < 20000; ++step)
+    {
+      state = state * 1664525u + 1013904223u;
+      const std::size_t i = (state >> 8) % static_cast<std::uint32_t> (n);
+      order& o = orders[i];
+      if (o.hook.is_linked ())
+      {
+        bk.erase (o);
+        expected.erase (o.price);
+      }
+      else
+      {
+        CHECK (bk.insert (o).second);
+        expected.insert (o.price);
+      }
+      CHECK (is_red_black (bk));
+
+      if (step % 997 == 0)
+        CHECK (matches (bk, expected));
+    }
+    CHECK (matches (bk, expected));
+
+    // Erasing in order through iterators empties the tree.
+    for (book::iterator it = bk.begin (); it != bk.end (); )
+    {
+      it = bk.erase (it);
+      CHECK (is_red_black (bk));
+    }
+    CHECK (bk.empty ());
+
+    // Ascending insertion is the worst case for rebalancing.
+    for (order& o : orders)
+    {
+      bk.insert (o);
+      CHECK (is_red_black (bk));
+    }
+    expected.clear ();
+    for (int i = 0; i < n; ++i)
+      expected.insert (i);
+    CHECK (matches (bk, expected));
+  }
+
+  return 0;
+}
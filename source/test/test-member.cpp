@@ -0,0 +1,108 @@
+/** test-member.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/nonnull_ptr_member.hpp"
+
+#include <cstddef>
+
+struct hook
+{
+  int links[2];
+};
+
+struct base
+{
+  int id;
+};
+
+struct node
+  : base
+{
+  double weight;
+  hook   h;
+  int    value;
+
+  int
+  get (void) const noexcept
+  {
+    return value;
+  }
+};
+
+struct point
+{
+  int x;
+  int y;
+};
+
+constexpr point origin { 0, 5 };
+
+// Projection is constexpr and keeps the cv-qualification of the pointee.
+static_assert (*gch::make_nonnull_ptr (origin).project (&point::y) == 5, "");
+static_assert (std::is_same<decltype (gch::make_nonnull_ptr (origin).project (&point::y)),
+                            gch::nonnull_ptr<const int>>::value, "");
+
+template <typename P, typename M, typename = void>
+struct can_project
+  : std::false_type
+{ };
+
+template <typename P, typename M>
+struct can_project<P, M,
+                   decltype (void (std::declval<P> ().project (std::declval<M> ())))>
+  : std::true_type
+{ };
+
+static_assert (can_project<gch::nonnull_ptr<node>, int base::*>::value, "");
+static_assert (! can_project<gch::nonnull_ptr<base>, int node::*>::value, "");
+static_assert (! can_project<gch::nonnull_ptr<node>, int (node::*) (void) const noexcept>::value,
+               "");
+
+int
+main (void)
+{
+  node n { };
+  n.id = 1;
+  n.value = 7;
+
+  gch::nonnull_ptr<node> p (n);
+  gch::nonnull_ptr<int> v = p.project (&node::value);
+  CHECK (v == &n.value);
+  *v = 8;
+  CHECK (n.get () == 8);
+
+  // Members of bases.
+  CHECK (p.project (&base::id) == &n.id);
+
+  gch::nonnull_ptr<hook> h = p.project (&node::h);
+  CHECK (h == &n.h);
+
+  gch::nonnull_ptr<node> back = gch::container_of (h, &node::h);
+  CHECK (back == p);
+  CHECK (gch::container_of (v, &node::value) == p);
+  CHECK (gch::container_of (p.project (&node::weight), &node::weight) == p);
+
+  // A const member pointer yields a const container.
+  gch::nonnull_ptr<const hook> ch = h;
+  gch::nonnull_ptr<const node> cback = gch::container_of (ch, &node::h);
+  CHECK (cback == p);
+
+  // Members of bases map back to the base subobject.
+  gch::nonnull_ptr<base> b = gch::container_of (p.project (&base::id), &base::id);
+  CHECK (b == static_cast<base *> (&n));
+
+  // For a standard-layout class, which is all that is accepted without the Itanium C++ ABI,
+  // the offset agrees with offsetof.
+  static_assert (std::is_standard_layout<point>::value, "");
+  CHECK (gch::detail::member_offset (&point::y)
+         == static_cast<std::ptrdiff_t> (offsetof (point, y)));
+  point pt { 1, 2 };
+  CHECK (gch::container_of (gch::make_nonnull_ptr (pt.y), &point::y) == &pt);
+
+  return 0;
+}
@@ -0,0 +1,70 @@
+/** test-module.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#define NONNULL_PTR_TEST_MODULE
+#include "test_common.hpp"
+
+#include <functional>
+#include <unordered_set>
+#include <utility>
+
+import gch.nonnull_ptr;
+
+#ifdef GCH_NONNULL_PTR_HPP
+#  error "The module test should not include nonnull_ptr.hpp."
+#endif
+
+struct base
+{
+  int value;
+};
+
+struct derived
+  : base
+{ };
+
+int
+main (void)
+{
+  int x[2] = { 1, 2 };
+  gch::nonnull_ptr<int> p (x[0]);
+  gch::nonnull_ptr<int> q (x[1]);
+  gch::nonnull_cptr<int> c (x[0]);
+
+  CHECK (*p == 1);
+  CHECK (p == c);
+  CHECK (p != q);
+  CHECK (p < q);
+  CHECK (q > p);
+  CHECK (p <= c);
+  CHECK (q >= c);
+  CHECK ((p <=> q) < 0);
+  CHECK (p != nullptr);
+
+  gch::nonnull_ptr<int> m = gch::make_nonnull_ptr (x[1]);
+  CHECK (m == q);
+
+  using gch::swap;
+  swap (p, q);
+  CHECK (*p == 2);
+  CHECK (*q == 1);
+
+  derived d { };
+  gch::nonnull_ptr<base> b (gch::nonnull_ptr<derived> { d });
+  b->value = 3;
+  CHECK (d.value == 3);
+
+  // The specialization of std::hash comes with the module.
+  std::unordered_set<gch::nonnull_ptr<int>> set;
+  set.insert (p);
+  set.insert (q);
+  set.insert (m);
+  CHECK (set.size () == 2);
+  CHECK (std::hash<gch::nonnull_ptr<int>> { } (p) == std::hash<int *> { } (&x[1]));
+
+  return 0;
+}
@@ -0,0 +1,99 @@
+/** test-nonnull_aligned_ptr.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/nonnull_aligned_ptr.hpp"
+
+struct alignas (64) block
+{
+  int values[16];
+};
+
+static
+int
+sum (gch::nonnull_aligned_ptr<const int, 64> p, std::size_t n)
+{
+  const int *data = p.get ();
+  int total = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    total += data[i];
+  return total;
+}
+
+static
+int
+first (gch::nonnull_ptr<const int> p)
+{
+  return *p;
+}
+
+static_assert (sizeof (gch::nonnull_aligned_ptr<int, 64>) == sizeof (int *), "");
+static_assert (std::is_trivially_copyable<gch::nonnull_aligned_ptr<int, 64>>::value, "");
+static_assert (! std::is_default_constructible<gch::nonnull_aligned_ptr<int, 64>>::value, "");
+static_assert (gch::nonnull_aligned_ptr<int, 64>::alignment == 64, "");
+
+// Alignment may be weakened implicitly, but only strengthened explicitly.
+static_assert (std::is_convertible<gch::nonnull_aligned_ptr<int, 64>,
+                                   gch::nonnull_aligned_ptr<const int, 16>>::value, "");
+static_assert (! std::is_convertible<gch::nonnull_aligned_ptr<int, 16>,
+                                     gch::nonnull_aligned_ptr<int, 64>>::value, "");
+static_assert (std::is_constructible<gch::nonnull_aligned_ptr<const int, 64>,
+                                     gch::nonnull_aligned_ptr<int, 16>>::value, "");
+static_assert (! std::is_constructible<gch::nonnull_aligned_ptr<int, 64>,
+                                       gch::nonnull_aligned_ptr<const int, 16>>::value, "");
+
+// Conversion to `nonnull_ptr` is implicit.
+static_assert (std::is_convertible<gch::nonnull_aligned_ptr<int, 64>,
+                                   gch::nonnull_ptr<int>>::value, "");
+static_assert (std::is_convertible<gch::nonnull_aligned_ptr<int, 64>,
+                                   gch::nonnull_ptr<const int>>::value, "");
+static_assert (! std::is_convertible<gch::nonnull_aligned_ptr<const int, 64>,
+                                     gch::nonnull_ptr<int>>::value, "");
+
+// Construction from `nonnull_ptr` makes a claim, so it is explicit.
+static_assert (! std::is_convertible<gch::nonnull_ptr<int>,
+                                     gch::nonnull_aligned_ptr<int, 64>>::value, "");
+
+int
+main (void)
+{
+  block b { };
+  for (int i = 0; i < 16; ++i)
+    b.values[i] = i;
+
+  gch::nonnull_aligned_ptr<int, 64> p (b.values[0]);
+  CHECK (p.get () == &b.values[0]);
+  CHECK (*p == 0);
+  CHECK (sum (p, 16) == 120);
+  CHECK (first (p) == 0);
+
+  gch::nonnull_aligned_ptr<int, 16> q = gch::make_nonnull_aligned_ptr<16> (b.values[4]);
+  CHECK (q.get () == &b.values[4]);
+  CHECK (! (gch::nonnull_aligned_ptr<int, 64>::is_aligned (&b.values[4])));
+
+  gch::nonnull_aligned_ptr<int, 16> r = p;
+  CHECK (r == p);
+  swap (r, q);
+  CHECK (q == p);
+  CHECK (r != p);
+
+  gch::nonnull_ptr<int> np = p;
+  CHECK (np == &b.values[0]);
+
+  gch::nonnull_aligned_ptr<int, 64> from_np (np);
+  CHECK (from_np == p);
+
+  gch::nonnull_aligned_ptr<int, 16> weak (b.values[0]);
+  gch::nonnull_aligned_ptr<const int, 64> strong (weak);
+  CHECK (strong == p);
+  CHECK (*strong == 0);
+
+  int *raw = p;
+  CHECK (raw == &b.values[0]);
+
+  return 0;
+}
@@ -0,0 +1,164 @@
+/** test-nonnull_dyn_ptr.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/nonnull_dyn_ptr.hpp"
+
+struct shape
+{
+  int  (*area)  (const void *);
+  void (*scale) (void *, int);
+
+  template <typename T>
+  static
+  int
+  area_impl (const void *self)
+  {
+    return static_cast<const T *> (self)->area ();
+  }
+
+  template <typename T>
+  static
+  void
+  scale_impl (void *self, int factor)
+  {
+    static_cast<T *> (self)->scale (factor);
+  }
+
+  template <typename T>
+  static constexpr
+  shape
+  table_for (void) noexcept
+  {
+    return { &area_impl<T>, &scale_impl<T> };
+  }
+};
+
+struct counter
+{
+  int (*next) (void *);
+
+  template <typename T>
+  static
+  int
+  next_impl (void *self)
+  {
+    return ++static_cast<T *> (self)->value;
+  }
+
+  template <typename T>
+  static constexpr
+  counter
+  table_for (void) noexcept
+  {
+    return { &next_impl<T> };
+  }
+};
+
+// These types are unrelated and have no virtual functions.
+
+struct square
+{
+  int
+  area (void) const noexcept
+  {
+    return side * side;
+  }
+
+  void
+  scale (int factor) noexcept
+  {
+    side *= factor;
+  }
+
+  int side;
+  int value;
+};
+
+struct rectangle
+{
+  int
+  area (void) const noexcept
+  {
+    return width * height;
+  }
+
+  void
+  scale (int factor) noexcept
+  {
+    width *= factor;
+    height *= factor;
+  }
+
+  int width;
+  int height;
+};
+
+static_assert (sizeof (gch::nonnull_dyn_ptr<shape>) == 2 * sizeof (void *), "");
+static_assert (sizeof (gch::nonnull_dyn_ptr<counter>) == 2 * sizeof (void *), "");
+static_assert (std::is_trivially_copyable<gch::nonnull_dyn_ptr<shape>>::value, "");
+static_assert (! std::is_default_constructible<gch::nonnull_dyn_ptr<shape>>::value, "");
+
+static_assert (! std::is_constructible<gch::nonnull_dyn_ptr<shape>, square>::value, "");
+static_assert (! std::is_constructible<gch::nonnull_dyn_ptr<shape>, const square&>::value, "");
+static_assert (  std::is_constructible<gch::nonnull_dyn_ptr<const shape>, const square&>::value, "");
+
+static
+int
+total_area (const gch::nonnull_dyn_ptr<const shape> *first,
+            const gch::nonnull_dyn_ptr<const shape> *last)
+{
+  int sum = 0;
+  for (; first != last; ++first)
+    sum += first->call (&shape::area);
+  return sum;
+}
+
+static constexpr square g_square { 3, 0 };
+static constexpr gch::nonnull_dyn_ptr<const shape> g_dsquare { g_square };
+
+int
+main (void)
+{
+  square    s { 2, 0 };
+  rectangle r { 2, 3 };
+
+  gch::nonnull_dyn_ptr<shape> ds (s);
+  gch::nonnull_dyn_ptr<shape> dr = gch::make_nonnull_dyn_ptr<shape> (r);
+
+  CHECK (ds.call (&shape::area) == 4);
+  CHECK (dr.call (&shape::area) == 6);
+  CHECK (ds.object () == &s);
+
+  dr.call (&shape::scale, 2);
+  CHECK (r.width == 4 && r.height == 6);
+
+  const gch::nonnull_dyn_ptr<const shape> shapes[] {
+    ds,
+    dr,
+    gch::nonnull_dyn_ptr<const shape> (g_square),
+    g_dsquare
+  };
+  CHECK (total_area (shapes, shapes + 4) == 4 + 24 + 9 + 9);
+
+  gch::nonnull_ptr<square> ps (s);
+  gch::nonnull_dyn_ptr<shape> dps = ps;
+  CHECK (dps == ds);
+  CHECK (dps != dr);
+
+  swap (ds, dr);
+  CHECK (ds.call (&shape::area) == 24);
+  CHECK (dr.call (&shape::area) == 4);
+
+  // A single function is stored inline.
+  gch::nonnull_dyn_ptr<counter> dc (s);
+  CHECK (dc.call (&counter::next) == 1);
+  CHECK (dc.call (&counter::next) == 2);
+  CHECK (s.value == 2);
+
+  return 0;
+}
@@ -0,0 +1,106 @@
+/** test-nonnull_function_ref.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/nonnull_function_ref.hpp"
+
+static
+int
+twice (int x)
+{
+  return 2 * x;
+}
+
+struct accumulator
+{
+  int
+  operator() (int x)
+  {
+    return total += x;
+  }
+
+  int total;
+};
+
+struct const_callable
+{
+  long
+  operator() (int x) const
+  {
+    return x + offset;
+  }
+
+  long offset;
+};
+
+static
+int
+apply (gch::nonnull_function_ref<int (int)> f, int x)
+{
+  return f (x);
+}
+
+static_assert (sizeof (gch::nonnull_function_ref<int (int)>) == 2 * sizeof (void *), "");
+static_assert (std::is_trivially_copyable<gch::nonnull_function_ref<int (int)>>::value, "");
+static_assert (std::is_trivially_destructible<gch::nonnull_function_ref<int (int)>>::value, "");
+static_assert (! std::is_default_constructible<gch::nonnull_function_ref<int (int)>>::value, "");
+
+// Temporaries are rejected, as with `nonnull_ptr`.
+static_assert (! std::is_constructible<gch::nonnull_function_ref<int (int)>,
+                                       accumulator>::value, "");
+static_assert (! std::is_constructible<gch::nonnull_function_ref<int (int)>,
+                                       const accumulator&&>::value, "");
+
+// Incompatible signatures are rejected.
+static_assert (! std::is_constructible<gch::nonnull_function_ref<int (int)>,
+                                       int (&) (int, int)>::value, "");
+static_assert (! std::is_constructible<gch::nonnull_function_ref<int * (int)>,
+                                       accumulator&>::value, "");
+
+int
+main (void)
+{
+  CHECK (apply (twice, 3) == 6);
+
+  accumulator acc { 0 };
+  CHECK (apply (acc, 3) == 3);
+  CHECK (apply (acc, 4) == 7);
+  CHECK (acc.total == 7);
+
+  const const_callable cc { 10 };
+  gch::nonnull_function_ref<long (int)> rc (cc);
+  CHECK (rc (1) == 11);
+
+  // Return values may be converted or discarded.
+  gch::nonnull_function_ref<void (int)> rv (acc);
+  rv (1);
+  CHECK (acc.total == 8);
+
+  auto lambda = [&acc] (int x) { return acc.total * x; };
+  gch::nonnull_function_ref<int (int)> rl (lambda);
+  CHECK (rl (2) == 16);
+
+  gch::nonnull_ptr<accumulator> pacc (acc);
+  gch::nonnull_function_ref<int (int)> rp (pacc);
+  CHECK (rp (2) == 10);
+
+  gch::nonnull_function_ref<int (int)> rt (twice);
+  swap (rt, rl);
+  CHECK (rt (1) == 10);
+  CHECK (rl (1) == 2);
+
+  rt = rl;
+  CHECK (rt (5) == 10);
+
+#ifdef GCH_CTAD_SUPPORT
+  gch::nonnull_function_ref rd (twice);
+  static_assert (std::is_same<decltype (rd), gch::nonnull_function_ref<int (int)>>::value, "");
+  CHECK (rd (4) == 8);
+#endif
+
+  return 0;
+}
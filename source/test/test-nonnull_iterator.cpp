@@ -0,0 +1,108 @@
+/** test-nonnull_iterator.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/nonnull_iterator.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#ifdef GCH_LIB_CONCEPTS
+#  include <ranges>
+#endif
+
+using iter  = gch::nonnull_iterator<int>;
+using citer = gch::nonnull_iterator<const int>;
+
+static_assert (sizeof (iter) == sizeof (int *), "");
+static_assert (std::is_trivially_copyable<iter>::value, "");
+static_assert (std::is_convertible<iter, citer>::value, "");
+static_assert (! std::is_convertible<citer, iter>::value, "");
+static_assert (! std::is_convertible<int&, iter>::value, "");
+static_assert (! std::is_constructible<iter, int&&>::value, "");
+
+static_assert (std::is_same<std::iterator_traits<iter>::iterator_category,
+                            std::random_access_iterator_tag>::value, "");
+static_assert (std::is_same<std::iterator_traits<citer>::value_type, int>::value, "");
+
+#ifdef GCH_LIB_CONCEPTS
+static_assert (std::contiguous_iterator<iter>);
+static_assert (std::contiguous_iterator<citer>);
+static_assert (std::sized_sentinel_for<citer, iter>);
+#endif
+
+constexpr int global[] { 1, 2, 3 };
+static_assert (*(gch::make_nonnull_iterator (global[0]) + 2) == 3, "");
+static_assert (gch::make_nonnull_iterator (global[2]) - gch::make_nonnull_iterator (global[0]) == 2,
+               "");
+static_assert (std::pointer_traits<citer>::to_address (citer (global[1])) == &global[1], "");
+
+int
+main (void)
+{
+  int arr[] { 5, 3, 1, 4, 2 };
+  iter first (arr[0]);
+  iter last = first + 5;
+
+  CHECK (last - first == 5);
+  CHECK (first[3] == 4);
+  CHECK (*(2 + first) == 1);
+  CHECK (first < last);
+  CHECK (last > first);
+  CHECK (first <= first);
+  CHECK (last >= first);
+  CHECK (first != last);
+
+  iter it = first;
+  CHECK (*it++ == 5);
+  CHECK (*it == 3);
+  CHECK (*++it == 1);
+  CHECK (*it-- == 1);
+  CHECK (*--it == 5);
+  it += 4;
+  CHECK (*it == 2);
+  it -= 1;
+  CHECK (*it == 4);
+  CHECK (*(it - 1) == 1);
+
+  std::stable_sort (first, last);
+  CHECK (std::is_sorted (arr, arr + 5));
+
+  std::vector<int> out (5);
+  std::copy (citer (arr[0]), citer (arr[0]) + 5, out.begin ());
+  CHECK (std::equal (out.begin (), out.end (), citer (arr[0])));
+  CHECK (std::accumulate (first, last, 0) == 15);
+
+  std::fill (first, last, 7);
+  CHECK (std::count (arr, arr + 5, 7) == 5);
+
+  citer c = first;
+  CHECK (c == first);
+  CHECK (std::pointer_traits<citer>::to_address (c) == &arr[0]);
+
+  iter from_ptr (gch::make_nonnull_ptr (arr[1]));
+  CHECK (from_ptr.get () == &arr[1]);
+  swap (first, from_ptr);
+  CHECK (first.get () == &arr[1]);
+
+#ifdef GCH_LIB_CONCEPTS
+  CHECK (std::to_address (c) == &arr[0]);
+
+  std::ranges::subrange<citer> range { citer (arr[0]), citer (arr[0]) + 5 };
+  static_assert (std::ranges::contiguous_range<decltype (range)>);
+  CHECK (std::ranges::data (range) == &arr[0]);
+  CHECK (std::ranges::count (range, 7) == 5);
+#endif
+
+#ifdef GCH_CTAD_SUPPORT
+  gch::nonnull_iterator deduced (arr[0]);
+  static_assert (std::is_same<decltype (deduced), iter>::value, "");
+#endif
+
+  return 0;
+}
@@ -0,0 +1,60 @@
+/** test-nonnull_ptr_core.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "gch/nonnull_ptr_fwd.hpp"
+
+// The forward declaration is enough to name the type.
+struct registry
+{
+  const gch::nonnull_ptr<int> *first;
+  gch::nonnull_cptr<int>      *second;
+};
+
+#define NONNULL_PTR_TEST_CORE_ONLY
+#include "test_common.hpp"
+
+// Before C++20 the ordering comparisons need std::less, so <functional> is included.
+#if defined (GCH_LIB_THREE_WAY_COMPARISON) \
+ && (defined (_GLIBCXX_FUNCTIONAL) || defined (_LIBCPP_FUNCTIONAL))
+#  error "nonnull_ptr_core.hpp should not include <functional> from C++20."
+#endif
+
+#ifdef GCH_NONNULL_PTR_FUNCTIONAL_HPP
+#  error "nonnull_ptr_core.hpp should not include nonnull_ptr_functional.hpp."
+#endif
+
+int
+main (void)
+{
+  int x[2] = { 1, 2 };
+  gch::nonnull_ptr<int> p (x[0]);
+  gch::nonnull_ptr<int> q (x[1]);
+  gch::nonnull_cptr<int> c (x[0]);
+
+  registry r { &p, &c };
+  CHECK (*r.first == p);
+
+  CHECK (p == c);
+  CHECK (p != q);
+  CHECK (p == &x[0]);
+  CHECK (&x[1] != p);
+  CHECK (p != nullptr);
+  CHECK (! (nullptr == q));
+
+  // The orderings are defined by the core header, so they agree with the ones seen by
+  // translation units which include nonnull_ptr.hpp.
+  CHECK (p < q);
+  CHECK (q >= p);
+  CHECK (! (p > &x[1]));
+  CHECK (&x[0] <= q);
+
+  p.swap (q);
+  CHECK (*p == 2);
+  CHECK (*q == 1);
+
+  return 0;
+}
@@ -0,0 +1,78 @@
+/** test-nonnull_restrict_ptr.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/nonnull_restrict_ptr.hpp"
+
+#include <cstddef>
+
+static
+void
+saxpy (float a, gch::nonnull_restrict_ptr<const float> x, gch::nonnull_restrict_ptr<float> y,
+       std::size_t n)
+{
+  for (std::size_t i = 0; i < n; ++i)
+    y[i] += a * x[i];
+}
+
+static
+int
+first (gch::nonnull_ptr<const int> p)
+{
+  return *p;
+}
+
+static_assert (sizeof (gch::nonnull_restrict_ptr<int>) == sizeof (int *), "");
+static_assert (std::is_trivially_copyable<gch::nonnull_restrict_ptr<int>>::value, "");
+static_assert (! std::is_default_constructible<gch::nonnull_restrict_ptr<int>>::value, "");
+static_assert (! std::is_constructible<gch::nonnull_restrict_ptr<int>, int&&>::value, "");
+
+// Conversion to `nonnull_ptr` is implicit, but the no-alias promise must be made explicitly.
+static_assert (std::is_convertible<gch::nonnull_restrict_ptr<int>,
+                                   gch::nonnull_ptr<const int>>::value, "");
+static_assert (! std::is_convertible<gch::nonnull_restrict_ptr<const int>,
+                                     gch::nonnull_ptr<int>>::value, "");
+static_assert (! std::is_convertible<gch::nonnull_ptr<int>,
+                                     gch::nonnull_restrict_ptr<int>>::value, "");
+static_assert (! std::is_convertible<int&, gch::nonnull_restrict_ptr<int>>::value, "");
+
+constexpr int global = 7;
+static_assert (*gch::make_nonnull_restrict_ptr (global) == 7, "");
+
+int
+main (void)
+{
+  float xs[] { 1, 2, 3, 4, 5, 6, 7, 8 };
+  float ys[] { 8, 7, 6, 5, 4, 3, 2, 1 };
+
+  saxpy (2, gch::nonnull_restrict_ptr<const float> (xs[0]),
+         gch::nonnull_restrict_ptr<float> (ys[0]), 8);
+  for (std::size_t i = 0; i < 8; ++i)
+    CHECK (static_cast<int> (ys[i]) == static_cast<int> (i) + 10);
+
+  int i = 1;
+  int j = 2;
+  gch::nonnull_restrict_ptr<int> p = gch::make_nonnull_restrict_ptr (i);
+  gch::nonnull_restrict_ptr<int> q (gch::make_nonnull_ptr (j));
+  CHECK (p.get () == &i);
+  CHECK (*q == 2);
+  CHECK (first (p) == 1);
+  CHECK (p != q);
+
+  swap (p, q);
+  CHECK (p.get () == &j);
+  CHECK (q.get () == &i);
+
+  gch::nonnull_ptr<int> np = p;
+  CHECK (np == &j);
+
+  int *raw = q;
+  *raw = 3;
+  CHECK (*q == 3);
+
+  return 0;
+}
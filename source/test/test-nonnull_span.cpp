@@ -0,0 +1,203 @@
+/** test-nonnull_span.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/nonnull_span.hpp"
+
+#include <array>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static
+int
+sum (gch::nonnull_span<const int> s)
+{
+  return std::accumulate (s.begin (), s.end (), 0);
+}
+
+static
+int
+ends (gch::nonnull_span<const int, 4> s)
+{
+  return s.front () + s.back ();
+}
+
+static_assert (sizeof (gch::nonnull_span<int, 4>) == sizeof (int *), "");
+static_assert (sizeof (gch::nonnull_span<int>) == sizeof (int *) + sizeof (std::size_t), "");
+static_assert (std::is_trivially_copyable<gch::nonnull_span<int>>::value, "");
+static_assert (! std::is_default_constructible<gch::nonnull_span<int>>::value, "");
+static_assert (gch::nonnull_span<int, 4>::extent == 4, "");
+static_assert (gch::nonnull_span<int>::extent == gch::dynamic_extent, "");
+
+// Arrays convert implicitly, containers (which may be empty) explicitly.
+static_assert (std::is_convertible<int (&)[4], gch::nonnull_span<int, 4>>::value, "");
+static_assert (! std::is_convertible<int (&)[3], gch::nonnull_span<int, 4>>::value, "");
+static_assert (std::is_convertible<std::array<int, 4>&, gch::nonnull_span<const int>>::value, "");
+static_assert (! std::is_convertible<std::vector<int>&, gch::nonnull_span<int>>::value, "");
+static_assert (std::is_constructible<gch::nonnull_span<int>, std::vector<int>&>::value, "");
+static_assert (! std::is_constructible<gch::nonnull_span<int>, std::vector<int>&&>::value, "");
+static_assert (! std::is_constructible<gch::nonnull_span<int>, const std::vector<int>&>::value,
+               "");
+static_assert (! std::is_constructible<gch::nonnull_span<int>, std::string&>::value, "");
+
+// Static to dynamic is implicit, dynamic to static is explicit.
+static_assert (std::is_convertible<gch::nonnull_span<int, 4>,
+                                   gch::nonnull_span<const int>>::value, "");
+static_assert (! std::is_convertible<gch::nonnull_span<int>,
+                                     gch::nonnull_span<int, 4>>::value, "");
+static_assert (std::is_constructible<gch::nonnull_span<int, 4>,
+                                     gch::nonnull_span<int>>::value, "");
+static_assert (! std::is_constructible<gch::nonnull_span<int, 4>,
+                                       gch::nonnull_span<int, 3>>::value, "");
+static_assert (! std::is_constructible<gch::nonnull_span<int>,
+                                       gch::nonnull_span<const int>>::value, "");
+
+constexpr int global[] { 1, 2, 3 };
+static_assert (gch::nonnull_span<const int, 3> (global).back () == 3, "");
+static_assert (gch::nonnull_span<const int> (global).size () == 3, "");
+
+static
+void
+exit_on_abort (int)
+{
+  std::_Exit (0);
+}
+
+// The exit code with which CTest skips the assertion tests.
+static constexpr int skip_code = 77;
+
+int
+main (int argc, char **argv)
+{
+  // The assertion tests pass the name of an invalid access, which should abort before
+  // anything is read. Without assertions there is nothing to test.
+  if (argc > 1)
+  {
+#ifdef NDEBUG
+    printf ("Assertions are disabled.\n");
+    return skip_code;
+#else
+    std::signal (SIGABRT, &exit_on_abort);
+    std::vector<int> two { 1, 2 };
+    std::vector<int> none;
+    gch::nonnull_span<int> dynamic (two);
+    if (std::strcmp (argv[1], "first-out-of-range") == 0)
+    {
+      CHECK ((dynamic.first<5> ().size () == 0));
+    }
+    else if (std::strcmp (argv[1], "last-out-of-range") == 0)
+    {
+      CHECK ((dynamic.last<5> ().size () == 0));
+    }
+    else if (std::strcmp (argv[1], "empty-container") == 0)
+    {
+      CHECK (gch::nonnull_span<int> (none).size () == 0);
+    }
+    printf ("The access was not caught.\n");
+    return 1;
+#endif
+  }
+
+  int arr[] { 1, 2, 3, 4 };
+  gch::nonnull_span<int, 4> s4 (arr);
+  CHECK (s4.data () == &arr[0]);
+  CHECK (s4.size () == 4);
+  CHECK (s4.size_bytes () == sizeof (arr));
+  CHECK (! s4.empty ());
+  CHECK (ends (s4) == 5);
+  CHECK (sum (s4) == 10);
+  CHECK (s4[2] == 3);
+  CHECK (*s4.rbegin () == 4);
+
+  gch::nonnull_span<int> s = s4;
+  CHECK (s.size () == 4);
+  CHECK (s.begin () == s4.begin ());
+
+  CHECK ((s4.first<2> ().size () == 2));
+  CHECK ((s4.last<2> ().front () == 3));
+  CHECK ((s4.subspan<1, 2> ().back () == 3));
+  CHECK (s.first (3).back () == 3);
+  CHECK (s.last (1).front () == 4);
+  CHECK (s.subspan (1, 2).front () == 2);
+  CHECK (s.subspan (2).size () == 2);
+
+  gch::nonnull_span<int, 4> back_to_static (s);
+  CHECK (back_to_static.data () == s.data ());
+
+  std::vector<int> v { 5, 6, 7 };
+  gch::nonnull_span<int> vs (v);
+  CHECK (vs.size () == 3);
+  CHECK (vs.front () == 5);
+  CHECK (gch::make_nonnull_span (v).back () == 7);
+  CHECK ((vs.first<3> ().back () == 7));
+  CHECK ((vs.last<3> ().front () == 5));
+
+  // The checked factories reject empty spans in every build.
+  CHECK (gch::make_nonnull_span_checked (v).size () == 3);
+  CHECK (gch::make_nonnull_span_checked (gch::make_nonnull_ptr (arr[0]), 4).back () == 4);
+  bool threw = false;
+  try
+  {
+    std::vector<int> none;
+    static_cast<void> (gch::make_nonnull_span_checked (none));
+  }
+  catch (const std::invalid_argument&)
+  {
+    threw = true;
+  }
+  CHECK (threw);
+
+  threw = false;
+  try
+  {
+    static_cast<void> (gch::make_nonnull_span_checked (gch::make_nonnull_ptr (arr[0]), 0));
+  }
+  catch (const std::invalid_argument&)
+  {
+    threw = true;
+  }
+  CHECK (threw);
+
+  const std::vector<int>& cv = v;
+  CHECK (sum (gch::nonnull_span<const int> (cv)) == 18);
+
+  std::array<int, 2> a { { 8, 9 } };
+  CHECK (sum (a) == 17);
+
+  gch::nonnull_span<int> from_ptr = gch::make_nonnull_span (gch::make_nonnull_ptr (arr[1]), 2);
+  CHECK (from_ptr.back () == 3);
+
+  swap (s, from_ptr);
+  CHECK (s.size () == 2);
+  CHECK (from_ptr.size () == 4);
+
+#ifdef GCH_CTAD_SUPPORT
+  gch::nonnull_span deduced_array (arr);
+  static_assert (std::is_same<decltype (deduced_array), gch::nonnull_span<int, 4>>::value, "");
+
+  gch::nonnull_span deduced_vector (v);
+  static_assert (std::is_same<decltype (deduced_vector), gch::nonnull_span<int>>::value, "");
+
+  gch::nonnull_span deduced_std_array (a);
+  static_assert (std::is_same<decltype (deduced_std_array), gch::nonnull_span<int, 2>>::value,
+                 "");
+#endif
+
+#ifdef GCH_LIB_SPAN
+  std::span<const int> std_span = s4;
+  CHECK (std_span.size () == 4);
+  std::span<int, 4> static_std_span = s4;
+  CHECK (static_std_span.data () == arr);
+#endif
+
+  return 0;
+}
@@ -0,0 +1,138 @@
+/** test-nonnull_variant_ptr.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/nonnull_variant_ptr.hpp"
+
+struct alignas (4) literal
+{
+  int value;
+};
+
+struct alignas (4) negate
+{
+  int operand;
+};
+
+struct alignas (4) add
+{
+  int lhs;
+  int rhs;
+};
+
+struct incomplete;
+
+using node_ptr = gch::nonnull_variant_ptr<literal, negate, const add>;
+
+// Alternatives may be incomplete where the type is only named.
+using forward_ptr = gch::nonnull_variant_ptr<literal, incomplete>;
+
+static_assert (sizeof (node_ptr) == sizeof (void *), "");
+static_assert (std::is_trivially_copyable<node_ptr>::value, "");
+static_assert (! std::is_default_constructible<node_ptr>::value, "");
+static_assert (node_ptr::tag_bits == 2, "");
+static_assert (gch::nonnull_variant_ptr<literal>::tag_bits == 0, "");
+static_assert (gch::nonnull_variant_ptr<literal, negate>::tag_bits == 1, "");
+static_assert (node_ptr::index_of<negate>::value == 1, "");
+static_assert (node_ptr::index_of<int>::value == 3, "");
+static_assert (std::is_same<node_ptr::alternative<2>, const add>::value, "");
+
+static_assert (! std::is_constructible<node_ptr, literal>::value, "");
+static_assert (! std::is_constructible<node_ptr, int&>::value, "");
+static_assert (! std::is_constructible<node_ptr, const literal&>::value, "");
+static_assert (  std::is_constructible<node_ptr, const add&>::value, "");
+static_assert (  std::is_constructible<node_ptr, add&>::value, "");
+
+struct evaluator
+{
+  int
+  operator() (const literal& n) const noexcept
+  {
+    return n.value;
+  }
+
+  int
+  operator() (const negate& n) const noexcept
+  {
+    return -n.operand;
+  }
+
+  int
+  operator() (const add& n) const noexcept
+  {
+    return n.lhs + n.rhs;
+  }
+};
+
+struct doubler
+{
+  void
+  operator() (literal& n) const noexcept
+  {
+    n.value *= 2;
+  }
+
+  void
+  operator() (negate& n) const noexcept
+  {
+    n.operand *= 2;
+  }
+
+  void
+  operator() (const add&) const noexcept
+  { }
+};
+
+int
+main (void)
+{
+  literal   l { 3 };
+  negate    n { 4 };
+  const add a { 1, 2 };
+
+  node_ptr pl (l);
+  node_ptr pn = gch::nonnull_ptr<negate> (n);
+  node_ptr pa (a);
+
+  CHECK (pl.index () == 0);
+  CHECK (pn.index () == 1);
+  CHECK (pa.index () == 2);
+
+  CHECK (pl.holds<literal> ());
+  CHECK (! pl.holds<negate> ());
+  CHECK (gch::holds_alternative<const add> (pa));
+
+  CHECK (pl.get<literal> () == &l);
+  CHECK (pn.get_if<negate> () == &n);
+  CHECK (pn.get_if<literal> () == nullptr);
+  CHECK (gch::get_if<const add> (pa) == &a);
+  CHECK (pa.address () == &a);
+
+  CHECK (pl.visit (evaluator { }) == 3);
+  CHECK (gch::visit (evaluator { }, pn) == -4);
+  CHECK (pa.visit (evaluator { }) == 3);
+
+  pl.visit (doubler { });
+  pn.visit (doubler { });
+  CHECK (l.value == 6);
+  CHECK (n.operand == 8);
+
+  node_ptr pl2 (l);
+  CHECK (pl == pl2);
+  CHECK (pl != pn);
+
+  add b { 5, 6 };
+  node_ptr pb (b);
+  CHECK (pb.holds<const add> ());
+  CHECK (pb.visit (evaluator { }) == 11);
+
+  swap (pl2, pn);
+  CHECK (pn == pl);
+  CHECK (pl2.holds<negate> ());
+
+  return 0;
+}
@@ -0,0 +1,97 @@
+/** test-nonnull_views.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/nonnull_views.hpp"
+
+#ifdef GCH_LIB_RANGES
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+static
+int
+read (gch::nonnull_ptr<const int> p)
+{
+  return *p;
+}
+
+static_assert (std::ranges::random_access_range<
+  decltype (std::declval<std::vector<int>&> () | gch::views::addressof)>);
+static_assert (std::is_same_v<
+  std::ranges::range_value_t<decltype (std::declval<std::deque<int>&> () | gch::views::addressof)>,
+  gch::nonnull_ptr<int>>);
+
+// Only lvalues have addresses.
+static_assert (! std::is_invocable_v<decltype (gch::views::addressof),
+                                     decltype (std::views::iota (0, 3))>);
+
+static_assert (std::is_same_v<
+  std::ranges::range_value_t<
+    decltype (std::declval<std::vector<std::unique_ptr<int>>&> () | gch::views::nonnull)>,
+  gch::nonnull_ptr<int>>);
+
+static_assert (std::is_same_v<
+  std::ranges::range_reference_t<
+    decltype (std::declval<std::vector<gch::nonnull_ptr<const int>>&> () | gch::views::deref)>,
+  const int&>);
+
+int
+main (void)
+{
+  std::deque<int> d { 1, 2, 3 };
+  int total = 0;
+  for (gch::nonnull_ptr<int> p : d | gch::views::addressof)
+    total += read (p);
+  CHECK (total == 6);
+
+  std::vector<gch::nonnull_ptr<int>> ptrs;
+  std::ranges::copy (gch::views::addressof (d), std::back_inserter (ptrs));
+  CHECK (ptrs.size () == 3);
+  CHECK (ptrs[1] == &d[1]);
+
+  for (int& x : ptrs | gch::views::deref)
+    x *= 10;
+  CHECK (d[2] == 30);
+
+  std::vector<std::unique_ptr<int>> owners;
+  owners.push_back (std::make_unique<int> (4));
+  owners.push_back (std::make_unique<int> (5));
+  CHECK (gch::all_nonnull (owners));
+
+  total = 0;
+  for (gch::nonnull_ptr<int> p : owners | gch::views::nonnull)
+    total += read (p);
+  CHECK (total == 9);
+  CHECK ((owners | gch::views::nonnull)[1] == owners[1].get ());
+
+  int x = 1;
+  std::vector<int *> raw { &x, nullptr };
+  CHECK (! gch::all_nonnull (raw));
+  CHECK ((raw | std::views::take (1) | gch::views::nonnull).front () == &x);
+
+  // Adaptors compose with the standard ones.
+  auto doubled = owners | gch::views::nonnull | gch::views::deref
+                        | std::views::transform ([] (int v) noexcept { return v * 2; });
+  total = 0;
+  for (int v : doubled)
+    total += v;
+  CHECK (total == 18);
+
+  return 0;
+}
+
+#else
+
+int
+main (void)
+{
+  return 0;
+}
+
+#endif
@@ -0,0 +1,177 @@
+/** test-trace.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GCH_NONNULL_PTR_TRACE
+#  define GCH_NONNULL_PTR_TRACE
+#endif
+
+#include "test_common.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+  // Each of these is on its own cache line.
+  struct alignas (64) strided
+  {
+    std::uint64_t value;
+  };
+
+  struct hot
+  {
+    std::uint64_t value;
+  };
+
+  constexpr std::size_t strided_count = 16384;
+  constexpr std::size_t hot_count     = 2 * GCH_NONNULL_PTR_TRACE_BUFFER_SIZE;
+
+  strided g_strided[strided_count];
+  hot     g_hot;
+
+  struct trace_record
+  {
+    std::uint64_t address;
+    std::uint32_t type;
+  };
+
+  std::uint64_t
+  get_le (const unsigned char *p, std::size_t bytes)
+  {
+    std::uint64_t x = 0;
+    while (bytes != 0)
+      x = (x << 8) | p[--bytes];
+    return x;
+  }
+
+  bool
+  read_trace (const char *path, std::vector<trace_record>& records,
+              std::vector<std::string>& types)
+  {
+    std::FILE *file = std::fopen (path, "rb");
+    if (file == nullptr)
+      return false;
+
+    unsigned char header[12];
+    bool valid = std::fread (header, 1, sizeof (header), file) == sizeof (header)
+              && std::memcmp (header, gch::trace::format::magic, 8) == 0
+              && get_le (header + 8, 4) == gch::trace::format::version;
+
+    unsigned char chunk[8];
+    while (valid && std::fread (chunk, 1, sizeof (chunk), file) == sizeof (chunk))
+    {
+      const std::uint64_t kind  = get_le (chunk, 4);
+      const std::size_t   count = static_cast<std::size_t> (get_le (chunk + 4, 4));
+      std::vector<unsigned char> data (
+        kind == static_cast<std::uint64_t> (gch::trace::format::chunk_kind::records)
+          ? count * gch::trace::format::record_size : 4 + count);
+
+      if (std::fread (data.data (), 1, data.size (), file) != data.size ())
+        valid = false;
+      else if (kind == static_cast<std::uint64_t> (gch::trace::format::chunk_kind::records))
+      {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+          const unsigned char *r = data.data () + i * gch::trace::format::record_size;
+          records.push_back ({ get_le (r, 8), static_cast<std::uint32_t> (get_le (r + 8, 4)) });
+
+          // The type chunk comes first.
+          if (records.back ().type >= types.size ())
+            valid = false;
+        }
+      }
+      else
+      {
+        // The IDs are numbered in the order of their type chunks.
+        if (get_le (data.data (), 4) != types.size ())
+          valid = false;
+        types.emplace_back (data.begin () + 4, data.end ());
+      }
+    }
+
+    std::fclose (file);
+    return valid;
+  }
+
+}
+
+int
+main (int argc, char **argv)
+{
+  // The trace simulator test passes a path, and keeps the trace.
+  const std::string path = argc > 1 ? std::string (argv[1])
+                                    : "test-trace.c++" + std::to_string (__cplusplus) + ".trace";
+
+  // Nothing is recorded before the trace starts.
+  gch::nonnull_ptr<hot> h (g_hot);
+  h->value = 1;
+
+  CHECK (gch::trace::start (path.c_str ()));
+  CHECK (! gch::trace::start (path.c_str ()));
+  CHECK (gch::trace::is_running ());
+
+  // Two passes over 1 MiB, with one dereference per cache line.
+  std::uint64_t sum = 0;
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    for (strided& s : g_strided)
+    {
+      gch::nonnull_ptr<const strided> p (s);
+      sum += (*p).value;
+    }
+  }
+  CHECK (sum == 0);
+
+  // This fills the ring of the thread, so it has to wait for the writer.
+  std::thread worker ([] () noexcept {
+    gch::nonnull_ptr<hot> p (g_hot);
+    for (std::size_t i = 0; i < hot_count; ++i)
+      ++p->value;
+  });
+  worker.join ();
+
+  gch::trace::stop ();
+  CHECK (! gch::trace::is_running ());
+  h->value = 0;
+
+  std::vector<trace_record> records;
+  std::vector<std::string> types;
+  CHECK (read_trace (path.c_str (), records, types));
+  if (argc <= 1)
+    std::remove (path.c_str ());
+
+  CHECK (records.size () == 2 * strided_count + hot_count);
+  CHECK (types.size () == 2);
+
+  // Each thread's records are in program order.
+  std::size_t next_strided = 0;
+  std::size_t hot_records  = 0;
+  for (const trace_record& r : records)
+  {
+    CHECK (r.type < types.size ());
+    if (types[r.type].find ("strided") != std::string::npos)
+    {
+      const strided *expected = &g_strided[next_strided++ % strided_count];
+      CHECK (r.address == reinterpret_cast<std::uintptr_t> (expected));
+    }
+    else
+    {
+      CHECK (types[r.type].find ("hot") != std::string::npos);
+      CHECK (r.address == reinterpret_cast<std::uintptr_t> (&g_hot));
+      ++hot_records;
+    }
+  }
+  CHECK (next_strided == 2 * strided_count);
+  CHECK (hot_records == hot_count);
+
+  return 0;
+}
@@ -0,0 +1,111 @@
+/** test-work_stealing_deque.cpp
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "test_common.hpp"
+#include "gch/work_stealing_deque.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using deque = gch::work_stealing_deque<int>;
+
+static_assert (! std::is_copy_constructible<deque>::value, "");
+
+int
+main (void)
+{
+  {
+    deque d (4);
+    CHECK (d.empty ());
+    CHECK (d.capacity () == 4);
+    CHECK (d.pop () == nullptr);
+    CHECK (d.steal () == nullptr);
+
+    int x[10] = { };
+
+    // The owner pops in LIFO order; thieves steal in FIFO order.
+    d.push (gch::nonnull_ptr<int> (x[0]));
+    d.push (gch::nonnull_ptr<int> (x[1]));
+    d.push (gch::nonnull_ptr<int> (x[2]));
+    CHECK (d.size () == 3);
+    CHECK (d.pop () == &x[2]);
+    CHECK (d.steal () == &x[0]);
+    CHECK (d.pop () == &x[1]);
+    CHECK (d.pop () == nullptr);
+    CHECK (d.steal () == nullptr);
+    CHECK (d.empty ());
+
+    // Growing keeps the elements in place, including ones wrapped around the old buffer.
+    for (int& i : x)
+      d.push (gch::nonnull_ptr<int> (i));
+    CHECK (d.capacity () == 16);
+    CHECK (d.size () == 10);
+    CHECK (d.steal () == &x[0]);
+    CHECK (d.steal () == &x[1]);
+    for (int i = 9; i >= 2; --i)
+      CHECK (d.pop () == &x[i]);
+    CHECK (d.empty ());
+  }
+
+  // One owner pushes and pops while several thieves steal: every item is taken once.
+  {
+    const std::size_t items = 100000;
+    const int thieves = 3;
+
+    std::vector<int> values (items);
+    std::vector<std::atomic<int>> taken (items);
+    for (std::atomic<int>& t : taken)
+      t.store (0, std::memory_order_relaxed);
+
+    deque d (2);
+    std::atomic<bool> done (false);
+
+    auto take = [&] (int *p) noexcept {
+      taken[static_cast<std::size_t> (p - values.data ())].fetch_add (1,
+                                                                     std::memory_order_relaxed);
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thieves; ++t)
+    {
+      threads.emplace_back ([&] () noexcept {
+        while (! done.load (std::memory_order_acquire))
+        {
+          if (int *p = d.steal ())
+            take (p);
+          else
+            std::this_thread::yield ();
+        }
+      });
+    }
+
+    for (std::size_t i = 0; i < items; ++i)
+    {
+      d.push (gch::nonnull_ptr<int> (values[i]));
+      if (i % 3 == 0)
+      {
+        if (int *p = d.pop ())
+          take (p);
+      }
+    }
+    while (int *p = d.pop ())
+      take (p);
+
+    done.store (true, std::memory_order_release);
+    for (std::thread& t : threads)
+      t.join ();
+
+    bool each_once = true;
+    for (std::atomic<int>& t : taken)
+      each_once = each_once && t.load (std::memory_order_relaxed) == 1;
+    CHECK (each_once);
+    CHECK (d.empty ());
+  }
+
+  return 0;
+}
@@ -8,7 +8,14 @@
 #ifndef NONNULL_PTR_TEST_COMMON_HPP
 #define NONNULL_PTR_TEST_COMMON_HPP
 
-#include "gch/nonnull_ptr.hpp"
+// Tests of the core header define this so that nothing else is included, and tests of the
+// module define NONNULL_PTR_TEST_MODULE and import it themselves.
+#if defined (NONNULL_PTR_TEST_MODULE)
+#elif defined (NONNULL_PTR_TEST_CORE_ONLY)
+#  include "gch/nonnull_ptr_core.hpp"
+#else
+#  include "gch/nonnull_ptr.hpp"
+#endif
 
 #include <cstdio>
 
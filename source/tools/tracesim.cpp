@@ -0,0 +1,430 @@
+/** tracesim.cpp
+ * Replays a trace written by nonnull_ptr in the trace mode (see
+ * nonnull_ptr_trace.hpp) through a model of set-associative caches and a TLB,
+ * and reports the miss rates for each value type.
+ *
+ * Usage: nonnull_ptr.tracesim [options] trace-file
+ *
+ *   --cache SIZE:WAYS:LINE    Adds a cache level (the first replaces the default
+ *                             levels of 32K:8:64 and 1M:16:64). Each level is looked
+ *                             up on a miss in the level before it.
+ *   --tlb ENTRIES:WAYS:PAGE   Sets the TLB (default 64:4:4K).
+ *   --no-tlb                  Does not model a TLB.
+ *
+ * Sizes may have a suffix of K, M or G. All levels use LRU replacement.
+ *
+ * Copyright © 2022 Gene Harvey
+ *
+ * This software may be modified and distributed under the terms
+ * of the MIT license. See the LICENSE file for details.
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+  // The layout is described in nonnull_ptr_trace.hpp.
+  constexpr char          trace_magic[8]    = { 'G', 'C', 'H', 'T', 'R', 'A', 'C', 'E' };
+  constexpr std::uint32_t trace_version     = 1;
+  constexpr std::uint32_t chunk_records     = 1;
+  constexpr std::uint32_t chunk_type        = 2;
+  constexpr std::size_t   trace_record_size = 12;
+
+  // No type name comes anywhere near this long.
+  constexpr std::uint32_t max_type_name = 1 << 20;
+
+  // Records are read in blocks of this many, so that a corrupt count cannot make the
+  // simulator allocate much.
+  constexpr std::uint32_t record_block = 4096;
+
+  /**
+   * A set-associative cache with LRU replacement. A TLB is modeled as a cache whose
+   * lines are pages.
+   */
+  class cache_level
+  {
+  public:
+    cache_level (std::string name, std::uint64_t size, std::uint64_t ways, std::uint64_t line)
+      : m_name (std::move (name)),
+        m_size (size),
+        m_ways (ways),
+        m_line (line),
+        m_sets (size / (ways * line)),
+        m_tags (m_sets * ways, 0),
+        m_stamps (m_sets * ways, 0),
+        m_clock (0)
+    { }
+
+    /**
+     * Looks up an address, and fills its line on a miss.
+     *
+     * @param address an address.
+     * @return whether the address hit.
+     */
+    bool
+    access (std::uint64_t address)
+    {
+      // Tags are stored plus one, so that zero marks an empty way.
+      const std::uint64_t block = address / m_line;
+      const std::uint64_t tag   = block + 1;
+      const std::uint64_t first = (block % m_sets) * m_ways;
+
+      ++m_clock;
+      std::uint64_t victim = first;
+      for (std::uint64_t i = first; i < first + m_ways; ++i)
+      {
+        if (m_tags[i] == tag)
+        {
+          m_stamps[i] = m_clock;
+          return true;
+        }
+        if (m_stamps[i] < m_stamps[victim])
+          victim = i;
+      }
+
+      m_tags[victim]   = tag;
+      m_stamps[victim] = m_clock;
+      return false;
+    }
+
+    const std::string&
+    name (void) const noexcept
+    {
+      return m_name;
+    }
+
+    std::uint64_t size (void) const noexcept { return m_size; }
+    std::uint64_t ways (void) const noexcept { return m_ways; }
+    std::uint64_t line (void) const noexcept { return m_line; }
+
+  private:
+    std::string                m_name;
+    std::uint64_t              m_size;
+    std::uint64_t              m_ways;
+    std::uint64_t              m_line;
+    std::uint64_t              m_sets;
+    std::vector<std::uint64_t> m_tags;
+    std::vector<std::uint64_t> m_stamps;
+    std::uint64_t              m_clock;
+  };
+
+  struct type_stats
+  {
+    std::string                type;
+    std::uint64_t              accesses = 0;
+    std::vector<std::uint64_t> misses;     // By cache level.
+    std::uint64_t              tlb_misses = 0;
+  };
+
+  bool
+  parse_size (const std::string& s, std::uint64_t& out)
+  {
+    char *end = nullptr;
+    const unsigned long long n = std::strtoull (s.c_str (), &end, 10);
+    if (end == s.c_str ())
+      return false;
+
+    std::uint64_t scale = 1;
+    if (*end == 'K' || *end == 'k')
+      scale = 1ULL << 10;
+    else if (*end == 'M' || *end == 'm')
+      scale = 1ULL << 20;
+    else if (*end == 'G' || *end == 'g')
+      scale = 1ULL << 30;
+
+    if (scale != 1)
+      ++end;
+    if (*end != '\0' || n == 0)
+      return false;
+
+    out = n * scale;
+    return true;
+  }
+
+  // Parses "SIZE:WAYS:LINE".
+  bool
+  parse_geometry (const char *arg, std::uint64_t (&out)[3])
+  {
+    std::string s (arg);
+    for (int i = 0; i < 3; ++i)
+    {
+      const std::string::size_type colon = s.find (':');
+      if ((colon == std::string::npos) != (i == 2))
+        return false;
+      if (! parse_size (s.substr (0, colon), out[i]))
+        return false;
+      if (colon != std::string::npos)
+        s.erase (0, colon + 1);
+    }
+    return true;
+  }
+
+  std::uint32_t
+  get_u32 (const unsigned char *p) noexcept
+  {
+    std::uint32_t x = 0;
+    for (int i = 3; i >= 0; --i)
+      x = (x << 8) | p[i];
+    return x;
+  }
+
+  std::uint64_t
+  get_u64 (const unsigned char *p) noexcept
+  {
+    std::uint64_t x = 0;
+    for (int i = 7; i >= 0; --i)
+      x = (x << 8) | p[i];
+    return x;
+  }
+
+
+  void
+  usage (void)
+  {
+    std::fputs ("Usage: nonnull_ptr.tracesim [--cache SIZE:WAYS:LINE]... "
+                "[--tlb ENTRIES:WAYS:PAGE | --no-tlb] trace-file\n", stderr);
+  }
+
+}
+
+int
+main (int argc, char **argv)
+{
+  std::vector<cache_level> caches;
+  std::vector<cache_level> tlb;
+  tlb.emplace_back ("TLB", 64 * 4096, 4, 4096);
+  const char *path = nullptr;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    const char *arg = argv[i];
+    std::uint64_t g[3];
+    if (std::strcmp (arg, "--cache") == 0 && i + 1 < argc)
+    {
+      if (! parse_geometry (argv[++i], g) || g[0] % (g[1] * g[2]) != 0)
+      {
+        std::fprintf (stderr, "Invalid cache geometry: %s\n", argv[i]);
+        return 2;
+      }
+      caches.emplace_back ("L" + std::to_string (caches.size () + 1), g[0], g[1], g[2]);
+    }
+    else if (std::strcmp (arg, "--tlb") == 0 && i + 1 < argc)
+    {
+      if (! parse_geometry (argv[++i], g) || g[0] % g[1] != 0)
+      {
+        std::fprintf (stderr, "Invalid TLB geometry: %s\n", argv[i]);
+        return 2;
+      }
+      tlb.clear ();
+      tlb.emplace_back ("TLB", g[0] * g[2], g[1], g[2]);
+    }
+    else if (std::strcmp (arg, "--no-tlb") == 0)
+      tlb.clear ();
+    else if (arg[0] != '-' && path == nullptr)
+      path = arg;
+    else
+    {
+      usage ();
+      return 2;
+    }
+  }
+
+  if (path == nullptr)
+  {
+    usage ();
+    return 2;
+  }
+
+  if (caches.empty ())
+  {
+    caches.emplace_back ("L1", 32 * 1024, 8, 64);
+    caches.emplace_back ("L2", 1024 * 1024, 16, 64);
+  }
+
+  std::FILE *file = std::fopen (path, "rb");
+  if (file == nullptr)
+  {
+    std::fprintf (stderr, "Could not open %s.\n", path);
+    return 1;
+  }
+
+  unsigned char header[sizeof (trace_magic) + 4];
+  if (std::fread (header, 1, sizeof (header), file) != sizeof (header)
+      || std::memcmp (header, trace_magic, sizeof (trace_magic)) != 0
+      || get_u32 (header + sizeof (trace_magic)) != trace_version)
+  {
+    std::fprintf (stderr, "%s is not a nonnull_ptr trace of version %u.\n", path,
+                  static_cast<unsigned> (trace_version));
+    std::fclose (file);
+    return 1;
+  }
+
+  std::vector<type_stats> stats;
+  std::vector<unsigned char> buffer;
+  std::uint64_t records = 0;
+  bool truncated = false;
+  bool corrupt = false;
+
+  unsigned char chunk[8];
+  while (! truncated && ! corrupt && std::fread (chunk, 1, sizeof (chunk), file) == sizeof (chunk))
+  {
+    const std::uint32_t kind  = get_u32 (chunk);
+    const std::uint32_t count = get_u32 (chunk + 4);
+
+    if (kind == chunk_records)
+    {
+      for (std::uint32_t remaining = count; remaining != 0 && ! corrupt; )
+      {
+        const std::uint32_t n = remaining < record_block ? remaining : record_block;
+        buffer.resize (n * trace_record_size);
+        if (std::fread (buffer.data (), 1, buffer.size (), file) != buffer.size ())
+        {
+          truncated = true;
+          break;
+        }
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+          const unsigned char *r = buffer.data () + i * trace_record_size;
+          const std::uint64_t address = get_u64 (r);
+          const std::uint32_t id = get_u32 (r + 8);
+          if (id >= stats.size ())
+          {
+            std::fprintf (stderr, "%s has a record of the type ID %lu before its type chunk.\n",
+                          path, static_cast<unsigned long> (id));
+            corrupt = true;
+            break;
+          }
+
+          type_stats& s = stats[id];
+          ++s.accesses;
+          for (std::size_t level = 0; level < caches.size (); ++level)
+          {
+            if (caches[level].access (address))
+              break;
+            ++s.misses[level];
+          }
+
+          if (! tlb.empty () && ! tlb.front ().access (address))
+            ++s.tlb_misses;
+          ++records;
+        }
+        remaining -= n;
+      }
+    }
+    else if (kind == chunk_type)
+    {
+      if (count > max_type_name)
+      {
+        std::fprintf (stderr, "%s has a type name of %lu bytes.\n", path,
+                      static_cast<unsigned long> (count));
+        corrupt = true;
+        break;
+      }
+
+      buffer.resize (std::size_t { 4 } + count);
+      if (std::fread (buffer.data (), 1, buffer.size (), file) != buffer.size ())
+      {
+        truncated = true;
+        break;
+      }
+
+      // The IDs are numbered in the order of their type chunks.
+      const std::uint32_t id = get_u32 (buffer.data ());
+      if (id != stats.size ())
+      {
+        std::fprintf (stderr, "%s has a type chunk for the type ID %lu out of order.\n", path,
+                      static_cast<unsigned long> (id));
+        corrupt = true;
+        break;
+      }
+
+      stats.emplace_back ();
+      stats.back ().type.assign (buffer.begin () + 4, buffer.end ());
+      stats.back ().misses.resize (caches.size (), 0);
+    }
+    else
+    {
+      // The size of an unknown chunk is not known, so nothing after it can be read.
+      std::fprintf (stderr, "%s has a chunk of unknown kind %lu.\n", path,
+                    static_cast<unsigned long> (kind));
+      corrupt = true;
+    }
+  }
+  std::fclose (file);
+
+  if (corrupt)
+    return 1;
+
+  std::printf ("%llu records", static_cast<unsigned long long> (records));
+  std::printf (truncated ? " (the trace is truncated)\n" : "\n");
+  for (const cache_level& c : caches)
+  {
+    std::printf ("%-4s %10llu bytes, %3llu-way, %4llu-byte lines\n", c.name ().c_str (),
+                 static_cast<unsigned long long> (c.size ()),
+                 static_cast<unsigned long long> (c.ways ()),
+                 static_cast<unsigned long long> (c.line ()));
+  }
+  for (const cache_level& t : tlb)
+  {
+    std::printf ("%-4s %10llu entries, %3llu-way, %4llu-byte pages\n", t.name ().c_str (),
+                 static_cast<unsigned long long> (t.size () / t.line ()),
+                 static_cast<unsigned long long> (t.ways ()),
+                 static_cast<unsigned long long> (t.line ()));
+  }
+
+  type_stats total;
+  total.type = "total";
+  total.misses.assign (caches.size (), 0);
+
+  std::vector<type_stats> rows;
+  for (std::size_t id = 0; id < stats.size (); ++id)
+  {
+    type_stats s = stats[id];
+    if (s.accesses == 0)
+      continue;
+    if (s.type.empty ())
+      s.type = "type " + std::to_string (id);
+
+    total.accesses   += s.accesses;
+    total.tlb_misses += s.tlb_misses;
+    for (std::size_t level = 0; level < caches.size (); ++level)
+      total.misses[level] += s.misses[level];
+    rows.push_back (std::move (s));
+  }
+
+  std::sort (rows.begin (), rows.end (), [] (const type_stats& lhs, const type_stats& rhs) {
+    return lhs.accesses != rhs.accesses ? lhs.accesses > rhs.accesses : lhs.type < rhs.type;
+  });
+  rows.push_back (total);
+
+  // The miss rates of every level are relative to all accesses, not to the accesses
+  // which reached that level.
+  std::printf ("\n%-40s %12s", "type", "accesses");
+  for (const cache_level& c : caches)
+    std::printf (" %9s", (c.name () + " miss").c_str ());
+  if (! tlb.empty ())
+    std::printf (" %9s", "TLB miss");
+  std::printf ("\n");
+
+  for (const type_stats& s : rows)
+  {
+    const double n = static_cast<double> (std::max (s.accesses, std::uint64_t { 1 }));
+    std::printf ("%-40s %12llu", s.type.c_str (), static_cast<unsigned long long> (s.accesses));
+    for (std::uint64_t m : s.misses)
+      std::printf (" %8.2f%%", 100.0 * static_cast<double> (m) / n);
+    if (! tlb.empty ())
+      std::printf (" %8.2f%%", 100.0 * static_cast<double> (s.tlb_misses) / n);
+    std::printf ("\n");
+  }
+
+  return 0;
+}